@@ -9,4 +9,6 @@ IncludeDir["VulkanSDK"] = "%{VULKAN_SDK}/include"
 
 
 Library = {}
-Library["Vulkan"] = "%{VULKAN_SDK}/Lib/vulkan-1.lib"
\ No newline at end of file
+Library["Vulkan"] = "%{VULKAN_SDK}/Lib/vulkan-1.lib"
+Library["ShaderC"] = "%{VULKAN_SDK}/Lib/shaderc_shared.lib"
+Library["SpirvTools"] = "%{VULKAN_SDK}/Lib/SPIRV-Tools-shared.lib"
\ No newline at end of file
@@ -23,7 +23,9 @@ project "VulkanTutorial"
     links
     {
         "glfw",
-        "%{Library.Vulkan}"
+        "%{Library.Vulkan}",
+        "%{Library.ShaderC}",          -- 运行时编译GLSL(shader热重载)
+        "%{Library.SpirvTools}"        -- 校验生成的SPIR-V(等同spirv-val)
     }
 
     defines
@@ -31,12 +33,14 @@ project "VulkanTutorial"
         "GLFW_INCLUDE_VULKAN",
         "GLM_FORCE_RADIANS",
         "GLM_FORCE_DEPTH_ZERO_TO_ONE",
-        "NOMINMAX"                     -- Windows.h中的min() max()禁用
+        "NOMINMAX",                    -- Windows.h中的min() max()禁用
+        "SPIRV_TOOLS_SHAREDLIB"        -- 使用SPIRV-Tools的动态库
     }
 
     filter "system:windows"
         systemversion "latest"
         defines "VK_USE_PLATFORM_WIN32_KHR"
+        links "windowscodecs"          -- WIC解码纹理图片
 
     filter "configurations:Debug"
         defines "VK_TUTORIAL_DEBUG"
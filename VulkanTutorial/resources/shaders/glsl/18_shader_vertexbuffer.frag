@@ -1,9 +1,28 @@
 #version 450
 
+// Specialized pipelines turn these into constants and fold the branches; the ubershader (defaults) reads push constants.
+layout(constant_id = 16) const bool IsUbershader = true;
+layout(constant_id = 17) const uint MaterialFeatures = 1;
+
+const uint MaterialVertexColor = 1;
+const uint MaterialBaseColor = 2;
+
+layout(push_constant) uniform MaterialParameters {
+    vec4 baseColor;
+    uint features;
+    uint textureIndex;  // only read by 18_shader_vertexbuffer_bindless.frag
+} material;
+
 layout(location = 0) in vec3 fragColor;
 
 layout(location = 0) out vec4 outColor;
 
 void main() {
-    outColor = vec4(fragColor, 1.0);
+    uint features = IsUbershader ? material.features : MaterialFeatures;
+    vec3 color = vec3(1.0);
+    if ((features & MaterialVertexColor) != 0)
+        color *= fragColor;
+    if ((features & MaterialBaseColor) != 0)
+        color *= material.baseColor.rgb;
+    outColor = vec4(color, 1.0);
 }
@@ -4,8 +4,10 @@ layout(location = 0) in vec2 inPosition;
 layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 fragColor;
+layout(location = 1) out vec2 fragTexCoord;  // the quad spans [-0.5, 0.5], mapped to [0, 1]
 
 void main() {
     gl_Position = vec4(inPosition, 0.0, 1.0);
     fragColor = inColor;
+    fragTexCoord = inPosition + 0.5;
 }
@@ -0,0 +1,38 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// Same ubershader as 18_shader_vertexbuffer.frag plus the bindless texture table; only used when the device supports descriptor indexing.
+layout(constant_id = 16) const bool IsUbershader = true;
+layout(constant_id = 17) const uint MaterialFeatures = 1;
+
+const uint MaterialVertexColor = 1;
+const uint MaterialBaseColor = 2;
+const uint MaterialTexture = 4;
+const uint InvalidTextureIndex = 0xFFFFFFFFu;
+
+// Set 0 is BindlessTable; only the texture binding is used here.
+layout(set = 0, binding = 0) uniform sampler2D Textures[];
+
+layout(push_constant) uniform MaterialParameters {
+    vec4 baseColor;
+    uint features;
+    uint textureIndex;
+} material;
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragTexCoord;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    uint features = IsUbershader ? material.features : MaterialFeatures;
+    vec3 color = vec3(1.0);
+    if ((features & MaterialVertexColor) != 0)
+        color *= fragColor;
+    if ((features & MaterialBaseColor) != 0)
+        color *= material.baseColor.rgb;
+    // The index comes from a push constant, so it is uniform for the draw; nonuniformEXT keeps it correct if it ever comes from per-vertex data.
+    if ((features & MaterialTexture) != 0 && material.textureIndex != InvalidTextureIndex)
+        color *= texture(Textures[nonuniformEXT(material.textureIndex)], fragTexCoord).rgb;
+    outColor = vec4(color, 1.0);
+}
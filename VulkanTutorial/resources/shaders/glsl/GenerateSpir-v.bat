@@ -1,6 +1,25 @@
 @echo off
-call C:/VulkanSDK/1.3.290.0/Bin/glslc.exe 09_shader_base.vert -o ../spir-v/09_shader_base_vert.spv
-call C:/VulkanSDK/1.3.290.0/Bin/glslc.exe 09_shader_base.frag -o ../spir-v/09_shader_base_frag.spv
-call C:/VulkanSDK/1.3.290.0/Bin/glslc.exe 18_shader_vertexbuffer.vert -o ../spir-v/18_shader_vertexbuffer_vert.spv
-call C:/VulkanSDK/1.3.290.0/Bin/glslc.exe 18_shader_vertexbuffer.frag -o ../spir-v/18_shader_vertexbuffer_frag.spv
-pause
\ No newline at end of file
+set BIN=C:/VulkanSDK/1.3.290.0/Bin
+call :compile 09_shader_base.vert 09_shader_base_vert || goto :fail
+call :compile 09_shader_base.frag 09_shader_base_frag || goto :fail
+call :compile 18_shader_vertexbuffer.vert 18_shader_vertexbuffer_vert || goto :fail
+call :compile 18_shader_vertexbuffer.frag 18_shader_vertexbuffer_frag || goto :fail
+call :compile 18_shader_vertexbuffer_bindless.frag 18_shader_vertexbuffer_bindless_frag || goto :fail
+call :compile quantized_mesh.vert quantized_mesh_vert || goto :fail
+call :compile meshlet_cull.comp meshlet_cull_comp || goto :fail
+call :compile meshlet.frag meshlet_frag || goto :fail
+call :compile meshlet.task meshlet_task || goto :fail
+call :compile meshlet.mesh meshlet_mesh || goto :fail
+pause
+exit /b 0
+
+rem glslc编译后用spirv-val校验，任何一步失败都停止，不留下未校验的二进制
+:compile
+call %BIN%/glslc.exe --target-env=vulkan1.3 -O %1 -o ../spir-v/%2.spv || exit /b 1
+call %BIN%/spirv-val.exe --target-env vulkan1.3 ../spir-v/%2.spv || (del ..\spir-v\%2.spv & exit /b 1)
+exit /b 0
+
+:fail
+echo Fail to generate SPIR-V !
+pause
+exit /b 1
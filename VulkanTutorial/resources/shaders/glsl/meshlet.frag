@@ -0,0 +1,12 @@
+#version 450
+
+layout(location = 0) in vec3 fragNormal;
+
+layout(location = 0) out vec4 outColor;
+
+void main() {
+    // A fixed directional light, just enough to see the shape of the mesh.
+    const vec3 lightDirection = normalize(vec3(0.4, 0.8, 0.6));
+    float diffuse = max(dot(normalize(fragNormal), lightDirection), 0.0);
+    outColor = vec4(vec3(0.15 + 0.85 * diffuse), 1.0);
+}
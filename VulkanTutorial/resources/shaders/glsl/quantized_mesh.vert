@@ -0,0 +1,35 @@
+#version 450
+
+// Draws the index list compacted by meshlet_cull.comp from the single 20-byte stream (QuantizedMeshVertexLayout)
+// quantized on the CPU by VertexQuantizer. The vertex fetch already converts SNORM/UNORM to float, so the shader
+// only undoes the bounds normalization and the octahedral normal encoding.
+layout(push_constant) uniform DrawConstants {
+    mat4 viewProjection;
+    vec4 positionScale;
+    vec4 positionOffset;
+    vec4 texCoordScaleOffset;
+} constants;
+
+layout(location = 0) in vec4 inPosition;
+layout(location = 1) in vec2 inNormal;
+layout(location = 2) in vec2 inTexCoord;
+layout(location = 3) in vec4 inColor;
+
+layout(location = 0) out vec3 fragNormal;
+layout(location = 1) out vec3 fragColor;
+layout(location = 2) out vec2 fragTexCoord;
+
+vec3 decodeOctahedral(vec2 e) {
+    vec3 n = vec3(e, 1.0 - abs(e.x) - abs(e.y));
+    float t = max(-n.z, 0.0);
+    n.xy += mix(vec2(t), vec2(-t), greaterThanEqual(n.xy, vec2(0.0)));
+    return normalize(n);
+}
+
+void main() {
+    vec3 position = inPosition.xyz * constants.positionScale.xyz + constants.positionOffset.xyz;
+    gl_Position = constants.viewProjection * vec4(position, 1.0);
+    fragNormal = decodeOctahedral(inNormal);
+    fragColor = inColor.rgb;
+    fragTexCoord = inTexCoord * constants.texCoordScaleOffset.xy + constants.texCoordScaleOffset.zw;
+}
@@ -1,6 +1,7 @@
 #include "Application.h"
 #include <glm/vec4.hpp>
 #include <glm/mat4x4.hpp>
+#include <glm/gtc/matrix_transform.hpp>
 
 #include <exception>
 #include <iostream>
@@ -8,17 +9,88 @@
 #include <iomanip>
 #include <numeric>
 #include <algorithm>
-#include <fstream>
+#include <array>
+#include <cmath>
 #include <unordered_map>
 #include <set>
 
 namespace VulkanTutorial {
 
+	void Application::parseArguments(int vArgumentCount, char** vArguments)
+	{
+		for (int i = 1; i < vArgumentCount; ++i) {
+			std::string Argument = vArguments[i];
+			if (Argument == "--shader-object")
+				m_RenderBackend = RenderBackend::ShaderObject;
+			else if (Argument == "--benchmark-backends")
+				m_IsBenchmarkBackends = true;
+			else if (Argument == "--import-mesh" && i + 1 < vArgumentCount)
+				m_ImportMeshPath = vArguments[++i];
+			else if (Argument == "--mesh" && i + 1 < vArgumentCount)
+				m_MeshPath = vArguments[++i];
+			else if (Argument == "--no-optimize")
+				m_MeshImportOptions.m_IsOptimized = false;
+			else if (Argument == "--mesh-shader")
+				m_IsMeshShaderPreferred = true;
+			else if (Argument == "--textures" && i + 1 < vArgumentCount)
+				m_TextureDirectory = vArguments[++i];
+			else if (Argument == "--import-texture" && i + 1 < vArgumentCount)
+				m_ImportTexturePath = vArguments[++i];
+			else
+				std::cerr << std::format(R"(Unknown argument "{0}".)", Argument) << "\n";
+		}
+	}
+
 	void Application::run()
 	{
+		if (!m_ImportMeshPath.empty()) {
+			Mesh ImportedMesh = MeshImporter::import(m_ImportMeshPath, m_MeshImportOptions);
+			VertexQuantizer::report(ImportedMesh, VertexQuantizer::quantize(ImportedMesh));
+			IndexPacker::report(ImportedMesh, IndexPacker::pack(ImportedMesh));
+			// 按窗口分辨率和45度视角，打印相机在不同距离(包围球半径的倍数)时选中的LOD
+			LodSelector Selector;
+			Selector.setProjection(glm::radians(45.0f), m_Height);
+			float Radius = glm::length(ImportedMesh.m_Bounds.getExtent()) * 0.5f;
+			for (float Distance : { 2.0f, 8.0f, 32.0f, 128.0f, 512.0f }) {
+				glm::vec3 CameraPosition = ImportedMesh.m_Bounds.getCenter() + glm::vec3(0.0f, 0.0f, Distance * Radius);
+				uint32_t Lod = Selector.select(ImportedMesh, CameraPosition, glm::mat4(1.0f));
+				std::cout << std::format("\tdistance {0}x radius: LOD {1} ({2} triangles)\n", Distance, Lod, ImportedMesh.getLodIndices(Lod).size() / 3);
+			}
+			// 与--mesh的初始相机相同，统计meshlet剔除的效果
+			glm::vec3 CameraPosition;
+			glm::mat4 ViewProjection = getMeshViewProjection(ImportedMesh.m_Bounds, 0.0f, static_cast<float>(m_Width) / m_Height, CameraPosition);
+			MeshletCullStatistics Statistics = MeshletBuilder::cull(ImportedMesh.m_Meshlets, ViewProjection, CameraPosition);
+			std::cout << std::format("\tmeshlet culling: {0} of {1} visible ({2} triangles), {3} outside the frustum, {4} back-facing\n",
+				Statistics.m_VisibleMeshletCount, ImportedMesh.m_Meshlets.m_Meshlets.size(), Statistics.m_VisibleTriangleCount,
+				Statistics.m_FrustumCulledCount, Statistics.m_ConeCulledCount);
+			return;
+		}
+		if (!m_ImportTexturePath.empty()) {
+			std::cout << std::format(R"(Try to import texture "{0}" ...)", m_ImportTexturePath.string()) << "\n";
+			ImageDecoder Decoder;
+			Timer ImportTimer;
+			std::filesystem::path CachePath = TextureImporter::import(m_ImportTexturePath, Decoder);
+			float ImportMilliseconds = ImportTimer.ellapseMilliseconds();
+			Timer LoadTimer;
+			Ktx2File File(CachePath);
+			size_t LevelSize = File.getLevelRange().size();
+			std::vector<std::byte> Staging(LevelSize);
+			memcpy(Staging.data(), File.getLevelRange().data(), LevelSize);  // 与TextureLoader加载时相同的一次拷贝
+			float LoadMilliseconds = LoadTimer.ellapseMilliseconds();
+			std::cout << std::format("\timport: {0:.2f} ms, KTX2 \"{1}\"\n", ImportMilliseconds, CachePath.string());
+			std::cout << std::format("\t{0}x{1}, {2} mip levels, {3} KB, load {4:.2f} ms\n", File.getExtent().width, File.getExtent().height,
+				File.getLevelCount(), LevelSize / 1024, LoadMilliseconds);
+			std::cout << std::format(R"(Success to import texture "{0}" !)", m_ImportTexturePath.string()) << "\n";
+			return;
+		}
 		initWindow();
 		initVulkan();
-		mainLoop();
+		if (m_IsBenchmarkBackends) {
+			benchmarkRenderBackends();
+			benchmarkDescriptorUpdates();
+		}
+		else
+			mainLoop();
 		cleanup();
 	}
 
@@ -43,6 +115,11 @@ namespace VulkanTutorial {
 			else
 				App->m_IsMinimized = false;
 			});
+		glfwSetKeyCallback(m_Window, [](GLFWwindow* window, int key, int scancode, int action, int mods) {
+			auto App = reinterpret_cast<Application*>(glfwGetWindowUserPointer(window));
+			if (key == GLFW_KEY_M && action == GLFW_PRESS && App->m_MaterialSystem.size() > 0)
+				App->m_ActiveMaterial = (App->m_ActiveMaterial + 1) % App->m_MaterialSystem.size();
+			});
 	}
 
 	void Application::initVulkan()
@@ -55,19 +132,30 @@ namespace VulkanTutorial {
 		createSwapChain();
 		createImageViews();
 		createRenderPass();
+		loadShaderPack();
+		watchShaderSources();
+		createPipelineLibrary();
+		createMaterials();
+		createDescriptorAllocator();
+		createBindlessTable();
+		createDescriptorBuffer();
 		createGraphicsPipeline();
 		createFramebuffers();
 		createGraphicsCommandPool();
 		createVertexBuffer();
 		createIndexBuffer();
+		createMeshletRenderer();
+		createTextureLoader();
 		createGraphicsCommandBuffers();
 		createSyncObjects();
+		createPipelineStatistics();
 	}
 
 	void Application::mainLoop()
 	{
 		while (!glfwWindowShouldClose(m_Window)) {
 			if (!m_IsMinimized) {
+				processShaderReloads();
 				float Time = m_Timer.ellapseMilliseconds();
 				float DeltaTime = Time - m_LastFrameTime;
 				m_LastFrameTime = Time;
@@ -76,19 +164,33 @@ namespace VulkanTutorial {
 			}
 			glfwPollEvents();
 		}
-		vkDeviceWaitIdle(m_LogicalDevice); // Ӧóֱͣڸ豸VkDeviceύִϡ
+		vkDeviceWaitIdle(m_LogicalDevice); // 让应用程序暂停，直到所有在该设备（VkDevice）上提交的命令都执行完毕。
 	}
 
 	void Application::cleanup()
 	{
 		std::cout << "Try to clean up ..." << "\n";
+		m_ShaderWatcher.stop();
+		m_MaterialSystem.report();
+		m_DescriptorCache.report();
+		m_PipelineStatistics.report();
+		m_MaterialSystem.destroy(m_FrameCount);
+		m_DeletionQueue.flushAll();
 		for (size_t i = 0; i < m_MaxFrameInFlight; ++i) {
 			vkDestroyFence(m_LogicalDevice, m_InFlightFence[i], nullptr);
 			vkDestroySemaphore(m_LogicalDevice, m_RenderFinishedSemaphore[i], nullptr);
 			vkDestroySemaphore(m_LogicalDevice, m_ImageAvailableSemaphore[i], nullptr);
 		}
 		vkDestroyCommandPool(m_LogicalDevice, m_GraphicsCommandPool, nullptr);
-		vkDestroyPipeline(m_LogicalDevice, m_Pipeline, nullptr);
+		m_PipelineStatistics.destroy();
+		m_MeshletRenderer.destroy();
+		m_TextureLoader.destroy();
+		m_ShaderObjectBackend.destroy();
+		m_PipelineLibrary.destroy();
+		m_BindlessTable.destroy();
+		m_DescriptorBuffer.destroy();
+		m_DescriptorCache.destroy();
+		m_DescriptorAllocator.destroy();
 		vkDestroyPipelineLayout(m_LogicalDevice, m_PipelineLayout, nullptr);
 		vkDestroyRenderPass(m_LogicalDevice, m_RenderPass, nullptr);
 		cleanupSwapchain();
@@ -96,6 +198,7 @@ namespace VulkanTutorial {
 		vkFreeMemory(m_LogicalDevice, m_IndexBufferMemory, nullptr);
 		vkDestroyBuffer(m_LogicalDevice, m_VertexBuffer, nullptr);
 		vkFreeMemory(m_LogicalDevice, m_VertexBufferMemory, nullptr);
+		m_ShaderPack.close();
 		vkDestroyDevice(m_LogicalDevice, nullptr);
 		vkDestroySurfaceKHR(m_Instance, m_Surface, nullptr);
 		if (IsEnableValidationLayer) {
@@ -113,9 +216,9 @@ namespace VulkanTutorial {
 		uint32_t ExtensionCount = 0;
 		vkEnumerateInstanceExtensionProperties(nullptr, &ExtensionCount, nullptr);
 
-		//  VkExtensionProperties 洢չϢ
+		// 分配 VkExtensionProperties 数组来存储扩展信息
 		std::vector<VkExtensionProperties> Extensions(ExtensionCount);
-		// ڶεãȡչϸϢ
+		// 第二次调用：获取扩展详细信息
 		vkEnumerateInstanceExtensionProperties(nullptr, &ExtensionCount, Extensions.data());
 
 		return Extensions;
@@ -138,9 +241,9 @@ namespace VulkanTutorial {
 		uint32_t extensionCount = 0;
 		vkEnumerateDeviceExtensionProperties(vPhysicalDevice, nullptr, &extensionCount, nullptr);
 
-		//  VkExtensionProperties 洢չϢ
+		// 分配 VkExtensionProperties 数组来存储扩展信息
 		std::vector<VkExtensionProperties> extensions(extensionCount);
-		// ڶεãȡչϸϢ
+		// 第二次调用：获取扩展详细信息
 		vkEnumerateDeviceExtensionProperties(vPhysicalDevice, nullptr, &extensionCount, extensions.data());
 		return extensions;
 	}
@@ -191,10 +294,10 @@ namespace VulkanTutorial {
 		VkPhysicalDeviceFeatures Features;
 		vkGetPhysicalDeviceProperties(vPhysicalDevice, &Properties);
 		vkGetPhysicalDeviceFeatures(vPhysicalDevice, &Features);
-		if (Properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) // Կ
+		if (Properties.deviceType == VK_PHYSICAL_DEVICE_TYPE_DISCRETE_GPU) // 独立显卡
 			Score += 1000;
-		Score += Properties.limits.maxImageDimension2D;                    // Texturesize֧
-		if (!Features.geometryShader)                                      // Ƿ֧Geometry Shader
+		Score += Properties.limits.maxImageDimension2D;                    // Texture最大size支持
+		if (!Features.geometryShader)                                      // 是否支持Geometry Shader
 			return 0;
 		return Score;
 	}
@@ -283,7 +386,7 @@ namespace VulkanTutorial {
 	VkExtent2D Application::chooseSwapchainExtent(const VkSurfaceCapabilitiesKHR& vCapabilities)
 	{
 		if (vCapabilities.currentExtent.width != std::numeric_limits<uint32_t>::max()) {
-			return vCapabilities.currentExtent; // currentExtentwideheightΪ0xFFFFFFFFʱcurrentExtentֵ޸ĵģ
+			return vCapabilities.currentExtent; // 当currentExtent中wide和height都为0xFFFFFFFF时currentExtent的数值才是允许修改的！
 		}
 		else {
 			int Width, Height;
@@ -311,7 +414,7 @@ namespace VulkanTutorial {
 		cleanupSwapchain();
 		createSwapChain();
 		createImageViews();
-		// ʵӦrecreate render pass()
+		// 这里其实还应该recreate render pass(略)
 		createFramebuffers();
 		std::cout << "Success to recreate swapchian !" << "\n";
 	}
@@ -325,31 +428,123 @@ namespace VulkanTutorial {
 		vkDestroySwapchainKHR(m_LogicalDevice, m_Swapchain, nullptr);
 	}
 
-	std::vector<char> Application::readFile(const std::filesystem::path& vPath)
+	void Application::loadShaderPack()
+	{
+		std::cout << "Try to load shader pack ..." << "\n";
+		const std::filesystem::path PackPath = "resources/shaders/shaders.pack";
+		const std::filesystem::path SpirvDirectory = "resources/shaders/spir-v";
+		const std::filesystem::path SourceDirectory = "resources/shaders/glsl";
+		if (std::filesystem::is_directory(SourceDirectory)) {
+			// spir-v目录只存放由GLSL生成并经过校验的二进制，打包前按源码重新生成；内容未变时文件保持不动
+			m_ShaderCompiler = std::make_unique<ShaderCompiler>("resources/shaders/cache");
+			for (const auto& Entry : std::filesystem::directory_iterator(SourceDirectory)) {
+				if (!Entry.is_regular_file() || !ShaderCompiler::isShaderSource(Entry.path()))
+					continue;
+				try {
+					m_ShaderCompiler->generate(Entry.path(), SpirvDirectory);
+				}
+				catch (const std::exception& e) {
+					std::cerr << e.what() << "\n"; // 编译或校验失败时保留上一次生成的版本
+				}
+			}
+		}
+		std::vector<std::filesystem::path> SpirvPaths;
+		if (std::filesystem::is_directory(SpirvDirectory)) { // 发布时可以只带shaders.pack
+			for (const auto& Entry : std::filesystem::directory_iterator(SpirvDirectory)) {
+				if (Entry.is_regular_file() && Entry.path().extension() == ".spv")
+					SpirvPaths.emplace_back(Entry.path());
+			}
+		}
+		if (ShaderPack::isOutdated(PackPath, SpirvPaths))
+			ShaderPack::build(PackPath, SpirvPaths);
+		m_ShaderPack.open(PackPath); // 整个包只映射一次，之后创建ShaderModule不再有任何文件IO
+		if (IsEnableValidationLayer && !m_ShaderPack.verify())
+			throw std::runtime_error("Shader pack is corrupted!");
+		std::cout << std::format("Success to load shader pack with {0} shaders !", m_ShaderPack.size()) << "\n";
+	}
+
+	void Application::watchShaderSources()
+	{
+		const std::filesystem::path SourceDirectory = "resources/shaders/glsl";
+		if (!IsEnableShaderHotReload || !m_ShaderCompiler) // 启动时的编译已经在loadShaderPack中完成并打包
+			return;
+		std::cout << "Try to watch shader sources ..." << "\n";
+		m_ShaderWatcher.start(SourceDirectory, [this](const std::filesystem::path& vPath) {
+			if (!ShaderCompiler::isShaderSource(vPath))
+				return;
+			try {
+				auto Code = m_ShaderCompiler->compile(vPath); // 在监视线程上编译，不阻塞渲染
+				std::lock_guard<std::mutex> Lock(m_ShaderReloadMutex);
+				m_PendingShaderReloads.emplace_back(ShaderCompiler::getShaderName(vPath), std::move(Code));
+			}
+			catch (const std::exception& e) {
+				std::cerr << e.what() << "\n";
+			}
+			});
+		std::cout << "Success to watch shader sources !" << "\n";
+	}
+
+	void Application::processShaderReloads()
+	{
+		std::vector<std::pair<std::string, std::vector<uint32_t>>> Reloads;
+		{
+			std::lock_guard<std::mutex> Lock(m_ShaderReloadMutex);
+			Reloads.swap(m_PendingShaderReloads);
+		}
+		bool IsPipelineAffected = false;
+		for (auto& [Name, Code] : Reloads) {
+			IsPipelineAffected |= m_PipelineKey.uses(Name);
+			m_CompiledShaders[Name] = std::move(Code);
+		}
+		if (IsPipelineAffected)
+			recreateGraphicsPipeline();
+	}
+
+	void Application::recreateGraphicsPipeline()
 	{
-		std::ifstream InFileStream(vPath, std::ios_base::ate | std::ios_base::binary);
-		if (!InFileStream)
-			throw std::runtime_error(std::format(R"(Fail to open the file at "{0}".)", vPath.string()));
-		size_t FileSize = static_cast<size_t>(InFileStream.tellg());
-		std::vector<char> Code(FileSize);
-		InFileStream.seekg(0);
-		InFileStream.read(Code.data(), FileSize);
-		InFileStream.close();
-		return Code;
+		std::cout << "Try to recreate graphics pipeline ..." << "\n";
+		uint64_t OldPipelineID = m_PipelineID;
+		try {
+			createGraphicsPipeline();
+		}
+		catch (const std::exception& e) {
+			std::cerr << e.what() << "\n";
+			m_PipelineID = OldPipelineID; // 创建失败则继续使用旧的pipeline
+			return;
+		}
+		// 旧pipeline可能还在被在途的帧使用，不等待设备空闲，而是等这些帧完成后再销毁
+		if (m_PipelineID != OldPipelineID)
+			releaseGraphicsPipeline(OldPipelineID);
+		std::cout << "Success to recreate graphics pipeline !" << "\n";
+	}
+
+	uint64_t Application::requestGraphicsPipeline(const GraphicsPipelineDesc& vDesc)
+	{
+		if (m_RenderBackend == RenderBackend::ShaderObject)
+			return m_ShaderObjectBackend.request(vDesc);
+		return m_PipelineLibrary.request(vDesc);
 	}
 
-	VkShaderModule Application::createShaderModule(const std::vector<char>& vCode)
+	void Application::releaseGraphicsPipeline(uint64_t vID)
 	{
-		VkShaderModuleCreateInfo ShaderModuleCreateInfo{};
-		ShaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-		ShaderModuleCreateInfo.pCode = reinterpret_cast<const uint32_t*>(vCode.data());
-		ShaderModuleCreateInfo.codeSize = vCode.size();
+		if (m_RenderBackend == RenderBackend::ShaderObject)
+			m_ShaderObjectBackend.release(vID, m_FrameCount);
+		else
+			m_PipelineLibrary.release(vID, m_FrameCount);
+	}
+
+	std::span<const uint32_t> Application::getShaderCode(const std::string& vName)
+	{
+		if (auto It = m_CompiledShaders.find(vName); It != m_CompiledShaders.end())
+			return It->second;
+		return m_ShaderPack.find(vName);
+	}
 
-		VkShaderModule ShaderModule;
-		if (vkCreateShaderModule(m_LogicalDevice, &ShaderModuleCreateInfo, nullptr, &ShaderModule) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create shader module!");
-		std::cout << "Success to create a shader module." << "\n";
-		return ShaderModule;
+	std::span<const uint32_t> Application::findShaderCode(const std::string& vName)
+	{
+		if (auto It = m_CompiledShaders.find(vName); It != m_CompiledShaders.end())
+			return It->second;
+		return m_ShaderPack.tryFind(vName);
 	}
 
 	void Application::recordCommandBuffer(VkCommandBuffer vCommandBuffer, uint32_t vImageIndex)
@@ -358,25 +553,138 @@ namespace VulkanTutorial {
 		VkCommandBufferBeginInfo CommandBufferBeginInfo{};
 		CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		CommandBufferBeginInfo.flags = 0;
-		CommandBufferBeginInfo.pInheritanceInfo = nullptr; // μҪָ
+		CommandBufferBeginInfo.pInheritanceInfo = nullptr; // 次级缓冲区才需要指定
 
 		if (vkBeginCommandBuffer(vCommandBuffer, &CommandBufferBeginInfo) != VK_SUCCESS)
 			throw std::runtime_error("Failed to begin recording command buffer!");
 		//std::cout << "cmd : vkBeginCommandBuffer" << "\n";
+		m_PipelineStatistics.reset(vCommandBuffer, m_CurrentFrame); // 查询池只能在render pass外重置
+		if (m_MeshletRenderer.isEnabled()) { // 剔除的compute dispatch同样只能在render pass外录制
+			glm::vec3 CameraPosition;
+			float Aspect = static_cast<float>(m_SwapchainExtent.width) / m_SwapchainExtent.height;
+			glm::mat4 ViewProjection = getMeshViewProjection(m_MeshBounds, m_Timer.ellapseMilliseconds() * 0.0005f, Aspect, CameraPosition);
+			m_MeshletRenderer.setLodProjection(glm::radians(45.0f), m_SwapchainExtent.height);  // 与getMeshViewProjection的视角一致
+			m_MeshletRenderer.cull(vCommandBuffer, m_CurrentFrame, ViewProjection, CameraPosition);
+		}
+
+		beginRendering(vCommandBuffer, vImageIndex);
+		bindGraphicsState(vCommandBuffer);
+
+		// Vertex Buffer
+		VkBuffer VertexBuffer[] = { m_VertexBuffer };
+		VkDeviceSize Offset[] = { 0 };
+		vkCmdBindVertexBuffers(vCommandBuffer, 0, 1, VertexBuffer, Offset); // 可以是多个！
+		vkCmdBindIndexBuffer(vCommandBuffer, m_IndexBuffer, 0, m_PackedIndices.m_IndexType);
+
+		m_PipelineStatistics.begin(vCommandBuffer, m_CurrentFrame);
+		m_PackedIndices.draw(vCommandBuffer);
+		if (m_MeshletRenderer.isDynamicRendering() == (m_RenderBackend == RenderBackend::ShaderObject)) // benchmark临时切换后端时，按另一种方式创建的meshlet管线不能使用
+			m_MeshletRenderer.draw(vCommandBuffer, m_CurrentFrame, m_SwapchainExtent);
+		m_PipelineStatistics.end(vCommandBuffer, m_CurrentFrame);
+		//std::cout << "cmd : vkCmdDraw" << "\n";
+
+		endRendering(vCommandBuffer, vImageIndex);
+
+		if (vkEndCommandBuffer(vCommandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to record command buffer!");
+		//std::cout << "cmd : vkEndCommandBuffer" << "\n";
+
+		//std::cout << "Success to recording commands to a command buffer !" << "\n";
+	}
 
-		VkRenderPassBeginInfo RenderPassBeginInfo{};
-		RenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
-		RenderPassBeginInfo.renderPass = m_RenderPass;
-		RenderPassBeginInfo.framebuffer = m_SwapchainFramebuffers[vImageIndex];
-		RenderPassBeginInfo.renderArea.offset = { 0, 0 };
-		RenderPassBeginInfo.renderArea.extent = m_SwapchainExtent;
+	void Application::beginRendering(VkCommandBuffer vCommandBuffer, uint32_t vImageIndex)
+	{
 		VkClearValue ClearColor{ {{0.0f, 0.0f, 0.0f, 1.0f}} };
-		RenderPassBeginInfo.clearValueCount = 1;
-		RenderPassBeginInfo.pClearValues = &ClearColor;
+		if (m_RenderBackend == RenderBackend::Pipeline) {
+			VkRenderPassBeginInfo RenderPassBeginInfo{};
+			RenderPassBeginInfo.sType = VK_STRUCTURE_TYPE_RENDER_PASS_BEGIN_INFO;
+			RenderPassBeginInfo.renderPass = m_RenderPass;
+			RenderPassBeginInfo.framebuffer = m_SwapchainFramebuffers[vImageIndex];
+			RenderPassBeginInfo.renderArea.offset = { 0, 0 };
+			RenderPassBeginInfo.renderArea.extent = m_SwapchainExtent;
+			RenderPassBeginInfo.clearValueCount = 1;
+			RenderPassBeginInfo.pClearValues = &ClearColor;
+
+			vkCmdBeginRenderPass(vCommandBuffer, &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
+			//std::cout << "cmd : vkCmdBeginRenderPass" << "\n";
+			return;
+		}
+
+		// shader object不能在VkRenderPass中使用；render pass的布局转换和subpass依赖在这里用屏障显式完成
+		VkImageMemoryBarrier ImageBarrier{};
+		ImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		ImageBarrier.srcAccessMask = 0;
+		ImageBarrier.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		ImageBarrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED; // 随后整张清除，不需要保留旧内容
+		ImageBarrier.newLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		ImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		ImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		ImageBarrier.image = m_SwapchainImages[vImageIndex];
+		ImageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		// 与等待image available信号量的阶段相同，保证转换发生在呈现引擎释放图像之后
+		vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &ImageBarrier);
+
+		VkRenderingAttachmentInfo ColorAttachment{};
+		ColorAttachment.sType = VK_STRUCTURE_TYPE_RENDERING_ATTACHMENT_INFO;
+		ColorAttachment.imageView = m_SwapchainImageViews[vImageIndex];
+		ColorAttachment.imageLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		ColorAttachment.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;
+		ColorAttachment.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
+		ColorAttachment.clearValue = ClearColor;
+		VkRenderingInfo RenderingInfo{};
+		RenderingInfo.sType = VK_STRUCTURE_TYPE_RENDERING_INFO;
+		RenderingInfo.renderArea.offset = { 0, 0 };
+		RenderingInfo.renderArea.extent = m_SwapchainExtent;
+		RenderingInfo.layerCount = 1;
+		RenderingInfo.colorAttachmentCount = 1;
+		RenderingInfo.pColorAttachments = &ColorAttachment;
+		vkCmdBeginRendering(vCommandBuffer, &RenderingInfo);
+	}
+
+	void Application::endRendering(VkCommandBuffer vCommandBuffer, uint32_t vImageIndex)
+	{
+		if (m_RenderBackend == RenderBackend::Pipeline) {
+			vkCmdEndRenderPass(vCommandBuffer); // finalLayout完成到PRESENT_SRC_KHR的转换
+			//std::cout << "cmd : vkCmdEndRenderPass" << "\n";
+			return;
+		}
+		vkCmdEndRendering(vCommandBuffer);
+
+		VkImageMemoryBarrier ImageBarrier{};
+		ImageBarrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+		ImageBarrier.srcAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
+		ImageBarrier.dstAccessMask = 0; // 呈现由信号量同步，不需要访问掩码
+		ImageBarrier.oldLayout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
+		ImageBarrier.newLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR;
+		ImageBarrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		ImageBarrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+		ImageBarrier.image = m_SwapchainImages[vImageIndex];
+		ImageBarrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 1, 0, 1 };
+		vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT, VK_PIPELINE_STAGE_BOTTOM_OF_PIPE_BIT,
+			0, 0, nullptr, 0, nullptr, 1, &ImageBarrier);
+	}
 
-		vkCmdBeginRenderPass(vCommandBuffer, &RenderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
-		//std::cout << "cmd : vkCmdBeginRenderPass" << "\n";
-		vkCmdBindPipeline(vCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_Pipeline);
+	void Application::bindGraphicsState(VkCommandBuffer vCommandBuffer)
+	{
+		// 材质参数总是推送，特化pipeline忽略其中已成为常量的Features
+		// 纹理槽位在纹理就绪时才确定，因此每帧从句柄解析
+		const Material& ActiveMaterial = m_MaterialSystem.getMaterial(m_ActiveMaterial);
+		MaterialParameters Parameters = ActiveMaterial.m_Parameters;
+		if (Parameters.m_Features & MaterialTexture)
+			Parameters.m_TextureIndex = m_MaterialTexture ? m_TextureLoader.getBindlessIndex(*m_MaterialTexture) : m_TextureLoader.getPlaceholderBindlessIndex();
+		vkCmdPushConstants(vCommandBuffer, m_PipelineLayout, VK_SHADER_STAGE_FRAGMENT_BIT, 0,
+			sizeof(MaterialParameters), &Parameters);
+		if (m_BindlessTable.isEnabled()) // 整帧只绑定这一个set，所有材质共用
+			m_BindlessTable.bind(vCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_PipelineLayout, 0);
+		if (m_RenderBackend == RenderBackend::ShaderObject) {
+			m_ShaderObjectBackend.bind(vCommandBuffer, m_PipelineID, m_SwapchainExtent); // 包括视口和裁剪在内的全部状态
+			return;
+		}
+		VkPipeline Pipeline = m_MaterialSystem.resolve(m_ActiveMaterial);
+		if (Pipeline == VK_NULL_HANDLE)
+			Pipeline = m_PipelineLibrary.getPipeline(m_PipelineID); // 特化pipeline尚未编译完成，使用ubershader
+		vkCmdBindPipeline(vCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, Pipeline);
 		//std::cout << "cmd : vkCmdBindPipeline" << "\n";
 
 		// Dynamic States settings
@@ -387,7 +695,7 @@ namespace VulkanTutorial {
 		Viewport.height = static_cast<float>(m_SwapchainExtent.height);
 		Viewport.minDepth = 0.0f;
 		Viewport.maxDepth = 1.0f;
-		vkCmdSetViewport(vCommandBuffer, 0, 1, &Viewport); // ڶӿindexpiplineӿ
+		vkCmdSetViewport(vCommandBuffer, 0, 1, &Viewport); // 第二个参数是视口index，pipline允许多个视口
 		//std::cout << "cmd : vkCmdSetViewport" << "\n";
 
 		VkRect2D Scissor;
@@ -395,24 +703,6 @@ namespace VulkanTutorial {
 		Scissor.extent = m_SwapchainExtent;
 		vkCmdSetScissor(vCommandBuffer, 0, 1, &Scissor);
 		//std::cout << "cmd : vkCmdSetScissor" << "\n";
-
-		// Vertex Buffer
-		VkBuffer VertexBuffer[] = { m_VertexBuffer };
-		VkDeviceSize Offset[] = { 0 };
-		vkCmdBindVertexBuffers(vCommandBuffer, 0, 1, VertexBuffer, Offset); // Ƕ
-		vkCmdBindIndexBuffer(vCommandBuffer, m_IndexBuffer, 0, VK_INDEX_TYPE_UINT16);
-
-		vkCmdDrawIndexed(vCommandBuffer, static_cast<uint32_t>(Indices.size()), 1, 0, 0, 0);
-		//std::cout << "cmd : vkCmdDraw" << "\n";
-
-		vkCmdEndRenderPass(vCommandBuffer);
-		//std::cout << "cmd : vkCmdEndRenderPass" << "\n";
-
-		if (vkEndCommandBuffer(vCommandBuffer) != VK_SUCCESS)
-			throw std::runtime_error("Failed to record command buffer!");
-		//std::cout << "cmd : vkEndCommandBuffer" << "\n";
-
-		//std::cout << "Success to recording commands to a command buffer !" << "\n";
 	}
 
 	uint32_t Application::findMemoryType(uint32_t vTypeFilter, VkMemoryPropertyFlags vProperties)
@@ -431,7 +721,7 @@ namespace VulkanTutorial {
 	{
 		VkBufferCreateInfo BufferCreateInfo{};
 		BufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
-		BufferCreateInfo.size = Vertices.size() * sizeof(Vertices[0]);
+		BufferCreateInfo.size = vSize;
 		BufferCreateInfo.usage = vUsage;
 		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
 
@@ -439,16 +729,21 @@ namespace VulkanTutorial {
 			throw std::runtime_error("Failed to create vertex buffer!");
 
 		VkMemoryRequirements MemoryRequirement{};
-		vkGetBufferMemoryRequirements(m_LogicalDevice, vBuffer, &MemoryRequirement); // ѯVertexBufferϢ
+		vkGetBufferMemoryRequirements(m_LogicalDevice, vBuffer, &MemoryRequirement); // 查询VertexBuffer信息
 
 		VkMemoryAllocateInfo MemoryAllocateInfo{};
 		MemoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
 		MemoryAllocateInfo.allocationSize = MemoryRequirement.size;
 		MemoryAllocateInfo.memoryTypeIndex = findMemoryType(MemoryRequirement.memoryTypeBits, vFlags);
+		VkMemoryAllocateFlagsInfo MemoryAllocateFlagsInfo{};
+		MemoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+		MemoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+		if (vUsage & VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT) // 要取设备地址的buffer，其内存也必须带DEVICE_ADDRESS标志
+			MemoryAllocateInfo.pNext = &MemoryAllocateFlagsInfo;
 
 		if (vkAllocateMemory(m_LogicalDevice, &MemoryAllocateInfo, nullptr, &vBufferMemory) != VK_SUCCESS)
 			throw std::runtime_error("Failed to allocate vertex buffer memory!");
-		vkBindBufferMemory(m_LogicalDevice, vBuffer, vBufferMemory, 0); // Memory󶨵Buffer
+		vkBindBufferMemory(m_LogicalDevice, vBuffer, vBufferMemory, 0); // 将Memory绑定到Buffer
 	}
 
 	void Application::copyBuffer(VkBuffer vDestination, VkBuffer vSource, VkDeviceSize vSize)
@@ -465,7 +760,7 @@ namespace VulkanTutorial {
 		VkCommandBufferBeginInfo CommandBufferBeginInfo{};
 		CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
 		CommandBufferBeginInfo.flags = 0;
-		CommandBufferBeginInfo.pInheritanceInfo = nullptr; // μҪָ
+		CommandBufferBeginInfo.pInheritanceInfo = nullptr; // 次级缓冲区才需要指定
 
 		vkBeginCommandBuffer(CopyCommandBuffer, &CommandBufferBeginInfo);
 		VkBufferCopy CopyRegion{};
@@ -485,6 +780,18 @@ namespace VulkanTutorial {
 		vkFreeCommandBuffers(m_LogicalDevice, m_GraphicsCommandPool, 1, &CopyCommandBuffer);
 	}
 
+	glm::mat4 Application::getMeshViewProjection(const MeshBounds& vBounds, float vAngle, float vAspect, glm::vec3& vCameraPosition) const
+	{
+		float Radius = glm::length(vBounds.getExtent()) * 0.5f;
+		glm::vec3 Center = vBounds.getCenter();
+		// 旋转的同时在2.5到6.5倍半径之间推拉，让运行时的LOD选择有机会切换；角度为0时与导入统计用的相机相同
+		float Distance = (2.5f + 2.0f * (1.0f - std::cos(vAngle * 0.25f))) * Radius;
+		vCameraPosition = Center + glm::vec3(std::sin(vAngle), 0.3f, std::cos(vAngle)) * Distance;
+		glm::mat4 Projection = glm::perspectiveRH_ZO(glm::radians(45.0f), vAspect, Radius * 0.01f, Radius * 10.0f);
+		Projection[1][1] *= -1.0f; // Vulkan裁剪空间的Y轴朝下
+		return Projection * glm::lookAt(vCameraPosition, Center, glm::vec3(0.0f, 1.0f, 0.0f));
+	}
+
 	void Application::createInstance()
 	{
 		std::cout << "Try to create Vulkan instance ..." << "\n";
@@ -539,7 +846,7 @@ namespace VulkanTutorial {
 				std::cerr << "validation layer: " << pCallbackData->pMessage << std::endl;
 				return VK_FALSE;
 			};
-		// vkCreateDebugUtilsMessengerEXTһչûĬϵ룬Ҫʾֶ
+		// vkCreateDebugUtilsMessengerEXT是一个扩展函数，并没有默认导入，因此需要显示手动导入
 		auto Func = (PFN_vkCreateDebugUtilsMessengerEXT)vkGetInstanceProcAddr(m_Instance, "vkCreateDebugUtilsMessengerEXT");
 		if (!Func || Func(m_Instance, &CreateInfo, nullptr, &m_DebugMessenger) != VK_SUCCESS)
 			throw std::runtime_error("Failed to set up debug messenger!");
@@ -584,6 +891,8 @@ namespace VulkanTutorial {
 		vkGetPhysicalDeviceProperties(m_PhysicalDevice, &ChosenPhysicalDeviceProperties);
 		if (m_PhysicalDevice == VK_NULL_HANDLE)
 			throw std::runtime_error("Failed to find GPUs with Vulkan support!");
+		m_DeviceTuning = DeviceTuning::query(m_PhysicalDevice);  // 只有meshlet剔除的compute shader声明了这些常量，创建剔除管线时特化
+		std::cout << "Device tuning: " << m_DeviceTuning.toString() << "\n";
 
 		std::cout << "Success to pick physical device " << ChosenPhysicalDeviceProperties.deviceName << " for Vulkan !" << "\n";
 	}
@@ -610,8 +919,9 @@ namespace VulkanTutorial {
 		DeviceCreateInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
 		DeviceCreateInfo.pQueueCreateInfos = QueueCreateInfos.data();
 		DeviceCreateInfo.queueCreateInfoCount = static_cast<uint32_t>(QueueCreateInfos.size());
-		VkPhysicalDeviceFeatures PhysicalDeviceFeatures{};
-		DeviceCreateInfo.pEnabledFeatures = &PhysicalDeviceFeatures;
+		m_DeviceFeatures.query(m_PhysicalDevice);
+		DeviceCreateInfo.pNext = m_DeviceFeatures.getFeatureChain(); // 特性由VkPhysicalDeviceFeatures2链给出
+		DeviceCreateInfo.pEnabledFeatures = nullptr;
 
 		std::cout << "Available device extensions:\n";
 		showExtensionInformation(getSupportedDeviceExtensions(m_PhysicalDevice));
@@ -620,13 +930,17 @@ namespace VulkanTutorial {
 		showExtensionInformation(RequiredDeviceExtensions);
 		std::cout << "Satisfy the device extensions requirements? " << std::boolalpha
 			<< checkRequiredDeviceExtensionsSupport(m_PhysicalDevice, RequiredDeviceExtensions) << std::noboolalpha << "\n";
+		std::cout << "Enabled optional device extensions:\n";
+		showExtensionInformation(m_DeviceFeatures.getEnabledExtensions());
+		RequiredDeviceExtensions.insert(RequiredDeviceExtensions.end(),
+			m_DeviceFeatures.getEnabledExtensions().begin(), m_DeviceFeatures.getEnabledExtensions().end());
 		DeviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(RequiredDeviceExtensions.size());
 		DeviceCreateInfo.ppEnabledExtensionNames = RequiredDeviceExtensions.data();
 
 		if (vkCreateDevice(m_PhysicalDevice, &DeviceCreateInfo, nullptr, &m_LogicalDevice) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create logical device!");
-		vkGetDeviceQueue(m_LogicalDevice, GraphicQueueIndice.value(), 0, &m_GraphicsQueue); // ֻһqueueindex = 0
-		vkGetDeviceQueue(m_LogicalDevice, PresentQueueIndice.value(), 0, &m_PresentQueue); // ֻһqueueindex = 0
+		vkGetDeviceQueue(m_LogicalDevice, GraphicQueueIndice.value(), 0, &m_GraphicsQueue); // 这里只有一个queue即index = 0
+		vkGetDeviceQueue(m_LogicalDevice, PresentQueueIndice.value(), 0, &m_PresentQueue); // 这里只有一个queue即index = 0
 		std::cout << "Statisfy the queue families requirements? " << std::boolalpha
 			<< checkRequiredQueueFamiliesSupport() << std::noboolalpha << "\n";
 		std::cout << "Success to create logical device for Vulkan !" << "\n";
@@ -639,7 +953,7 @@ namespace VulkanTutorial {
 		VkSurfaceFormatKHR SurfaceFormat = chooseSwapchainSurfaceFormat(SwapChainSupportDetails.m_SurfaceFormats);
 		VkPresentModeKHR PresentMode = chooseSwapchainPresentMode(SwapChainSupportDetails.m_PresentModes);
 		VkExtent2D Extent = chooseSwapchainExtent(SwapChainSupportDetails.m_SurfaceCapabilities);
-		uint32_t ImageCount = SwapChainSupportDetails.m_SurfaceCapabilities.minImageCount + 1; // +1ǲȴڲܻȡһͼƬȾЧ
+		uint32_t ImageCount = SwapChainSupportDetails.m_SurfaceCapabilities.minImageCount + 1; // +1是不想等待驱动程序完成内部操作才能获取下一张图片，增加渲染效率
 		if (SwapChainSupportDetails.m_SurfaceCapabilities.minImageCount > 0
 			&& ImageCount > SwapChainSupportDetails.m_SurfaceCapabilities.maxImageCount)
 			ImageCount = SwapChainSupportDetails.m_SurfaceCapabilities.maxImageCount;
@@ -651,25 +965,25 @@ namespace VulkanTutorial {
 		SwapchainCreateInfo.imageFormat = SurfaceFormat.format;
 		SwapchainCreateInfo.imageColorSpace = SurfaceFormat.colorSpace;
 		SwapchainCreateInfo.presentMode = PresentMode;
-		SwapchainCreateInfo.clipped = VK_TRUE; // trueȾĲĻϱڵĲֲȾܣ
+		SwapchainCreateInfo.clipped = VK_TRUE; // true当渲染的部分在屏幕上被遮挡的部分不进行渲染，提高性能！
 		SwapchainCreateInfo.imageExtent = Extent;
-		SwapchainCreateInfo.imageArrayLayers = 1; // ͨ1VRҪ2Ž()
+		SwapchainCreateInfo.imageArrayLayers = 1; // 通常都是1，除非如VR这种需要2张结果(左右眼)
 		SwapchainCreateInfo.imageUsage = VK_IMAGE_USAGE_COLOR_ATTACHMENT_BIT;
 		std::optional<uint32_t> GraphicQueueIndice = findQueueFamilies(m_PhysicalDevice, VK_QUEUE_GRAPHICS_BIT);
 		std::optional<uint32_t> PresentQueueIndice = findPresentQueueFamilies(m_PhysicalDevice);
 		uint32_t QueueFamilyIndices[] = { GraphicQueueIndice.value(), PresentQueueIndice.value() };
 		if (GraphicQueueIndice.value() != PresentQueueIndice.value()) {
-			SwapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT; // 干
+			SwapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_CONCURRENT; // 多个队列族共享
 			SwapchainCreateInfo.queueFamilyIndexCount = 2;
 			SwapchainCreateInfo.pQueueFamilyIndices = QueueFamilyIndices;
 		}
 		else {
-			SwapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE; // 
+			SwapchainCreateInfo.imageSharingMode = VK_SHARING_MODE_EXCLUSIVE; // 单个队列族独享
 			SwapchainCreateInfo.queueFamilyIndexCount = 0;
 			SwapchainCreateInfo.pQueueFamilyIndices = nullptr;
 		}
 		SwapchainCreateInfo.preTransform = SwapChainSupportDetails.m_SurfaceCapabilities.currentTransform;
-		SwapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR; // AlphaҪл
+		SwapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR; // 忽略Alpha，不需要与其他窗口物体进行混合
 		SwapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
 
 		if (vkCreateSwapchainKHR(m_LogicalDevice, &SwapchainCreateInfo, nullptr, &m_Swapchain) != VK_SUCCESS)
@@ -697,7 +1011,7 @@ namespace VulkanTutorial {
 			ImageViewCreateInfo.components.r = VK_COMPONENT_SWIZZLE_IDENTITY;
 			ImageViewCreateInfo.components.g = VK_COMPONENT_SWIZZLE_IDENTITY;
 			ImageViewCreateInfo.components.b = VK_COMPONENT_SWIZZLE_IDENTITY;
-			ImageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY; // ӳûaͨimageaͨ
+			ImageViewCreateInfo.components.a = VK_COMPONENT_SWIZZLE_IDENTITY; // 即不进行映射置换，a通道就是image的a通道数据
 			ImageViewCreateInfo.subresourceRange.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
 			ImageViewCreateInfo.subresourceRange.baseMipLevel = 0;
 			ImageViewCreateInfo.subresourceRange.levelCount = 1;
@@ -716,27 +1030,27 @@ namespace VulkanTutorial {
 		VkAttachmentDescription AttachmentDescription{};
 		AttachmentDescription.format = m_SwapchainFormat;
 		AttachmentDescription.samples = VK_SAMPLE_COUNT_1_BIT;
-		AttachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;  // ʱclear
+		AttachmentDescription.loadOp = VK_ATTACHMENT_LOAD_OP_CLEAR;  // 加载时先clear
 		AttachmentDescription.storeOp = VK_ATTACHMENT_STORE_OP_STORE;
 		AttachmentDescription.stencilLoadOp = VK_ATTACHMENT_LOAD_OP_DONT_CARE;
-		AttachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // ǲcare
+		AttachmentDescription.stencilStoreOp = VK_ATTACHMENT_STORE_OP_DONT_CARE; // 这里我们不care
 		AttachmentDescription.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED; // VkImageLayout (dont care)
-		AttachmentDescription.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // ڽʾ
+		AttachmentDescription.finalLayout = VK_IMAGE_LAYOUT_PRESENT_SRC_KHR; // 用于交换链显示
 
 		// Subpasses and Attachment references
 		VkAttachmentReference AttachmentReference;
 		AttachmentReference.attachment = 0;
 		AttachmentReference.layout = VK_IMAGE_LAYOUT_COLOR_ATTACHMENT_OPTIMAL;
 
-		VkSubpassDescription Subpass{}; // ֻҪһsubpassȾ
+		VkSubpassDescription Subpass{}; // 这里我们只需要一个subpass渲染三角形
 		Subpass.pipelineBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS;
 		Subpass.colorAttachmentCount = 1;
 		Subpass.pColorAttachments = &AttachmentReference;
 
 		VkSubpassDependency SubpassDependecy{};
-		SubpassDependecy.srcSubpass = VK_SUBPASS_EXTERNAL; // ʾȾͨĲһ֡Ⱦ
-		SubpassDependecy.dstSubpass = 0; // Ŀͨ
-		SubpassDependecy.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; // һ׶εɫ׶ΣＴһ֡
+		SubpassDependecy.srcSubpass = VK_SUBPASS_EXTERNAL; // 表示依赖于渲染通道外的操作，如上一帧的渲染结果
+		SubpassDependecy.dstSubpass = 0; // 目标子通道的索引
+		SubpassDependecy.srcStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT; // 上一阶段的颜色输出阶段，这里即上一帧
 		SubpassDependecy.srcAccessMask = 0;
 		SubpassDependecy.dstStageMask = VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT;
 		SubpassDependecy.dstAccessMask = VK_ACCESS_COLOR_ATTACHMENT_WRITE_BIT;
@@ -757,166 +1071,117 @@ namespace VulkanTutorial {
 		std::cout << "Success to create a render pass !" << "\n";
 	}
 
-	void Application::createGraphicsPipeline()
+	void Application::createPipelineLibrary()
 	{
-		std::cout << "Try to create a pipeline ..." << "\n";
-		auto VertexShaderCode = readFile("resources/shaders/spir-v/18_shader_vertexbuffer_vert.spv");
-		auto FragmentShaderCode = readFile("resources/shaders/spir-v/18_shader_vertexbuffer_frag.spv");
-		VkShaderModule VertexShaderModule = createShaderModule(VertexShaderCode);
-		VkShaderModule FragmentShaderModule = createShaderModule(FragmentShaderCode);
-
-		VkPipelineShaderStageCreateInfo VertexShaderStageCreateInfo{};
-		VertexShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		VertexShaderStageCreateInfo.pSpecializationInfo = nullptr; // ָshaderеĳֵȾʱٸֵЧʣ
-		VertexShaderStageCreateInfo.stage = VK_SHADER_STAGE_VERTEX_BIT;
-		VertexShaderStageCreateInfo.module = VertexShaderModule;
-		VertexShaderStageCreateInfo.pName = "main"; // shader
-
-		VkPipelineShaderStageCreateInfo FragmentShaderStageCreateInfo{};
-		FragmentShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
-		FragmentShaderStageCreateInfo.pSpecializationInfo = nullptr;
-		FragmentShaderStageCreateInfo.stage = VK_SHADER_STAGE_FRAGMENT_BIT;
-		FragmentShaderStageCreateInfo.module = FragmentShaderModule;
-		FragmentShaderStageCreateInfo.pName = "main";
-
-		VkPipelineShaderStageCreateInfo ShaderStageCreateInfos[] = { VertexShaderStageCreateInfo, FragmentShaderStageCreateInfo };
-
-		// VertexInput
-		VkPipelineVertexInputStateCreateInfo VertexInputStateCreateInfo{};
-		VertexInputStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-		auto VertexBindingDescription = Vertex::getBindingDescription();
-		VertexInputStateCreateInfo.vertexBindingDescriptionCount = 1;
-		VertexInputStateCreateInfo.pVertexBindingDescriptions = &VertexBindingDescription;           // ṹϢʵΪ
-		auto VertexArributeDescriptions = Vertex::getAttributeDescriptions();
-		VertexInputStateCreateInfo.vertexAttributeDescriptionCount = static_cast<uint32_t>(VertexArributeDescriptions.size());
-		VertexInputStateCreateInfo.pVertexAttributeDescriptions = VertexArributeDescriptions.data(); //ṹԲ֡ʽƫ
-
-		// Input Assembly
-		VkPipelineInputAssemblyStateCreateInfo InputAssemblyStateCreateInfo{};
-		InputAssemblyStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
-		InputAssemblyStateCreateInfo.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
-		InputAssemblyStateCreateInfo.primitiveRestartEnable = VK_FALSE;
-
-		// Dynamic State
-		std::vector<VkDynamicState> RequiredDynamicStates{
-			VK_DYNAMIC_STATE_VIEWPORT,
-			VK_DYNAMIC_STATE_SCISSOR
-		};
-		VkPipelineDynamicStateCreateInfo DynamicStateCreateInfo{};
-		DynamicStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
-		DynamicStateCreateInfo.dynamicStateCount = static_cast<uint32_t>(RequiredDynamicStates.size());
-		DynamicStateCreateInfo.pDynamicStates = RequiredDynamicStates.data();
+		m_PipelineLibrary.create(m_LogicalDevice, m_DeviceFeatures, m_DeletionQueue);
+		m_ShaderObjectBackend.create(m_LogicalDevice, m_DeviceFeatures, m_DeletionQueue);
+		if (m_RenderBackend == RenderBackend::ShaderObject && !m_ShaderObjectBackend.isSupported()) {
+			std::cerr << "VK_EXT_shader_object is not supported, fall back to pipelines." << "\n";
+			m_RenderBackend = RenderBackend::Pipeline;
+		}
+	}
 
-		// Viewport and Scissors
-		VkViewport Viewport;
-		Viewport.x = 0;
-		Viewport.y = 0;
-		Viewport.width = static_cast<float>(m_SwapchainExtent.width);
-		Viewport.height = static_cast<float>(m_SwapchainExtent.height);
-		Viewport.minDepth = 0.0f;
-		Viewport.maxDepth = 1.0f;
-		VkRect2D Scissor;
-		Scissor.offset = VkOffset2D(0, 0);
-		Scissor.extent = m_SwapchainExtent;
-		VkPipelineViewportStateCreateInfo ViewportStateCreateInfo{};
-		ViewportStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
-		ViewportStateCreateInfo.pScissors = &Scissor;
-		ViewportStateCreateInfo.viewportCount = 1;
-		ViewportStateCreateInfo.scissorCount = 1; // ЩGPU֧жViewportScissor
-		ViewportStateCreateInfo.pViewports = nullptr;
-		ViewportStateCreateInfo.pScissors = nullptr; // ﲻҪãΪѾָΪdynamic state֮ʱָ
-
-		// Rasterizer
-		VkPipelineRasterizationStateCreateInfo RasterizationStateCreateInfo{};
-		RasterizationStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
-		RasterizationStateCreateInfo.depthClampEnable = VK_FALSE; // ׶Ƿclamp
-		RasterizationStateCreateInfo.rasterizerDiscardEnable = VK_FALSE; // Ƿ񲻽йդ
-		RasterizationStateCreateInfo.polygonMode = VK_POLYGON_MODE_FILL;
-		RasterizationStateCreateInfo.lineWidth = 1.0f;
-		RasterizationStateCreateInfo.cullMode = VK_CULL_MODE_BACK_BIT;
-		RasterizationStateCreateInfo.frontFace = VK_FRONT_FACE_CLOCKWISE; // ˳ʱΪ
-		RasterizationStateCreateInfo.depthBiasEnable = VK_FALSE; // ƫ
-		RasterizationStateCreateInfo.depthBiasClamp = 0.0f;
-		RasterizationStateCreateInfo.depthBiasConstantFactor = 0.0f;
-		RasterizationStateCreateInfo.depthBiasSlopeFactor = 0.0f;
-		//Depth = Depth + depthBiasConstantFactor * constant + depthBiasSlopeFactor * slope (㹫ʽ)
-
-		// Mutisampling
-		VkPipelineMultisampleStateCreateInfo MultisamplingCreateInfo{};
-		MultisamplingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
-		MultisamplingCreateInfo.sampleShadingEnable = VK_FALSE; // Ƿ񳬲
-		MultisamplingCreateInfo.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
-		MultisamplingCreateInfo.minSampleShading = 1.0f;
-		MultisamplingCreateInfo.pSampleMask = nullptr;
-		MultisamplingCreateInfo.alphaToCoverageEnable = VK_FALSE;
-		MultisamplingCreateInfo.alphaToOneEnable = VK_FALSE;
-
-		// Depth and Stencil testing
-		VkPipelineDepthStencilStateCreateInfo DepthStencilStateCreateInfo{}; // ʱ
-
-		// Color Blending
-		VkPipelineColorBlendAttachmentState ColorBlendAttachment_1;
-		ColorBlendAttachment_1.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
-			| VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
-		ColorBlendAttachment_1.blendEnable = VK_TRUE;  // õalpha blending
-		ColorBlendAttachment_1.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
-		ColorBlendAttachment_1.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
-		ColorBlendAttachment_1.colorBlendOp = VK_BLEND_OP_ADD;
-		ColorBlendAttachment_1.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
-		ColorBlendAttachment_1.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
-		ColorBlendAttachment_1.alphaBlendOp = VK_BLEND_OP_ADD;
-
-		VkPipelineColorBlendStateCreateInfo ColorBlendStateCreateInfo{};
-		ColorBlendStateCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
-		ColorBlendStateCreateInfo.logicOpEnable = VK_FALSE;
-		ColorBlendStateCreateInfo.logicOp = VK_LOGIC_OP_COPY;
-		ColorBlendStateCreateInfo.attachmentCount = 1;
-		ColorBlendStateCreateInfo.pAttachments = &ColorBlendAttachment_1;
-		ColorBlendStateCreateInfo.blendConstants[0] = 0.0f;
-		ColorBlendStateCreateInfo.blendConstants[1] = 0.0f;
-		ColorBlendStateCreateInfo.blendConstants[2] = 0.0f;
-		ColorBlendStateCreateInfo.blendConstants[3] = 0.0f; // ֻVK_BLEND_FACTOR_CONSTANT_COLORVK_BLEND_FACTOR_CONSTANT_ALPHAҪ
+	void Application::createMaterials()
+	{
+		m_MaterialSystem.create(m_PipelineLibrary);
+		m_MaterialSystem.addMaterial({ "VertexColor", { glm::vec4(1.0f), MaterialVertexColor } });
+		m_MaterialSystem.addMaterial({ "TintedVertexColor", { glm::vec4(1.0f, 0.6f, 0.2f, 1.0f), MaterialVertexColor | MaterialBaseColor } });
+		m_MaterialSystem.addMaterial({ "BaseColor", { glm::vec4(0.2f, 0.7f, 0.7f, 1.0f), MaterialBaseColor } });
+		m_MaterialSystem.addMaterial({ "Textured", { glm::vec4(1.0f), MaterialVertexColor | MaterialTexture } }); // 不支持bindless时退化为VertexColor
+	}
+
+	void Application::createDescriptorAllocator()
+	{
+		std::cout << "Try to create a descriptor allocator ..." << "\n";
+		// 每个在途帧一条pool链，drawFrame在该帧fence等待之后重置
+		m_DescriptorAllocator.create(m_LogicalDevice, m_MaxFrameInFlight);
+		std::cout << std::format("Success to create a descriptor allocator with {0} frame pools !", m_MaxFrameInFlight) << "\n";
+	}
+
+	void Application::createBindlessTable()
+	{
+		// bindless表的layout由DescriptorCache去重并持有，数组大小在表内按设备限制裁剪；不支持descriptor indexing时表保持禁用
+		m_DescriptorCache.create(m_LogicalDevice, m_DescriptorAllocator);
+		m_BindlessTable.create(m_LogicalDevice, m_DeviceFeatures, m_DescriptorCache, m_DeletionQueue);
+		// 只有启用时pipeline layout才有set 0，声明了Textures[]的fragment shader不能用于没有该set的layout
+		if (m_BindlessTable.isEnabled())
+			m_PipelineKey.m_FragmentShader = BindlessFragmentShaderName;
+	}
+
+	void Application::createDescriptorBuffer()
+	{
+		// 只有--benchmark-backends使用；主pipeline的set 0是从pool分配的bindless set，同一pipeline不能混用两种绑定方式
+		if (!m_DeviceFeatures.isDescriptorBufferSupported()) {
+			std::cout << "VK_EXT_descriptor_buffer is not supported, descriptor buffer is disabled." << "\n";
+			return;
+		}
+		m_DescriptorBuffer.create(m_PhysicalDevice, m_LogicalDevice, m_DeviceFeatures, m_MaxFrameInFlight);
+	}
+
+	VkPushConstantRange Application::getMaterialPushConstantRange()
+	{
+		VkPushConstantRange Range{};
+		Range.stageFlags = VK_SHADER_STAGE_FRAGMENT_BIT;
+		Range.offset = 0;
+		Range.size = sizeof(MaterialParameters);
+		return Range;
+	}
+
+	std::vector<VkDescriptorSetLayout> Application::getPipelineSetLayouts()
+	{
+		// set 0是bindless表(设备支持时)
+		std::vector<VkDescriptorSetLayout> SetLayouts;
+		if (m_BindlessTable.isEnabled())
+			SetLayouts.emplace_back(m_BindlessTable.getSetLayout());
+		return SetLayouts;
+	}
+
+	void Application::createGraphicsPipeline()
+	{
+		std::cout << std::format("Try to create a pipeline {0:016x} ({1}) ...", m_PipelineKey.hash(), m_PipelineKey.m_Constants.toString()) << "\n";
 
 		// Pipeline Layout
 		VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo{};
 		PipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
-		PipelineLayoutCreateInfo.setLayoutCount = 0;
-		PipelineLayoutCreateInfo.pSetLayouts = nullptr;
-		PipelineLayoutCreateInfo.pushConstantRangeCount = 0;
-		PipelineLayoutCreateInfo.pPushConstantRanges = nullptr;
-
-		if (vkCreatePipelineLayout(m_LogicalDevice, &PipelineLayoutCreateInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
+		std::vector<VkDescriptorSetLayout> SetLayouts = getPipelineSetLayouts();
+		PipelineLayoutCreateInfo.setLayoutCount = static_cast<uint32_t>(SetLayouts.size());
+		PipelineLayoutCreateInfo.pSetLayouts = SetLayouts.data();
+		VkPushConstantRange MaterialRange = getMaterialPushConstantRange();
+		PipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		PipelineLayoutCreateInfo.pPushConstantRanges = &MaterialRange;
+
+		if (m_PipelineLayout == VK_NULL_HANDLE // 重新创建pipeline时沿用已有的layout
+			&& vkCreatePipelineLayout(m_LogicalDevice, &PipelineLayoutCreateInfo, nullptr, &m_PipelineLayout) != VK_SUCCESS)
 			throw std::runtime_error("Failed to create pipeline layout!");
 
-		// Pipline !
-		VkGraphicsPipelineCreateInfo GraphicsPiplineCreateInfo{};
-		GraphicsPiplineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
-		GraphicsPiplineCreateInfo.stageCount = 2;
-		GraphicsPiplineCreateInfo.pStages = ShaderStageCreateInfos;
-		GraphicsPiplineCreateInfo.pVertexInputState = &VertexInputStateCreateInfo;
-		GraphicsPiplineCreateInfo.pInputAssemblyState = &InputAssemblyStateCreateInfo;
-		GraphicsPiplineCreateInfo.pDynamicState = &DynamicStateCreateInfo;
-		GraphicsPiplineCreateInfo.pViewportState = &ViewportStateCreateInfo;
-		GraphicsPiplineCreateInfo.pRasterizationState = &RasterizationStateCreateInfo;
-		GraphicsPiplineCreateInfo.pMultisampleState = &MultisamplingCreateInfo;
-		GraphicsPiplineCreateInfo.pDepthStencilState = &DepthStencilStateCreateInfo;
-		GraphicsPiplineCreateInfo.pColorBlendState = &ColorBlendStateCreateInfo;
-		GraphicsPiplineCreateInfo.layout = m_PipelineLayout;
-		GraphicsPiplineCreateInfo.renderPass = m_RenderPass;
-		GraphicsPiplineCreateInfo.subpass = 0; // ֻһsubpassΪ0
-
-		GraphicsPiplineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
-		GraphicsPiplineCreateInfo.basePipelineIndex = -1;
-
-		if (vkCreateGraphicsPipelines(m_LogicalDevice, VK_NULL_HANDLE, 1,
-			&GraphicsPiplineCreateInfo, nullptr, &m_Pipeline) != VK_SUCCESS)
-			throw std::runtime_error("Failed to create graphics pipeline!");
-
-		vkDestroyShaderModule(m_LogicalDevice, FragmentShaderModule, nullptr);
-		vkDestroyShaderModule(m_LogicalDevice, VertexShaderModule, nullptr);
+		// m_PipelineID是ubershader，可以立即绘制任何材质；各材质的特化pipeline在后台编译，绝不阻塞渲染
+		GraphicsPipelineDesc Desc = createGraphicsPipelineDesc();
+		m_PipelineID = requestGraphicsPipeline(Desc);
+		if (m_RenderBackend == RenderBackend::Pipeline && !m_IsBenchmarkBackends) // benchmark只比较ubershader本身
+			m_MaterialSystem.requestSpecializations(Desc, m_FrameCount);
 		std::cout << "Success to create a pipeline !" << "\n";
 	}
 
+	GraphicsPipelineDesc Application::createGraphicsPipelineDesc()
+	{
+		// 固定功能状态的默认值即本程序所用：背面剔除、顺时针为正面、alpha blending；图元拓扑由索引打包结果决定
+		GraphicsPipelineDesc Desc;
+		Desc.m_Topology = m_PackedIndices.m_Topology;
+		Desc.m_IsPrimitiveRestartEnable = m_PackedIndices.isStrip(); // 三角形带之间以全1索引分隔
+		Desc.m_VertexCode = getShaderCode(m_PipelineKey.m_VertexShader); // 直接指向映射内存，无需拷贝
+		Desc.m_FragmentCode = getShaderCode(m_PipelineKey.m_FragmentShader);
+		Desc.m_Constants = m_PipelineKey.m_Constants; // shader中没有声明的constant ID会被忽略，因此两个阶段可以共用同一组常量
+		Desc.m_VertexBindings = { Vertex::getBindingDescription() };
+		auto VertexArributeDescriptions = Vertex::getAttributeDescriptions();
+		Desc.m_VertexAttributes.assign(VertexArributeDescriptions.begin(), VertexArributeDescriptions.end());
+		Desc.m_Layout = m_PipelineLayout;
+		Desc.m_SetLayouts = getPipelineSetLayouts();
+		Desc.m_PushConstantRanges = { getMaterialPushConstantRange() };
+		Desc.m_RenderPass = m_RenderPass;
+		Desc.m_Subpass = 0; // 只有一个subpass索引为0
+		return Desc;
+	}
+
 	void Application::createFramebuffers()
 	{
 		std::cout << "Try to create swapchain framebuffers ..." << "\n";
@@ -933,7 +1198,7 @@ namespace VulkanTutorial {
 			FramebufferCreateInfo.pAttachments = FramebufferImageViews;
 			FramebufferCreateInfo.width = m_SwapchainExtent.width;
 			FramebufferCreateInfo.height = m_SwapchainExtent.height;
-			FramebufferCreateInfo.layers = 1; // ͨΪ13Dͼ
+			FramebufferCreateInfo.layers = 1; // 通常为1，除非3D纹理或立体贴图
 
 			if (vkCreateFramebuffer(m_LogicalDevice, &FramebufferCreateInfo, nullptr, &m_SwapchainFramebuffers[i]) != VK_SUCCESS)
 				throw std::runtime_error("Failed to create framebuffer!");
@@ -964,18 +1229,18 @@ namespace VulkanTutorial {
 		// Staging Buffer
 		VkBuffer StagingBuffer = VK_NULL_HANDLE;
 		VkDeviceMemory StagingBufferMemory = VK_NULL_HANDLE;
-		createBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT   // ҪɼCPUͨvkMapMemoryʲд
+		createBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT   // 要求主机可见，才允许CPU通过vkMapMemory来访问并写入数据
 			| VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferMemory);
 
 		void* Data;
-		if (vkMapMemory(m_LogicalDevice, StagingBufferMemory, 0, BufferSize, 0, &Data) != VK_SUCCESS) // DataָGPUԴģ
+		if (vkMapMemory(m_LogicalDevice, StagingBufferMemory, 0, BufferSize, 0, &Data) != VK_SUCCESS) // 这里Data是指向GPU显存的！
 			throw std::runtime_error("Failed to map vertex buffer memory!");
-		memcpy(Data, Vertices.data(), (size_t)BufferSize); // 
-		vkUnmapMemory(m_LogicalDevice, StagingBufferMemory); // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT־unmapݻͬGPU
+		memcpy(Data, Vertices.data(), (size_t)BufferSize); // 设置数据
+		vkUnmapMemory(m_LogicalDevice, StagingBufferMemory); // 这里VK_MEMORY_PROPERTY_HOST_COHERENT_BIT标志，unmap数据会同步到GPU
 
 		// Vertex Buffer
 		createBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VertexBuffer, m_VertexBufferMemory); // VK_MEMORY_PROPERTY_HOST_COHERENT_BITҪһڴ棬ͨCPUдʱҪֶvkFlushMappedMemoryRangesͬ
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VertexBuffer, m_VertexBufferMemory); // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT要求一致性内存，当你通过CPU写入数据时，不需要手动调用vkFlushMappedMemoryRanges来同步数据
 
 		copyBuffer(m_VertexBuffer, StagingBuffer, BufferSize);
 
@@ -988,28 +1253,29 @@ namespace VulkanTutorial {
 	void Application::createIndexBuffer()
 	{
 		std::cout << "Try to create a index buffer ..." << "\n";
-		VkDeviceSize BufferSize = Indices.size() * sizeof(Indices[0]);
+		VkDeviceSize BufferSize = m_PackedIndices.m_Data.size();
 		// Staging Buffer
 		VkBuffer StagingBuffer = VK_NULL_HANDLE;
 		VkDeviceMemory StagingBufferMemory = VK_NULL_HANDLE;
-		createBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT   // ҪɼCPUͨvkMapMemoryʲд
+		createBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT, VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT   // 要求主机可见，才允许CPU通过vkMapMemory来访问并写入数据
 			| VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, StagingBuffer, StagingBufferMemory);
 
 		void* Data;
-		if (vkMapMemory(m_LogicalDevice, StagingBufferMemory, 0, BufferSize, 0, &Data) != VK_SUCCESS) // DataָGPUԴģ
+		if (vkMapMemory(m_LogicalDevice, StagingBufferMemory, 0, BufferSize, 0, &Data) != VK_SUCCESS) // 这里Data是指向GPU显存的！
 			throw std::runtime_error("Failed to map vertex buffer memory!");
-		memcpy(Data, Indices.data(), (size_t)BufferSize); // 
-		vkUnmapMemory(m_LogicalDevice, StagingBufferMemory); // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT־unmapݻͬGPU
+		memcpy(Data, m_PackedIndices.m_Data.data(), (size_t)BufferSize); // 设置数据
+		vkUnmapMemory(m_LogicalDevice, StagingBufferMemory); // 这里VK_MEMORY_PROPERTY_HOST_COHERENT_BIT标志，unmap数据会同步到GPU
 
 		// Vertex Buffer
 		createBuffer(BufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndexBuffer, m_IndexBufferMemory); // VK_MEMORY_PROPERTY_HOST_COHERENT_BITҪһڴ棬ͨCPUдʱҪֶvkFlushMappedMemoryRangesͬ
+			VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndexBuffer, m_IndexBufferMemory); // VK_MEMORY_PROPERTY_HOST_COHERENT_BIT要求一致性内存，当你通过CPU写入数据时，不需要手动调用vkFlushMappedMemoryRanges来同步数据
 
 		copyBuffer(m_IndexBuffer, StagingBuffer, BufferSize);
 
 		vkDestroyBuffer(m_LogicalDevice, StagingBuffer, nullptr);
 		vkFreeMemory(m_LogicalDevice, StagingBufferMemory, nullptr);
 
+		std::cout << std::format("\t{0} {1}-bit indices ({2})\n", m_PackedIndices.getIndexCount(), m_PackedIndices.getIndexSize() * 8, m_PackedIndices.isStrip() ? "strips" : "list");
 		std::cout << "Success to create a index buffer !" << "\n";
 	}
 
@@ -1028,6 +1294,62 @@ namespace VulkanTutorial {
 		std::cout << "Success to allocate a command buffers for graphics command pool !" << "\n";
 	}
 
+	void Application::createPipelineStatistics()
+	{
+		std::cout << "Try to create pipeline statistics queries ..." << "\n";
+		m_PipelineStatistics.create(m_LogicalDevice, m_DeviceFeatures, m_MaxFrameInFlight);
+		if (!m_PipelineStatistics.isEnabled())
+			std::cout << "\tpipelineStatisticsQuery is not supported, skipped" << "\n";
+		std::cout << "Success to create pipeline statistics queries !" << "\n";
+	}
+
+	void Application::createMeshletRenderer()
+	{
+		if (m_MeshPath.empty())
+			return;
+		MeshCacheFile MeshFile = MeshImporter::importMapped(m_MeshPath, m_MeshImportOptions);
+		MeshletShaderCode ShaderCode;
+		// meshlet着色器是可选的，缺失时只跳过网格绘制，不影响教程本身的管线
+		ShaderCode.m_Cull = findShaderCode("meshlet_cull_comp");
+		ShaderCode.m_Vertex = findShaderCode("quantized_mesh_vert");
+		ShaderCode.m_Fragment = findShaderCode("meshlet_frag");
+		if (m_IsMeshShaderPreferred) {
+			if (m_DeviceFeatures.isMeshShaderSupported()) {
+				ShaderCode.m_Task = findShaderCode("meshlet_task");
+				ShaderCode.m_Mesh = findShaderCode("meshlet_mesh");
+			}
+			else
+				std::cout << "\tVK_EXT_mesh_shader is not supported, fall back to compute culling" << "\n";
+		}
+		if (ShaderCode.m_Cull.empty() || ShaderCode.m_Vertex.empty() || ShaderCode.m_Fragment.empty()) {
+			std::cout << "\tmeshlet shaders are not found, skip drawing the mesh" << "\n";
+			return;
+		}
+		// 与主绘制使用同一种渲染方式：ShaderObject后端没有render pass，meshlet管线按交换链格式以动态渲染创建
+		VkRenderPass RenderPass = m_RenderBackend == RenderBackend::ShaderObject ? VK_NULL_HANDLE : m_RenderPass;
+		m_MeshletRenderer.create(m_PhysicalDevice, m_LogicalDevice, m_DeviceFeatures, m_DeviceTuning, m_DescriptorCache, m_GraphicsCommandPool, m_GraphicsQueue, RenderPass, m_SwapchainFormat,
+			MeshFile, ShaderCode, m_MaxFrameInFlight);
+		m_MeshBounds = MeshFile.getBounds();
+	}
+
+	void Application::createTextureLoader()
+	{
+		m_TextureLoader.create(m_PhysicalDevice, m_LogicalDevice, findQueueFamilies(m_PhysicalDevice, VK_QUEUE_GRAPHICS_BIT).value(), m_GraphicsQueue, m_BindlessTable);
+		if (m_TextureDirectory.empty())
+			return;
+		// 只排队不等待：渲染立即开始，纹理在就绪前使用占位纹理
+		size_t Count = 0;
+		for (const auto& Entry : std::filesystem::directory_iterator(m_TextureDirectory)) {
+			if (Entry.is_regular_file() && TextureLoader::isSupported(Entry.path())) {
+				TextureHandle Handle = m_TextureLoader.load(Entry.path());
+				if (!m_MaterialTexture)
+					m_MaterialTexture = Handle;
+				++Count;
+			}
+		}
+		std::cout << std::format("\tqueue {0} textures from \"{1}\"\n", Count, m_TextureDirectory.string());
+	}
+
 	void Application::createSyncObjects()
 	{
 		std::cout << "Try to create required synchronized objects ..." << "\n";
@@ -1039,7 +1361,7 @@ namespace VulkanTutorial {
 
 		VkFenceCreateInfo FenceCreateInfo{};
 		FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
-		FenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // fenceʼΪźţһ֡޷ʼ
+		FenceCreateInfo.flags = VK_FENCE_CREATE_SIGNALED_BIT; // fence初始化为有信号，否则第一帧无法开始
 
 		std::cout << "Required synchronized objects:" << "\n";
 		std::cout << "\tImage available semaphore" << "\n";
@@ -1060,6 +1382,13 @@ namespace VulkanTutorial {
 		//std::cout << std::format("Frame time: {:.2f} ms", vDeltaTime) << "\n";
 		//std::cout << std::format("Current frame index: {}", m_CurrentFrame) << "\n";
 		vkWaitForFences(m_LogicalDevice, 1, &m_InFlightFence[m_CurrentFrame], VK_TRUE, UINT64_MAX);
+		if (m_FrameCount >= m_MaxFrameInFlight) // 此时第m_FrameCount - m_MaxFrameInFlight帧已经执行完毕
+			m_DeletionQueue.flush(m_FrameCount - m_MaxFrameInFlight);
+		m_PipelineLibrary.update(m_FrameCount); // 换入后台优化完成的pipeline
+		m_TextureLoader.update(); // 提交后台解码完成的纹理，就绪的纹理替换占位纹理
+		m_DescriptorAllocator.beginFrame(m_CurrentFrame); // 该帧上一轮分配的descriptor set已不再使用
+		m_DescriptorBuffer.beginFrame(m_CurrentFrame);
+		m_PipelineStatistics.collect(m_CurrentFrame); // 读取该帧上一轮的查询结果
 
 		uint32_t SwapchainImageIndex;
 		if (VkResult Result = vkAcquireNextImageKHR(m_LogicalDevice, m_Swapchain, UINT64_MAX,
@@ -1084,7 +1413,7 @@ namespace VulkanTutorial {
 		VkPipelineStageFlags WaitStages[] = { VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT };
 		SubmitInfo.signalSemaphoreCount = 1;
 		SubmitInfo.pSignalSemaphores = WaitSemaphores;
-		SubmitInfo.pWaitDstStageMask = WaitStages;     // һһӦ
+		SubmitInfo.pWaitDstStageMask = WaitStages;     // 这两个数组一一对应
 		SubmitInfo.commandBufferCount = 1;
 		SubmitInfo.pCommandBuffers = &m_GraphicsCommandBuffer[m_CurrentFrame];
 		VkSemaphore SignalSemaphores[] = { m_RenderFinishedSemaphore[m_CurrentFrame] };
@@ -1102,7 +1431,7 @@ namespace VulkanTutorial {
 		PresentInfo.swapchainCount = 1;
 		PresentInfo.pSwapchains = Swapchains;
 		PresentInfo.pImageIndices = &SwapchainImageIndex;
-		PresentInfo.pResults = nullptr; // SwapchainûҪ
+		PresentInfo.pResults = nullptr; // 单个Swapchain没必要
 
 		if (VkResult Result = vkQueuePresentKHR(m_PresentQueue, &PresentInfo);
 			Result == VK_ERROR_OUT_OF_DATE_KHR || Result == VK_SUBOPTIMAL_KHR || m_IsWindowResize) {
@@ -1114,7 +1443,228 @@ namespace VulkanTutorial {
 		}
 
 		m_CurrentFrame = (m_CurrentFrame + 1) % m_MaxFrameInFlight;
+		++m_FrameCount;
 		//std::cout << "End Frame" << "\n";
 	}
 
-}
\ No newline at end of file
+	void Application::benchmarkRenderBackends()
+	{
+		std::cout << "Try to benchmark render backends ..." << "\n";
+		const uint32_t VariantCount = 8;     // 每个后端首次使用的变体数
+		const uint32_t RecordCount = 1000;   // 录制次数
+
+		VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+		VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
+		CommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		CommandBufferAllocateInfo.commandPool = m_GraphicsCommandPool;
+		CommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		CommandBufferAllocateInfo.commandBufferCount = 1;
+		if (vkAllocateCommandBuffers(m_LogicalDevice, &CommandBufferAllocateInfo, &CommandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate command buffers!");
+
+		std::vector<RenderBackend> Backends{ RenderBackend::Pipeline };
+		if (m_ShaderObjectBackend.isSupported())
+			Backends.emplace_back(RenderBackend::ShaderObject);
+		const RenderBackend OriginalBackend = m_RenderBackend;
+		const uint64_t OriginalPipelineID = m_PipelineID;
+		for (auto Backend : Backends) {
+			m_RenderBackend = Backend;
+			// 首次使用：每个变体带不同的specialization constant，必须重新编译，计时包括第一次录制
+			std::vector<uint64_t> IDs;
+			float TotalFirstUse = 0.0f;
+			float MaxFirstUse = 0.0f;
+			for (uint32_t i = 0; i < VariantCount; ++i) {
+				GraphicsPipelineDesc Desc = createGraphicsPipelineDesc();
+				Desc.m_Constants.set(BenchmarkConstantID, "BenchmarkVariant", static_cast<uint32_t>(Backend) * VariantCount + i + 1);
+				Timer FirstUseTimer;
+				m_PipelineID = requestGraphicsPipeline(Desc);
+				vkResetCommandBuffer(CommandBuffer, 0);
+				recordCommandBuffer(CommandBuffer, 0);
+				float FirstUse = FirstUseTimer.ellapseMilliseconds();
+				TotalFirstUse += FirstUse;
+				MaxFirstUse = std::max(MaxFirstUse, FirstUse);
+				IDs.emplace_back(m_PipelineID);
+			}
+
+			Timer RecordTimer;
+			for (uint32_t i = 0; i < RecordCount; ++i) {
+				m_PipelineID = IDs[i % IDs.size()];
+				vkResetCommandBuffer(CommandBuffer, 0);
+				recordCommandBuffer(CommandBuffer, 0);
+			}
+			float RecordMicroseconds = RecordTimer.ellapseMilliseconds() * 1000.0f / RecordCount;
+
+			std::cout << std::format("{0:<14} first use: avg {1:.3f} ms, max {2:.3f} ms | record: {3:.2f} us per command buffer",
+				Backend == RenderBackend::ShaderObject ? "shader object" : "pipeline", TotalFirstUse / VariantCount, MaxFirstUse, RecordMicroseconds) << "\n";
+			for (auto ID : IDs)
+				releaseGraphicsPipeline(ID); // 从未提交，cleanup时随删除队列一起销毁
+		}
+		m_RenderBackend = OriginalBackend;
+		m_PipelineID = OriginalPipelineID;
+		vkFreeCommandBuffers(m_LogicalDevice, m_GraphicsCommandPool, 1, &CommandBuffer);
+		std::cout << "Success to benchmark render backends !" << "\n";
+	}
+
+	void Application::benchmarkDescriptorUpdates()
+	{
+		std::cout << "Try to benchmark descriptor updates ..." << "\n";
+		constexpr uint32_t BindingCount = 4;
+		constexpr VkDeviceSize BindingRange = 256;  // 不小于任何设备的minUniformBufferOffsetAlignment
+		const uint32_t UpdateCount = 10000;
+
+		VkBuffer UniformBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory UniformBufferMemory = VK_NULL_HANDLE;
+		VkBufferUsageFlags UniformBufferUsage = VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT;
+		if (m_DescriptorBuffer.isSupported()) // descriptor buffer以设备地址引用资源
+			UniformBufferUsage |= VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+		createBuffer(BindingRange * BindingCount, UniformBufferUsage,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, UniformBuffer, UniformBufferMemory);
+
+		std::array<VkDescriptorSetLayoutBinding, BindingCount> Bindings{};
+		std::array<VkDescriptorBufferInfo, BindingCount> BufferInfos{};  // 模板直接读取这个数组
+		std::array<VkDescriptorUpdateTemplateEntry, BindingCount> Entries{};
+		for (uint32_t i = 0; i < BindingCount; ++i) {
+			Bindings[i] = { i, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 1, VK_SHADER_STAGE_VERTEX_BIT | VK_SHADER_STAGE_FRAGMENT_BIT, nullptr };
+			BufferInfos[i] = { UniformBuffer, BindingRange * i, BindingRange };
+			Entries[i] = DescriptorUpdateTemplate::makeEntry(i, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, sizeof(VkDescriptorBufferInfo) * i);
+		}
+		VkDescriptorSetLayout SetLayout = m_DescriptorCache.getLayout(Bindings);
+
+		// 逐draw更新一个set：循环使用少量set，只测量更新本身
+		std::vector<VkDescriptorSet> DescriptorSets(64);
+		for (auto& DescriptorSet : DescriptorSets)
+			DescriptorSet = m_DescriptorAllocator.allocateStatic(SetLayout);
+
+		Timer WriteTimer;
+		for (uint32_t i = 0; i < UpdateCount; ++i) {
+			std::array<VkWriteDescriptorSet, BindingCount> WriteDescriptorSets{};
+			for (uint32_t k = 0; k < BindingCount; ++k) {
+				WriteDescriptorSets[k].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+				WriteDescriptorSets[k].dstSet = DescriptorSets[i % DescriptorSets.size()];
+				WriteDescriptorSets[k].dstBinding = k;
+				WriteDescriptorSets[k].descriptorCount = 1;
+				WriteDescriptorSets[k].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+				WriteDescriptorSets[k].pBufferInfo = &BufferInfos[k];
+			}
+			vkUpdateDescriptorSets(m_LogicalDevice, BindingCount, WriteDescriptorSets.data(), 0, nullptr);
+		}
+		float WriteMicroseconds = WriteTimer.ellapseMilliseconds() * 1000.0f / UpdateCount;
+
+		DescriptorUpdateTemplate UpdateTemplate;
+		UpdateTemplate.create(m_LogicalDevice, SetLayout, Entries);
+		Timer TemplateTimer;
+		for (uint32_t i = 0; i < UpdateCount; ++i)
+			UpdateTemplate.update(DescriptorSets[i % DescriptorSets.size()], BufferInfos.data());
+		float TemplateMicroseconds = TemplateTimer.ellapseMilliseconds() * 1000.0f / UpdateCount;
+		std::cout << std::format("vkUpdateDescriptorSets: {0:.3f} us per set | update template: {1:.3f} us per set",
+			WriteMicroseconds, TemplateMicroseconds) << "\n";
+
+		// 逐draw变化的set：分配+更新+绑定 对比 push descriptor，计时包括录制
+		if (m_DeviceFeatures.isPushDescriptorSupported()) {
+			VkDescriptorSetLayout PushSetLayout = m_DescriptorCache.getLayout(Bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_PUSH_DESCRIPTOR_BIT_KHR);
+			VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo{};
+			PipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			PipelineLayoutCreateInfo.setLayoutCount = 1;
+			PipelineLayoutCreateInfo.pSetLayouts = &SetLayout;
+			VkPipelineLayout SetPipelineLayout = VK_NULL_HANDLE;
+			VkPipelineLayout PushPipelineLayout = VK_NULL_HANDLE;
+			if (vkCreatePipelineLayout(m_LogicalDevice, &PipelineLayoutCreateInfo, nullptr, &SetPipelineLayout) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create pipeline layout!");
+			PipelineLayoutCreateInfo.pSetLayouts = &PushSetLayout;
+			if (vkCreatePipelineLayout(m_LogicalDevice, &PipelineLayoutCreateInfo, nullptr, &PushPipelineLayout) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create pipeline layout!");
+
+			DescriptorUpdateTemplate PushTemplate;
+			PushTemplate.createForPush(m_LogicalDevice, m_DeviceFeatures, PushSetLayout, Entries, PushPipelineLayout, 0);
+
+			VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+			VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
+			CommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			CommandBufferAllocateInfo.commandPool = m_GraphicsCommandPool;
+			CommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			CommandBufferAllocateInfo.commandBufferCount = 1;
+			if (vkAllocateCommandBuffers(m_LogicalDevice, &CommandBufferAllocateInfo, &CommandBuffer) != VK_SUCCESS)
+				throw std::runtime_error("Failed to allocate command buffers!");
+			VkCommandBufferBeginInfo CommandBufferBeginInfo{};
+			CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+			vkBeginCommandBuffer(CommandBuffer, &CommandBufferBeginInfo);
+			Timer SetTimer;
+			for (uint32_t i = 0; i < UpdateCount; ++i) {
+				VkDescriptorSet DescriptorSet = m_DescriptorAllocator.allocateFrame(SetLayout);
+				UpdateTemplate.update(DescriptorSet, BufferInfos.data());
+				vkCmdBindDescriptorSets(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, SetPipelineLayout, 0, 1, &DescriptorSet, 0, nullptr);
+			}
+			float SetMicroseconds = SetTimer.ellapseMilliseconds() * 1000.0f / UpdateCount;
+			vkEndCommandBuffer(CommandBuffer);
+
+			vkResetCommandBuffer(CommandBuffer, 0);
+			vkBeginCommandBuffer(CommandBuffer, &CommandBufferBeginInfo);
+			Timer PushTimer;
+			for (uint32_t i = 0; i < UpdateCount; ++i)
+				PushTemplate.push(CommandBuffer, BufferInfos.data());
+			float PushMicroseconds = PushTimer.ellapseMilliseconds() * 1000.0f / UpdateCount;
+			vkEndCommandBuffer(CommandBuffer);
+			std::cout << std::format("allocate + update + bind: {0:.3f} us per draw | push descriptor: {1:.3f} us per draw",
+				SetMicroseconds, PushMicroseconds) << "\n";
+
+			vkFreeCommandBuffers(m_LogicalDevice, m_GraphicsCommandPool, 1, &CommandBuffer);
+			PushTemplate.destroy();
+			vkDestroyPipelineLayout(m_LogicalDevice, PushPipelineLayout, nullptr);
+			vkDestroyPipelineLayout(m_LogicalDevice, SetPipelineLayout, nullptr);
+		}
+
+		// descriptor buffer：分配只是移动偏移，写入即vkGetDescriptorEXT拷贝到映射内存，绑定只设置偏移
+		if (m_DescriptorBuffer.isSupported()) {
+			VkDescriptorSetLayout BufferSetLayout = m_DescriptorCache.getLayout(Bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT);
+			VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo{};
+			PipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+			PipelineLayoutCreateInfo.setLayoutCount = 1;
+			PipelineLayoutCreateInfo.pSetLayouts = &BufferSetLayout;
+			VkPipelineLayout BufferPipelineLayout = VK_NULL_HANDLE;
+			if (vkCreatePipelineLayout(m_LogicalDevice, &PipelineLayoutCreateInfo, nullptr, &BufferPipelineLayout) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create pipeline layout!");
+
+			VkCommandBuffer CommandBuffer = VK_NULL_HANDLE;
+			VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
+			CommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+			CommandBufferAllocateInfo.commandPool = m_GraphicsCommandPool;
+			CommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+			CommandBufferAllocateInfo.commandBufferCount = 1;
+			if (vkAllocateCommandBuffers(m_LogicalDevice, &CommandBufferAllocateInfo, &CommandBuffer) != VK_SUCCESS)
+				throw std::runtime_error("Failed to allocate command buffers!");
+			VkCommandBufferBeginInfo CommandBufferBeginInfo{};
+			CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+
+			const VkDeviceAddress UniformBufferAddress = m_DescriptorBuffer.getBufferAddress(UniformBuffer);
+			vkBeginCommandBuffer(CommandBuffer, &CommandBufferBeginInfo);
+			m_DescriptorBuffer.bind(CommandBuffer);
+			Timer BufferTimer;
+			VkDeviceSize SetSize = 0;
+			for (uint32_t i = 0; i < UpdateCount; ++i) {
+				if (!m_DescriptorBuffer.canAllocate(BufferSetLayout))
+					m_DescriptorBuffer.beginFrame(m_CurrentFrame); // 从未提交，本帧区域满了直接回绕
+				VkDeviceSize SetOffset = m_DescriptorBuffer.allocate(BufferSetLayout);
+				for (uint32_t k = 0; k < BindingCount; ++k)
+					m_DescriptorBuffer.writeBuffer(SetOffset, BufferSetLayout, k, VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER,
+						UniformBufferAddress + BufferInfos[k].offset, BufferInfos[k].range);
+				m_DescriptorBuffer.setOffset(CommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, BufferPipelineLayout, 0, SetOffset);
+				if (i == 0)
+					SetSize = m_DescriptorBuffer.getUsedBytes();
+			}
+			float BufferMicroseconds = BufferTimer.ellapseMilliseconds() * 1000.0f / UpdateCount;
+			vkEndCommandBuffer(CommandBuffer);
+			m_DescriptorBuffer.beginFrame(m_CurrentFrame);
+			std::cout << std::format("descriptor buffer: {0:.3f} us per draw, {1} bytes per set", BufferMicroseconds, SetSize) << "\n";
+
+			vkFreeCommandBuffers(m_LogicalDevice, m_GraphicsCommandPool, 1, &CommandBuffer);
+			vkDestroyPipelineLayout(m_LogicalDevice, BufferPipelineLayout, nullptr);
+		}
+
+		UpdateTemplate.destroy();
+		vkDestroyBuffer(m_LogicalDevice, UniformBuffer, nullptr);
+		vkFreeMemory(m_LogicalDevice, UniformBufferMemory, nullptr);
+		std::cout << "Success to benchmark descriptor updates !" << "\n";
+	}
+
+}
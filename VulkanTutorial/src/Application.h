@@ -2,6 +2,32 @@
 #include "Base.h"
 #include "Timer.h"
 #include "Primitive.h"
+#include "ShaderPack.h"
+#include "ShaderCompiler.h"
+#include "ShaderWatcher.h"
+#include "DeletionQueue.h"
+#include "PipelineKey.h"
+#include "DeviceTuning.h"
+#include "DeviceFeatures.h"
+#include "PipelineLibrary.h"
+#include "ShaderObjectBackend.h"
+#include "Material.h"
+#include "DescriptorAllocator.h"
+#include "DescriptorCache.h"
+#include "DescriptorUpdateTemplate.h"
+#include "DescriptorBuffer.h"
+#include "MeshImporter.h"
+#include "IndexPacker.h"
+#include "VertexQuantizer.h"
+#include "LodSelector.h"
+#include "MeshletBuilder.h"
+#include "MeshletRenderer.h"
+#include "PipelineStatistics.h"
+#include "BindlessTable.h"
+#include "ImageDecoder.h"
+#include "Ktx2File.h"
+#include "TextureImporter.h"
+#include "TextureLoader.h"
 
 #include <GLFW/glfw3.h>
 #define GLFW_EXPOSE_NATIVE_WIN32
@@ -12,6 +38,11 @@
 #include <vector>
 #include <optional>
 #include <filesystem>
+#include <span>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 
 
 namespace VulkanTutorial {
@@ -23,10 +54,20 @@ namespace VulkanTutorial {
 		{{-0.5f, 0.5f}, {1.0f, 1.0f, 1.0f}},
 	};
 
-	const std::vector<uint16_t> Indices = {
+	const std::vector<uint32_t> Indices = {
 		0, 1, 2, 2, 3, 0
 	};
 
+	const std::string VertexShaderName = "18_shader_vertexbuffer_vert";
+	const std::string FragmentShaderName = "18_shader_vertexbuffer_frag";
+	const std::string BindlessFragmentShaderName = "18_shader_vertexbuffer_bindless_frag"; // 启用bindless表时替换FragmentShaderName
+
+	enum class RenderBackend
+	{
+		Pipeline,      // VkPipeline (PipelineLibrary)
+		ShaderObject   // VK_EXT_shader_object (ShaderObjectBackend)
+	};
+
 	struct SwapChainSupportDetails {
 		VkSurfaceCapabilitiesKHR m_SurfaceCapabilities;
 		std::vector<VkSurfaceFormatKHR> m_SurfaceFormats;
@@ -36,6 +77,7 @@ namespace VulkanTutorial {
 	class Application
 	{
 	public:
+		void parseArguments(int vArgumentCount, char** vArguments);
 		void run();
 
 	private:
@@ -54,6 +96,11 @@ namespace VulkanTutorial {
 		void createSwapChain();
 		void createImageViews();
 		void createRenderPass();
+		void createPipelineLibrary();
+		void createMaterials();
+		void createDescriptorAllocator();
+		void createBindlessTable();
+		void createDescriptorBuffer();
 		void createGraphicsPipeline();
 		void createFramebuffers();
 		void createGraphicsCommandPool();
@@ -61,8 +108,13 @@ namespace VulkanTutorial {
 		void createIndexBuffer();
 		void createGraphicsCommandBuffers();
 		void createSyncObjects();
+		void createPipelineStatistics();
+		void createMeshletRenderer();
+		void createTextureLoader();
 		// mainLoop
 		void drawFrame(float vDeltaTime);
+		void benchmarkRenderBackends();
+		void benchmarkDescriptorUpdates();
 	private:
 		// Extensions
 		void showExtensionInformation(const std::vector<VkExtensionProperties>& vExtensions);
@@ -79,7 +131,7 @@ namespace VulkanTutorial {
 		// Divece and Queue families
 		uint32_t ratePhysicalDevice(VkPhysicalDevice vPhysicalDevice);
 		std::optional<uint32_t> findQueueFamilies(VkPhysicalDevice vPhysicalDevice, VkQueueFlagBits vFlag);
-		std::optional<uint32_t> findPresentQueueFamilies(VkPhysicalDevice vPhysicalDevice);  // ѯ֧presentQueueFamily
+		std::optional<uint32_t> findPresentQueueFamilies(VkPhysicalDevice vPhysicalDevice);  // 查询支持present的QueueFamily
 		bool checkRequiredQueueFamiliesSupport();  // All Queue required available ?
 	private:
 		// SwapChain
@@ -92,27 +144,51 @@ namespace VulkanTutorial {
 		void cleanupSwapchain();
 	private:
 		// Shader
-		std::vector<char> readFile(const std::filesystem::path& vPath);
-		VkShaderModule createShaderModule(const std::vector<char>& vCode);
+		void loadShaderPack();
+		void watchShaderSources();
+		void processShaderReloads();
+		void recreateGraphicsPipeline();
+		GraphicsPipelineDesc createGraphicsPipelineDesc();
+		VkPushConstantRange getMaterialPushConstantRange();
+		std::vector<VkDescriptorSetLayout> getPipelineSetLayouts();
+		uint64_t requestGraphicsPipeline(const GraphicsPipelineDesc& vDesc);   // 由当前后端创建
+		void releaseGraphicsPipeline(uint64_t vID);
+		std::span<const uint32_t> getShaderCode(const std::string& vName);
+		std::span<const uint32_t> findShaderCode(const std::string& vName);  // 不抛异常，找不到时返回空span
 	private:
 		// Command
 		void recordCommandBuffer(VkCommandBuffer vCommandBuffer, uint32_t vImageIndex);
+		void beginRendering(VkCommandBuffer vCommandBuffer, uint32_t vImageIndex);  // Pipeline后端进入render pass，ShaderObject后端使用动态渲染
+		void endRendering(VkCommandBuffer vCommandBuffer, uint32_t vImageIndex);
+		void bindGraphicsState(VkCommandBuffer vCommandBuffer);  // 绑定pipeline或shader object并设置动态状态
 	private:
 		// Buffer
 		uint32_t findMemoryType(uint32_t vTypeFilter, VkMemoryPropertyFlags vProperties);
 		void createBuffer(VkDeviceSize vSize, VkBufferUsageFlags vUsage, VkMemoryPropertyFlags vFlags,
-			VkBuffer& vBuffer, VkDeviceMemory& vBufferMemory); // BufferMemory
+			VkBuffer& vBuffer, VkDeviceMemory& vBufferMemory); // 创建Buffer并分配Memory
 		void copyBuffer(VkBuffer vDestination, VkBuffer vSource, VkDeviceSize vSize);
+	private:
+		// Mesh
+		glm::mat4 getMeshViewProjection(const MeshBounds& vBounds, float vAngle, float vAspect, glm::vec3& vCameraPosition) const;  // 绕网格中心水平旋转并前后推拉的相机
 	public:
 		uint32_t m_Width = 800;
 		uint32_t m_Height = 600;
-		const uint32_t m_MaxFrameInFlight = 2; // CPUGPUһ֡棬ͨ2Ǻ
+		const uint32_t m_MaxFrameInFlight = 2; // 即CPU最多领先GPU一帧画面，通常2是合理的
 		uint32_t m_CurrentFrame = 0;
+		uint64_t m_FrameCount = 0; // 已提交的总帧数，用于延迟销毁
 		bool m_IsWindowResize = false;
 		bool m_IsMinimized = false;
 		GLFWwindow* m_Window = nullptr;
 		Timer m_Timer = {};
 		float m_LastFrameTime = 0.0f;
+		RenderBackend m_RenderBackend = RenderBackend::Pipeline;
+		bool m_IsBenchmarkBackends = false;
+		std::filesystem::path m_ImportMeshPath; // 非空时只导入网格并打印统计，不创建窗口
+		std::filesystem::path m_MeshPath; // 非空时导入网格，按meshlet剔除后绘制在四边形之上
+		MeshImportOptions m_MeshImportOptions; // --no-optimize关闭网格优化，作用于--import-mesh和--mesh
+		bool m_IsMeshShaderPreferred = false; // 设备支持时用VK_EXT_mesh_shader绘制m_MeshPath
+		std::filesystem::path m_TextureDirectory; // 非空时启动后在后台加载该目录下的所有图片
+		std::filesystem::path m_ImportTexturePath; // 非空时只把图片导入为KTX2缓存并打印统计，不创建窗口
 	private:
 		VkInstance m_Instance;
 		VkDebugUtilsMessengerEXT m_DebugMessenger;
@@ -126,7 +202,7 @@ namespace VulkanTutorial {
 		VkExtent2D m_SwapchainExtent;
 		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
 		VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
-		VkPipeline m_Pipeline = VK_NULL_HANDLE;
+		uint64_t m_PipelineID = 0; // 由当前后端(m_PipelineLibrary或m_ShaderObjectBackend)管理
 		std::vector<VkFramebuffer> m_SwapchainFramebuffers;
 		VkCommandPool m_GraphicsCommandPool = VK_NULL_HANDLE;
 		std::vector<VkCommandBuffer> m_GraphicsCommandBuffer;
@@ -138,9 +214,34 @@ namespace VulkanTutorial {
 		VkDeviceMemory m_VertexBufferMemory = VK_NULL_HANDLE;
 		VkBuffer m_IndexBuffer = VK_NULL_HANDLE;
 		VkDeviceMemory m_IndexBufferMemory = VK_NULL_HANDLE;
+		PackedIndices m_PackedIndices = IndexPacker::pack(Indices, Vertices.size()); // 索引格式和图元拓扑在创建pipeline前就已确定
 
 		VkQueue m_GraphicsQueue = VK_NULL_HANDLE;
 		VkQueue m_PresentQueue = VK_NULL_HANDLE;
+
+		DeviceFeatures m_DeviceFeatures;
+		PipelineLibrary m_PipelineLibrary;
+		ShaderObjectBackend m_ShaderObjectBackend;
+		MaterialSystem m_MaterialSystem;
+		uint32_t m_ActiveMaterial = 0; // 按M键切换
+		ShaderPack m_ShaderPack;
+		DeviceTuning m_DeviceTuning;
+		PipelineKey m_PipelineKey{ .m_VertexShader = VertexShaderName, .m_FragmentShader = FragmentShaderName, .m_Constants = {} };
+		std::unique_ptr<ShaderCompiler> m_ShaderCompiler;
+		ShaderWatcher m_ShaderWatcher;
+		std::unordered_map<std::string, std::vector<uint32_t>> m_CompiledShaders; // 运行时编译的shader优先于shader pack
+		std::mutex m_ShaderReloadMutex;
+		std::vector<std::pair<std::string, std::vector<uint32_t>>> m_PendingShaderReloads;
+		DeletionQueue m_DeletionQueue;
+		DescriptorAllocator m_DescriptorAllocator;
+		DescriptorCache m_DescriptorCache;
+		BindlessTable m_BindlessTable;
+		DescriptorBuffer m_DescriptorBuffer;
+		PipelineStatistics m_PipelineStatistics;
+		MeshletRenderer m_MeshletRenderer;
+		MeshBounds m_MeshBounds;
+		TextureLoader m_TextureLoader;
+		std::optional<TextureHandle> m_MaterialTexture; // Textured材质采样的纹理，为空时采样占位纹理
 	};
 
 }
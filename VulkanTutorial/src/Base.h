@@ -5,4 +5,10 @@
 	const bool IsEnableValidationLayer = true;
 #else
 	const bool IsEnableValidationLayer = false;
+#endif
+
+#ifdef VK_TUTORIAL_DIST
+	const bool IsEnableShaderHotReload = false;  // 发布版本只使用预编译的shader pack
+#else
+	const bool IsEnableShaderHotReload = true;
 #endif
\ No newline at end of file
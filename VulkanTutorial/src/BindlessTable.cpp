@@ -0,0 +1,161 @@
+#include "BindlessTable.h"
+
+#include <algorithm>
+#include <array>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr VkShaderStageFlags BindlessStages = VK_SHADER_STAGE_ALL_GRAPHICS | VK_SHADER_STAGE_COMPUTE_BIT;
+
+	}
+
+	BindlessTable::~BindlessTable()
+	{
+		destroy();
+	}
+
+	void BindlessTable::create(VkDevice vDevice, const DeviceFeatures& vFeatures, DescriptorCache& vDescriptorCache, DeletionQueue& vDeletionQueue,
+		uint32_t vMaxTextures, uint32_t vMaxStorageBuffers)
+	{
+		m_Device = vDevice;
+		m_DeletionQueue = &vDeletionQueue;
+		if (!vFeatures.isDescriptorIndexingSupported()) {
+			std::cout << "Descriptor indexing is not supported, bindless table is disabled." << "\n";
+			return;
+		}
+
+		// 数组大小不能超过设备对update-after-bind descriptor的限制
+		const auto& Properties = vFeatures.getDescriptorIndexingProperties();
+		m_Textures.m_Capacity = std::min({ vMaxTextures, Properties.maxDescriptorSetUpdateAfterBindSampledImages,
+			Properties.maxPerStageDescriptorUpdateAfterBindSampledImages });
+		m_StorageBuffers.m_Capacity = std::min({ vMaxStorageBuffers, Properties.maxDescriptorSetUpdateAfterBindStorageBuffers,
+			Properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers });
+		// 两个数组在同一stage中可见，总数还受maxPerStageUpdateAfterBindResources限制，超出时按比例缩小
+		uint64_t TotalCount = static_cast<uint64_t>(m_Textures.m_Capacity) + m_StorageBuffers.m_Capacity;
+		if (TotalCount > Properties.maxPerStageUpdateAfterBindResources) {
+			m_Textures.m_Capacity = static_cast<uint32_t>(m_Textures.m_Capacity * Properties.maxPerStageUpdateAfterBindResources / TotalCount);
+			m_StorageBuffers.m_Capacity = static_cast<uint32_t>(m_StorageBuffers.m_Capacity * Properties.maxPerStageUpdateAfterBindResources / TotalCount);
+		}
+
+		std::array<VkDescriptorSetLayoutBinding, 2> Bindings{};
+		Bindings[0].binding = TextureBinding;
+		Bindings[0].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+		Bindings[0].descriptorCount = m_Textures.m_Capacity;
+		Bindings[0].stageFlags = BindlessStages;
+		Bindings[1].binding = StorageBufferBinding;
+		Bindings[1].descriptorType = VK_DESCRIPTOR_TYPE_STORAGE_BUFFER;
+		Bindings[1].descriptorCount = m_StorageBuffers.m_Capacity;
+		Bindings[1].stageFlags = BindlessStages;
+
+		// PARTIALLY_BOUND：未写入的槽位只要不被访问就合法
+		// UPDATE_AFTER_BIND + UPDATE_UNUSED_WHILE_PENDING：set绑定后、命令执行中仍可写入未被使用的槽位
+		const VkDescriptorBindingFlags BindingFlag = VK_DESCRIPTOR_BINDING_PARTIALLY_BOUND_BIT
+			| VK_DESCRIPTOR_BINDING_UPDATE_AFTER_BIND_BIT | VK_DESCRIPTOR_BINDING_UPDATE_UNUSED_WHILE_PENDING_BIT;
+		std::array<VkDescriptorBindingFlags, 2> BindingFlags{ BindingFlag, BindingFlag };
+		m_SetLayout = vDescriptorCache.getLayout(Bindings, VK_DESCRIPTOR_SET_LAYOUT_CREATE_UPDATE_AFTER_BIND_POOL_BIT, BindingFlags);
+
+		std::array<VkDescriptorPoolSize, 2> PoolSizes{ {
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, m_Textures.m_Capacity },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, m_StorageBuffers.m_Capacity }
+		} };
+		VkDescriptorPoolCreateInfo DescriptorPoolCreateInfo{};
+		DescriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		DescriptorPoolCreateInfo.flags = VK_DESCRIPTOR_POOL_CREATE_UPDATE_AFTER_BIND_BIT;
+		DescriptorPoolCreateInfo.maxSets = 1;
+		DescriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(PoolSizes.size());
+		DescriptorPoolCreateInfo.pPoolSizes = PoolSizes.data();
+		if (vkCreateDescriptorPool(m_Device, &DescriptorPoolCreateInfo, nullptr, &m_DescriptorPool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create bindless descriptor pool!");
+
+		VkDescriptorSetAllocateInfo DescriptorSetAllocateInfo{};
+		DescriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		DescriptorSetAllocateInfo.descriptorPool = m_DescriptorPool;
+		DescriptorSetAllocateInfo.descriptorSetCount = 1;
+		DescriptorSetAllocateInfo.pSetLayouts = &m_SetLayout;
+		if (vkAllocateDescriptorSets(m_Device, &DescriptorSetAllocateInfo, &m_DescriptorSet) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate bindless descriptor set!");
+
+		std::cout << std::format("Success to create a bindless table ({0} textures, {1} storage buffers) !",
+			m_Textures.m_Capacity, m_StorageBuffers.m_Capacity) << "\n";
+	}
+
+	void BindlessTable::destroy()
+	{
+		if (m_Device == VK_NULL_HANDLE)
+			return;
+		if (m_DescriptorPool != VK_NULL_HANDLE)
+			vkDestroyDescriptorPool(m_Device, m_DescriptorPool, nullptr);  // set随pool一起释放
+		m_DescriptorPool = VK_NULL_HANDLE;
+		m_SetLayout = VK_NULL_HANDLE;
+		m_DescriptorSet = VK_NULL_HANDLE;
+		m_Textures = {};
+		m_StorageBuffers = {};
+		m_Device = VK_NULL_HANDLE;
+	}
+
+	uint32_t BindlessTable::addTexture(VkImageView vImageView, VkSampler vSampler, VkImageLayout vLayout)
+	{
+		uint32_t Index = allocateSlot(m_Textures, "texture");
+		VkDescriptorImageInfo ImageInfo{ vSampler, vImageView, vLayout };
+		write(TextureBinding, Index, VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, &ImageInfo, nullptr);
+		return Index;
+	}
+
+	uint32_t BindlessTable::addStorageBuffer(VkBuffer vBuffer, VkDeviceSize vOffset, VkDeviceSize vRange)
+	{
+		uint32_t Index = allocateSlot(m_StorageBuffers, "storage buffer");
+		VkDescriptorBufferInfo BufferInfo{ vBuffer, vOffset, vRange };
+		write(StorageBufferBinding, Index, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, nullptr, &BufferInfo);
+		return Index;
+	}
+
+	void BindlessTable::removeTexture(uint32_t vIndex, uint64_t vRetireFrame)
+	{
+		// 槽位内容保留不动，仍在执行的命令读到的还是旧资源；退休后才允许被新资源覆盖
+		m_DeletionQueue->push(vRetireFrame, [this, vIndex]() { m_Textures.m_FreeIndices.emplace_back(vIndex); });
+	}
+
+	void BindlessTable::removeStorageBuffer(uint32_t vIndex, uint64_t vRetireFrame)
+	{
+		m_DeletionQueue->push(vRetireFrame, [this, vIndex]() { m_StorageBuffers.m_FreeIndices.emplace_back(vIndex); });
+	}
+
+	void BindlessTable::bind(VkCommandBuffer vCommandBuffer, VkPipelineBindPoint vBindPoint, VkPipelineLayout vLayout, uint32_t vSetIndex) const
+	{
+		vkCmdBindDescriptorSets(vCommandBuffer, vBindPoint, vLayout, vSetIndex, 1, &m_DescriptorSet, 0, nullptr);
+	}
+
+	uint32_t BindlessTable::allocateSlot(Slots& vSlots, const char* vName)
+	{
+		if (!isEnabled())
+			throw std::runtime_error("Bindless table is not enabled!");
+		if (!vSlots.m_FreeIndices.empty()) {
+			uint32_t Index = vSlots.m_FreeIndices.back();
+			vSlots.m_FreeIndices.pop_back();
+			return Index;
+		}
+		if (vSlots.m_Count >= vSlots.m_Capacity)
+			throw std::runtime_error(std::format("Fail to add a {0} to the bindless table, all {1} slots are used.", vName, vSlots.m_Capacity));
+		return vSlots.m_Count++;
+	}
+
+	void BindlessTable::write(uint32_t vBinding, uint32_t vIndex, VkDescriptorType vType, const VkDescriptorImageInfo* vImageInfo, const VkDescriptorBufferInfo* vBufferInfo)
+	{
+		VkWriteDescriptorSet WriteDescriptorSet{};
+		WriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+		WriteDescriptorSet.dstSet = m_DescriptorSet;
+		WriteDescriptorSet.dstBinding = vBinding;
+		WriteDescriptorSet.dstArrayElement = vIndex;
+		WriteDescriptorSet.descriptorCount = 1;
+		WriteDescriptorSet.descriptorType = vType;
+		WriteDescriptorSet.pImageInfo = vImageInfo;
+		WriteDescriptorSet.pBufferInfo = vBufferInfo;
+		vkUpdateDescriptorSets(m_Device, 1, &WriteDescriptorSet, 0, nullptr);
+	}
+
+}
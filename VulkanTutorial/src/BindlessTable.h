@@ -0,0 +1,73 @@
+#pragma once
+#include "DeletionQueue.h"
+#include "DescriptorCache.h"
+#include "DeviceFeatures.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 基于descriptor indexing的bindless资源表：全部纹理和storage buffer各放在同一个set的一个大数组中，
+	// shader按索引(例如材质ID)访问，每帧只需绑定一次该set，不同材质的draw之间不再切换descriptor set。
+	// 数组是部分绑定、绑定后可更新的，新增资源只写入空闲槽位，不影响正在执行的命令
+	//
+	// GLSL中对应的声明(需要GL_EXT_nonuniform_qualifier)：
+	//   layout(set = 0, binding = 0) uniform sampler2D Textures[];
+	//   layout(set = 0, binding = 1) readonly buffer Buffers { uint Data[]; } StorageBuffers[];
+	// 18_shader_vertexbuffer_bindless.frag按材质push constant中的槽位采样Textures[]
+	class BindlessTable
+	{
+	public:
+		enum Binding : uint32_t
+		{
+			TextureBinding = 0,
+			StorageBufferBinding = 1
+		};
+		static constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+		BindlessTable() = default;
+		~BindlessTable();
+
+		BindlessTable(const BindlessTable&) = delete;
+		BindlessTable& operator=(const BindlessTable&) = delete;
+
+		void create(VkDevice vDevice, const DeviceFeatures& vFeatures, DescriptorCache& vDescriptorCache, DeletionQueue& vDeletionQueue,
+			uint32_t vMaxTextures = 4096, uint32_t vMaxStorageBuffers = 1024);
+		void destroy();
+
+		uint32_t addTexture(VkImageView vImageView, VkSampler vSampler, VkImageLayout vLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL);
+		uint32_t addStorageBuffer(VkBuffer vBuffer, VkDeviceSize vOffset = 0, VkDeviceSize vRange = VK_WHOLE_SIZE);
+		void removeTexture(uint32_t vIndex, uint64_t vRetireFrame);        // 第vRetireFrame帧执行完毕后槽位才能复用
+		void removeStorageBuffer(uint32_t vIndex, uint64_t vRetireFrame);
+
+		void bind(VkCommandBuffer vCommandBuffer, VkPipelineBindPoint vBindPoint, VkPipelineLayout vLayout, uint32_t vSetIndex) const;
+
+		inline bool isEnabled() const { return m_DescriptorSet != VK_NULL_HANDLE; }
+		inline VkDescriptorSetLayout getSetLayout() const { return m_SetLayout; }
+		inline uint32_t getTextureCount() const { return m_Textures.m_Count - static_cast<uint32_t>(m_Textures.m_FreeIndices.size()); }
+		inline uint32_t getStorageBufferCount() const { return m_StorageBuffers.m_Count - static_cast<uint32_t>(m_StorageBuffers.m_FreeIndices.size()); }
+	private:
+		// 槽位分配：优先复用已退休的槽位，否则追加
+		struct Slots
+		{
+			uint32_t m_Capacity = 0;
+			uint32_t m_Count = 0;
+			std::vector<uint32_t> m_FreeIndices;
+		};
+
+		uint32_t allocateSlot(Slots& vSlots, const char* vName);
+		void write(uint32_t vBinding, uint32_t vIndex, VkDescriptorType vType, const VkDescriptorImageInfo* vImageInfo, const VkDescriptorBufferInfo* vBufferInfo);
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		DeletionQueue* m_DeletionQueue = nullptr;
+		VkDescriptorSetLayout m_SetLayout = VK_NULL_HANDLE;  // 归DescriptorCache所有
+		VkDescriptorPool m_DescriptorPool = VK_NULL_HANDLE;
+		VkDescriptorSet m_DescriptorSet = VK_NULL_HANDLE;
+		Slots m_Textures;
+		Slots m_StorageBuffers;
+	};
+
+}
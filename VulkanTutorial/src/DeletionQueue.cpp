@@ -0,0 +1,26 @@
+#include "DeletionQueue.h"
+
+namespace VulkanTutorial {
+
+	void DeletionQueue::push(uint64_t vRetireFrame, std::function<void()> vDestroyer)
+	{
+		m_Entries.emplace_back(Entry{ vRetireFrame, std::move(vDestroyer) });
+	}
+
+	void DeletionQueue::flush(uint64_t vCompletedFrame)
+	{
+		// RetireFrame单调递增，只需从队首开始检查
+		while (!m_Entries.empty() && m_Entries.front().m_RetireFrame <= vCompletedFrame) {
+			m_Entries.front().m_Destroyer();
+			m_Entries.pop_front();
+		}
+	}
+
+	void DeletionQueue::flushAll()
+	{
+		for (auto& Entry : m_Entries)
+			Entry.m_Destroyer();
+		m_Entries.clear();
+	}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include <cstdint>
+#include <deque>
+#include <functional>
+
+namespace VulkanTutorial {
+
+	// 延迟销毁队列：对象在第N帧之后不再被录制，等到第N帧的命令执行完毕(fence已等待)后再真正销毁，避免vkDeviceWaitIdle
+	class DeletionQueue
+	{
+	public:
+		void push(uint64_t vRetireFrame, std::function<void()> vDestroyer);
+		void flush(uint64_t vCompletedFrame);  // 销毁所有RetireFrame <= vCompletedFrame的对象
+		void flushAll();
+		inline bool empty() const { return m_Entries.empty(); }
+	private:
+		struct Entry
+		{
+			uint64_t m_RetireFrame = 0;
+			std::function<void()> m_Destroyer;
+		};
+		std::deque<Entry> m_Entries;
+	};
+
+}
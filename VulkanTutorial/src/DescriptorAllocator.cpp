@@ -0,0 +1,144 @@
+#include "DescriptorAllocator.h"
+
+#include <algorithm>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t MaxSetsPerPool = 4096;
+
+	}
+
+	DescriptorAllocator::~DescriptorAllocator()
+	{
+		destroy();
+	}
+
+	DescriptorAllocator::PoolRatios DescriptorAllocator::getDefaultRatios()
+	{
+		return {
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f },
+			{ VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f },
+			{ VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f },
+			{ VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 1.0f },
+			{ VK_DESCRIPTOR_TYPE_SAMPLER, 1.0f },
+			{ VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f }
+		};
+	}
+
+	void DescriptorAllocator::create(VkDevice vDevice, uint32_t vFrameCount, const PoolRatios& vRatios)
+	{
+		m_Device = vDevice;
+		m_Ratios = vRatios;
+		m_FramePools.resize(vFrameCount);
+		m_CurrentFrame = 0;
+	}
+
+	void DescriptorAllocator::destroy()
+	{
+		if (m_Device == VK_NULL_HANDLE)
+			return;
+		auto DestroyChain = [this](PoolChain& vChain) {
+			if (vChain.m_Current != VK_NULL_HANDLE)
+				vkDestroyDescriptorPool(m_Device, vChain.m_Current, nullptr);
+			for (auto Pool : vChain.m_FullPools)
+				vkDestroyDescriptorPool(m_Device, Pool, nullptr);
+			vChain = {};
+		};
+		for (auto& Chain : m_FramePools)
+			DestroyChain(Chain);
+		DestroyChain(m_StaticPools);
+		for (auto Pool : m_FreePools)
+			vkDestroyDescriptorPool(m_Device, Pool, nullptr);
+		m_FramePools.clear();
+		m_FreePools.clear();
+		m_PoolCount = 0;
+		m_Device = VK_NULL_HANDLE;
+	}
+
+	void DescriptorAllocator::beginFrame(uint32_t vFrameIndex)
+	{
+		m_CurrentFrame = vFrameIndex;
+		PoolChain& Chain = m_FramePools[vFrameIndex];
+		// 上一次使用这些pool的帧已经完成，整个pool一起重置，当前pool继续使用，其余放回空闲列表
+		if (Chain.m_Current != VK_NULL_HANDLE)
+			vkResetDescriptorPool(m_Device, Chain.m_Current, 0);
+		for (auto Pool : Chain.m_FullPools) {
+			vkResetDescriptorPool(m_Device, Pool, 0);
+			m_FreePools.emplace_back(Pool);
+		}
+		Chain.m_FullPools.clear();
+	}
+
+	VkDescriptorSet DescriptorAllocator::allocateFrame(VkDescriptorSetLayout vLayout, const void* vNext)
+	{
+		return allocate(m_FramePools[m_CurrentFrame], vLayout, vNext);
+	}
+
+	VkDescriptorSet DescriptorAllocator::allocateStatic(VkDescriptorSetLayout vLayout, const void* vNext)
+	{
+		return allocate(m_StaticPools, vLayout, vNext);
+	}
+
+	VkDescriptorSet DescriptorAllocator::allocate(PoolChain& vChain, VkDescriptorSetLayout vLayout, const void* vNext)
+	{
+		if (vChain.m_Current == VK_NULL_HANDLE)
+			vChain.m_Current = acquirePool();
+
+		VkDescriptorSetAllocateInfo DescriptorSetAllocateInfo{};
+		DescriptorSetAllocateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO;
+		DescriptorSetAllocateInfo.pNext = vNext;
+		DescriptorSetAllocateInfo.descriptorPool = vChain.m_Current;
+		DescriptorSetAllocateInfo.descriptorSetCount = 1;
+		DescriptorSetAllocateInfo.pSetLayouts = &vLayout;
+
+		VkDescriptorSet DescriptorSet = VK_NULL_HANDLE;
+		VkResult Result = vkAllocateDescriptorSets(m_Device, &DescriptorSetAllocateInfo, &DescriptorSet);
+		if (Result == VK_ERROR_OUT_OF_POOL_MEMORY || Result == VK_ERROR_FRAGMENTED_POOL) {
+			// 当前pool已满，换一个新的pool重试一次
+			vChain.m_FullPools.emplace_back(vChain.m_Current);
+			vChain.m_Current = acquirePool();
+			DescriptorSetAllocateInfo.descriptorPool = vChain.m_Current;
+			Result = vkAllocateDescriptorSets(m_Device, &DescriptorSetAllocateInfo, &DescriptorSet);
+		}
+		if (Result != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate descriptor set!");
+		return DescriptorSet;
+	}
+
+	VkDescriptorPool DescriptorAllocator::acquirePool()
+	{
+		if (!m_FreePools.empty()) {
+			VkDescriptorPool Pool = m_FreePools.back();
+			m_FreePools.pop_back();
+			return Pool;
+		}
+		VkDescriptorPool Pool = createPool(m_SetsPerPool);
+		m_SetsPerPool = std::min(m_SetsPerPool * 2, MaxSetsPerPool);
+		return Pool;
+	}
+
+	VkDescriptorPool DescriptorAllocator::createPool(uint32_t vMaxSets)
+	{
+		std::vector<VkDescriptorPoolSize> PoolSizes;
+		for (const auto& [Type, Ratio] : m_Ratios)
+			PoolSizes.emplace_back(VkDescriptorPoolSize{ Type, std::max(1u, static_cast<uint32_t>(Ratio * vMaxSets)) });
+
+		VkDescriptorPoolCreateInfo DescriptorPoolCreateInfo{};
+		DescriptorPoolCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO;
+		DescriptorPoolCreateInfo.flags = 0; // 不需要FREE_DESCRIPTOR_SET_BIT，set只随pool整体重置
+		DescriptorPoolCreateInfo.maxSets = vMaxSets;
+		DescriptorPoolCreateInfo.poolSizeCount = static_cast<uint32_t>(PoolSizes.size());
+		DescriptorPoolCreateInfo.pPoolSizes = PoolSizes.data();
+
+		VkDescriptorPool Pool = VK_NULL_HANDLE;
+		if (vkCreateDescriptorPool(m_Device, &DescriptorPoolCreateInfo, nullptr, &Pool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create descriptor pool!");
+		++m_PoolCount;
+		return Pool;
+	}
+
+}
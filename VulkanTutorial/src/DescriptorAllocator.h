@@ -0,0 +1,55 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 可增长的descriptor set分配器：
+	// 1. 当前pool耗尽时换一个新pool(优先复用已重置的空pool)，分配为O(1)
+	// 2. 每帧的临时set在该帧fence等待后随pool一起vkResetDescriptorPool，从不单独释放
+	// 3. 长期存在的静态set放在单独的pool链中，直到destroy()才释放
+	class DescriptorAllocator
+	{
+	public:
+		using PoolRatios = std::vector<std::pair<VkDescriptorType, float>>;  // 平均每个set含有的各类descriptor数
+
+		DescriptorAllocator() = default;
+		~DescriptorAllocator();
+
+		DescriptorAllocator(const DescriptorAllocator&) = delete;
+		DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+
+		void create(VkDevice vDevice, uint32_t vFrameCount, const PoolRatios& vRatios = getDefaultRatios());
+		void destroy();
+
+		void beginFrame(uint32_t vFrameIndex);  // 必须在该帧的fence等待之后调用
+		VkDescriptorSet allocateFrame(VkDescriptorSetLayout vLayout, const void* vNext = nullptr);   // 只在当前帧有效
+		VkDescriptorSet allocateStatic(VkDescriptorSetLayout vLayout, const void* vNext = nullptr);  // 直到destroy()一直有效
+
+		inline uint32_t getPoolCount() const { return m_PoolCount; }
+		static PoolRatios getDefaultRatios();
+	private:
+		struct PoolChain
+		{
+			VkDescriptorPool m_Current = VK_NULL_HANDLE;
+			std::vector<VkDescriptorPool> m_FullPools;
+		};
+
+		VkDescriptorSet allocate(PoolChain& vChain, VkDescriptorSetLayout vLayout, const void* vNext);
+		VkDescriptorPool acquirePool();
+		VkDescriptorPool createPool(uint32_t vMaxSets);
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		PoolRatios m_Ratios;
+		std::vector<PoolChain> m_FramePools;
+		PoolChain m_StaticPools;
+		std::vector<VkDescriptorPool> m_FreePools;  // 已重置的空pool
+		uint32_t m_CurrentFrame = 0;
+		uint32_t m_SetsPerPool = 64;                 // 每新建一个pool就增大，减少pool的数量
+		uint32_t m_PoolCount = 0;
+	};
+
+}
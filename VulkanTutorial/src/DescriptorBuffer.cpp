@@ -0,0 +1,221 @@
+#include "DescriptorBuffer.h"
+#include "DeviceFunction.h"
+
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		inline VkDeviceSize alignUp(VkDeviceSize vValue, VkDeviceSize vAlignment)
+		{
+			return (vValue + vAlignment - 1) / vAlignment * vAlignment;
+		}
+
+		uint32_t findMemoryType(VkPhysicalDevice vPhysicalDevice, uint32_t vTypeFilter, VkMemoryPropertyFlags vProperties)
+		{
+			VkPhysicalDeviceMemoryProperties MemoryProperties{};
+			vkGetPhysicalDeviceMemoryProperties(vPhysicalDevice, &MemoryProperties);
+			for (uint32_t i = 0; i < MemoryProperties.memoryTypeCount; ++i) {
+				if ((vTypeFilter & (1 << i)) && (MemoryProperties.memoryTypes[i].propertyFlags & vProperties) == vProperties)
+					return i;
+			}
+			throw std::runtime_error("Failed to find suitable memory type!");
+		}
+
+	}
+
+	DescriptorBuffer::~DescriptorBuffer()
+	{
+		destroy();
+	}
+
+	void DescriptorBuffer::create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, const DeviceFeatures& vFeatures, uint32_t vFrameCount,
+		VkDeviceSize vBytesPerFrame)
+	{
+		m_Device = vDevice;
+		m_IsSupported = vFeatures.isDescriptorBufferSupported();
+		if (!m_IsSupported)
+			return;
+		m_Properties = vFeatures.getDescriptorBufferProperties();
+		m_GetDescriptorSetLayoutSize = loadDeviceFunction<PFN_vkGetDescriptorSetLayoutSizeEXT>(m_Device, "vkGetDescriptorSetLayoutSizeEXT");
+		m_GetDescriptorSetLayoutBindingOffset = loadDeviceFunction<PFN_vkGetDescriptorSetLayoutBindingOffsetEXT>(m_Device, "vkGetDescriptorSetLayoutBindingOffsetEXT");
+		m_GetDescriptor = loadDeviceFunction<PFN_vkGetDescriptorEXT>(m_Device, "vkGetDescriptorEXT");
+		m_CmdBindDescriptorBuffers = loadDeviceFunction<PFN_vkCmdBindDescriptorBuffersEXT>(m_Device, "vkCmdBindDescriptorBuffersEXT");
+		m_CmdSetDescriptorBufferOffsets = loadDeviceFunction<PFN_vkCmdSetDescriptorBufferOffsetsEXT>(m_Device, "vkCmdSetDescriptorBufferOffsetsEXT");
+
+		// 同一块buffer同时存放sampler与资源descriptor，每帧区域按偏移对齐要求对齐
+		m_BytesPerFrame = alignUp(vBytesPerFrame, m_Properties.descriptorBufferOffsetAlignment);
+		VkDeviceSize Size = std::min({ m_BytesPerFrame * vFrameCount, m_Properties.samplerDescriptorBufferAddressSpaceSize,
+			m_Properties.resourceDescriptorBufferAddressSpaceSize, m_Properties.descriptorBufferAddressSpaceSize });
+		m_BytesPerFrame = Size / vFrameCount / m_Properties.descriptorBufferOffsetAlignment * m_Properties.descriptorBufferOffsetAlignment;
+
+		VkBufferCreateInfo BufferCreateInfo{};
+		BufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		BufferCreateInfo.size = Size;
+		BufferCreateInfo.usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT
+			| VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT;
+		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(m_Device, &BufferCreateInfo, nullptr, &m_Buffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create descriptor buffer!");
+
+		VkMemoryRequirements MemoryRequirements;
+		vkGetBufferMemoryRequirements(m_Device, m_Buffer, &MemoryRequirements);
+		VkMemoryAllocateFlagsInfo MemoryAllocateFlagsInfo{};
+		MemoryAllocateFlagsInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_FLAGS_INFO;
+		MemoryAllocateFlagsInfo.flags = VK_MEMORY_ALLOCATE_DEVICE_ADDRESS_BIT;
+		VkMemoryAllocateInfo MemoryAllocateInfo{};
+		MemoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		MemoryAllocateInfo.pNext = &MemoryAllocateFlagsInfo;
+		MemoryAllocateInfo.allocationSize = MemoryRequirements.size;
+		MemoryAllocateInfo.memoryTypeIndex = findMemoryType(vPhysicalDevice, MemoryRequirements.memoryTypeBits,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		if (vkAllocateMemory(m_Device, &MemoryAllocateInfo, nullptr, &m_BufferMemory) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate descriptor buffer memory!");
+		vkBindBufferMemory(m_Device, m_Buffer, m_BufferMemory, 0);
+
+		void* Data = nullptr;
+		vkMapMemory(m_Device, m_BufferMemory, 0, Size, 0, &Data);
+		m_MappedData = static_cast<uint8_t*>(Data);
+		m_BufferAddress = getBufferAddress(m_Buffer);
+		m_FrameBegin = m_FrameOffset = 0;
+		std::cout << std::format("Success to create a descriptor buffer ({0} KB per frame) !", m_BytesPerFrame >> 10) << "\n";
+	}
+
+	void DescriptorBuffer::destroy()
+	{
+		if (m_Device == VK_NULL_HANDLE)
+			return;
+		if (m_Buffer != VK_NULL_HANDLE) {
+			vkUnmapMemory(m_Device, m_BufferMemory);
+			vkDestroyBuffer(m_Device, m_Buffer, nullptr);
+			vkFreeMemory(m_Device, m_BufferMemory, nullptr);
+		}
+		m_Buffer = VK_NULL_HANDLE;
+		m_BufferMemory = VK_NULL_HANDLE;
+		m_MappedData = nullptr;
+		m_LayoutSizes.clear();
+		m_Device = VK_NULL_HANDLE;
+	}
+
+	void DescriptorBuffer::beginFrame(uint32_t vFrameIndex)
+	{
+		if (!m_IsSupported)
+			return;
+		m_FrameBegin = m_BytesPerFrame * vFrameIndex;
+		m_FrameOffset = m_FrameBegin;
+	}
+
+	bool DescriptorBuffer::canAllocate(VkDescriptorSetLayout vLayout)
+	{
+		return alignUp(m_FrameOffset, m_Properties.descriptorBufferOffsetAlignment) + getLayoutSize(vLayout) <= m_FrameBegin + m_BytesPerFrame;
+	}
+
+	VkDeviceSize DescriptorBuffer::allocate(VkDescriptorSetLayout vLayout)
+	{
+		VkDeviceSize Offset = alignUp(m_FrameOffset, m_Properties.descriptorBufferOffsetAlignment);
+		VkDeviceSize Size = getLayoutSize(vLayout);
+		if (Offset + Size > m_FrameBegin + m_BytesPerFrame)
+			throw std::runtime_error(std::format("Fail to allocate {0} bytes in the descriptor buffer, the frame region of {1} bytes is full.", Size, m_BytesPerFrame));
+		m_FrameOffset = Offset + Size;
+		return Offset;
+	}
+
+	void DescriptorBuffer::writeBuffer(VkDeviceSize vSetOffset, VkDescriptorSetLayout vLayout, uint32_t vBinding, VkDescriptorType vType,
+		VkDeviceAddress vAddress, VkDeviceSize vRange, uint32_t vArrayElement)
+	{
+		VkDescriptorAddressInfoEXT AddressInfo{};
+		AddressInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_ADDRESS_INFO_EXT;
+		AddressInfo.address = vAddress;
+		AddressInfo.range = vRange;
+		AddressInfo.format = VK_FORMAT_UNDEFINED;
+
+		VkDescriptorGetInfoEXT GetInfo{};
+		GetInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+		GetInfo.type = vType;
+		if (vType == VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER)
+			GetInfo.data.pUniformBuffer = &AddressInfo;
+		else if (vType == VK_DESCRIPTOR_TYPE_STORAGE_BUFFER)
+			GetInfo.data.pStorageBuffer = &AddressInfo;
+		else
+			throw std::runtime_error("Unsupported descriptor type for a descriptor buffer write!");
+		write(vSetOffset, vLayout, vBinding, vArrayElement, GetInfo);
+	}
+
+	void DescriptorBuffer::writeImage(VkDeviceSize vSetOffset, VkDescriptorSetLayout vLayout, uint32_t vBinding, VkDescriptorType vType,
+		const VkDescriptorImageInfo& vImageInfo, uint32_t vArrayElement)
+	{
+		VkDescriptorGetInfoEXT GetInfo{};
+		GetInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_GET_INFO_EXT;
+		GetInfo.type = vType;
+		switch (vType) {
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: GetInfo.data.pCombinedImageSampler = &vImageInfo; break;
+		case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE: GetInfo.data.pSampledImage = &vImageInfo; break;
+		case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: GetInfo.data.pStorageImage = &vImageInfo; break;
+		case VK_DESCRIPTOR_TYPE_SAMPLER: GetInfo.data.pSampler = &vImageInfo.sampler; break;
+		default: throw std::runtime_error("Unsupported descriptor type for a descriptor buffer write!");
+		}
+		write(vSetOffset, vLayout, vBinding, vArrayElement, GetInfo);
+	}
+
+	void DescriptorBuffer::bind(VkCommandBuffer vCommandBuffer) const
+	{
+		VkDescriptorBufferBindingInfoEXT BindingInfo{};
+		BindingInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_BUFFER_BINDING_INFO_EXT;
+		BindingInfo.address = m_BufferAddress;
+		BindingInfo.usage = VK_BUFFER_USAGE_RESOURCE_DESCRIPTOR_BUFFER_BIT_EXT | VK_BUFFER_USAGE_SAMPLER_DESCRIPTOR_BUFFER_BIT_EXT;
+		m_CmdBindDescriptorBuffers(vCommandBuffer, 1, &BindingInfo);
+	}
+
+	void DescriptorBuffer::setOffset(VkCommandBuffer vCommandBuffer, VkPipelineBindPoint vBindPoint, VkPipelineLayout vLayout, uint32_t vSetIndex, VkDeviceSize vSetOffset) const
+	{
+		const uint32_t BufferIndex = 0;  // 只绑定了一块descriptor buffer
+		m_CmdSetDescriptorBufferOffsets(vCommandBuffer, vBindPoint, vLayout, vSetIndex, 1, &BufferIndex, &vSetOffset);
+	}
+
+	VkDeviceAddress DescriptorBuffer::getBufferAddress(VkBuffer vBuffer) const
+	{
+		VkBufferDeviceAddressInfo AddressInfo{};
+		AddressInfo.sType = VK_STRUCTURE_TYPE_BUFFER_DEVICE_ADDRESS_INFO;
+		AddressInfo.buffer = vBuffer;
+		return vkGetBufferDeviceAddress(m_Device, &AddressInfo);
+	}
+
+	VkDeviceSize DescriptorBuffer::getLayoutSize(VkDescriptorSetLayout vLayout)
+	{
+		for (const auto& Info : m_LayoutSizes) {
+			if (Info.m_Layout == vLayout)
+				return Info.m_Size;
+		}
+		VkDeviceSize Size = 0;
+		m_GetDescriptorSetLayoutSize(m_Device, vLayout, &Size);
+		m_LayoutSizes.emplace_back(LayoutInfo{ vLayout, Size });
+		return Size;
+	}
+
+	size_t DescriptorBuffer::getDescriptorSize(VkDescriptorType vType) const
+	{
+		switch (vType) {
+		case VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER: return m_Properties.uniformBufferDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_STORAGE_BUFFER: return m_Properties.storageBufferDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER: return m_Properties.combinedImageSamplerDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE: return m_Properties.sampledImageDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_STORAGE_IMAGE: return m_Properties.storageImageDescriptorSize;
+		case VK_DESCRIPTOR_TYPE_SAMPLER: return m_Properties.samplerDescriptorSize;
+		default: throw std::runtime_error("Unsupported descriptor type for a descriptor buffer write!");
+		}
+	}
+
+	void DescriptorBuffer::write(VkDeviceSize vSetOffset, VkDescriptorSetLayout vLayout, uint32_t vBinding, uint32_t vArrayElement, const VkDescriptorGetInfoEXT& vGetInfo)
+	{
+		// 数组元素在binding内紧密排列
+		VkDeviceSize BindingOffset = 0;
+		m_GetDescriptorSetLayoutBindingOffset(m_Device, vLayout, vBinding, &BindingOffset);
+		size_t DescriptorSize = getDescriptorSize(vGetInfo.type);
+		m_GetDescriptor(m_Device, &vGetInfo, DescriptorSize, m_MappedData + vSetOffset + BindingOffset + DescriptorSize * vArrayElement);
+	}
+
+}
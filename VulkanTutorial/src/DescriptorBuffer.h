@@ -0,0 +1,75 @@
+#pragma once
+#include "DeviceFeatures.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// VK_EXT_descriptor_buffer后端：descriptor由vkGetDescriptorEXT直接写入一块host可见的buffer，绘制时按偏移绑定，
+	// 没有descriptor pool和set。buffer按帧切成环形区域，每帧在自己的区域内线性分配，帧开始时整体回绕。
+	// 使用要求：
+	// 1. set layout带VK_DESCRIPTOR_SET_LAYOUT_CREATE_DESCRIPTOR_BUFFER_BIT_EXT
+	// 2. pipeline带VK_PIPELINE_CREATE_DESCRIPTOR_BUFFER_BIT_EXT
+	// 3. 被引用的buffer以设备地址给出，须带VK_BUFFER_USAGE_SHADER_DEVICE_ADDRESS_BIT
+	class DescriptorBuffer
+	{
+	public:
+		DescriptorBuffer() = default;
+		~DescriptorBuffer();
+
+		DescriptorBuffer(const DescriptorBuffer&) = delete;
+		DescriptorBuffer& operator=(const DescriptorBuffer&) = delete;
+
+		void create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, const DeviceFeatures& vFeatures, uint32_t vFrameCount,
+			VkDeviceSize vBytesPerFrame = 1 << 20);
+		void destroy();
+
+		void beginFrame(uint32_t vFrameIndex);  // 必须在该帧的fence等待之后调用
+		bool canAllocate(VkDescriptorSetLayout vLayout);
+		VkDeviceSize allocate(VkDescriptorSetLayout vLayout);  // 返回该set在buffer中的偏移，只在当前帧有效
+		void writeBuffer(VkDeviceSize vSetOffset, VkDescriptorSetLayout vLayout, uint32_t vBinding, VkDescriptorType vType,
+			VkDeviceAddress vAddress, VkDeviceSize vRange, uint32_t vArrayElement = 0);
+		void writeImage(VkDeviceSize vSetOffset, VkDescriptorSetLayout vLayout, uint32_t vBinding, VkDescriptorType vType,
+			const VkDescriptorImageInfo& vImageInfo, uint32_t vArrayElement = 0);
+
+		void bind(VkCommandBuffer vCommandBuffer) const;  // 每个命令缓冲绑定一次，之后只切换偏移
+		void setOffset(VkCommandBuffer vCommandBuffer, VkPipelineBindPoint vBindPoint, VkPipelineLayout vLayout, uint32_t vSetIndex, VkDeviceSize vSetOffset) const;
+		VkDeviceAddress getBufferAddress(VkBuffer vBuffer) const;
+
+		inline bool isSupported() const { return m_IsSupported; }
+		inline VkDeviceSize getUsedBytes() const { return m_FrameOffset - m_FrameBegin; }
+	private:
+		struct LayoutInfo
+		{
+			VkDescriptorSetLayout m_Layout = VK_NULL_HANDLE;
+			VkDeviceSize m_Size = 0;
+		};
+
+		VkDeviceSize getLayoutSize(VkDescriptorSetLayout vLayout);
+		size_t getDescriptorSize(VkDescriptorType vType) const;
+		void write(VkDeviceSize vSetOffset, VkDescriptorSetLayout vLayout, uint32_t vBinding, uint32_t vArrayElement, const VkDescriptorGetInfoEXT& vGetInfo);
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		bool m_IsSupported = false;
+		VkPhysicalDeviceDescriptorBufferPropertiesEXT m_Properties{};
+
+		VkBuffer m_Buffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_BufferMemory = VK_NULL_HANDLE;
+		uint8_t* m_MappedData = nullptr;   // 常驻映射，coherent内存无需flush
+		VkDeviceAddress m_BufferAddress = 0;
+		VkDeviceSize m_BytesPerFrame = 0;
+		VkDeviceSize m_FrameBegin = 0;
+		VkDeviceSize m_FrameOffset = 0;
+		std::vector<LayoutInfo> m_LayoutSizes;  // layout数量很少，线性查找即可
+
+		PFN_vkGetDescriptorSetLayoutSizeEXT m_GetDescriptorSetLayoutSize = nullptr;
+		PFN_vkGetDescriptorSetLayoutBindingOffsetEXT m_GetDescriptorSetLayoutBindingOffset = nullptr;
+		PFN_vkGetDescriptorEXT m_GetDescriptor = nullptr;
+		PFN_vkCmdBindDescriptorBuffersEXT m_CmdBindDescriptorBuffers = nullptr;
+		PFN_vkCmdSetDescriptorBufferOffsetsEXT m_CmdSetDescriptorBufferOffsets = nullptr;
+	};
+
+}
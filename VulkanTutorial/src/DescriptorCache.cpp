@@ -0,0 +1,252 @@
+#include "DescriptorCache.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		// 键按字段逐个追加，只用于没有填充字节的类型(句柄与整数)
+		template<typename T>
+		void appendValue(std::vector<std::byte>& vKey, const T& vValue)
+		{
+			const std::byte* Bytes = reinterpret_cast<const std::byte*>(&vValue);
+			vKey.insert(vKey.end(), Bytes, Bytes + sizeof(T));
+		}
+
+		enum class SetKeyKind : uint8_t
+		{
+			Writes,
+			Template
+		};
+
+		inline uint64_t hashKey(const std::vector<std::byte>& vKey)
+		{
+			return hashBytes(vKey.data(), vKey.size());
+		}
+
+	}
+
+	DescriptorCache::~DescriptorCache()
+	{
+		destroy();
+	}
+
+	void DescriptorCache::create(VkDevice vDevice, DescriptorAllocator& vAllocator)
+	{
+		m_Device = vDevice;
+		m_Allocator = &vAllocator;
+		m_Statistics = {};
+	}
+
+	void DescriptorCache::destroy()
+	{
+		if (m_Device == VK_NULL_HANDLE)
+			return;
+		for (const auto& [Hash, Entry] : m_Layouts)
+			vkDestroyDescriptorSetLayout(m_Device, Entry.m_Layout, nullptr);
+		m_Layouts.clear();
+		m_Sets.clear();
+		m_FreeSets.clear();
+		m_Device = VK_NULL_HANDLE;
+	}
+
+	uint64_t DescriptorCache::hashLayout(std::span<const VkDescriptorSetLayoutBinding> vBindings, VkDescriptorSetLayoutCreateFlags vFlags,
+		std::span<const VkDescriptorBindingFlags> vBindingFlags)
+	{
+		return hashKey(buildLayoutKey(vBindings, vFlags, vBindingFlags));
+	}
+
+	uint64_t DescriptorCache::hashSet(VkDescriptorSetLayout vLayout, std::span<const DescriptorWrite> vWrites)
+	{
+		return hashKey(buildSetKey(vLayout, vWrites));
+	}
+
+	DescriptorCache::CacheKey DescriptorCache::buildLayoutKey(std::span<const VkDescriptorSetLayoutBinding> vBindings, VkDescriptorSetLayoutCreateFlags vFlags,
+		std::span<const VkDescriptorBindingFlags> vBindingFlags)
+	{
+		// binding的声明顺序不影响layout，按binding编号排序后再生成键
+		std::vector<uint32_t> Order(vBindings.size());
+		for (uint32_t i = 0; i < Order.size(); ++i)
+			Order[i] = i;
+		std::sort(Order.begin(), Order.end(), [&vBindings](uint32_t vLhs, uint32_t vRhs) { return vBindings[vLhs].binding < vBindings[vRhs].binding; });
+
+		CacheKey Key;
+		appendValue(Key, vFlags);
+		for (uint32_t i : Order) {
+			const auto& Binding = vBindings[i];
+			appendValue(Key, Binding.binding);
+			appendValue(Key, Binding.descriptorType);
+			appendValue(Key, Binding.descriptorCount);
+			appendValue(Key, Binding.stageFlags);
+			appendValue(Key, static_cast<uint8_t>(Binding.pImmutableSamplers != nullptr));
+			if (Binding.pImmutableSamplers != nullptr) {
+				for (uint32_t k = 0; k < Binding.descriptorCount; ++k)
+					appendValue(Key, Binding.pImmutableSamplers[k]);
+			}
+			appendValue(Key, vBindingFlags.empty() ? VkDescriptorBindingFlags(0) : vBindingFlags[i]);
+		}
+		return Key;
+	}
+
+	DescriptorCache::CacheKey DescriptorCache::buildSetKey(VkDescriptorSetLayout vLayout, std::span<const DescriptorWrite> vWrites)
+	{
+		CacheKey Key;
+		appendValue(Key, SetKeyKind::Writes);
+		appendValue(Key, vLayout);
+		for (const auto& Write : vWrites) {
+			appendValue(Key, Write.m_Binding);
+			appendValue(Key, Write.m_Type);
+			appendValue(Key, static_cast<uint32_t>(Write.m_Buffers.size()));
+			for (const auto& Buffer : Write.m_Buffers) {
+				appendValue(Key, Buffer.buffer);
+				appendValue(Key, Buffer.offset);
+				appendValue(Key, Buffer.range);
+			}
+			appendValue(Key, static_cast<uint32_t>(Write.m_Images.size()));
+			for (const auto& Image : Write.m_Images) {
+				appendValue(Key, Image.sampler);
+				appendValue(Key, Image.imageView);
+				appendValue(Key, Image.imageLayout);
+			}
+		}
+		return Key;
+	}
+
+	DescriptorCache::CacheKey DescriptorCache::buildTemplateSetKey(VkDescriptorSetLayout vLayout, const void* vData, size_t vSize)
+	{
+		CacheKey Key;
+		appendValue(Key, SetKeyKind::Template);
+		appendValue(Key, vLayout);
+		const std::byte* Data = static_cast<const std::byte*>(vData);
+		Key.insert(Key.end(), Data, Data + vSize);
+		return Key;
+	}
+
+	VkDescriptorSetLayout DescriptorCache::getLayout(std::span<const VkDescriptorSetLayoutBinding> vBindings, VkDescriptorSetLayoutCreateFlags vFlags,
+		std::span<const VkDescriptorBindingFlags> vBindingFlags)
+	{
+		if (!vBindingFlags.empty() && vBindingFlags.size() != vBindings.size())
+			throw std::runtime_error("Descriptor binding flags do not match the bindings!");
+
+		++m_Statistics.m_LayoutRequests;
+		CacheKey Key = buildLayoutKey(vBindings, vFlags, vBindingFlags);
+		uint64_t Hash = hashKey(Key);
+		auto [Begin, End] = m_Layouts.equal_range(Hash);
+		for (auto It = Begin; It != End; ++It) {
+			if (It->second.m_Key == Key) {
+				++m_Statistics.m_LayoutHits;
+				return It->second.m_Layout;
+			}
+		}
+
+		VkDescriptorSetLayoutBindingFlagsCreateInfo BindingFlagsCreateInfo{};
+		BindingFlagsCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_BINDING_FLAGS_CREATE_INFO;
+		BindingFlagsCreateInfo.bindingCount = static_cast<uint32_t>(vBindingFlags.size());
+		BindingFlagsCreateInfo.pBindingFlags = vBindingFlags.data();
+
+		VkDescriptorSetLayoutCreateInfo SetLayoutCreateInfo{};
+		SetLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_LAYOUT_CREATE_INFO;
+		SetLayoutCreateInfo.pNext = vBindingFlags.empty() ? nullptr : &BindingFlagsCreateInfo;
+		SetLayoutCreateInfo.flags = vFlags;
+		SetLayoutCreateInfo.bindingCount = static_cast<uint32_t>(vBindings.size());
+		SetLayoutCreateInfo.pBindings = vBindings.data();
+
+		VkDescriptorSetLayout Layout = VK_NULL_HANDLE;
+		if (vkCreateDescriptorSetLayout(m_Device, &SetLayoutCreateInfo, nullptr, &Layout) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create descriptor set layout!");
+		m_Layouts.emplace(Hash, CachedLayout{ std::move(Key), Layout });
+		return Layout;
+	}
+
+	VkDescriptorSet DescriptorCache::getSet(VkDescriptorSetLayout vLayout, std::span<const DescriptorWrite> vWrites)
+	{
+		++m_Statistics.m_SetRequests;
+		CacheKey Key = buildSetKey(vLayout, vWrites);
+		uint64_t Hash = hashKey(Key);
+		if (const CachedSet* Entry = findSet(Hash, Key)) {
+			++m_Statistics.m_SetHits;
+			return Entry->m_Set;
+		}
+
+		VkDescriptorSet DescriptorSet = acquireSet(vLayout);
+		std::vector<VkWriteDescriptorSet> WriteDescriptorSets;
+		WriteDescriptorSets.reserve(vWrites.size());
+		for (const auto& Write : vWrites) {
+			VkWriteDescriptorSet WriteDescriptorSet{};
+			WriteDescriptorSet.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+			WriteDescriptorSet.dstSet = DescriptorSet;
+			WriteDescriptorSet.dstBinding = Write.m_Binding;
+			WriteDescriptorSet.dstArrayElement = 0;
+			WriteDescriptorSet.descriptorType = Write.m_Type;
+			if (Write.m_Images.empty()) {
+				WriteDescriptorSet.descriptorCount = static_cast<uint32_t>(Write.m_Buffers.size());
+				WriteDescriptorSet.pBufferInfo = Write.m_Buffers.data();
+			}
+			else {
+				WriteDescriptorSet.descriptorCount = static_cast<uint32_t>(Write.m_Images.size());
+				WriteDescriptorSet.pImageInfo = Write.m_Images.data();
+			}
+			WriteDescriptorSets.emplace_back(WriteDescriptorSet);
+		}
+		vkUpdateDescriptorSets(m_Device, static_cast<uint32_t>(WriteDescriptorSets.size()), WriteDescriptorSets.data(), 0, nullptr);
+		m_Sets.emplace(Hash, CachedSet{ std::move(Key), vLayout, DescriptorSet });
+		return DescriptorSet;
+	}
+
+	VkDescriptorSet DescriptorCache::getSet(VkDescriptorSetLayout vLayout, const DescriptorUpdateTemplate& vTemplate, const void* vData, size_t vSize)
+	{
+		++m_Statistics.m_SetRequests;
+		CacheKey Key = buildTemplateSetKey(vLayout, vData, vSize);
+		uint64_t Hash = hashKey(Key);
+		if (const CachedSet* Entry = findSet(Hash, Key)) {
+			++m_Statistics.m_SetHits;
+			return Entry->m_Set;
+		}
+
+		VkDescriptorSet DescriptorSet = acquireSet(vLayout);
+		vTemplate.update(DescriptorSet, vData);
+		m_Sets.emplace(Hash, CachedSet{ std::move(Key), vLayout, DescriptorSet });
+		return DescriptorSet;
+	}
+
+	const DescriptorCache::CachedSet* DescriptorCache::findSet(uint64_t vHash, const CacheKey& vKey) const
+	{
+		auto [Begin, End] = m_Sets.equal_range(vHash);
+		for (auto It = Begin; It != End; ++It) {
+			if (It->second.m_Key == vKey)
+				return &It->second;
+		}
+		return nullptr;
+	}
+
+	VkDescriptorSet DescriptorCache::acquireSet(VkDescriptorSetLayout vLayout)
+	{
+		// 静态pool中的set不能单独释放，回收的set按layout复用，clearSets()前后分配的set总数不会增长
+		if (auto It = m_FreeSets.find(vLayout); It != m_FreeSets.end() && !It->second.empty()) {
+			VkDescriptorSet DescriptorSet = It->second.back();
+			It->second.pop_back();
+			return DescriptorSet;
+		}
+		return m_Allocator->allocateStatic(vLayout);
+	}
+
+	void DescriptorCache::clearSets()
+	{
+		for (const auto& [Hash, Entry] : m_Sets)
+			m_FreeSets[Entry.m_Layout].emplace_back(Entry.m_Set);
+		m_Sets.clear();
+	}
+
+	void DescriptorCache::report() const
+	{
+		std::cout << std::format("Descriptor cache: {0} layouts, layout hit rate {1:.1f}% ({2}/{3}); {4} sets, set hit rate {5:.1f}% ({6}/{7})\n",
+			m_Layouts.size(), m_Statistics.getLayoutHitRate() * 100.0f, m_Statistics.m_LayoutHits, m_Statistics.m_LayoutRequests,
+			m_Sets.size(), m_Statistics.getSetHitRate() * 100.0f, m_Statistics.m_SetHits, m_Statistics.m_SetRequests);
+	}
+
+}
@@ -0,0 +1,97 @@
+#pragma once
+#include "DescriptorAllocator.h"
+#include "DescriptorUpdateTemplate.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 写入一个binding的全部资源，pBufferInfo与pImageInfo二选一
+	struct DescriptorWrite
+	{
+		uint32_t m_Binding = 0;
+		VkDescriptorType m_Type = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
+		std::vector<VkDescriptorBufferInfo> m_Buffers;
+		std::vector<VkDescriptorImageInfo> m_Images;
+	};
+
+	// descriptor set layout与descriptor set缓存：
+	// 1. layout按binding内容哈希去重，相同的binding组合只创建一次
+	// 2. set按(layout, 写入的全部资源)哈希复用，已写好的set直接返回，不再重复vkUpdateDescriptorSets
+	// 缓存的set从分配器的静态pool中分配，键中包含资源句柄，资源销毁前须调用clearSets()
+	// 查找表以哈希为索引，同时保存完整的键，命中时逐字节比较，哈希冲突不会返回错误的layout或set
+	class DescriptorCache
+	{
+	public:
+		struct Statistics
+		{
+			uint64_t m_LayoutRequests = 0;
+			uint64_t m_LayoutHits = 0;
+			uint64_t m_SetRequests = 0;
+			uint64_t m_SetHits = 0;
+
+			inline float getLayoutHitRate() const { return m_LayoutRequests == 0 ? 0.0f : static_cast<float>(m_LayoutHits) / m_LayoutRequests; }
+			inline float getSetHitRate() const { return m_SetRequests == 0 ? 0.0f : static_cast<float>(m_SetHits) / m_SetRequests; }
+		};
+
+		DescriptorCache() = default;
+		~DescriptorCache();
+
+		DescriptorCache(const DescriptorCache&) = delete;
+		DescriptorCache& operator=(const DescriptorCache&) = delete;
+
+		void create(VkDevice vDevice, DescriptorAllocator& vAllocator);
+		void destroy();
+
+		// vBindingFlags为空或与vBindings一一对应(descriptor indexing的binding flags)
+		VkDescriptorSetLayout getLayout(std::span<const VkDescriptorSetLayoutBinding> vBindings, VkDescriptorSetLayoutCreateFlags vFlags = 0,
+			std::span<const VkDescriptorBindingFlags> vBindingFlags = {});
+		VkDescriptorSet getSet(VkDescriptorSetLayout vLayout, std::span<const DescriptorWrite> vWrites);
+		// 通过更新模板写入，vData的vSize字节即缓存键，结构体中的填充字节须初始化
+		VkDescriptorSet getSet(VkDescriptorSetLayout vLayout, const DescriptorUpdateTemplate& vTemplate, const void* vData, size_t vSize);
+		void clearSets();  // 清除查找表并回收全部set，之后同一layout的请求重写这些set而不是再分配；调用时GPU须已不再使用它们
+
+		inline const Statistics& getStatistics() const { return m_Statistics; }
+		void report() const;
+
+		static uint64_t hashLayout(std::span<const VkDescriptorSetLayoutBinding> vBindings, VkDescriptorSetLayoutCreateFlags vFlags,
+			std::span<const VkDescriptorBindingFlags> vBindingFlags);
+		static uint64_t hashSet(VkDescriptorSetLayout vLayout, std::span<const DescriptorWrite> vWrites);
+	private:
+		using CacheKey = std::vector<std::byte>;
+
+		struct CachedLayout
+		{
+			CacheKey m_Key;
+			VkDescriptorSetLayout m_Layout = VK_NULL_HANDLE;
+		};
+
+		struct CachedSet
+		{
+			CacheKey m_Key;
+			VkDescriptorSetLayout m_Layout = VK_NULL_HANDLE;
+			VkDescriptorSet m_Set = VK_NULL_HANDLE;
+		};
+
+		static CacheKey buildLayoutKey(std::span<const VkDescriptorSetLayoutBinding> vBindings, VkDescriptorSetLayoutCreateFlags vFlags,
+			std::span<const VkDescriptorBindingFlags> vBindingFlags);
+		static CacheKey buildSetKey(VkDescriptorSetLayout vLayout, std::span<const DescriptorWrite> vWrites);
+		static CacheKey buildTemplateSetKey(VkDescriptorSetLayout vLayout, const void* vData, size_t vSize);
+		const CachedSet* findSet(uint64_t vHash, const CacheKey& vKey) const;
+		VkDescriptorSet acquireSet(VkDescriptorSetLayout vLayout);  // 优先复用clearSets()回收的set
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		DescriptorAllocator* m_Allocator = nullptr;
+		std::unordered_multimap<uint64_t, CachedLayout> m_Layouts;
+		std::unordered_multimap<uint64_t, CachedSet> m_Sets;
+		std::unordered_map<VkDescriptorSetLayout, std::vector<VkDescriptorSet>> m_FreeSets;
+		Statistics m_Statistics;
+	};
+
+}
@@ -0,0 +1,84 @@
+#include "DescriptorUpdateTemplate.h"
+#include "DeviceFunction.h"
+
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	DescriptorUpdateTemplate::~DescriptorUpdateTemplate()
+	{
+		destroy();
+	}
+
+	VkDescriptorUpdateTemplateEntry DescriptorUpdateTemplate::makeEntry(uint32_t vBinding, VkDescriptorType vType, size_t vOffset, uint32_t vCount, size_t vStride)
+	{
+		VkDescriptorUpdateTemplateEntry Entry{};
+		Entry.dstBinding = vBinding;
+		Entry.dstArrayElement = 0;
+		Entry.descriptorCount = vCount;
+		Entry.descriptorType = vType;
+		Entry.offset = vOffset;
+		Entry.stride = vStride;
+		return Entry;
+	}
+
+	void DescriptorUpdateTemplate::create(VkDevice vDevice, VkDescriptorSetLayout vSetLayout, std::span<const VkDescriptorUpdateTemplateEntry> vEntries)
+	{
+		destroy();
+		m_Device = vDevice;
+
+		VkDescriptorUpdateTemplateCreateInfo TemplateCreateInfo{};
+		TemplateCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+		TemplateCreateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(vEntries.size());
+		TemplateCreateInfo.pDescriptorUpdateEntries = vEntries.data();
+		TemplateCreateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_DESCRIPTOR_SET;
+		TemplateCreateInfo.descriptorSetLayout = vSetLayout;
+		if (vkCreateDescriptorUpdateTemplate(m_Device, &TemplateCreateInfo, nullptr, &m_Template) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create descriptor update template!");
+	}
+
+	void DescriptorUpdateTemplate::createForPush(VkDevice vDevice, const DeviceFeatures& vFeatures, VkDescriptorSetLayout vSetLayout,
+		std::span<const VkDescriptorUpdateTemplateEntry> vEntries, VkPipelineLayout vPipelineLayout, uint32_t vSetIndex, VkPipelineBindPoint vBindPoint)
+	{
+		if (!vFeatures.isPushDescriptorSupported())
+			throw std::runtime_error("VK_KHR_push_descriptor is not supported!");
+		destroy();
+		m_Device = vDevice;
+		m_PipelineLayout = vPipelineLayout;
+		m_SetIndex = vSetIndex;
+
+		// push模板没有set，descriptorSetLayout被忽略，由pipeline layout中第vSetIndex个set决定布局
+		VkDescriptorUpdateTemplateCreateInfo TemplateCreateInfo{};
+		TemplateCreateInfo.sType = VK_STRUCTURE_TYPE_DESCRIPTOR_UPDATE_TEMPLATE_CREATE_INFO;
+		TemplateCreateInfo.descriptorUpdateEntryCount = static_cast<uint32_t>(vEntries.size());
+		TemplateCreateInfo.pDescriptorUpdateEntries = vEntries.data();
+		TemplateCreateInfo.templateType = VK_DESCRIPTOR_UPDATE_TEMPLATE_TYPE_PUSH_DESCRIPTORS_KHR;
+		TemplateCreateInfo.descriptorSetLayout = vSetLayout;
+		TemplateCreateInfo.pipelineBindPoint = vBindPoint;
+		TemplateCreateInfo.pipelineLayout = vPipelineLayout;
+		TemplateCreateInfo.set = vSetIndex;
+		if (vkCreateDescriptorUpdateTemplate(m_Device, &TemplateCreateInfo, nullptr, &m_Template) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create push descriptor update template!");
+		m_CmdPushDescriptorSetWithTemplate = loadDeviceFunction<PFN_vkCmdPushDescriptorSetWithTemplateKHR>(m_Device, "vkCmdPushDescriptorSetWithTemplateKHR");
+	}
+
+	void DescriptorUpdateTemplate::destroy()
+	{
+		if (m_Template != VK_NULL_HANDLE)
+			vkDestroyDescriptorUpdateTemplate(m_Device, m_Template, nullptr);
+		m_Template = VK_NULL_HANDLE;
+		m_PipelineLayout = VK_NULL_HANDLE;
+		m_CmdPushDescriptorSetWithTemplate = nullptr;
+	}
+
+	void DescriptorUpdateTemplate::update(VkDescriptorSet vDescriptorSet, const void* vData) const
+	{
+		vkUpdateDescriptorSetWithTemplate(m_Device, vDescriptorSet, m_Template, vData);
+	}
+
+	void DescriptorUpdateTemplate::push(VkCommandBuffer vCommandBuffer, const void* vData) const
+	{
+		m_CmdPushDescriptorSetWithTemplate(vCommandBuffer, m_Template, m_PipelineLayout, m_SetIndex, vData);
+	}
+
+}
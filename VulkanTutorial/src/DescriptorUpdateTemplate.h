@@ -0,0 +1,45 @@
+#pragma once
+#include "DeviceFeatures.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace VulkanTutorial {
+
+	// 预编译的descriptor更新模板：按条目直接从应用自己的数据结构中读取VkDescriptorBufferInfo/VkDescriptorImageInfo，
+	// 省去每次构造VkWriteDescriptorSet数组。普通模板用于vkUpdateDescriptorSetWithTemplate；
+	// push模板配合带PUSH_DESCRIPTOR标志的layout，把频繁变化的逐draw set直接记录进命令缓冲，不需要分配set
+	class DescriptorUpdateTemplate
+	{
+	public:
+		DescriptorUpdateTemplate() = default;
+		~DescriptorUpdateTemplate();
+
+		DescriptorUpdateTemplate(const DescriptorUpdateTemplate&) = delete;
+		DescriptorUpdateTemplate& operator=(const DescriptorUpdateTemplate&) = delete;
+
+		// 数据结构中第vOffset字节起有vCount个descriptor信息，相邻两个相隔vStride字节
+		static VkDescriptorUpdateTemplateEntry makeEntry(uint32_t vBinding, VkDescriptorType vType, size_t vOffset, uint32_t vCount = 1, size_t vStride = 0);
+
+		void create(VkDevice vDevice, VkDescriptorSetLayout vSetLayout, std::span<const VkDescriptorUpdateTemplateEntry> vEntries);
+		void createForPush(VkDevice vDevice, const DeviceFeatures& vFeatures, VkDescriptorSetLayout vSetLayout, std::span<const VkDescriptorUpdateTemplateEntry> vEntries,
+			VkPipelineLayout vPipelineLayout, uint32_t vSetIndex, VkPipelineBindPoint vBindPoint = VK_PIPELINE_BIND_POINT_GRAPHICS);
+		void destroy();
+
+		void update(VkDescriptorSet vDescriptorSet, const void* vData) const;
+		void push(VkCommandBuffer vCommandBuffer, const void* vData) const;
+
+		inline bool isPush() const { return m_CmdPushDescriptorSetWithTemplate != nullptr; }
+		inline VkDescriptorUpdateTemplate getHandle() const { return m_Template; }
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		VkDescriptorUpdateTemplate m_Template = VK_NULL_HANDLE;
+		VkPipelineLayout m_PipelineLayout = VK_NULL_HANDLE;
+		uint32_t m_SetIndex = 0;
+		PFN_vkCmdPushDescriptorSetWithTemplateKHR m_CmdPushDescriptorSetWithTemplate = nullptr;
+	};
+
+}
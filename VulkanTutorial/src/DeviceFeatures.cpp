@@ -0,0 +1,167 @@
+#include "DeviceFeatures.h"
+
+#include <algorithm>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		// 同一组内的扩展相互依赖，只有全部支持时才一起启用
+		const std::vector<std::vector<const char*>> OptionalExtensionGroups{
+			{ VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME, VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME },
+			{ VK_EXT_SHADER_OBJECT_EXTENSION_NAME },
+			{ VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME },
+			{ VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME },
+			{ VK_KHR_BUFFER_DEVICE_ADDRESS_EXTENSION_NAME, VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME },
+			{ VK_KHR_SHADER_FLOAT_CONTROLS_EXTENSION_NAME, VK_KHR_SPIRV_1_4_EXTENSION_NAME, VK_EXT_MESH_SHADER_EXTENSION_NAME }
+		};
+
+	}
+
+	void DeviceFeatures::query(VkPhysicalDevice vPhysicalDevice)
+	{
+		uint32_t ExtensionCount = 0;
+		vkEnumerateDeviceExtensionProperties(vPhysicalDevice, nullptr, &ExtensionCount, nullptr);
+		std::vector<VkExtensionProperties> Extensions(ExtensionCount);
+		vkEnumerateDeviceExtensionProperties(vPhysicalDevice, nullptr, &ExtensionCount, Extensions.data());
+		m_SupportedExtensions.clear();
+		for (const auto& Extension : Extensions)
+			m_SupportedExtensions.emplace_back(Extension.extensionName);
+
+		VkPhysicalDeviceProperties Properties{};
+		vkGetPhysicalDeviceProperties(vPhysicalDevice, &Properties);
+		m_ApiVersion = Properties.apiVersion;  // 核心特性结构体只能在设备支持对应版本时串进链中
+
+		m_EnabledExtensions.clear();
+		for (const auto& Group : OptionalExtensionGroups) {
+			bool IsGroupSupported = std::all_of(Group.begin(), Group.end(), [this](const char* vExtension) {
+				return std::find(m_SupportedExtensions.begin(), m_SupportedExtensions.end(), vExtension) != m_SupportedExtensions.end();
+				});
+			if (IsGroupSupported)
+				m_EnabledExtensions.insert(m_EnabledExtensions.end(), Group.begin(), Group.end());
+		}
+
+		// 只把已启用扩展的特性结构体串进pNext链
+		m_Features2 = {};
+		m_Features2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_FEATURES_2;
+		VkPhysicalDeviceProperties2 Properties2{};
+		Properties2.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		m_GraphicsPipelineLibraryFeatures = {};
+		m_GraphicsPipelineLibraryFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_FEATURES_EXT;
+		m_GraphicsPipelineLibraryProperties = {};
+		m_GraphicsPipelineLibraryProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_GRAPHICS_PIPELINE_LIBRARY_PROPERTIES_EXT;
+		if (isExtensionEnabled(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME)) {
+			m_GraphicsPipelineLibraryFeatures.pNext = m_Features2.pNext;
+			m_Features2.pNext = &m_GraphicsPipelineLibraryFeatures;
+			m_GraphicsPipelineLibraryProperties.pNext = Properties2.pNext;
+			Properties2.pNext = &m_GraphicsPipelineLibraryProperties;
+		}
+		m_ShaderObjectFeatures = {};
+		m_ShaderObjectFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SHADER_OBJECT_FEATURES_EXT;
+		if (isExtensionEnabled(VK_EXT_SHADER_OBJECT_EXTENSION_NAME)) {
+			m_ShaderObjectFeatures.pNext = m_Features2.pNext;
+			m_Features2.pNext = &m_ShaderObjectFeatures;
+		}
+		m_DynamicRenderingFeatures = {};
+		m_DynamicRenderingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DYNAMIC_RENDERING_FEATURES;
+		if (isExtensionEnabled(VK_EXT_SHADER_OBJECT_EXTENSION_NAME) && m_ApiVersion >= VK_API_VERSION_1_3) {  // shader object没有VkRenderPass，只能在vkCmdBeginRendering中绘制
+			m_DynamicRenderingFeatures.pNext = m_Features2.pNext;
+			m_Features2.pNext = &m_DynamicRenderingFeatures;
+		}
+		m_DescriptorIndexingFeatures = {};
+		m_DescriptorIndexingFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_FEATURES;
+		m_DescriptorIndexingProperties = {};
+		m_DescriptorIndexingProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_INDEXING_PROPERTIES;
+		if (isExtensionEnabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)) {
+			m_DescriptorIndexingFeatures.pNext = m_Features2.pNext;
+			m_Features2.pNext = &m_DescriptorIndexingFeatures;
+			m_DescriptorIndexingProperties.pNext = Properties2.pNext;
+			Properties2.pNext = &m_DescriptorIndexingProperties;
+		}
+		m_PushDescriptorProperties = {};
+		m_PushDescriptorProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PUSH_DESCRIPTOR_PROPERTIES_KHR;
+		if (isExtensionEnabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME)) {  // 该扩展没有特性结构体
+			m_PushDescriptorProperties.pNext = Properties2.pNext;
+			Properties2.pNext = &m_PushDescriptorProperties;
+		}
+		m_BufferDeviceAddressFeatures = {};
+		m_BufferDeviceAddressFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_BUFFER_DEVICE_ADDRESS_FEATURES;
+		m_DescriptorBufferFeatures = {};
+		m_DescriptorBufferFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_FEATURES_EXT;
+		m_DescriptorBufferProperties = {};
+		m_DescriptorBufferProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_DESCRIPTOR_BUFFER_PROPERTIES_EXT;
+		if (isExtensionEnabled(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)) {
+			m_BufferDeviceAddressFeatures.pNext = m_Features2.pNext;
+			m_Features2.pNext = &m_BufferDeviceAddressFeatures;
+			m_DescriptorBufferFeatures.pNext = m_Features2.pNext;
+			m_Features2.pNext = &m_DescriptorBufferFeatures;
+			m_DescriptorBufferProperties.pNext = Properties2.pNext;
+			Properties2.pNext = &m_DescriptorBufferProperties;
+		}
+		m_MeshShaderFeatures = {};
+		m_MeshShaderFeatures.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_MESH_SHADER_FEATURES_EXT;
+		if (isExtensionEnabled(VK_EXT_MESH_SHADER_EXTENSION_NAME)) {
+			m_MeshShaderFeatures.pNext = m_Features2.pNext;
+			m_Features2.pNext = &m_MeshShaderFeatures;
+		}
+		vkGetPhysicalDeviceFeatures2(vPhysicalDevice, &m_Features2);
+		vkGetPhysicalDeviceProperties2(vPhysicalDevice, &Properties2);
+		m_GraphicsPipelineLibraryProperties.pNext = nullptr;  // Properties2是局部变量
+		m_DescriptorIndexingProperties.pNext = nullptr;
+		m_PushDescriptorProperties.pNext = nullptr;
+		m_DescriptorBufferProperties.pNext = nullptr;
+
+		// 查询会把所有支持的核心特性都置为VK_TRUE，这里只保留用得到的
+		VkBool32 IsPipelineStatisticsQuerySupported = m_Features2.features.pipelineStatisticsQuery;
+		m_Features2.features = {};
+		m_Features2.features.pipelineStatisticsQuery = IsPipelineStatisticsQuerySupported;
+		// capture replay只用于调试工具回放，启用后部分驱动会降低地址分配效率
+		m_BufferDeviceAddressFeatures.bufferDeviceAddressCaptureReplay = VK_FALSE;
+		m_BufferDeviceAddressFeatures.bufferDeviceAddressMultiDevice = VK_FALSE;
+		m_DescriptorBufferFeatures.descriptorBufferCaptureReplay = VK_FALSE;
+		// 这几项各自依赖multiview、fragment shading rate等没有启用的特性
+		m_MeshShaderFeatures.multiviewMeshShader = VK_FALSE;
+		m_MeshShaderFeatures.primitiveFragmentShadingRateMeshShader = VK_FALSE;
+		m_MeshShaderFeatures.meshShaderQueries = VK_FALSE;
+	}
+
+	bool DeviceFeatures::isExtensionEnabled(std::string_view vExtension) const
+	{
+		return std::find(m_EnabledExtensions.begin(), m_EnabledExtensions.end(), vExtension) != m_EnabledExtensions.end();
+	}
+
+	bool DeviceFeatures::isGraphicsPipelineLibrarySupported() const
+	{
+		return isExtensionEnabled(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME) && m_GraphicsPipelineLibraryFeatures.graphicsPipelineLibrary;
+	}
+
+	bool DeviceFeatures::isShaderObjectSupported() const
+	{
+		// 动态状态设置和动态渲染使用了Vulkan 1.3核心函数
+		return m_ApiVersion >= VK_API_VERSION_1_3 && isExtensionEnabled(VK_EXT_SHADER_OBJECT_EXTENSION_NAME) && m_ShaderObjectFeatures.shaderObject
+			&& isDynamicRenderingSupported();
+	}
+
+	bool DeviceFeatures::isDescriptorIndexingSupported() const
+	{
+		// bindless表只依赖这几项：部分绑定、绑定后更新与运行时大小的数组
+		const auto& Features = m_DescriptorIndexingFeatures;
+		return isExtensionEnabled(VK_EXT_DESCRIPTOR_INDEXING_EXTENSION_NAME)
+			&& Features.descriptorBindingPartiallyBound && Features.runtimeDescriptorArray
+			&& Features.shaderSampledImageArrayNonUniformIndexing
+			&& Features.descriptorBindingSampledImageUpdateAfterBind && Features.descriptorBindingStorageBufferUpdateAfterBind
+			&& Features.descriptorBindingUpdateUnusedWhilePending;
+	}
+
+	bool DeviceFeatures::isDescriptorBufferSupported() const
+	{
+		return isExtensionEnabled(VK_EXT_DESCRIPTOR_BUFFER_EXTENSION_NAME)
+			&& m_DescriptorBufferFeatures.descriptorBuffer && m_BufferDeviceAddressFeatures.bufferDeviceAddress;
+	}
+
+	bool DeviceFeatures::isMeshShaderSupported() const
+	{
+		return isExtensionEnabled(VK_EXT_MESH_SHADER_EXTENSION_NAME) && m_MeshShaderFeatures.taskShader && m_MeshShaderFeatures.meshShader;
+	}
+
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 可选的设备扩展与特性：创建逻辑设备前查询，设备支持的部分才会被启用
+	class DeviceFeatures
+	{
+	public:
+		DeviceFeatures() = default;
+		DeviceFeatures(const DeviceFeatures&) = delete;            // 内部pNext链指向自身成员
+		DeviceFeatures& operator=(const DeviceFeatures&) = delete;
+
+		void query(VkPhysicalDevice vPhysicalDevice);
+
+		inline const void* getFeatureChain() const { return &m_Features2; }  // 用作VkDeviceCreateInfo::pNext
+		inline const std::vector<const char*>& getEnabledExtensions() const { return m_EnabledExtensions; }
+		bool isExtensionEnabled(std::string_view vExtension) const;
+
+		bool isGraphicsPipelineLibrarySupported() const;
+		inline bool isGraphicsPipelineLibraryFastLinkingSupported() const { return isGraphicsPipelineLibrarySupported() && m_GraphicsPipelineLibraryProperties.graphicsPipelineLibraryFastLinking; }
+		bool isShaderObjectSupported() const;
+		inline bool isDynamicRenderingSupported() const { return m_DynamicRenderingFeatures.dynamicRendering; }
+		bool isDescriptorIndexingSupported() const;
+		inline const VkPhysicalDeviceDescriptorIndexingProperties& getDescriptorIndexingProperties() const { return m_DescriptorIndexingProperties; }
+		inline bool isPushDescriptorSupported() const { return isExtensionEnabled(VK_KHR_PUSH_DESCRIPTOR_EXTENSION_NAME); }
+		inline uint32_t getMaxPushDescriptors() const { return m_PushDescriptorProperties.maxPushDescriptors; }
+		bool isDescriptorBufferSupported() const;
+		inline const VkPhysicalDeviceDescriptorBufferPropertiesEXT& getDescriptorBufferProperties() const { return m_DescriptorBufferProperties; }
+		bool isMeshShaderSupported() const;
+		inline bool isPipelineStatisticsQuerySupported() const { return m_Features2.features.pipelineStatisticsQuery; }
+		inline uint32_t getApiVersion() const { return m_ApiVersion; }
+	private:
+		std::vector<std::string> m_SupportedExtensions;
+		std::vector<const char*> m_EnabledExtensions;
+		uint32_t m_ApiVersion = 0;
+
+		VkPhysicalDeviceFeatures2 m_Features2{};
+		VkPhysicalDeviceGraphicsPipelineLibraryFeaturesEXT m_GraphicsPipelineLibraryFeatures{};
+		VkPhysicalDeviceGraphicsPipelineLibraryPropertiesEXT m_GraphicsPipelineLibraryProperties{};
+		VkPhysicalDeviceShaderObjectFeaturesEXT m_ShaderObjectFeatures{};
+		VkPhysicalDeviceDynamicRenderingFeatures m_DynamicRenderingFeatures{};
+		VkPhysicalDeviceDescriptorIndexingFeatures m_DescriptorIndexingFeatures{};
+		VkPhysicalDeviceDescriptorIndexingProperties m_DescriptorIndexingProperties{};
+		VkPhysicalDevicePushDescriptorPropertiesKHR m_PushDescriptorProperties{};
+		VkPhysicalDeviceBufferDeviceAddressFeatures m_BufferDeviceAddressFeatures{};
+		VkPhysicalDeviceDescriptorBufferFeaturesEXT m_DescriptorBufferFeatures{};
+		VkPhysicalDeviceDescriptorBufferPropertiesEXT m_DescriptorBufferProperties{};
+		VkPhysicalDeviceMeshShaderFeaturesEXT m_MeshShaderFeatures{};
+	};
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <format>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	// 扩展函数不由loader导出，须通过vkGetDeviceProcAddr获取
+	template<typename T>
+	T loadDeviceFunction(VkDevice vDevice, const char* vName)
+	{
+		auto Function = reinterpret_cast<T>(vkGetDeviceProcAddr(vDevice, vName));
+		if (Function == nullptr)
+			throw std::runtime_error(std::format(R"(Fail to load device function "{0}".)", vName));
+		return Function;
+	}
+
+}
@@ -0,0 +1,65 @@
+#include "DeviceTuning.h"
+
+#include <algorithm>
+#include <format>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t VendorAMD = 0x1002;
+		constexpr uint32_t VendorIntel = 0x8086;
+		constexpr uint32_t DefaultWorkGroupSize = 256;
+
+		const char* getVendorName(uint32_t vVendorID)
+		{
+			switch (vVendorID) {
+			case VendorAMD: return "AMD";
+			case VendorIntel: return "Intel";
+			case 0x10DE: return "NVIDIA";
+			case 0x13B5: return "ARM";
+			case 0x5143: return "Qualcomm";
+			default: return "Unknown";
+			}
+		}
+
+	}
+
+	DeviceTuning DeviceTuning::query(VkPhysicalDevice vPhysicalDevice)
+	{
+		VkPhysicalDeviceSubgroupProperties SubgroupProperties{};
+		SubgroupProperties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_SUBGROUP_PROPERTIES;
+		VkPhysicalDeviceProperties2 Properties{};
+		Properties.sType = VK_STRUCTURE_TYPE_PHYSICAL_DEVICE_PROPERTIES_2;
+		Properties.pNext = &SubgroupProperties;
+		vkGetPhysicalDeviceProperties2(vPhysicalDevice, &Properties);
+
+		const VkPhysicalDeviceLimits& Limits = Properties.properties.limits;
+		DeviceTuning Tuning;
+		Tuning.m_VendorID = Properties.properties.vendorID;
+		Tuning.m_SubgroupSize = std::max(SubgroupProperties.subgroupSize, 1u);
+
+		// 工作组大小不能超过设备上限，并取subgroup大小的整数倍，避免最后一个subgroup只有部分线程活跃
+		uint32_t WorkGroupSize = std::min({ DefaultWorkGroupSize, Limits.maxComputeWorkGroupSize[0], Limits.maxComputeWorkGroupInvocations });
+		Tuning.m_WorkGroupSize = std::max(WorkGroupSize / Tuning.m_SubgroupSize * Tuning.m_SubgroupSize, Tuning.m_SubgroupSize);
+		if (Tuning.m_WorkGroupSize > WorkGroupSize)
+			Tuning.m_WorkGroupSize = WorkGroupSize;
+
+		// Intel核显寄存器较少，展开过多反而降低占用率
+		Tuning.m_UnrollCount = Tuning.m_VendorID == VendorIntel ? 2 : 4;
+		return Tuning;
+	}
+
+	void DeviceTuning::apply(SpecializationConstants& vConstants) const
+	{
+		vConstants.set(WorkGroupSizeConstantID, "WorkGroupSize", m_WorkGroupSize);
+		vConstants.set(UnrollCountConstantID, "UnrollCount", m_UnrollCount);
+	}
+
+	std::string DeviceTuning::toString() const
+	{
+		return std::format("Vendor={0} SubgroupSize={1} WorkGroupSize={2} UnrollCount={3}",
+			getVendorName(m_VendorID), m_SubgroupSize, m_WorkGroupSize, m_UnrollCount);
+	}
+
+}
@@ -0,0 +1,25 @@
+#pragma once
+#include "PipelineKey.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+
+namespace VulkanTutorial {
+
+	// 按物理设备选择的shader调优参数，通过specialization constant传给同一份SPIR-V
+	struct DeviceTuning
+	{
+		uint32_t m_VendorID = 0;
+		uint32_t m_SubgroupSize = 32;
+		uint32_t m_WorkGroupSize = 256;
+		uint32_t m_UnrollCount = 4;
+
+		static DeviceTuning query(VkPhysicalDevice vPhysicalDevice);
+
+		void apply(SpecializationConstants& vConstants) const;
+		std::string toString() const;
+	};
+
+}
@@ -0,0 +1,572 @@
+#include "GltfLoader.h"
+#include "Json.h"
+#include "MappedFile.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t GlbMagic = 0x46546C67;      // "glTF"
+		constexpr uint32_t GlbJsonChunk = 0x4E4F534A;  // "JSON"
+		constexpr uint32_t GlbBinChunk = 0x004E4942;   // "BIN\0"
+		constexpr int64_t TrianglesMode = 4;
+		constexpr size_t CopyBlockSize = 1 << 16;
+		constexpr size_t IndexBlockSize = CopyBlockSize / 3 * 3;  // 不会把一个三角形拆到两个块里
+
+		enum ComponentType : uint32_t
+		{
+			ByteComponent = 5120,
+			UnsignedByteComponent = 5121,
+			ShortComponent = 5122,
+			UnsignedShortComponent = 5123,
+			UnsignedIntComponent = 5125,
+			FloatComponent = 5126
+		};
+
+		struct GltfDocument
+		{
+			MappedFile m_File;
+			JsonValue m_Json;
+			std::span<const std::byte> m_BinChunk;
+			std::vector<MappedFile> m_ExternalFiles;
+			std::vector<std::vector<std::byte>> m_DecodedBuffers;
+			std::vector<std::span<const std::byte>> m_Buffers;
+		};
+
+		// 一个accessor在映射内存中的位置，第i个元素位于m_Data + i * m_Stride
+		struct AccessorView
+		{
+			const std::byte* m_Data = nullptr;
+			size_t m_Count = 0;
+			size_t m_Stride = 0;
+			uint32_t m_ComponentType = 0;
+			uint32_t m_ComponentCount = 0;
+			bool m_IsNormalized = false;
+			int64_t m_BufferView = -1;
+			size_t m_ByteOffset = 0;    // 在bufferView内的偏移
+
+			inline bool isValid() const { return m_Data != nullptr; }
+		};
+
+		// 场景中的一个(节点, primitive)实例，以及它在合并后Mesh中的位置
+		struct PrimitiveInstance
+		{
+			glm::mat4 m_Transform = glm::mat4(1.0f);
+			glm::mat3 m_NormalMatrix = glm::mat3(glm::mat4(1.0f));
+			bool m_IsIdentity = true;
+			bool m_IsMirrored = false;  // 行列式为负时需要翻转三角形绕序
+			AccessorView m_Positions;
+			AccessorView m_Normals;
+			AccessorView m_TexCoords;
+			AccessorView m_Colors;
+			AccessorView m_Indices;
+			size_t m_VertexBase = 0;
+			size_t m_IndexBase = 0;
+			size_t m_IndexCount = 0;
+		};
+
+		struct CopyTask
+		{
+			size_t m_Instance = 0;
+			size_t m_Begin = 0;
+			size_t m_End = 0;
+		};
+
+		inline uint32_t readUint32(const std::byte* vData)
+		{
+			uint32_t Value = 0;
+			std::memcpy(&Value, vData, sizeof(Value));
+			return Value;
+		}
+
+		uint32_t getComponentSize(uint32_t vComponentType)
+		{
+			switch (vComponentType) {
+			case ByteComponent:
+			case UnsignedByteComponent: return 1;
+			case ShortComponent:
+			case UnsignedShortComponent: return 2;
+			case UnsignedIntComponent:
+			case FloatComponent: return 4;
+			default: throw std::runtime_error(std::format("Unknown glTF component type {0}.", vComponentType));
+			}
+		}
+
+		uint32_t getComponentCount(std::string_view vType)
+		{
+			if (vType == "SCALAR") return 1;
+			if (vType == "VEC2") return 2;
+			if (vType == "VEC3") return 3;
+			if (vType == "VEC4") return 4;
+			throw std::runtime_error(std::format(R"(Unsupported glTF accessor type "{0}".)", vType));
+		}
+
+		// 相对URI按RFC 3986做百分号解码(例如"my%20model.bin")，解码后的字节是UTF-8
+		std::filesystem::path resolveUri(const std::filesystem::path& vBasePath, std::string_view vUri)
+		{
+			auto decodeHex = [](char vChar) -> int {
+				if (vChar >= '0' && vChar <= '9') return vChar - '0';
+				if (vChar >= 'a' && vChar <= 'f') return vChar - 'a' + 10;
+				if (vChar >= 'A' && vChar <= 'F') return vChar - 'A' + 10;
+				return -1;
+			};
+			std::u8string Decoded;
+			Decoded.reserve(vUri.size());
+			for (size_t i = 0; i < vUri.size(); ++i) {
+				if (vUri[i] != '%') {
+					Decoded.push_back(static_cast<char8_t>(vUri[i]));
+					continue;
+				}
+				int High = i + 2 < vUri.size() ? decodeHex(vUri[i + 1]) : -1;
+				int Low = High >= 0 ? decodeHex(vUri[i + 2]) : -1;
+				if (Low < 0)
+					throw std::runtime_error(std::format(R"(Invalid percent-encoding in glTF URI "{0}".)", vUri));
+				Decoded.push_back(static_cast<char8_t>(High * 16 + Low));
+				i += 2;
+			}
+			return vBasePath.parent_path() / std::filesystem::path(Decoded);
+		}
+
+		std::vector<std::byte> decodeBase64(std::string_view vText)
+		{
+			auto decodeChar = [](char vChar) -> int {
+				if (vChar >= 'A' && vChar <= 'Z') return vChar - 'A';
+				if (vChar >= 'a' && vChar <= 'z') return vChar - 'a' + 26;
+				if (vChar >= '0' && vChar <= '9') return vChar - '0' + 52;
+				if (vChar == '+') return 62;
+				if (vChar == '/') return 63;
+				return -1;
+			};
+			std::vector<std::byte> Result;
+			Result.reserve(vText.size() / 4 * 3);
+			uint32_t Bits = 0;
+			int BitCount = 0;
+			for (char Char : vText) {
+				int Value = decodeChar(Char);
+				if (Value < 0)
+					break;  // 遇到'='填充即结束
+				Bits = (Bits << 6) | static_cast<uint32_t>(Value);
+				BitCount += 6;
+				if (BitCount >= 8) {
+					BitCount -= 8;
+					Result.push_back(static_cast<std::byte>((Bits >> BitCount) & 0xFF));
+				}
+			}
+			return Result;
+		}
+
+		// 解析文件头，.glb取出JSON块与BIN块，.gltf整个文件就是JSON
+		void openDocument(const std::filesystem::path& vPath, GltfDocument& vDocument)
+		{
+			vDocument.m_File.open(vPath);
+			const std::byte* Data = vDocument.m_File.data();
+			size_t Size = vDocument.m_File.size();
+			std::string_view JsonText;
+			if (Size >= 12 && readUint32(Data) == GlbMagic) {
+				if (readUint32(Data + 4) != 2)
+					throw std::runtime_error(std::format(R"(Unsupported glTF version in "{0}".)", vPath.string()));
+				size_t Length = std::min<size_t>(readUint32(Data + 8), Size);
+				for (size_t Offset = 12; Offset + 8 <= Length;) {
+					size_t ChunkLength = readUint32(Data + Offset);
+					uint32_t ChunkType = readUint32(Data + Offset + 4);
+					if (Offset + 8 + ChunkLength > Length)
+						throw std::runtime_error(std::format(R"(Truncated GLB chunk in "{0}".)", vPath.string()));
+					if (ChunkType == GlbJsonChunk && JsonText.empty())
+						JsonText = std::string_view(reinterpret_cast<const char*>(Data + Offset + 8), ChunkLength);
+					else if (ChunkType == GlbBinChunk && vDocument.m_BinChunk.empty())
+						vDocument.m_BinChunk = { Data + Offset + 8, ChunkLength };
+					Offset += 8 + ChunkLength;  // 块长度已按4字节对齐
+				}
+				if (JsonText.empty())
+					throw std::runtime_error(std::format(R"(Missing JSON chunk in "{0}".)", vPath.string()));
+			}
+			else
+				JsonText = std::string_view(reinterpret_cast<const char*>(Data), Size);
+			vDocument.m_Json = JsonValue::parse(JsonText);
+
+			// Draco、meshopt等压缩扩展需要额外解码，不支持
+			const JsonValue& Required = vDocument.m_Json["extensionsRequired"];
+			if (Required.size() > 0)
+				throw std::runtime_error(std::format(R"(Unsupported glTF extension "{0}" required by "{1}".)", Required.at(0).asString(), vPath.string()));
+		}
+
+		void openBuffers(const std::filesystem::path& vPath, GltfDocument& vDocument)
+		{
+			const JsonValue& Buffers = vDocument.m_Json["buffers"];
+			vDocument.m_ExternalFiles.reserve(Buffers.size());
+			vDocument.m_DecodedBuffers.reserve(Buffers.size());
+			for (size_t i = 0; i < Buffers.size(); ++i) {
+				const JsonValue& Buffer = Buffers.at(i);
+				std::string_view Uri = Buffer["uri"].asString();
+				size_t ByteLength = static_cast<size_t>(Buffer["byteLength"].asInt());
+				std::span<const std::byte> Data;
+				if (Uri.empty())
+					Data = vDocument.m_BinChunk;
+				else if (Uri.starts_with("data:")) {
+					size_t Comma = Uri.find(',');
+					if (Comma == std::string_view::npos || Uri.substr(0, Comma).find(";base64") == std::string_view::npos)
+						throw std::runtime_error(std::format(R"(Unsupported data URI in "{0}".)", vPath.string()));
+					Data = vDocument.m_DecodedBuffers.emplace_back(decodeBase64(Uri.substr(Comma + 1)));
+				}
+				else {
+					const MappedFile& File = vDocument.m_ExternalFiles.emplace_back(resolveUri(vPath, Uri));
+					Data = { File.data(), File.size() };
+				}
+				if (Data.size() < ByteLength)
+					throw std::runtime_error(std::format(R"(glTF buffer {0} of "{1}" is shorter than its byteLength.)", i, vPath.string()));
+				vDocument.m_Buffers.emplace_back(Data.first(ByteLength));
+			}
+		}
+
+		AccessorView getAccessor(const GltfDocument& vDocument, const JsonValue& vIndex)
+		{
+			AccessorView View;
+			if (!vIndex.isNumber())
+				return View;
+			const JsonValue& Accessor = vDocument.m_Json["accessors"].at(static_cast<size_t>(vIndex.asInt()));
+			if (!Accessor.isObject())
+				throw std::runtime_error("glTF accessor index out of range.");
+			if (Accessor.contains("sparse") || !Accessor.contains("bufferView"))
+				throw std::runtime_error("Sparse glTF accessors are not supported.");
+
+			View.m_ComponentType = static_cast<uint32_t>(Accessor["componentType"].asInt());
+			View.m_ComponentCount = getComponentCount(Accessor["type"].asString());
+			View.m_Count = static_cast<size_t>(Accessor["count"].asInt());
+			View.m_IsNormalized = Accessor["normalized"].asBool();
+			View.m_BufferView = Accessor["bufferView"].asInt();
+			View.m_ByteOffset = static_cast<size_t>(Accessor["byteOffset"].asInt());
+
+			const JsonValue& BufferView = vDocument.m_Json["bufferViews"].at(static_cast<size_t>(View.m_BufferView));
+			size_t BufferIndex = static_cast<size_t>(BufferView["buffer"].asInt());
+			if (!BufferView.isObject() || BufferIndex >= vDocument.m_Buffers.size())
+				throw std::runtime_error("glTF bufferView index out of range.");
+			std::span<const std::byte> Buffer = vDocument.m_Buffers[BufferIndex];
+			size_t ViewOffset = static_cast<size_t>(BufferView["byteOffset"].asInt());
+			size_t ViewLength = static_cast<size_t>(BufferView["byteLength"].asInt());
+			size_t ElementSize = getComponentSize(View.m_ComponentType) * View.m_ComponentCount;
+			View.m_Stride = static_cast<size_t>(BufferView["byteStride"].asInt(static_cast<int64_t>(ElementSize)));
+			if (ViewOffset + ViewLength > Buffer.size()
+				|| (View.m_Count > 0 && View.m_ByteOffset + View.m_Stride * (View.m_Count - 1) + ElementSize > ViewLength))
+				throw std::runtime_error("glTF accessor exceeds its bufferView.");
+			View.m_Data = Buffer.data() + ViewOffset + View.m_ByteOffset;
+			return View;
+		}
+
+		// 读取第vIndex个元素的前vCount个分量并转换为float，normalized整数按规范映射到[0, 1]或[-1, 1]
+		void readFloats(const AccessorView& vView, size_t vIndex, float* vValues, uint32_t vCount)
+		{
+			const std::byte* Element = vView.m_Data + vIndex * vView.m_Stride;
+			vCount = std::min(vCount, vView.m_ComponentCount);
+			if (vView.m_ComponentType == FloatComponent) {
+				std::memcpy(vValues, Element, vCount * sizeof(float));
+				return;
+			}
+			for (uint32_t c = 0; c < vCount; ++c) {
+				switch (vView.m_ComponentType) {
+				case ByteComponent: {
+					int8_t Value = static_cast<int8_t>(Element[c]);
+					vValues[c] = vView.m_IsNormalized ? std::max(Value / 127.0f, -1.0f) : Value;
+					break;
+				}
+				case UnsignedByteComponent: {
+					uint8_t Value = static_cast<uint8_t>(Element[c]);
+					vValues[c] = vView.m_IsNormalized ? Value / 255.0f : Value;
+					break;
+				}
+				case ShortComponent: {
+					int16_t Value;
+					std::memcpy(&Value, Element + c * 2, sizeof(Value));
+					vValues[c] = vView.m_IsNormalized ? std::max(Value / 32767.0f, -1.0f) : Value;
+					break;
+				}
+				case UnsignedShortComponent: {
+					uint16_t Value;
+					std::memcpy(&Value, Element + c * 2, sizeof(Value));
+					vValues[c] = vView.m_IsNormalized ? Value / 65535.0f : Value;
+					break;
+				}
+				default: {
+					uint32_t Value;
+					std::memcpy(&Value, Element + c * 4, sizeof(Value));
+					vValues[c] = static_cast<float>(Value);
+					break;
+				}
+				}
+			}
+		}
+
+		inline uint32_t readIndex(const AccessorView& vView, size_t vIndex)
+		{
+			const std::byte* Element = vView.m_Data + vIndex * vView.m_Stride;
+			switch (vView.m_ComponentType) {
+			case UnsignedByteComponent: return static_cast<uint8_t>(Element[0]);
+			case UnsignedShortComponent: { uint16_t Value; std::memcpy(&Value, Element, sizeof(Value)); return Value; }
+			default: return readUint32(Element);
+			}
+		}
+
+		glm::mat4 getLocalTransform(const JsonValue& vNode)
+		{
+			glm::mat4 Result(1.0f);
+			const JsonValue& Matrix = vNode["matrix"];
+			if (Matrix.size() == 16) {
+				for (int c = 0; c < 4; ++c)
+					for (int r = 0; r < 4; ++r)
+						Result[c][r] = static_cast<float>(Matrix.at(c * 4 + r).asNumber());  // glTF矩阵按列主序存储
+				return Result;
+			}
+			const JsonValue& Translation = vNode["translation"];
+			const JsonValue& Rotation = vNode["rotation"];
+			const JsonValue& Scale = vNode["scale"];
+			float X = static_cast<float>(Rotation.at(0).asNumber(0.0)), Y = static_cast<float>(Rotation.at(1).asNumber(0.0));
+			float Z = static_cast<float>(Rotation.at(2).asNumber(0.0)), W = static_cast<float>(Rotation.at(3).asNumber(1.0));
+			// T * R * S
+			Result[0] = glm::vec4(1.0f - 2.0f * (Y * Y + Z * Z), 2.0f * (X * Y + W * Z), 2.0f * (X * Z - W * Y), 0.0f) * static_cast<float>(Scale.at(0).asNumber(1.0));
+			Result[1] = glm::vec4(2.0f * (X * Y - W * Z), 1.0f - 2.0f * (X * X + Z * Z), 2.0f * (Y * Z + W * X), 0.0f) * static_cast<float>(Scale.at(1).asNumber(1.0));
+			Result[2] = glm::vec4(2.0f * (X * Z + W * Y), 2.0f * (Y * Z - W * X), 1.0f - 2.0f * (X * X + Y * Y), 0.0f) * static_cast<float>(Scale.at(2).asNumber(1.0));
+			Result[3] = glm::vec4(static_cast<float>(Translation.at(0).asNumber()), static_cast<float>(Translation.at(1).asNumber()), static_cast<float>(Translation.at(2).asNumber()), 1.0f);
+			return Result;
+		}
+
+		bool isIdentity(const glm::mat4& vMatrix)
+		{
+			for (int c = 0; c < 4; ++c)
+				for (int r = 0; r < 4; ++r)
+					if (vMatrix[c][r] != (c == r ? 1.0f : 0.0f))
+						return false;
+			return true;
+		}
+
+		// 法线矩阵取左上3x3的逆转置，用伴随矩阵代替(之后会归一化，只需保留行列式的符号)
+		void setTransform(PrimitiveInstance& vInstance, const glm::mat4& vTransform)
+		{
+			vInstance.m_Transform = vTransform;
+			vInstance.m_IsIdentity = isIdentity(vTransform);
+			glm::vec3 Axis0(vTransform[0].x, vTransform[0].y, vTransform[0].z);
+			glm::vec3 Axis1(vTransform[1].x, vTransform[1].y, vTransform[1].z);
+			glm::vec3 Axis2(vTransform[2].x, vTransform[2].y, vTransform[2].z);
+			float Determinant = glm::dot(Axis0, glm::cross(Axis1, Axis2));
+			float Sign = Determinant < 0.0f ? -1.0f : 1.0f;
+			vInstance.m_IsMirrored = Determinant < 0.0f;
+			vInstance.m_NormalMatrix[0] = glm::cross(Axis1, Axis2) * Sign;
+			vInstance.m_NormalMatrix[1] = glm::cross(Axis2, Axis0) * Sign;
+			vInstance.m_NormalMatrix[2] = glm::cross(Axis0, Axis1) * Sign;
+		}
+
+		// 顶点流是否与MeshVertex逐字节一致：四个属性都是float、来自同一个交错bufferView，且偏移与MeshVertex相同
+		bool isMeshVertexLayout(const PrimitiveInstance& vInstance)
+		{
+			const AccessorView& Position = vInstance.m_Positions;
+			const AccessorView* Attributes[] = { &vInstance.m_Normals, &vInstance.m_TexCoords, &vInstance.m_Colors };
+			const size_t Offsets[] = { offsetof(MeshVertex, m_Normal), offsetof(MeshVertex, m_TexCoord), offsetof(MeshVertex, m_Color) };
+			const uint32_t Counts[] = { 3, 2, 3 };
+			static_assert(offsetof(MeshVertex, m_Position) == 0);
+			if (!vInstance.m_IsIdentity || Position.m_ComponentType != FloatComponent || Position.m_Stride != sizeof(MeshVertex))
+				return false;
+			size_t Base = Position.m_ByteOffset;
+			for (size_t i = 0; i < 3; ++i) {
+				const AccessorView& Attribute = *Attributes[i];
+				if (!Attribute.isValid() || Attribute.m_BufferView != Position.m_BufferView || Attribute.m_ComponentType != FloatComponent
+					|| Attribute.m_ComponentCount != Counts[i] || Attribute.m_Count != Position.m_Count || Attribute.m_ByteOffset != Base + Offsets[i])
+					return false;
+			}
+			return true;
+		}
+
+		void copyVertices(const PrimitiveInstance& vInstance, size_t vBegin, size_t vEnd, MeshVertex* vVertices)
+		{
+			if (isMeshVertexLayout(vInstance)) {
+				const std::byte* Source = vInstance.m_Positions.m_Data;
+				std::memcpy(vVertices + vBegin, Source + vBegin * sizeof(MeshVertex), (vEnd - vBegin) * sizeof(MeshVertex));
+				return;
+			}
+			for (size_t i = vBegin; i < vEnd; ++i) {
+				MeshVertex& Vertex = vVertices[i];
+				readFloats(vInstance.m_Positions, i, &Vertex.m_Position.x, 3);
+				if (vInstance.m_Normals.isValid())
+					readFloats(vInstance.m_Normals, i, &Vertex.m_Normal.x, 3);
+				if (vInstance.m_TexCoords.isValid())
+					readFloats(vInstance.m_TexCoords, i, &Vertex.m_TexCoord.x, 2);
+				if (vInstance.m_Colors.isValid())
+					readFloats(vInstance.m_Colors, i, &Vertex.m_Color.x, 3);  // RGBA颜色只取RGB
+				if (!vInstance.m_IsIdentity) {
+					glm::vec4 Position = vInstance.m_Transform * glm::vec4(Vertex.m_Position.x, Vertex.m_Position.y, Vertex.m_Position.z, 1.0f);
+					Vertex.m_Position = glm::vec3(Position.x, Position.y, Position.z);
+					glm::vec3 Normal = vInstance.m_NormalMatrix * Vertex.m_Normal;
+					float Length = glm::length(Normal);
+					Vertex.m_Normal = Length > 0.0f ? Normal / Length : Normal;
+				}
+			}
+		}
+
+		void copyIndices(const PrimitiveInstance& vInstance, size_t vBegin, size_t vEnd, uint32_t* vIndices)
+		{
+			uint32_t* Destination = vIndices + vInstance.m_IndexBase;
+			uint32_t VertexBase = static_cast<uint32_t>(vInstance.m_VertexBase);
+			const AccessorView& View = vInstance.m_Indices;
+			if (!View.isValid()) {
+				for (size_t i = vBegin; i < vEnd; ++i)
+					Destination[i] = VertexBase + static_cast<uint32_t>(i);
+			}
+			else if (VertexBase == 0 && View.m_ComponentType == UnsignedIntComponent && View.m_Stride == sizeof(uint32_t))
+				std::memcpy(Destination + vBegin, View.m_Data + vBegin * sizeof(uint32_t), (vEnd - vBegin) * sizeof(uint32_t));
+			else {
+				for (size_t i = vBegin; i < vEnd; ++i)
+					Destination[i] = VertexBase + readIndex(View, i);
+			}
+			// 在拷贝的同时检查越界，不必为校验单独遍历一次索引
+			for (size_t i = vBegin; i < vEnd; ++i)
+				if (Destination[i] - VertexBase >= vInstance.m_Positions.m_Count)
+					throw std::runtime_error("glTF index out of range.");
+			if (vInstance.m_IsMirrored) {
+				for (size_t i = vBegin; i + 2 < vEnd; i += 3)
+					std::swap(Destination[i + 1], Destination[i + 2]);
+			}
+		}
+
+		void collectInstances(const GltfDocument& vDocument, std::vector<PrimitiveInstance>& vInstances)
+		{
+			const JsonValue& Nodes = vDocument.m_Json["nodes"];
+			const JsonValue& Meshes = vDocument.m_Json["meshes"];
+			std::vector<size_t> Roots;
+			const JsonValue& Scene = vDocument.m_Json["scenes"].at(static_cast<size_t>(vDocument.m_Json["scene"].asInt(0)));
+			if (Scene.isObject()) {
+				for (size_t i = 0; i < Scene["nodes"].size(); ++i)
+					Roots.push_back(static_cast<size_t>(Scene["nodes"].at(i).asInt()));
+			}
+			else {
+				// 没有场景时把所有不是子节点的节点当作根节点
+				std::vector<bool> IsChild(Nodes.size(), false);
+				for (size_t i = 0; i < Nodes.size(); ++i) {
+					const JsonValue& Children = Nodes.at(i)["children"];
+					for (size_t k = 0; k < Children.size(); ++k) {
+						int64_t Child = Children.at(k).asInt(-1);
+						if (Child < 0 || static_cast<size_t>(Child) >= Nodes.size())
+							throw std::runtime_error(std::format("glTF node {0} has an out-of-range child index {1}.", i, Child));
+						IsChild[static_cast<size_t>(Child)] = true;
+					}
+				}
+				for (size_t i = 0; i < Nodes.size(); ++i)
+					if (!IsChild[i])
+						Roots.push_back(i);
+			}
+
+			struct NodeEntry
+			{
+				size_t m_Node;
+				glm::mat4 m_ParentTransform;
+				size_t m_Depth;
+			};
+			std::vector<NodeEntry> Stack;
+			for (auto It = Roots.rbegin(); It != Roots.rend(); ++It)
+				Stack.push_back({ *It, glm::mat4(1.0f), 0 });
+			while (!Stack.empty()) {
+				NodeEntry Entry = Stack.back();
+				Stack.pop_back();
+				const JsonValue& Node = Nodes.at(Entry.m_Node);
+				if (!Node.isObject() || Entry.m_Depth > Nodes.size())  // 越界或者有环
+					throw std::runtime_error("Invalid glTF node hierarchy.");
+				glm::mat4 Transform = Entry.m_ParentTransform * getLocalTransform(Node);
+
+				const JsonValue& Mesh = Meshes.at(static_cast<size_t>(Node["mesh"].asInt(-1)));
+				const JsonValue& Primitives = Mesh["primitives"];
+				for (size_t p = 0; p < Primitives.size(); ++p) {
+					const JsonValue& Primitive = Primitives.at(p);
+					const JsonValue& Attributes = Primitive["attributes"];
+					if (Primitive["mode"].asInt(TrianglesMode) != TrianglesMode || !Attributes.contains("POSITION")) {
+						std::cout << std::format("\tskip glTF primitive {0} of mesh \"{1}\": not a triangle list\n", p, Mesh["name"].asString());
+						continue;
+					}
+					PrimitiveInstance Instance;
+					setTransform(Instance, Transform);
+					Instance.m_Positions = getAccessor(vDocument, Attributes["POSITION"]);
+					Instance.m_Normals = getAccessor(vDocument, Attributes["NORMAL"]);
+					Instance.m_TexCoords = getAccessor(vDocument, Attributes["TEXCOORD_0"]);
+					Instance.m_Colors = getAccessor(vDocument, Attributes["COLOR_0"]);
+					Instance.m_Indices = getAccessor(vDocument, Primitive["indices"]);
+					for (const AccessorView* View : { &Instance.m_Normals, &Instance.m_TexCoords, &Instance.m_Colors })
+						if (View->isValid() && View->m_Count < Instance.m_Positions.m_Count)
+							throw std::runtime_error("glTF vertex attributes have mismatched counts.");
+					if (Instance.m_Indices.isValid() && (Instance.m_Indices.m_ComponentCount != 1
+						|| (Instance.m_Indices.m_ComponentType != UnsignedByteComponent && Instance.m_Indices.m_ComponentType != UnsignedShortComponent
+							&& Instance.m_Indices.m_ComponentType != UnsignedIntComponent)))
+						throw std::runtime_error("Invalid glTF index accessor.");
+					Instance.m_IndexCount = (Instance.m_Indices.isValid() ? Instance.m_Indices.m_Count : Instance.m_Positions.m_Count) / 3 * 3;
+					vInstances.emplace_back(Instance);
+				}
+
+				const JsonValue& Children = Node["children"];
+				for (size_t i = Children.size(); i-- > 0;)
+					Stack.push_back({ static_cast<size_t>(Children.at(i).asInt()), Transform, Entry.m_Depth + 1 });
+			}
+		}
+
+	}
+
+	Mesh GltfLoader::load(const std::filesystem::path& vPath)
+	{
+		GltfDocument Document;
+		openDocument(vPath, Document);
+		openBuffers(vPath, Document);
+		std::vector<PrimitiveInstance> Instances;
+		collectInstances(Document, Instances);
+
+		// 前缀和得到每个实例在合并结果中的位置，再按块并行拷贝
+		size_t VertexCount = 0, IndexCount = 0;
+		std::vector<CopyTask> VertexTasks, IndexTasks;
+		for (size_t i = 0; i < Instances.size(); ++i) {
+			PrimitiveInstance& Instance = Instances[i];
+			Instance.m_VertexBase = VertexCount;
+			Instance.m_IndexBase = IndexCount;
+			for (size_t Begin = 0; Begin < Instance.m_Positions.m_Count; Begin += CopyBlockSize)
+				VertexTasks.push_back({ i, Begin, std::min(Begin + CopyBlockSize, Instance.m_Positions.m_Count) });
+			for (size_t Begin = 0; Begin < Instance.m_IndexCount; Begin += IndexBlockSize)
+				IndexTasks.push_back({ i, Begin, std::min(Begin + IndexBlockSize, Instance.m_IndexCount) });
+			VertexCount += Instance.m_Positions.m_Count;
+			IndexCount += Instance.m_IndexCount;
+		}
+		if (VertexCount > UINT32_MAX)
+			throw std::runtime_error(std::format(R"(Too many vertices in "{0}".)", vPath.string()));
+
+		Mesh Result;
+		Result.m_Vertices.resize(VertexCount);
+		Result.m_Indices.resize(IndexCount);
+		parallelFor(VertexTasks.size(), [&](size_t vTask) {
+			const CopyTask& Task = VertexTasks[vTask];
+			const PrimitiveInstance& Instance = Instances[Task.m_Instance];
+			copyVertices(Instance, Task.m_Begin, Task.m_End, Result.m_Vertices.data() + Instance.m_VertexBase);
+			});
+		parallelFor(IndexTasks.size(), [&](size_t vTask) {
+			const CopyTask& Task = IndexTasks[vTask];
+			copyIndices(Instances[Task.m_Instance], Task.m_Begin, Task.m_End, Result.m_Indices.data());
+			});
+		Result.computeBounds();
+		return Result;
+	}
+
+	std::vector<std::filesystem::path> GltfLoader::getExternalBuffers(const std::filesystem::path& vPath)
+	{
+		GltfDocument Document;
+		openDocument(vPath, Document);
+		std::vector<std::filesystem::path> Result;
+		const JsonValue& Buffers = Document.m_Json["buffers"];
+		for (size_t i = 0; i < Buffers.size(); ++i) {
+			std::string_view Uri = Buffers.at(i)["uri"].asString();
+			if (!Uri.empty() && !Uri.starts_with("data:"))
+				Result.emplace_back(resolveUri(vPath, Uri));
+		}
+		return Result;
+	}
+
+}
@@ -0,0 +1,22 @@
+#pragma once
+#include "Mesh.h"
+
+#include <filesystem>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// glTF 2.0(.gltf + 外部/内嵌buffer，或二进制.glb)网格加载：
+	// 1. 所有buffer直接内存映射(.glb的BIN块、外部.bin文件)，data URI才需要解码
+	// 2. 遍历场景节点，每个(节点, primitive)实例的节点变换烘焙进顶点，合并成一个Mesh
+	// 3. 各实例预先算好输出位置后并行拷贝；顶点流布局与MeshVertex一致且节点变换为单位阵时整块memcpy，
+	//    否则按accessor逐属性跨步拷贝。glTF本身就是索引化的顶点，不需要去重
+	// 只支持三角形列表primitive，其他拓扑、sparse accessor与压缩扩展会被跳过或报错
+	class GltfLoader
+	{
+	public:
+		static Mesh load(const std::filesystem::path& vPath);
+		static std::vector<std::filesystem::path> getExternalBuffers(const std::filesystem::path& vPath);  // 供缓存计算内容哈希
+	};
+
+}
@@ -0,0 +1,89 @@
+#include "Hash.h"
+
+#include <cstring>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint64_t Prime1 = 0x9E3779B185EBCA87ull;
+		constexpr uint64_t Prime2 = 0xC2B2AE3D27D4EB4Full;
+		constexpr uint64_t Prime3 = 0x165667B19E3779F9ull;
+		constexpr uint64_t Prime4 = 0x85EBCA77C2B2AE63ull;
+		constexpr uint64_t Prime5 = 0x27D4EB2F165667C5ull;
+
+		inline uint64_t rotateLeft(uint64_t vValue, int vBits) { return (vValue << vBits) | (vValue >> (64 - vBits)); }
+
+		inline uint64_t read64(const unsigned char* vData) { uint64_t Value; std::memcpy(&Value, vData, sizeof(Value)); return Value; }
+		inline uint32_t read32(const unsigned char* vData) { uint32_t Value; std::memcpy(&Value, vData, sizeof(Value)); return Value; }
+
+		inline uint64_t round(uint64_t vAccumulator, uint64_t vInput)
+		{
+			vAccumulator += vInput * Prime2;
+			vAccumulator = rotateLeft(vAccumulator, 31);
+			return vAccumulator * Prime1;
+		}
+
+		inline uint64_t mergeRound(uint64_t vAccumulator, uint64_t vValue)
+		{
+			vAccumulator ^= round(0, vValue);
+			return vAccumulator * Prime1 + Prime4;
+		}
+
+	}
+
+	uint64_t hashBytes(const void* vData, size_t vSize, uint64_t vSeed)
+	{
+		const unsigned char* Data = static_cast<const unsigned char*>(vData);
+		const unsigned char* End = Data + vSize;
+		uint64_t Hash;
+
+		if (vSize >= 32) {
+			uint64_t V1 = vSeed + Prime1 + Prime2;
+			uint64_t V2 = vSeed + Prime2;
+			uint64_t V3 = vSeed;
+			uint64_t V4 = vSeed - Prime1;
+			const unsigned char* Limit = End - 32;
+			do {
+				V1 = round(V1, read64(Data));      Data += 8;
+				V2 = round(V2, read64(Data));      Data += 8;
+				V3 = round(V3, read64(Data));      Data += 8;
+				V4 = round(V4, read64(Data));      Data += 8;
+			} while (Data <= Limit);
+			Hash = rotateLeft(V1, 1) + rotateLeft(V2, 7) + rotateLeft(V3, 12) + rotateLeft(V4, 18);
+			Hash = mergeRound(Hash, V1);
+			Hash = mergeRound(Hash, V2);
+			Hash = mergeRound(Hash, V3);
+			Hash = mergeRound(Hash, V4);
+		}
+		else {
+			Hash = vSeed + Prime5;
+		}
+		Hash += static_cast<uint64_t>(vSize);
+
+		while (Data + 8 <= End) {
+			Hash ^= round(0, read64(Data));
+			Hash = rotateLeft(Hash, 27) * Prime1 + Prime4;
+			Data += 8;
+		}
+		if (Data + 4 <= End) {
+			Hash ^= static_cast<uint64_t>(read32(Data)) * Prime1;
+			Hash = rotateLeft(Hash, 23) * Prime2 + Prime3;
+			Data += 4;
+		}
+		while (Data < End) {
+			Hash ^= (*Data) * Prime5;
+			Hash = rotateLeft(Hash, 11) * Prime1;
+			++Data;
+		}
+
+		// avalanche
+		Hash ^= Hash >> 33;
+		Hash *= Prime2;
+		Hash ^= Hash >> 29;
+		Hash *= Prime3;
+		Hash ^= Hash >> 32;
+		return Hash;
+	}
+
+}
@@ -0,0 +1,19 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+namespace VulkanTutorial {
+
+	// 64位内容哈希(xxHash64算法)，用于文件内容校验和缓存键
+	uint64_t hashBytes(const void* vData, size_t vSize, uint64_t vSeed = 0);
+
+	inline uint64_t hashString(std::string_view vString, uint64_t vSeed = 0) { return hashBytes(vString.data(), vString.size(), vSeed); }
+
+	inline uint64_t hashCombine(uint64_t vSeed, uint64_t vValue)
+	{
+		vSeed ^= vValue + 0x9E3779B97F4A7C15ull + (vSeed << 12) + (vSeed >> 4);
+		return vSeed;
+	}
+
+}
@@ -0,0 +1,188 @@
+#include "ImageDecoder.h"
+
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <format>
+#include <stdexcept>
+#include <string>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <wincodec.h>
+#endif
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		std::string getLowerExtension(const std::filesystem::path& vPath)
+		{
+			std::string Extension = vPath.extension().string();
+			std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return Extension;
+		}
+
+	}
+
+	bool ImageDecoder::isSupported(const std::filesystem::path& vPath)
+	{
+#ifdef _WIN32
+		constexpr std::array<const char*, 7> Extensions{ ".png", ".jpg", ".jpeg", ".bmp", ".tif", ".tiff", ".gif" };
+#else
+		constexpr std::array<const char*, 2> Extensions{ ".ppm", ".pgm" };
+#endif
+		std::string Extension = getLowerExtension(vPath);
+		return std::find(Extensions.begin(), Extensions.end(), Extension) != Extensions.end();
+	}
+
+#ifdef _WIN32
+	ImageDecoder::ImageDecoder()
+	{
+		// 每个线程初始化自己的COM；线程已按其他模式初始化(RPC_E_CHANGED_MODE)时也能使用WIC，但不需要配对的CoUninitialize
+		m_IsComInitialized = SUCCEEDED(CoInitializeEx(nullptr, COINIT_MULTITHREADED));
+		IWICImagingFactory* Factory = nullptr;
+		if (FAILED(CoCreateInstance(CLSID_WICImagingFactory, nullptr, CLSCTX_INPROC_SERVER, IID_PPV_ARGS(&Factory)))) {
+			if (m_IsComInitialized)
+				CoUninitialize();
+			throw std::runtime_error("Failed to create WIC imaging factory!");
+		}
+		m_Factory = Factory;
+	}
+
+	ImageDecoder::~ImageDecoder()
+	{
+		close();
+		static_cast<IWICImagingFactory*>(m_Factory)->Release();
+		if (m_IsComInitialized)
+			CoUninitialize();
+	}
+
+	ImageExtent ImageDecoder::open(const std::filesystem::path& vPath)
+	{
+		close();
+		auto* Factory = static_cast<IWICImagingFactory*>(m_Factory);
+		IWICBitmapDecoder* Decoder = nullptr;
+		if (FAILED(Factory->CreateDecoderFromFilename(vPath.c_str(), nullptr, GENERIC_READ, WICDecodeMetadataCacheOnDemand, &Decoder)))
+			throw std::runtime_error(std::format(R"(Fail to open the image at "{0}".)", vPath.string()));
+		IWICBitmapFrameDecode* Frame = nullptr;
+		HRESULT Result = Decoder->GetFrame(0, &Frame);
+		Decoder->Release();   // 帧持有解码器的引用
+		if (FAILED(Result))
+			throw std::runtime_error(std::format(R"(Fail to read the first frame of "{0}".)", vPath.string()));
+
+		// 转换器在CopyPixels时才真正解码，并直接输出RGBA8
+		IWICFormatConverter* Converter = nullptr;
+		Result = Factory->CreateFormatConverter(&Converter);
+		if (SUCCEEDED(Result))
+			Result = Converter->Initialize(Frame, GUID_WICPixelFormat32bppRGBA, WICBitmapDitherTypeNone, nullptr, 0.0, WICBitmapPaletteTypeCustom);
+		Frame->Release();
+		UINT Width = 0, Height = 0;
+		if (SUCCEEDED(Result))
+			Result = Converter->GetSize(&Width, &Height);
+		if (FAILED(Result)) {
+			if (Converter)
+				Converter->Release();
+			throw std::runtime_error(std::format(R"(Fail to convert "{0}" to RGBA8.)", vPath.string()));
+		}
+		m_Source = Converter;
+		m_Path = vPath;
+		m_Extent = { Width, Height };
+		return m_Extent;
+	}
+
+	void ImageDecoder::decode(std::byte* vPixels)
+	{
+		if (!m_Source)
+			throw std::runtime_error("Failed to decode image which is not opened!");
+		UINT Stride = m_Extent.m_Width * 4;
+		HRESULT Result = static_cast<IWICBitmapSource*>(m_Source)->CopyPixels(nullptr, Stride, static_cast<UINT>(m_Extent.getRgbaSize()), reinterpret_cast<BYTE*>(vPixels));
+		close();
+		if (FAILED(Result))
+			throw std::runtime_error(std::format(R"(Fail to decode the image at "{0}".)", m_Path.string()));
+	}
+
+	void ImageDecoder::close()
+	{
+		if (m_Source)
+			static_cast<IWICBitmapSource*>(m_Source)->Release();
+		m_Source = nullptr;
+	}
+#else
+	ImageDecoder::ImageDecoder() = default;
+
+	ImageDecoder::~ImageDecoder() = default;
+
+	ImageExtent ImageDecoder::open(const std::filesystem::path& vPath)
+	{
+		close();
+		m_File.open(vPath);
+		const char* Data = reinterpret_cast<const char*>(m_File.data());
+		size_t Size = m_File.size(), Position = 0;
+
+		// 头部：魔数、宽、高、最大值，以空白分隔，#开始的注释到行尾；最大值后只有一个空白字符
+		auto readToken = [&]() -> std::string {
+			while (Position < Size) {
+				if (Data[Position] == '#') {
+					while (Position < Size && Data[Position] != '\n')
+						++Position;
+				}
+				else if (std::isspace(static_cast<unsigned char>(Data[Position])))
+					++Position;
+				else
+					break;
+			}
+			size_t Begin = Position;
+			while (Position < Size && !std::isspace(static_cast<unsigned char>(Data[Position])) && Data[Position] != '#')
+				++Position;
+			return std::string(Data + Begin, Position - Begin);
+		};
+		std::string Magic = readToken();
+		if (Magic != "P5" && Magic != "P6")
+			throw std::runtime_error(std::format(R"(Fail to decode "{0}" which is not a binary PPM/PGM.)", vPath.string()));
+		uint32_t Width = 0, Height = 0, MaxValue = 0;
+		try {
+			Width = static_cast<uint32_t>(std::stoul(readToken()));
+			Height = static_cast<uint32_t>(std::stoul(readToken()));
+			MaxValue = static_cast<uint32_t>(std::stoul(readToken()));
+		}
+		catch (const std::exception&) {
+			throw std::runtime_error(std::format(R"(Fail to parse the header of "{0}".)", vPath.string()));
+		}
+		m_ChannelCount = Magic == "P6" ? 3 : 1;
+		m_PixelOffset = Position + 1;
+		if (MaxValue != 255)
+			throw std::runtime_error(std::format(R"(Fail to decode "{0}" which is not 8-bit.)", vPath.string()));
+		// 宽或高为0时后面的截断检查恒成立，但创建图像和计算mip层数都不接受空的尺寸
+		if (Width == 0 || Height == 0)
+			throw std::runtime_error(std::format(R"(Fail to decode "{0}" which has an empty extent {1}x{2}.)", vPath.string(), Width, Height));
+		if (m_PixelOffset + static_cast<size_t>(Width) * Height * m_ChannelCount > Size)
+			throw std::runtime_error(std::format(R"(Fail to decode "{0}" which is truncated.)", vPath.string()));
+		m_Path = vPath;
+		m_Extent = { Width, Height };
+		return m_Extent;
+	}
+
+	void ImageDecoder::decode(std::byte* vPixels)
+	{
+		if (!m_File.isOpen())
+			throw std::runtime_error("Failed to decode image which is not opened!");
+		const uint8_t* Source = reinterpret_cast<const uint8_t*>(m_File.data()) + m_PixelOffset;
+		uint8_t* Target = reinterpret_cast<uint8_t*>(vPixels);
+		size_t PixelCount = static_cast<size_t>(m_Extent.m_Width) * m_Extent.m_Height;
+		for (size_t i = 0; i < PixelCount; ++i, Source += m_ChannelCount, Target += 4) {
+			Target[0] = Source[0];
+			Target[1] = Source[m_ChannelCount == 3 ? 1 : 0];
+			Target[2] = Source[m_ChannelCount == 3 ? 2 : 0];
+			Target[3] = 255;
+		}
+		close();
+	}
+
+	void ImageDecoder::close()
+	{
+		m_File.close();
+	}
+#endif
+
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include "MappedFile.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace VulkanTutorial {
+
+	struct ImageExtent
+	{
+		uint32_t m_Width = 0;
+		uint32_t m_Height = 0;
+
+		inline size_t getRgbaSize() const { return static_cast<size_t>(m_Width) * m_Height * 4; }
+	};
+
+	// 把图片解码为RGBA8，分两步：open()只读出尺寸，调用者据此准备好内存后decode()直接写入目标，不经过中间缓冲。
+	// Windows上使用WIC(PNG/JPEG/BMP/TIFF/GIF)；其他平台只支持二进制PPM/PGM。
+	// 实例不能跨线程共享，每个线程各用一个
+	class ImageDecoder
+	{
+	public:
+		ImageDecoder();
+		~ImageDecoder();
+
+		ImageDecoder(const ImageDecoder&) = delete;
+		ImageDecoder& operator=(const ImageDecoder&) = delete;
+
+		ImageExtent open(const std::filesystem::path& vPath);
+		void decode(std::byte* vPixels);   // 写入getRgbaSize()字节，各行紧密排列；之后须重新open()
+		void close();
+
+		static bool isSupported(const std::filesystem::path& vPath);   // 按扩展名判断
+	private:
+		ImageExtent m_Extent;
+		std::filesystem::path m_Path;
+#ifdef _WIN32
+		void* m_Factory = nullptr;    // IWICImagingFactory
+		void* m_Source = nullptr;     // 已转换为32bppRGBA的IWICBitmapSource
+		bool m_IsComInitialized = false;
+#else
+		MappedFile m_File;
+		size_t m_PixelOffset = 0;
+		uint32_t m_ChannelCount = 0;  // PGM为1，PPM为3
+#endif
+	};
+
+}
@@ -0,0 +1,218 @@
+#include "IndexPacker.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <optional>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t MaxChunkVertexRange = 0xFFFE;   // 0xFFFF留给primitive restart
+		constexpr uint32_t StripWindowSize = 16;            // 在尚未输出的前这么多个三角形中寻找能接上当前带的
+
+		// 一个块内的三角形区间，以及块内最小的顶点序号(base vertex)
+		struct TriangleChunk
+		{
+			size_t m_FirstTriangle = 0;
+			size_t m_TriangleCount = 0;
+			uint32_t m_BaseVertex = 0;
+		};
+
+		// 按原顺序累积三角形，顶点序号跨度超过16位范围时另起一块；单个三角形就超出范围时无法切块
+		std::optional<std::vector<TriangleChunk>> splitChunks(std::span<const uint32_t> vIndices)
+		{
+			std::vector<TriangleChunk> Result;
+			uint32_t Min = UINT32_MAX, Max = 0;
+			TriangleChunk Current;
+			for (size_t t = 0; t < vIndices.size() / 3; ++t) {
+				const uint32_t* Triangle = &vIndices[t * 3];
+				uint32_t TriangleMin = std::min({ Triangle[0], Triangle[1], Triangle[2] });
+				uint32_t TriangleMax = std::max({ Triangle[0], Triangle[1], Triangle[2] });
+				if (TriangleMax - TriangleMin > MaxChunkVertexRange)
+					return std::nullopt;
+				if (Current.m_TriangleCount > 0 && std::max(Max, TriangleMax) - std::min(Min, TriangleMin) > MaxChunkVertexRange) {
+					Current.m_BaseVertex = Min;
+					Result.push_back(Current);
+					Current = { t, 0, 0 };
+					Min = UINT32_MAX;
+					Max = 0;
+				}
+				Min = std::min(Min, TriangleMin);
+				Max = std::max(Max, TriangleMax);
+				++Current.m_TriangleCount;
+			}
+			if (Current.m_TriangleCount > 0) {
+				Current.m_BaseVertex = Min;
+				Result.push_back(Current);
+			}
+			return Result;
+		}
+
+	}
+
+	void PackedIndices::draw(VkCommandBuffer vCommandBuffer, size_t vLod, uint32_t vInstanceCount) const
+	{
+		const IndexChunkRange& Range = m_Lods[vLod];
+		for (uint32_t i = Range.m_FirstChunk; i < Range.m_FirstChunk + Range.m_ChunkCount; ++i)
+			vkCmdDrawIndexed(vCommandBuffer, m_Chunks[i].m_IndexCount, vInstanceCount, m_Chunks[i].m_FirstIndex, m_Chunks[i].m_VertexOffset, 0);
+	}
+
+	PackedIndices IndexPacker::pack(std::span<const uint32_t> vIndices, size_t vVertexCount, const IndexPackingConfig& vConfig)
+	{
+		return packLods(std::span<const std::span<const uint32_t>>(&vIndices, 1), vVertexCount, vConfig);
+	}
+
+	PackedIndices IndexPacker::pack(const Mesh& vMesh, const IndexPackingConfig& vConfig)
+	{
+		std::vector<std::span<const uint32_t>> Lods;
+		for (size_t Lod = 0; Lod < vMesh.getLodCount(); ++Lod)
+			Lods.push_back(vMesh.getLodIndices(Lod));
+		return packLods(Lods, vMesh.m_Vertices.size(), vConfig);
+	}
+
+	PackedIndices IndexPacker::packLods(std::span<const std::span<const uint32_t>> vLods, size_t vVertexCount, const IndexPackingConfig& vConfig)
+	{
+		// 每级LOD分别切块；顶点数在16位范围内时切块结果必然只有一块
+		const size_t LodCount = vLods.size();
+		std::vector<std::vector<TriangleChunk>> LodChunks(LodCount);
+		size_t ChunkCount = 0, TriangleCount = 0;
+		bool IsSplittable = true;
+		for (size_t Lod = 0; Lod < LodCount; ++Lod) {
+			if (vLods[Lod].size() % 3 != 0)
+				throw std::runtime_error("Failed to pack indices which are not a triangle list!");
+			TriangleCount += vLods[Lod].size() / 3;
+			if (auto Chunks = splitChunks(vLods[Lod])) {
+				LodChunks[Lod] = std::move(*Chunks);
+				ChunkCount += LodChunks[Lod].size();
+			}
+			else
+				IsSplittable = false;
+		}
+		bool Is16Bit = IsSplittable && (vVertexCount <= MaxChunkVertexRange + 1 || ChunkCount <= LodCount
+			|| TriangleCount >= static_cast<size_t>(vConfig.m_MinChunkTriangleCount) * ChunkCount);
+		if (!Is16Bit) {
+			for (size_t Lod = 0; Lod < LodCount; ++Lod)
+				LodChunks[Lod] = { { 0, vLods[Lod].size() / 3, 0 } };
+		}
+		const uint32_t RestartIndex = Is16Bit ? 0xFFFF : UINT32_MAX;
+
+		// 块内索引减去base vertex；三角形带整体更小时才使用
+		std::vector<std::vector<uint32_t>> Lists, Strips;
+		size_t ListSize = 0, StripSize = 0;
+		for (size_t Lod = 0; Lod < LodCount; ++Lod) {
+			std::span<const uint32_t> Indices = vLods[Lod];
+			for (const TriangleChunk& Chunk : LodChunks[Lod]) {
+				std::vector<uint32_t>& List = Lists.emplace_back(Indices.begin() + Chunk.m_FirstTriangle * 3, Indices.begin() + (Chunk.m_FirstTriangle + Chunk.m_TriangleCount) * 3);
+				for (uint32_t& Index : List)
+					Index -= Chunk.m_BaseVertex;
+				ListSize += List.size();
+				if (vConfig.m_IsStripAllowed) {
+					Strips.push_back(buildStrips(List, RestartIndex));
+					StripSize += Strips.back().size();
+				}
+			}
+		}
+		bool IsStrip = vConfig.m_IsStripAllowed && StripSize < ListSize;
+		const std::vector<std::vector<uint32_t>>& Sources = IsStrip ? Strips : Lists;
+
+		PackedIndices Result;
+		Result.m_IndexType = Is16Bit ? VK_INDEX_TYPE_UINT16 : VK_INDEX_TYPE_UINT32;
+		Result.m_Topology = IsStrip ? VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP : VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		Result.m_Data.resize((IsStrip ? StripSize : ListSize) * Result.getIndexSize());
+		uint32_t FirstIndex = 0;
+		size_t SourceIndex = 0;
+		for (size_t Lod = 0; Lod < LodCount; ++Lod) {
+			Result.m_Lods.push_back({ static_cast<uint32_t>(Result.m_Chunks.size()), static_cast<uint32_t>(LodChunks[Lod].size()) });
+			for (const TriangleChunk& Chunk : LodChunks[Lod]) {
+				const std::vector<uint32_t>& Source = Sources[SourceIndex++];
+				std::byte* Target = Result.m_Data.data() + static_cast<size_t>(FirstIndex) * Result.getIndexSize();
+				if (Is16Bit) {
+					for (size_t i = 0; i < Source.size(); ++i) {
+						uint16_t Index = static_cast<uint16_t>(Source[i]);
+						std::memcpy(Target + i * sizeof(uint16_t), &Index, sizeof(uint16_t));
+					}
+				}
+				else
+					std::memcpy(Target, Source.data(), Source.size() * sizeof(uint32_t));
+				Result.m_Chunks.push_back({ FirstIndex, static_cast<uint32_t>(Source.size()), static_cast<int32_t>(Chunk.m_BaseVertex) });
+				FirstIndex += static_cast<uint32_t>(Source.size());
+			}
+		}
+		return Result;
+	}
+
+	std::vector<uint32_t> IndexPacker::buildStrips(std::span<const uint32_t> vIndices, uint32_t vRestartIndex)
+	{
+		const size_t TriangleCount = vIndices.size() / 3;
+		std::vector<uint32_t> Result;
+		Result.reserve(vIndices.size());
+		std::vector<uint8_t> IsEmitted(TriangleCount, 0);
+		size_t Cursor = 0;
+		size_t EmittedCount = 0;
+
+		// 带中第n个三角形由最后两个顶点A、B和新顶点C组成，奇数位置的绕序翻转，即(B, A, C)
+		auto findNext = [&](uint32_t vA, uint32_t vB, bool vIsOdd, uint32_t& vC) -> size_t {
+			uint32_t First = vIsOdd ? vB : vA, Second = vIsOdd ? vA : vB;
+			uint32_t Visited = 0;
+			for (size_t t = Cursor; t < TriangleCount && Visited < StripWindowSize; ++t) {
+				if (IsEmitted[t])
+					continue;
+				++Visited;
+				const uint32_t* Triangle = &vIndices[t * 3];
+				for (size_t r = 0; r < 3; ++r) {
+					if (Triangle[r] == First && Triangle[(r + 1) % 3] == Second) {
+						vC = Triangle[(r + 2) % 3];
+						return t;
+					}
+				}
+			}
+			return TriangleCount;
+		};
+
+		while (EmittedCount < TriangleCount) {
+			while (IsEmitted[Cursor])
+				++Cursor;
+			// 新的带从窗口中第一个三角形开始，选一个之后能接上别的三角形的轮换
+			const uint32_t* Triangle = &vIndices[Cursor * 3];
+			IsEmitted[Cursor] = 1;
+			++EmittedCount;
+			size_t Rotation = 0;
+			uint32_t C = 0;
+			for (size_t r = 0; r < 3; ++r) {
+				if (findNext(Triangle[(r + 1) % 3], Triangle[(r + 2) % 3], true, C) != TriangleCount) {
+					Rotation = r;
+					break;
+				}
+			}
+			if (!Result.empty())
+				Result.push_back(vRestartIndex);
+			uint32_t A = Triangle[(Rotation + 1) % 3], B = Triangle[(Rotation + 2) % 3];
+			Result.insert(Result.end(), { Triangle[Rotation], A, B });
+
+			for (bool IsOdd = true;; IsOdd = !IsOdd) {
+				size_t Next = findNext(A, B, IsOdd, C);
+				if (Next == TriangleCount)
+					break;
+				IsEmitted[Next] = 1;
+				++EmittedCount;
+				Result.push_back(C);
+				A = B;
+				B = C;
+			}
+		}
+		return Result;
+	}
+
+	void IndexPacker::report(const Mesh& vSource, const PackedIndices& vPacked)
+	{
+		size_t SourceBytes = vSource.m_Indices.size() * sizeof(uint32_t);
+		std::cout << std::format("\tpack indices: {0} -> {1} KB ({2:.2f}x), {3}-bit {4}, {5} draws for LOD 0, {6} for all LODs\n", SourceBytes / 1024,
+			vPacked.m_Data.size() / 1024, vPacked.m_Data.empty() ? 0.0 : static_cast<double>(SourceBytes) / vPacked.m_Data.size(), vPacked.getIndexSize() * 8,
+			vPacked.isStrip() ? "strips" : "list", vPacked.m_Lods.empty() ? 0 : vPacked.m_Lods[0].m_ChunkCount, vPacked.m_Chunks.size());
+	}
+
+}
@@ -0,0 +1,65 @@
+#pragma once
+#include "Mesh.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 一次vkCmdDrawIndexed：索引区间加上base vertex，16位索引放不下的网格按顶点区间切成多块
+	struct IndexChunk
+	{
+		uint32_t m_FirstIndex = 0;
+		uint32_t m_IndexCount = 0;
+		int32_t m_VertexOffset = 0;
+	};
+
+	struct IndexChunkRange
+	{
+		uint32_t m_FirstChunk = 0;
+		uint32_t m_ChunkCount = 0;
+	};
+
+	struct IndexPackingConfig
+	{
+		bool m_IsStripAllowed = true;             // 三角形带只在比列表小时采用
+		uint32_t m_MinChunkTriangleCount = 1024;  // 切块后平均每块少于这么多三角形时改用32位索引，避免draw call太多
+	};
+
+	// 打包后的索引缓冲：所有LOD共用同一种索引格式和图元拓扑，三角形带之间用primitive restart分隔
+	struct PackedIndices
+	{
+		VkIndexType m_IndexType = VK_INDEX_TYPE_UINT32;
+		VkPrimitiveTopology m_Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		std::vector<std::byte> m_Data;
+		std::vector<IndexChunk> m_Chunks;
+		std::vector<IndexChunkRange> m_Lods;   // 每级LOD对应的块
+
+		inline bool isStrip() const { return m_Topology == VK_PRIMITIVE_TOPOLOGY_TRIANGLE_STRIP; }
+		inline uint32_t getIndexSize() const { return m_IndexType == VK_INDEX_TYPE_UINT16 ? 2 : 4; }
+		inline size_t getIndexCount() const { return m_Data.size() / getIndexSize(); }
+
+		void draw(VkCommandBuffer vCommandBuffer, size_t vLod = 0, uint32_t vInstanceCount = 1) const;  // 须已绑定该索引缓冲和匹配拓扑的管线
+	};
+
+	// 按网格大小选择索引格式：顶点数不超过16位范围时直接用16位；否则按顶点区间切块，每块带base vertex仍用16位，
+	// 块太碎时退回32位。可选转换为三角形带，比三角形列表小时才采用
+	class IndexPacker
+	{
+	public:
+		static PackedIndices pack(std::span<const uint32_t> vIndices, size_t vVertexCount, const IndexPackingConfig& vConfig = {});
+		static PackedIndices pack(const Mesh& vMesh, const IndexPackingConfig& vConfig = {});   // 每级LOD各自切块
+
+		// 三角形列表转为以vRestartIndex分隔的三角形带，保持每个三角形的绕序，三角形顺序只在一个小窗口内调整
+		static std::vector<uint32_t> buildStrips(std::span<const uint32_t> vIndices, uint32_t vRestartIndex);
+		static void report(const Mesh& vSource, const PackedIndices& vPacked);
+
+	private:
+		static PackedIndices packLods(std::span<const std::span<const uint32_t>> vLods, size_t vVertexCount, const IndexPackingConfig& vConfig);
+	};
+
+}
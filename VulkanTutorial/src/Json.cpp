@@ -0,0 +1,237 @@
+#include "Json.h"
+
+#include <charconv>
+#include <format>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		const JsonValue NullValue;
+		constexpr size_t MaxDepth = 256;
+
+	}
+
+	// 递归下降解析，数字使用std::from_chars
+	class JsonParser
+	{
+	public:
+		explicit JsonParser(std::string_view vText) : m_Text(vText) {}
+
+		JsonValue parseDocument()
+		{
+			JsonValue Result = parseValue(0);
+			skipSpace();
+			if (m_Position != m_Text.size())
+				fail("unexpected trailing characters");
+			return Result;
+		}
+	private:
+		[[noreturn]] void fail(const char* vReason) const
+		{
+			throw std::runtime_error(std::format("Fail to parse JSON at offset {0}: {1}.", m_Position, vReason));
+		}
+
+		void skipSpace()
+		{
+			while (m_Position < m_Text.size() && (m_Text[m_Position] == ' ' || m_Text[m_Position] == '\t' || m_Text[m_Position] == '\n' || m_Text[m_Position] == '\r'))
+				++m_Position;
+		}
+
+		bool consume(std::string_view vToken)
+		{
+			if (m_Text.substr(m_Position, vToken.size()) != vToken)
+				return false;
+			m_Position += vToken.size();
+			return true;
+		}
+
+		void expect(char vChar)
+		{
+			skipSpace();
+			if (m_Position >= m_Text.size() || m_Text[m_Position] != vChar)
+				fail("unexpected character");
+			++m_Position;
+		}
+
+		JsonValue parseValue(size_t vDepth)
+		{
+			if (vDepth > MaxDepth)
+				fail("nesting too deep");
+			skipSpace();
+			if (m_Position >= m_Text.size())
+				fail("unexpected end of input");
+			JsonValue Value;
+			char Char = m_Text[m_Position];
+			if (Char == '{') {
+				++m_Position;
+				Value.m_Type = JsonValue::Type::Object;
+				skipSpace();
+				if (consume("}"))
+					return Value;
+				do {
+					skipSpace();
+					Value.m_Keys.emplace_back(parseString());
+					expect(':');
+					Value.m_Values.emplace_back(parseValue(vDepth + 1));
+					skipSpace();
+				} while (consume(","));
+				expect('}');
+			}
+			else if (Char == '[') {
+				++m_Position;
+				Value.m_Type = JsonValue::Type::Array;
+				skipSpace();
+				if (consume("]"))
+					return Value;
+				do {
+					Value.m_Values.emplace_back(parseValue(vDepth + 1));
+					skipSpace();
+				} while (consume(","));
+				expect(']');
+			}
+			else if (Char == '"') {
+				Value.m_Type = JsonValue::Type::String;
+				Value.m_String = parseString();
+			}
+			else if (consume("true") || consume("false")) {
+				Value.m_Type = JsonValue::Type::Bool;
+				Value.m_Bool = Char == 't';
+			}
+			else if (consume("null")) {
+			}
+			else {
+				Value.m_Type = JsonValue::Type::Number;
+				auto [Pointer, Error] = std::from_chars(m_Text.data() + m_Position, m_Text.data() + m_Text.size(), Value.m_Number);
+				if (Error != std::errc())
+					fail("invalid value");
+				m_Position = static_cast<size_t>(Pointer - m_Text.data());
+			}
+			return Value;
+		}
+
+		uint32_t parseHex4()
+		{
+			if (m_Position + 4 > m_Text.size())
+				fail("truncated unicode escape");
+			uint32_t Code = 0;
+			auto [Pointer, Error] = std::from_chars(m_Text.data() + m_Position, m_Text.data() + m_Position + 4, Code, 16);
+			if (Error != std::errc() || Pointer != m_Text.data() + m_Position + 4)
+				fail("invalid unicode escape");
+			m_Position += 4;
+			return Code;
+		}
+
+		static void appendUtf8(std::string& vString, uint32_t vCode)
+		{
+			if (vCode < 0x80)
+				vString += static_cast<char>(vCode);
+			else if (vCode < 0x800) {
+				vString += static_cast<char>(0xC0 | (vCode >> 6));
+				vString += static_cast<char>(0x80 | (vCode & 0x3F));
+			}
+			else if (vCode < 0x10000) {
+				vString += static_cast<char>(0xE0 | (vCode >> 12));
+				vString += static_cast<char>(0x80 | ((vCode >> 6) & 0x3F));
+				vString += static_cast<char>(0x80 | (vCode & 0x3F));
+			}
+			else {
+				vString += static_cast<char>(0xF0 | (vCode >> 18));
+				vString += static_cast<char>(0x80 | ((vCode >> 12) & 0x3F));
+				vString += static_cast<char>(0x80 | ((vCode >> 6) & 0x3F));
+				vString += static_cast<char>(0x80 | (vCode & 0x3F));
+			}
+		}
+
+		std::string parseString()
+		{
+			if (m_Position >= m_Text.size() || m_Text[m_Position] != '"')
+				fail("expected a string");
+			++m_Position;
+			std::string Result;
+			while (true) {
+				// 没有转义的片段整段拷贝
+				size_t End = m_Text.find_first_of("\"\\", m_Position);
+				if (End == std::string_view::npos)
+					fail("unterminated string");
+				Result.append(m_Text.substr(m_Position, End - m_Position));
+				m_Position = End + 1;
+				if (m_Text[End] == '"')
+					return Result;
+				if (m_Position >= m_Text.size())
+					fail("unterminated string");
+				char Escape = m_Text[m_Position++];
+				switch (Escape) {
+				case '"': Result += '"'; break;
+				case '\\': Result += '\\'; break;
+				case '/': Result += '/'; break;
+				case 'b': Result += '\b'; break;
+				case 'f': Result += '\f'; break;
+				case 'n': Result += '\n'; break;
+				case 'r': Result += '\r'; break;
+				case 't': Result += '\t'; break;
+				case 'u': {
+					uint32_t Code = parseHex4();
+					if (Code >= 0xD800 && Code < 0xDC00 && consume("\\u")) { // UTF-16代理对
+						uint32_t Low = parseHex4();
+						Code = 0x10000 + ((Code - 0xD800) << 10) + (Low - 0xDC00);
+					}
+					appendUtf8(Result, Code);
+					break;
+				}
+				default:
+					fail("invalid escape");
+				}
+			}
+		}
+	private:
+		std::string_view m_Text;
+		size_t m_Position = 0;
+	};
+
+	JsonValue JsonValue::parse(std::string_view vText)
+	{
+		return JsonParser(vText).parseDocument();
+	}
+
+	const JsonValue& JsonValue::operator[](std::string_view vKey) const
+	{
+		for (size_t i = 0; i < m_Keys.size(); ++i) {
+			if (m_Keys[i] == vKey)
+				return m_Values[i];
+		}
+		return NullValue;
+	}
+
+	const JsonValue& JsonValue::at(size_t vIndex) const
+	{
+		return m_Type == Type::Array && vIndex < m_Values.size() ? m_Values[vIndex] : NullValue;
+	}
+
+	bool JsonValue::contains(std::string_view vKey) const
+	{
+		return !(*this)[vKey].isNull();
+	}
+
+	bool JsonValue::asBool(bool vDefault) const
+	{
+		return m_Type == Type::Bool ? m_Bool : vDefault;
+	}
+
+	double JsonValue::asNumber(double vDefault) const
+	{
+		return m_Type == Type::Number ? m_Number : vDefault;
+	}
+
+	int64_t JsonValue::asInt(int64_t vDefault) const
+	{
+		return m_Type == Type::Number ? static_cast<int64_t>(m_Number) : vDefault;
+	}
+
+	std::string_view JsonValue::asString(std::string_view vDefault) const
+	{
+		return m_Type == Type::String ? std::string_view(m_String) : vDefault;
+	}
+
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 只读JSON文档，够glTF等资源描述文件使用。
+	// 访问不存在的键或越界的下标返回null值，不抛异常，便于处理可选字段
+	class JsonValue
+	{
+	public:
+		enum class Type : uint8_t
+		{
+			Null = 0,
+			Bool,
+			Number,
+			String,
+			Array,
+			Object
+		};
+
+		static JsonValue parse(std::string_view vText);  // 语法错误时抛出异常
+
+		inline Type getType() const { return m_Type; }
+		inline bool isNull() const { return m_Type == Type::Null; }
+		inline bool isNumber() const { return m_Type == Type::Number; }
+		inline bool isString() const { return m_Type == Type::String; }
+		inline bool isArray() const { return m_Type == Type::Array; }
+		inline bool isObject() const { return m_Type == Type::Object; }
+
+		const JsonValue& operator[](std::string_view vKey) const;
+		const JsonValue& at(size_t vIndex) const;
+		bool contains(std::string_view vKey) const;
+		inline size_t size() const { return m_Values.size(); }  // 数组或对象的元素数量
+
+		bool asBool(bool vDefault = false) const;
+		double asNumber(double vDefault = 0.0) const;
+		int64_t asInt(int64_t vDefault = 0) const;
+		std::string_view asString(std::string_view vDefault = {}) const;
+	private:
+		friend class JsonParser;
+
+		Type m_Type = Type::Null;
+		bool m_Bool = false;
+		double m_Number = 0.0;
+		std::string m_String;
+		std::vector<std::string> m_Keys;    // 只有对象使用，与m_Values一一对应
+		std::vector<JsonValue> m_Values;
+	};
+
+}
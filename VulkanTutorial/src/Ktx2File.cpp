@@ -0,0 +1,271 @@
+#include "Ktx2File.h"
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cctype>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <optional>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint8_t Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+		constexpr uint64_t LevelAlignment = 4;   // lcm(纹素块大小, 4)，RGBA8为4
+		constexpr const char* WriterName = "VulkanTutorial";
+
+		uint64_t alignUp(uint64_t vValue, uint64_t vAlignment)
+		{
+			return (vValue + vAlignment - 1) / vAlignment * vAlignment;
+		}
+
+		// 纹素块的尺寸和字节数，未列出的格式返回空。只收录块大小整除staging对齐(16字节)的格式，
+		// 区域偏移才能满足vkCmdCopyBufferToImage按纹素块对齐的要求
+		struct TexelBlock
+		{
+			uint32_t m_Width = 1;
+			uint32_t m_Height = 1;
+			uint32_t m_ByteSize = 0;
+		};
+
+		std::optional<TexelBlock> getTexelBlock(VkFormat vFormat)
+		{
+			switch (vFormat) {
+			case VK_FORMAT_R8_UNORM: case VK_FORMAT_R8_SRGB:
+				return TexelBlock{ 1, 1, 1 };
+			case VK_FORMAT_R8G8_UNORM: case VK_FORMAT_R8G8_SRGB: case VK_FORMAT_R16_UNORM: case VK_FORMAT_R16_SFLOAT:
+				return TexelBlock{ 1, 1, 2 };
+			case VK_FORMAT_R8G8B8A8_UNORM: case VK_FORMAT_R8G8B8A8_SRGB: case VK_FORMAT_B8G8R8A8_UNORM: case VK_FORMAT_B8G8R8A8_SRGB:
+			case VK_FORMAT_A2B10G10R10_UNORM_PACK32: case VK_FORMAT_B10G11R11_UFLOAT_PACK32: case VK_FORMAT_E5B9G9R9_UFLOAT_PACK32:
+			case VK_FORMAT_R16G16_UNORM: case VK_FORMAT_R16G16_SFLOAT: case VK_FORMAT_R32_SFLOAT:
+				return TexelBlock{ 1, 1, 4 };
+			case VK_FORMAT_R16G16B16A16_UNORM: case VK_FORMAT_R16G16B16A16_SFLOAT: case VK_FORMAT_R32G32_SFLOAT:
+				return TexelBlock{ 1, 1, 8 };
+			case VK_FORMAT_R32G32B32A32_SFLOAT:
+				return TexelBlock{ 1, 1, 16 };
+			case VK_FORMAT_BC1_RGB_UNORM_BLOCK: case VK_FORMAT_BC1_RGB_SRGB_BLOCK: case VK_FORMAT_BC1_RGBA_UNORM_BLOCK: case VK_FORMAT_BC1_RGBA_SRGB_BLOCK:
+			case VK_FORMAT_BC4_UNORM_BLOCK: case VK_FORMAT_BC4_SNORM_BLOCK:
+			case VK_FORMAT_ETC2_R8G8B8_UNORM_BLOCK: case VK_FORMAT_ETC2_R8G8B8_SRGB_BLOCK: case VK_FORMAT_ETC2_R8G8B8A1_UNORM_BLOCK: case VK_FORMAT_ETC2_R8G8B8A1_SRGB_BLOCK:
+				return TexelBlock{ 4, 4, 8 };
+			case VK_FORMAT_BC2_UNORM_BLOCK: case VK_FORMAT_BC2_SRGB_BLOCK: case VK_FORMAT_BC3_UNORM_BLOCK: case VK_FORMAT_BC3_SRGB_BLOCK:
+			case VK_FORMAT_BC5_UNORM_BLOCK: case VK_FORMAT_BC5_SNORM_BLOCK: case VK_FORMAT_BC6H_UFLOAT_BLOCK: case VK_FORMAT_BC6H_SFLOAT_BLOCK:
+			case VK_FORMAT_BC7_UNORM_BLOCK: case VK_FORMAT_BC7_SRGB_BLOCK:
+			case VK_FORMAT_ETC2_R8G8B8A8_UNORM_BLOCK: case VK_FORMAT_ETC2_R8G8B8A8_SRGB_BLOCK:
+			case VK_FORMAT_ASTC_4x4_UNORM_BLOCK: case VK_FORMAT_ASTC_4x4_SRGB_BLOCK:
+				return TexelBlock{ 4, 4, 16 };
+			default:
+				return std::nullopt;
+			}
+		}
+
+		// KHR_DF基本描述块：RGBSDA颜色模型、BT.709原色，四个8位样本依次为R、G、B、A
+		std::vector<uint32_t> buildRgba8Dfd(bool vIsSrgb)
+		{
+			constexpr uint32_t SampleCount = 4;
+			constexpr uint32_t BlockSize = 24 + 16 * SampleCount;
+			constexpr uint32_t ColorModelRgbsda = 1, PrimariesBt709 = 1, TransferLinear = 1, TransferSrgb = 2;
+			constexpr uint32_t ChannelAlpha = 15, QualifierLinear = 0x10;
+
+			std::vector<uint32_t> Dfd;
+			Dfd.push_back(4 + BlockSize);
+			Dfd.push_back(0);                                 // vendorId = KHR, descriptorType = basic
+			Dfd.push_back(2 | (BlockSize << 16));             // versionNumber = 2
+			Dfd.push_back(ColorModelRgbsda | (PrimariesBt709 << 8) | ((vIsSrgb ? TransferSrgb : TransferLinear) << 16));
+			Dfd.push_back(0);                                 // 纹素块为1x1x1x1(存放的是各维度减一)
+			Dfd.push_back(4);                                 // bytesPlane0
+			Dfd.push_back(0);
+			for (uint32_t i = 0; i < SampleCount; ++i) {
+				uint32_t Channel = i == 3 ? ChannelAlpha : i;
+				if (i == 3 && vIsSrgb)
+					Channel |= QualifierLinear;                   // sRGB只作用于颜色，alpha仍是线性的
+				Dfd.push_back((i * 8) | (7 << 16) | (Channel << 24));  // bitOffset、bitLength - 1、channelType
+				Dfd.push_back(0);                             // samplePosition
+				Dfd.push_back(0);                             // sampleLower
+				Dfd.push_back(255);                           // sampleUpper
+			}
+			return Dfd;
+		}
+
+		// 多个线程或进程可能同时写同一路径，临时文件名各不相同，最后一步rename整体替换
+		std::filesystem::path makeTempPath(const std::filesystem::path& vPath)
+		{
+			static const uint64_t ProcessTag = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+			static std::atomic<uint64_t> Counter = 0;
+			std::filesystem::path TempPath = vPath;
+			TempPath += std::format(".{0:016x}_{1}.tmp", ProcessTag, Counter.fetch_add(1));
+			return TempPath;
+		}
+
+		std::vector<std::byte> buildKeyValueData()
+		{
+			// 每一项：4字节长度，key\0value\0，补零到4字节对齐
+			std::string Entry = std::string("KTXwriter") + '\0' + WriterName + '\0';
+			uint32_t Length = static_cast<uint32_t>(Entry.size());
+			std::vector<std::byte> Data(alignUp(sizeof(Length) + Length, 4));
+			std::memcpy(Data.data(), &Length, sizeof(Length));
+			std::memcpy(Data.data() + sizeof(Length), Entry.data(), Length);
+			return Data;
+		}
+
+	}
+
+	Ktx2File::Ktx2File(const std::filesystem::path& vPath)
+	{
+		open(vPath);
+	}
+
+	void Ktx2File::open(const std::filesystem::path& vPath)
+	{
+		close();
+		m_File.open(vPath);
+		try {
+			if (m_File.size() < sizeof(Ktx2Header))
+				throw std::runtime_error(std::format(R"(Fail to read "{0}" which is truncated.)", vPath.string()));
+			std::memcpy(&m_Header, m_File.data(), sizeof(Ktx2Header));
+			if (std::memcmp(m_Header.m_Identifier, Identifier, sizeof(Identifier)) != 0)
+				throw std::runtime_error(std::format(R"(Fail to read "{0}" which is not a KTX2 file.)", vPath.string()));
+			// 超压缩(Basis Universal/zstd)需要先转码，不是一次memcpy能完成的；VK_FORMAT_UNDEFINED同样需要转码
+			if (m_Header.m_SupercompressionScheme != 0 || m_Header.m_VkFormat == VK_FORMAT_UNDEFINED)
+				throw std::runtime_error(std::format(R"(Fail to read "{0}" which needs transcoding.)", vPath.string()));
+			if (m_Header.m_PixelWidth == 0 || m_Header.m_PixelHeight == 0 || m_Header.m_PixelDepth > 1 || m_Header.m_LayerCount > 1 || m_Header.m_FaceCount != 1)
+				throw std::runtime_error(std::format(R"(Fail to read "{0}" which is not a single 2D texture.)", vPath.string()));
+			std::optional<TexelBlock> Block = getTexelBlock(getFormat());
+			if (!Block.has_value())
+				throw std::runtime_error(std::format(R"(Fail to read "{0}" with unsupported format {1}.)", vPath.string(), m_Header.m_VkFormat));
+
+			// levelCount为0表示要求加载方生成mip，这里不在GPU上生成，只上传mip 0
+			uint32_t LevelCount = std::max(m_Header.m_LevelCount, 1u);
+			if (LevelCount > static_cast<uint32_t>(std::bit_width(std::max(m_Header.m_PixelWidth, m_Header.m_PixelHeight))))
+				throw std::runtime_error(std::format(R"(Fail to read "{0}" with too many mip levels.)", vPath.string()));
+			if (sizeof(Ktx2Header) + LevelCount * sizeof(Ktx2LevelIndex) > m_File.size())
+				throw std::runtime_error(std::format(R"(Fail to read "{0}" which is truncated.)", vPath.string()));
+			m_Levels.resize(LevelCount);
+			std::memcpy(m_Levels.data(), m_File.data() + sizeof(Ktx2Header), LevelCount * sizeof(Ktx2LevelIndex));
+			m_LevelRangeBegin = UINT64_MAX;
+			m_LevelRangeEnd = 0;
+			for (uint32_t i = 0; i < LevelCount; ++i) {
+				const Ktx2LevelIndex& Level = m_Levels[i];
+				// 上传时按纹素块整段拷贝，长度或对齐不对会读越界或拷出错位的图像
+				VkExtent2D Extent = getLevelExtent(i);
+				uint64_t ExpectedLength = uint64_t((Extent.width + Block->m_Width - 1) / Block->m_Width) * ((Extent.height + Block->m_Height - 1) / Block->m_Height) * Block->m_ByteSize;
+				if (Level.m_ByteLength != ExpectedLength || Level.m_ByteOffset % Block->m_ByteSize != 0 || Level.m_ByteOffset > m_File.size() || Level.m_ByteLength > m_File.size() - Level.m_ByteOffset)
+					throw std::runtime_error(std::format(R"(Fail to read "{0}" with invalid mip level.)", vPath.string()));
+				m_LevelRangeBegin = std::min(m_LevelRangeBegin, Level.m_ByteOffset);
+				m_LevelRangeEnd = std::max(m_LevelRangeEnd, Level.m_ByteOffset + Level.m_ByteLength);
+			}
+		}
+		catch (...) {
+			close();
+			throw;
+		}
+	}
+
+	void Ktx2File::close()
+	{
+		m_File.close();
+		m_Header = {};
+		m_Levels.clear();
+		m_LevelRangeBegin = m_LevelRangeEnd = 0;
+	}
+
+	VkExtent2D Ktx2File::getLevelExtent(uint32_t vLevel) const
+	{
+		return { std::max(m_Header.m_PixelWidth >> vLevel, 1u), std::max(m_Header.m_PixelHeight >> vLevel, 1u) };
+	}
+
+	std::span<const std::byte> Ktx2File::getLevelData(uint32_t vLevel) const
+	{
+		return { m_File.data() + m_Levels[vLevel].m_ByteOffset, static_cast<size_t>(m_Levels[vLevel].m_ByteLength) };
+	}
+
+	std::span<const std::byte> Ktx2File::getLevelRange() const
+	{
+		return { m_File.data() + m_LevelRangeBegin, static_cast<size_t>(m_LevelRangeEnd - m_LevelRangeBegin) };
+	}
+
+	uint64_t Ktx2File::getOffsetInLevelRange(uint32_t vLevel) const
+	{
+		return m_Levels[vLevel].m_ByteOffset - m_LevelRangeBegin;
+	}
+
+	bool Ktx2File::isKtx2(const std::filesystem::path& vPath)
+	{
+		std::string Extension = vPath.extension().string();
+		std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+		return Extension == ".ktx2";
+	}
+
+	void Ktx2File::write(const std::filesystem::path& vPath, VkFormat vFormat, VkExtent2D vExtent, std::span<const std::vector<std::byte>> vLevels)
+	{
+		if (vFormat != VK_FORMAT_R8G8B8A8_UNORM && vFormat != VK_FORMAT_R8G8B8A8_SRGB)
+			throw std::runtime_error("Failed to write KTX2 file with unsupported format!");
+		if (vLevels.empty() || vLevels.size() > static_cast<size_t>(std::bit_width(std::max(vExtent.width, vExtent.height))))
+			throw std::runtime_error("Failed to write KTX2 file with invalid mip level count!");
+		for (size_t i = 0; i < vLevels.size(); ++i) {
+			uint64_t Width = std::max(vExtent.width >> i, 1u), Height = std::max(vExtent.height >> i, 1u);
+			if (vLevels[i].size() != Width * Height * 4)
+				throw std::runtime_error("Failed to write KTX2 file with mismatched mip level size!");
+		}
+
+		std::vector<uint32_t> Dfd = buildRgba8Dfd(vFormat == VK_FORMAT_R8G8B8A8_SRGB);
+		std::vector<std::byte> KeyValueData = buildKeyValueData();
+		Ktx2Header Header;
+		std::memcpy(Header.m_Identifier, Identifier, sizeof(Identifier));
+		Header.m_VkFormat = vFormat;
+		Header.m_TypeSize = 1;
+		Header.m_PixelWidth = vExtent.width;
+		Header.m_PixelHeight = vExtent.height;
+		Header.m_FaceCount = 1;
+		Header.m_LevelCount = static_cast<uint32_t>(vLevels.size());
+		Header.m_DfdByteOffset = static_cast<uint32_t>(sizeof(Ktx2Header) + vLevels.size() * sizeof(Ktx2LevelIndex));
+		Header.m_DfdByteLength = static_cast<uint32_t>(Dfd.size() * sizeof(uint32_t));
+		Header.m_KvdByteOffset = Header.m_DfdByteOffset + Header.m_DfdByteLength;
+		Header.m_KvdByteLength = static_cast<uint32_t>(KeyValueData.size());
+
+		// 规范要求最小的mip存放在最前面，流式加载时可以先读到粗糙的级别
+		std::vector<Ktx2LevelIndex> Levels(vLevels.size());
+		uint64_t Offset = Header.m_KvdByteOffset + Header.m_KvdByteLength;
+		for (size_t i = vLevels.size(); i-- > 0;) {
+			Offset = alignUp(Offset, LevelAlignment);
+			Levels[i] = { Offset, vLevels[i].size(), vLevels[i].size() };
+			Offset += vLevels[i].size();
+		}
+
+		std::filesystem::path TempPath = makeTempPath(vPath);
+		try {
+			std::ofstream OutFileStream(TempPath, std::ios_base::binary | std::ios_base::trunc);
+			if (!OutFileStream)
+				throw std::runtime_error(std::format(R"(Fail to open the file at "{0}".)", TempPath.string()));
+			uint64_t Position = 0;
+			auto writeData = [&](uint64_t vOffset, const void* vData, uint64_t vSize) {
+				const char Padding[LevelAlignment]{};
+				OutFileStream.write(Padding, static_cast<std::streamsize>(vOffset - Position));
+				OutFileStream.write(reinterpret_cast<const char*>(vData), static_cast<std::streamsize>(vSize));
+				Position = vOffset + vSize;
+			};
+			writeData(0, &Header, sizeof(Header));
+			writeData(sizeof(Header), Levels.data(), Levels.size() * sizeof(Ktx2LevelIndex));
+			writeData(Header.m_DfdByteOffset, Dfd.data(), Header.m_DfdByteLength);
+			writeData(Header.m_KvdByteOffset, KeyValueData.data(), KeyValueData.size());
+			for (size_t i = vLevels.size(); i-- > 0;)
+				writeData(Levels[i].m_ByteOffset, vLevels[i].data(), vLevels[i].size());
+			if (!OutFileStream)
+				throw std::runtime_error(std::format(R"(Fail to write the file at "{0}".)", TempPath.string()));
+			OutFileStream.close();
+			std::filesystem::rename(TempPath, vPath);
+		}
+		catch (...) {
+			std::error_code ErrorCode;
+			std::filesystem::remove(TempPath, ErrorCode);
+			throw;
+		}
+	}
+
+}
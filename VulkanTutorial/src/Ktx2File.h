@@ -0,0 +1,74 @@
+#pragma once
+#include "MappedFile.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// KTX2文件头，紧接着是每级mip一项的Ktx2LevelIndex(mip 0在前)，之后是DFD、键值对和各级数据(最小的mip在前)
+	struct Ktx2Header
+	{
+		uint8_t m_Identifier[12]{};
+		uint32_t m_VkFormat = 0;
+		uint32_t m_TypeSize = 0;
+		uint32_t m_PixelWidth = 0;
+		uint32_t m_PixelHeight = 0;
+		uint32_t m_PixelDepth = 0;
+		uint32_t m_LayerCount = 0;
+		uint32_t m_FaceCount = 0;
+		uint32_t m_LevelCount = 0;
+		uint32_t m_SupercompressionScheme = 0;
+		uint32_t m_DfdByteOffset = 0;
+		uint32_t m_DfdByteLength = 0;
+		uint32_t m_KvdByteOffset = 0;
+		uint32_t m_KvdByteLength = 0;
+		uint64_t m_SgdByteOffset = 0;
+		uint64_t m_SgdByteLength = 0;
+	};
+	static_assert(sizeof(Ktx2Header) == 80);
+
+	struct Ktx2LevelIndex
+	{
+		uint64_t m_ByteOffset = 0;
+		uint64_t m_ByteLength = 0;
+		uint64_t m_UncompressedByteLength = 0;
+	};
+
+	// 只读映射的KTX2纹理容器，只支持没有超压缩的单层2D纹理。各级mip已经是目标格式，
+	// 在文件中连续存放，整段原样拷贝进staging buffer后用一次多区域的vkCmdCopyBufferToImage上传
+	class Ktx2File
+	{
+	public:
+		Ktx2File() = default;
+		explicit Ktx2File(const std::filesystem::path& vPath);
+
+		void open(const std::filesystem::path& vPath);  // 文件损坏、格式未知或各级长度与格式不符时抛出异常
+		void close();
+
+		inline bool isOpen() const { return m_File.isOpen(); }
+		inline VkFormat getFormat() const { return static_cast<VkFormat>(m_Header.m_VkFormat); }
+		inline VkExtent2D getExtent() const { return { m_Header.m_PixelWidth, m_Header.m_PixelHeight }; }
+		inline uint32_t getLevelCount() const { return static_cast<uint32_t>(m_Levels.size()); }
+		VkExtent2D getLevelExtent(uint32_t vLevel) const;
+		std::span<const std::byte> getLevelData(uint32_t vLevel) const;
+		std::span<const std::byte> getLevelRange() const;              // 包含所有级别(及其间的对齐填充)的一段
+		uint64_t getOffsetInLevelRange(uint32_t vLevel) const;
+
+		static bool isKtx2(const std::filesystem::path& vPath);        // 按扩展名判断
+		// 只支持R8G8B8A8_UNORM/SRGB，vLevels从mip 0开始，每级是紧密排列的像素
+		static void write(const std::filesystem::path& vPath, VkFormat vFormat, VkExtent2D vExtent, std::span<const std::vector<std::byte>> vLevels);
+	private:
+		MappedFile m_File;
+		Ktx2Header m_Header;
+		std::vector<Ktx2LevelIndex> m_Levels;
+		uint64_t m_LevelRangeBegin = 0;
+		uint64_t m_LevelRangeEnd = 0;
+	};
+
+}
@@ -0,0 +1,45 @@
+#include "LodSelector.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		// 相机在包围球内或非常近时按这个距离算，直接选LOD 0
+		constexpr float MinDistance = 1e-4f;
+
+	}
+
+	void LodSelector::setProjection(float vVerticalFov, uint32_t vViewportHeight)
+	{
+		m_ProjectionScale = static_cast<float>(vViewportHeight) / (2.0f * std::tan(vVerticalFov * 0.5f));
+	}
+
+	float LodSelector::getProjectedError(float vError, float vDistance) const
+	{
+		return vError * m_ProjectionScale / std::max(vDistance, MinDistance);
+	}
+
+	uint32_t LodSelector::select(std::span<const MeshLod> vLods, const glm::vec3& vCameraPosition, const glm::vec3& vCenter, float vRadius, float vScale) const
+	{
+		float Distance = glm::length(vCenter - vCameraPosition) - vRadius;
+		if (vLods.size() <= 1 || Distance <= MinDistance)
+			return 0;
+		for (size_t i = vLods.size() - 1; i > 0; --i) {
+			if (getProjectedError(vLods[i].m_Error * vScale, Distance) <= m_ErrorThreshold)
+				return static_cast<uint32_t>(i);
+		}
+		return 0;
+	}
+
+	uint32_t LodSelector::select(const Mesh& vMesh, const glm::vec3& vCameraPosition, const glm::mat4& vModel) const
+	{
+		glm::vec3 Center = glm::vec3(vModel * glm::vec4(vMesh.m_Bounds.getCenter(), 1.0f));
+		float Scale = std::max({ glm::length(glm::vec3(vModel[0])), glm::length(glm::vec3(vModel[1])), glm::length(glm::vec3(vModel[2])) });
+		float Radius = glm::length(vMesh.m_Bounds.getExtent()) * 0.5f * Scale;
+		return select(vMesh.m_Lods, vCameraPosition, Center, Radius, Scale);
+	}
+
+}
@@ -0,0 +1,29 @@
+#pragma once
+#include "Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <span>
+
+namespace VulkanTutorial {
+
+	// 运行时按投影到屏幕上的误差选择LOD：误差(模型空间距离)除以到包围球的距离再乘以投影缩放，得到像素数，
+	// 选误差不超过阈值的最粗一级。导入时生成的各级误差单调递增，从粗到细找到第一个满足的即可
+	class LodSelector
+	{
+	public:
+		void setProjection(float vVerticalFov, uint32_t vViewportHeight);  // vVerticalFov为弧度
+		inline void setErrorThreshold(float vPixels) { m_ErrorThreshold = vPixels; }
+		inline float getErrorThreshold() const { return m_ErrorThreshold; }
+
+		float getProjectedError(float vError, float vDistance) const;  // 返回像素数
+		// vScale为模型到世界的最大缩放，vCenter/vRadius为世界空间的包围球
+		uint32_t select(std::span<const MeshLod> vLods, const glm::vec3& vCameraPosition, const glm::vec3& vCenter, float vRadius, float vScale = 1.0f) const;
+		uint32_t select(const Mesh& vMesh, const glm::vec3& vCameraPosition, const glm::mat4& vModel) const;
+	private:
+		float m_ProjectionScale = 1.0f;  // viewport高度 / (2 * tan(fov / 2))
+		float m_ErrorThreshold = 1.0f;
+	};
+
+}
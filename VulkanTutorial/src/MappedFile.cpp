@@ -0,0 +1,138 @@
+#include "MappedFile.h"
+
+#include <format>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace VulkanTutorial {
+
+	MappedFile::MappedFile(const std::filesystem::path& vPath)
+	{
+		open(vPath);
+	}
+
+	MappedFile::~MappedFile()
+	{
+		close();
+	}
+
+	MappedFile::MappedFile(MappedFile&& vOther) noexcept
+	{
+		*this = std::move(vOther);
+	}
+
+	MappedFile& MappedFile::operator=(MappedFile&& vOther) noexcept
+	{
+		if (this != &vOther) {
+			close();
+			m_Path = std::move(vOther.m_Path);
+			m_Data = std::exchange(vOther.m_Data, nullptr);
+			m_Size = std::exchange(vOther.m_Size, 0);
+			m_IsOpen = std::exchange(vOther.m_IsOpen, false);
+#ifdef _WIN32
+			m_FileHandle = std::exchange(vOther.m_FileHandle, nullptr);
+			m_MappingHandle = std::exchange(vOther.m_MappingHandle, nullptr);
+#endif
+		}
+		return *this;
+	}
+
+#ifdef _WIN32
+	void MappedFile::open(const std::filesystem::path& vPath)
+	{
+		close();
+		HANDLE File = CreateFileW(vPath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+			OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+		if (File == INVALID_HANDLE_VALUE)
+			throw std::runtime_error(std::format(R"(Fail to open the file at "{0}".)", vPath.string()));
+		LARGE_INTEGER FileSize{};
+		if (!GetFileSizeEx(File, &FileSize)) {
+			CloseHandle(File);
+			throw std::runtime_error(std::format(R"(Fail to query the size of "{0}".)", vPath.string()));
+		}
+		m_Path = vPath;
+		m_FileHandle = File;
+		m_Size = static_cast<size_t>(FileSize.QuadPart);
+		m_IsOpen = true;
+		if (m_Size == 0)
+			return;
+
+		HANDLE Mapping = CreateFileMappingW(File, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		if (!Mapping) {
+			close();
+			throw std::runtime_error(std::format(R"(Fail to map the file at "{0}".)", vPath.string()));
+		}
+		m_MappingHandle = Mapping;
+		m_Data = static_cast<const std::byte*>(MapViewOfFile(Mapping, FILE_MAP_READ, 0, 0, 0));
+		if (!m_Data) {
+			close();
+			throw std::runtime_error(std::format(R"(Fail to map the file at "{0}".)", vPath.string()));
+		}
+	}
+
+	void MappedFile::close()
+	{
+		if (m_Data)
+			UnmapViewOfFile(m_Data);
+		if (m_MappingHandle)
+			CloseHandle(m_MappingHandle);
+		if (m_FileHandle)
+			CloseHandle(m_FileHandle);
+		m_Data = nullptr;
+		m_MappingHandle = nullptr;
+		m_FileHandle = nullptr;
+		m_Size = 0;
+		m_IsOpen = false;
+	}
+#else
+	void MappedFile::open(const std::filesystem::path& vPath)
+	{
+		close();
+		int FileDescriptor = ::open(vPath.c_str(), O_RDONLY | O_CLOEXEC);
+		if (FileDescriptor < 0)
+			throw std::runtime_error(std::format(R"(Fail to open the file at "{0}".)", vPath.string()));
+		struct stat FileStatus {};
+		if (fstat(FileDescriptor, &FileStatus) != 0) {
+			::close(FileDescriptor);
+			throw std::runtime_error(std::format(R"(Fail to query the size of "{0}".)", vPath.string()));
+		}
+		m_Path = vPath;
+		m_Size = static_cast<size_t>(FileStatus.st_size);
+		m_IsOpen = true;
+		if (m_Size == 0) {
+			::close(FileDescriptor);
+			return;
+		}
+
+		void* Data = mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, FileDescriptor, 0);
+		::close(FileDescriptor); // 映射建立后fd可以直接关闭
+		if (Data == MAP_FAILED) {
+			m_Size = 0;
+			m_IsOpen = false;
+			throw std::runtime_error(std::format(R"(Fail to map the file at "{0}".)", vPath.string()));
+		}
+		madvise(Data, m_Size, MADV_SEQUENTIAL);
+		madvise(Data, m_Size, MADV_WILLNEED);
+		m_Data = static_cast<const std::byte*>(Data);
+	}
+
+	void MappedFile::close()
+	{
+		if (m_Data)
+			munmap(const_cast<std::byte*>(m_Data), m_Size);
+		m_Data = nullptr;
+		m_Size = 0;
+		m_IsOpen = false;
+	}
+#endif
+
+}
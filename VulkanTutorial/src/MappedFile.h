@@ -0,0 +1,39 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+namespace VulkanTutorial {
+
+	// 只读内存映射文件，整个文件映射一次，析构时自动解除映射
+	class MappedFile
+	{
+	public:
+		MappedFile() = default;
+		explicit MappedFile(const std::filesystem::path& vPath);
+		~MappedFile();
+
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+		MappedFile(MappedFile&& vOther) noexcept;
+		MappedFile& operator=(MappedFile&& vOther) noexcept;
+
+		void open(const std::filesystem::path& vPath);
+		void close();
+
+		inline bool isOpen() const { return m_IsOpen; }
+		inline const std::byte* data() const { return m_Data; }
+		inline size_t size() const { return m_Size; }
+		inline const std::filesystem::path& path() const { return m_Path; }
+	private:
+		std::filesystem::path m_Path;
+		const std::byte* m_Data = nullptr;
+		size_t m_Size = 0;
+		bool m_IsOpen = false;   // 空文件没有映射，但仍视为已打开
+#ifdef _WIN32
+		void* m_FileHandle = nullptr;
+		void* m_MappingHandle = nullptr;
+#endif
+	};
+
+}
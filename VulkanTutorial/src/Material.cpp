@@ -0,0 +1,79 @@
+#include "Material.h"
+
+#include <format>
+#include <iostream>
+
+namespace VulkanTutorial {
+
+	void MaterialSystem::create(PipelineLibrary& vLibrary)
+	{
+		m_Library = &vLibrary;
+	}
+
+	void MaterialSystem::destroy(uint64_t vFrame)
+	{
+		for (auto& Entry : m_Materials) {
+			if (Entry.m_IsRequested)
+				m_Library->release(Entry.m_PipelineID, vFrame);
+		}
+		m_Materials.clear();
+	}
+
+	uint32_t MaterialSystem::addMaterial(const Material& vMaterial)
+	{
+		MaterialEntry Entry;
+		Entry.m_Material = vMaterial;
+		m_Materials.emplace_back(std::move(Entry));
+		return static_cast<uint32_t>(m_Materials.size() - 1);
+	}
+
+	void MaterialSystem::requestSpecializations(const GraphicsPipelineDesc& vUbershaderDesc, uint64_t vFrame)
+	{
+		for (auto& Entry : m_Materials) {
+			GraphicsPipelineDesc Desc = vUbershaderDesc;
+			Desc.m_Constants.set(MaterialUbershaderConstantID, "IsUbershader", false);
+			Desc.m_Constants.set(MaterialFeaturesConstantID, "MaterialFeatures", Entry.m_Material.m_Parameters.m_Features);
+			uint64_t ID = Desc.hash();
+			if (Entry.m_IsRequested && ID == Entry.m_PipelineID)
+				continue;
+			if (Entry.m_IsRequested)
+				m_Library->release(Entry.m_PipelineID, vFrame);
+			Entry.m_PipelineID = m_Library->requestAsync(Desc);
+			Entry.m_IsRequested = true;
+			Entry.m_IsSpecialized = false;
+			Entry.m_FallbackDraws = 0;
+			Entry.m_FallbackMilliseconds = 0.0f;
+			Entry.m_FallbackTimer.reset();
+		}
+	}
+
+	VkPipeline MaterialSystem::resolve(uint32_t vMaterial)
+	{
+		MaterialEntry& Entry = m_Materials[vMaterial];
+		if (!Entry.m_IsRequested)
+			return VK_NULL_HANDLE;
+		VkPipeline Pipeline = m_Library->getPipeline(Entry.m_PipelineID);
+		if (Pipeline == VK_NULL_HANDLE) {
+			++Entry.m_FallbackDraws;
+			return VK_NULL_HANDLE;
+		}
+		if (!Entry.m_IsSpecialized) {
+			Entry.m_IsSpecialized = true;
+			Entry.m_FallbackMilliseconds = Entry.m_FallbackTimer.ellapseMilliseconds();
+			std::cout << std::format(R"(Material "{0}" switched to its specialized pipeline after {1:.2f} ms ({2} ubershader draws).)",
+				Entry.m_Material.m_Name, Entry.m_FallbackMilliseconds, Entry.m_FallbackDraws) << "\n";
+		}
+		return Pipeline;
+	}
+
+	void MaterialSystem::report() const
+	{
+		std::cout << "Material fallback telemetry:\n";
+		for (const auto& Entry : m_Materials) {
+			float Milliseconds = Entry.m_IsSpecialized ? Entry.m_FallbackMilliseconds : Entry.m_FallbackTimer.ellapseMilliseconds();
+			std::cout << std::format("\t{0:<16} {1:>10.2f} ms on ubershader, {2} ubershader draws{3}\n", Entry.m_Material.m_Name,
+				Milliseconds, Entry.m_FallbackDraws, Entry.m_IsSpecialized ? "" : " (still compiling)");
+		}
+	}
+
+}
@@ -0,0 +1,72 @@
+#pragma once
+#include "PipelineLibrary.h"
+#include "Timer.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	enum MaterialFeature : uint32_t
+	{
+		MaterialVertexColor = 1 << 0,
+		MaterialBaseColor = 1 << 1,
+		MaterialTexture = 1 << 2     // 只有bindless表启用时生效，采样m_TextureIndex指向的纹理
+	};
+
+	// ubershader和特化pipeline共用的specialization constant，与18_shader_vertexbuffer.frag一致
+	enum MaterialConstantID : uint32_t
+	{
+		MaterialUbershaderConstantID = FeatureConstantIDBegin,
+		MaterialFeaturesConstantID = FeatureConstantIDBegin + 1
+	};
+
+	// push constant布局，ubershader在运行时读取，特化pipeline中Features已是编译期常量
+	struct MaterialParameters
+	{
+		glm::vec4 m_BaseColor = glm::vec4(1.0f);
+		uint32_t m_Features = 0;
+		uint32_t m_TextureIndex = UINT32_MAX;  // bindless表中的槽位，每帧绘制前由纹理句柄解析
+	};
+	static_assert(sizeof(MaterialParameters) == 24, "MaterialParameters must match the push constant block.");
+
+	struct Material
+	{
+		std::string m_Name;
+		MaterialParameters m_Parameters;
+	};
+
+	// 材质的特化pipeline在后台编译，完成前用ubershader绘制，并统计每个材质停留在ubershader上的时间
+	class MaterialSystem
+	{
+	public:
+		void create(PipelineLibrary& vLibrary);
+		void destroy(uint64_t vFrame);
+
+		uint32_t addMaterial(const Material& vMaterial);
+		void requestSpecializations(const GraphicsPipelineDesc& vUbershaderDesc, uint64_t vFrame); // 释放旧的特化pipeline并重新提交后台编译
+		VkPipeline resolve(uint32_t vMaterial);  // 特化pipeline已就绪则返回之，否则返回VK_NULL_HANDLE(即应使用ubershader)
+
+		inline const Material& getMaterial(uint32_t vMaterial) const { return m_Materials[vMaterial].m_Material; }
+		inline uint32_t size() const { return static_cast<uint32_t>(m_Materials.size()); }
+		void report() const;
+	private:
+		struct MaterialEntry
+		{
+			Material m_Material;
+			uint64_t m_PipelineID = 0;
+			bool m_IsRequested = false;
+			bool m_IsSpecialized = false;
+			uint64_t m_FallbackDraws = 0;    // 使用ubershader录制的次数
+			Timer m_FallbackTimer;           // 从提交编译起计时
+			float m_FallbackMilliseconds = 0.0f;
+		};
+	private:
+		PipelineLibrary* m_Library = nullptr;
+		std::vector<MaterialEntry> m_Materials;
+	};
+
+}
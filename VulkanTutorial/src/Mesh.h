@@ -0,0 +1,127 @@
+#pragma once
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 导入后的标准顶点，全部是float且没有填充字节，可以直接按字节哈希和比较
+	struct MeshVertex
+	{
+		glm::vec3 m_Position = glm::vec3(0.0f);
+		glm::vec3 m_Normal = glm::vec3(0.0f);
+		glm::vec2 m_TexCoord = glm::vec2(0.0f);
+		glm::vec3 m_Color = glm::vec3(1.0f);
+	};
+	static_assert(sizeof(MeshVertex) == 11 * sizeof(float), "MeshVertex must not contain padding");
+
+	// MeshVertex拆分后的两个顶点流：缓存按这两个流解码，mesh shader路径作为两个storage buffer读取
+	struct MeshPositionVertex
+	{
+		glm::vec3 m_Position = glm::vec3(0.0f);
+	};
+
+	struct MeshAttributeVertex
+	{
+		glm::vec3 m_Normal = glm::vec3(0.0f);
+		glm::vec2 m_TexCoord = glm::vec2(0.0f);
+		glm::vec3 m_Color = glm::vec3(1.0f);
+	};
+
+	struct MeshBounds
+	{
+		glm::vec3 m_Min = glm::vec3(std::numeric_limits<float>::max());
+		glm::vec3 m_Max = glm::vec3(std::numeric_limits<float>::lowest());
+
+		inline void expand(const glm::vec3& vPoint) { m_Min = glm::min(m_Min, vPoint); m_Max = glm::max(m_Max, vPoint); }
+		inline bool isValid() const { return m_Min.x <= m_Max.x; }
+		inline glm::vec3 getCenter() const { return (m_Min + m_Max) * 0.5f; }
+		inline glm::vec3 getExtent() const { return m_Max - m_Min; }
+	};
+
+	// 纹理坐标的范围，量化时按它归一化；缓存中保存一份，流式量化不必先扫描全部顶点
+	struct TexCoordBounds
+	{
+		glm::vec2 m_Min = glm::vec2(std::numeric_limits<float>::max());
+		glm::vec2 m_Max = glm::vec2(std::numeric_limits<float>::lowest());
+
+		inline void expand(const glm::vec2& vTexCoord) { m_Min = glm::min(m_Min, vTexCoord); m_Max = glm::max(m_Max, vTexCoord); }
+		inline bool isValid() const { return m_Min.x <= m_Max.x; }
+	};
+
+	// 一级LOD在索引数组中的区间，各级共享顶点
+	struct MeshLod
+	{
+		static constexpr uint32_t MaxCount = 8;
+
+		uint32_t m_IndexOffset = 0;
+		uint32_t m_IndexCount = 0;
+		float m_Error = 0.0f;  // 相对LOD 0的模型空间距离误差，逐级递增
+	};
+
+	// 网格的一小块，最多MeshletData::MaxVertexCount个顶点、MaxTriangleCount个三角形，三角形用8位局部索引
+	struct Meshlet
+	{
+		uint32_t m_VertexOffset = 0;    // MeshletData::m_Vertices中的起始位置
+		uint32_t m_TriangleOffset = 0;  // MeshletData::m_Triangles中的起始字节，4字节对齐
+		uint32_t m_VertexCount = 0;
+		uint32_t m_TriangleCount = 0;
+	};
+
+	// 剔除用的包围球与法线锥，布局与shader中的std430结构一致
+	struct MeshletBounds
+	{
+		glm::vec3 m_Center = glm::vec3(0.0f);
+		float m_Radius = 0.0f;
+		glm::vec3 m_ConeAxis = glm::vec3(0.0f);
+		float m_ConeCutoff = 1.0f;      // sin(法线锥半角)，法线分布太散无法剔除时为1
+	};
+
+	struct MeshletData
+	{
+		static constexpr uint32_t MaxVertexCount = 64;
+		static constexpr uint32_t MaxTriangleCount = 124;  // 满载时三角形索引共372字节，正好是4字节的整数倍
+
+		std::vector<Meshlet> m_Meshlets;
+		std::vector<MeshletBounds> m_Bounds;
+		std::vector<uint32_t> m_Vertices;   // 局部顶点到网格顶点的映射
+		std::vector<uint8_t> m_Triangles;   // 每个三角形3个局部索引，每个meshlet的区间补齐到4字节
+
+		inline size_t getTriangleCount() const
+		{
+			size_t Count = 0;
+			for (const Meshlet& Item : m_Meshlets)
+				Count += Item.m_TriangleCount;
+			return Count;
+		}
+	};
+
+	// 三角形列表网格，索引总是32位，上传时再决定GPU端的索引格式
+	struct Mesh
+	{
+		std::vector<MeshVertex> m_Vertices;
+		std::vector<uint32_t> m_Indices;  // 依次存放各级LOD的索引
+		std::vector<MeshLod> m_Lods;      // 为空时整个m_Indices就是唯一的一级
+		MeshletData m_Meshlets;           // 由LOD 0切分
+		MeshBounds m_Bounds;
+
+		inline size_t getLodCount() const { return m_Lods.empty() ? 1 : m_Lods.size(); }
+		inline std::span<const uint32_t> getLodIndices(size_t vLod) const
+		{
+			if (m_Lods.empty())
+				return m_Indices;
+			return std::span<const uint32_t>(m_Indices).subspan(m_Lods[vLod].m_IndexOffset, m_Lods[vLod].m_IndexCount);
+		}
+
+		void computeBounds()
+		{
+			m_Bounds = {};
+			for (const auto& Vertex : m_Vertices)
+				m_Bounds.expand(Vertex.m_Position);
+		}
+	};
+
+}
@@ -0,0 +1,395 @@
+#include "MeshCache.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t CacheMagic = 0x4853454D;  // "MESH"
+		// 修改文件格式或导入流程(去重、优化等)时递增，使旧缓存全部失效
+		constexpr uint32_t CacheVersion = 8;
+		constexpr uint64_t StreamAlignment = 16;
+		constexpr const char* CacheExtension = ".mesh";
+
+		const std::array<MeshAttributeDesc, 4> VertexLayout{ {
+			{ MeshAttributeSemantic::Position, VK_FORMAT_R32G32B32_SFLOAT, static_cast<uint32_t>(offsetof(MeshVertex, m_Position)) },
+			{ MeshAttributeSemantic::Normal, VK_FORMAT_R32G32B32_SFLOAT, static_cast<uint32_t>(offsetof(MeshVertex, m_Normal)) },
+			{ MeshAttributeSemantic::TexCoord, VK_FORMAT_R32G32_SFLOAT, static_cast<uint32_t>(offsetof(MeshVertex, m_TexCoord)) },
+			{ MeshAttributeSemantic::Color, VK_FORMAT_R32G32B32_SFLOAT, static_cast<uint32_t>(offsetof(MeshVertex, m_Color)) }
+		} };
+
+		inline bool isValidEncoding(MeshStreamEncoding vEncoding)
+		{
+			return vEncoding == MeshStreamEncoding::Raw || vEncoding == MeshStreamEncoding::Codec;
+		}
+
+		inline uint64_t alignUp(uint64_t vValue, uint64_t vAlignment)
+		{
+			return (vValue + vAlignment - 1) / vAlignment * vAlignment;
+		}
+
+		// 进程标记加进程内计数，同时导入同一网格的线程或进程各写各的临时文件
+		std::filesystem::path makeTempPath(const std::filesystem::path& vCachePath)
+		{
+			static const uint64_t ProcessTag = (static_cast<uint64_t>(std::random_device{}()) << 32) | std::random_device{}();
+			static std::atomic<uint64_t> Counter = 0;
+			std::filesystem::path TempPath = vCachePath;
+			TempPath += std::format(".{0:016x}_{1}.tmp", ProcessTag, Counter.fetch_add(1));
+			return TempPath;
+		}
+
+	}
+
+	MeshCacheFile::MeshCacheFile(MeshCacheFile&& vOther) noexcept
+	{
+		*this = std::move(vOther);
+	}
+
+	MeshCacheFile& MeshCacheFile::operator=(MeshCacheFile&& vOther) noexcept
+	{
+		if (this != &vOther) {
+			m_File = std::move(vOther.m_File);
+			m_Header = std::exchange(vOther.m_Header, nullptr);
+		}
+		return *this;
+	}
+
+	bool MeshCacheFile::open(const std::filesystem::path& vPath, uint64_t vSourceHash)
+	{
+		close();
+		m_File.open(vPath);
+		if (m_File.size() < sizeof(MeshCacheHeader))
+			return false;
+		const MeshCacheHeader* Header = reinterpret_cast<const MeshCacheHeader*>(m_File.data());
+		if (Header->m_Magic != CacheMagic || Header->m_Version != CacheVersion || Header->m_SourceHash != vSourceHash)
+			return false;
+		if (Header->m_VertexStride != sizeof(MeshVertex) || Header->m_IndexSize != sizeof(uint32_t) || Header->m_AttributeCount != VertexLayout.size())
+			return false;
+		for (size_t i = 0; i < VertexLayout.size(); ++i) {
+			const MeshAttributeDesc& Attribute = Header->m_Attributes[i];
+			if (Attribute.m_Semantic != VertexLayout[i].m_Semantic || Attribute.m_Format != VertexLayout[i].m_Format || Attribute.m_Offset != VertexLayout[i].m_Offset)
+				return false;
+		}
+		if (!isValidEncoding(Header->m_VertexEncoding) || !isValidEncoding(Header->m_IndexEncoding)
+			|| (Header->m_VertexEncoding == MeshStreamEncoding::Raw && Header->m_VertexDataSize != Header->m_VertexCount * Header->m_VertexStride)
+			|| (Header->m_IndexEncoding == MeshStreamEncoding::Raw && Header->m_IndexDataSize != Header->m_IndexCount * Header->m_IndexSize))
+			return false;
+		// 截断的文件(例如写入时进程被杀)不能信任
+		if (Header->m_VertexOffset % StreamAlignment != 0 || Header->m_IndexOffset % StreamAlignment != 0
+			|| Header->m_VertexOffset + Header->m_VertexDataSize > m_File.size()
+			|| Header->m_IndexOffset + Header->m_IndexDataSize > m_File.size())
+			return false;
+		if (Header->m_LodCount == 0 || Header->m_LodCount > MeshLod::MaxCount)
+			return false;
+		for (uint32_t i = 0; i < Header->m_LodCount; ++i) {
+			if (static_cast<uint64_t>(Header->m_Lods[i].m_IndexOffset) + Header->m_Lods[i].m_IndexCount > Header->m_IndexCount)
+				return false;
+		}
+		if (Header->m_MeshletOffset % StreamAlignment != 0 || Header->m_MeshletBoundsOffset % StreamAlignment != 0
+			|| Header->m_MeshletVertexOffset % StreamAlignment != 0 || Header->m_MeshletTriangleOffset % StreamAlignment != 0
+			|| Header->m_MeshletOffset + Header->m_MeshletCount * sizeof(Meshlet) > m_File.size()
+			|| Header->m_MeshletBoundsOffset + Header->m_MeshletCount * sizeof(MeshletBounds) > m_File.size()
+			|| Header->m_MeshletVertexOffset + Header->m_MeshletVertexCount * sizeof(uint32_t) > m_File.size()
+			|| Header->m_MeshletTriangleOffset + Header->m_MeshletTriangleSize > m_File.size())
+			return false;
+		m_Header = Header;
+		return true;
+	}
+
+	void MeshCacheFile::close()
+	{
+		m_Header = nullptr;
+		m_File.close();
+	}
+
+	void MeshCacheFile::decodeVertices(std::span<MeshVertex> vVertices) const
+	{
+		if (vVertices.size() != m_Header->m_VertexCount)
+			throw std::runtime_error("Failed to decode mesh cache vertices into a mismatched buffer!");
+		std::array<VertexChannel, sizeof(MeshVertex) / 4> Channels;
+		for (size_t i = 0; i < Channels.size(); ++i)
+			Channels[i] = { reinterpret_cast<std::byte*>(vVertices.data()) + i * 4, sizeof(MeshVertex) };
+		decodeVertices(Channels);
+	}
+
+	void MeshCacheFile::decodeVertexStreams(std::span<MeshPositionVertex> vPositions, std::span<MeshAttributeVertex> vAttributes) const
+	{
+		if (vPositions.size() != m_Header->m_VertexCount || vAttributes.size() != m_Header->m_VertexCount)
+			throw std::runtime_error("Failed to decode mesh cache vertices into a mismatched buffer!");
+		// MeshVertex的前3个通道是位置，其余依次是法线、纹理坐标和颜色，与MeshAttributeVertex一致
+		constexpr size_t PositionChannelCount = sizeof(MeshPositionVertex) / 4;
+		static_assert(offsetof(MeshVertex, m_Normal) == sizeof(MeshPositionVertex) && sizeof(MeshVertex) == sizeof(MeshPositionVertex) + sizeof(MeshAttributeVertex));
+		std::array<VertexChannel, sizeof(MeshVertex) / 4> Channels;
+		for (size_t i = 0; i < Channels.size(); ++i) {
+			if (i < PositionChannelCount)
+				Channels[i] = { reinterpret_cast<std::byte*>(vPositions.data()) + i * 4, sizeof(MeshPositionVertex) };
+			else
+				Channels[i] = { reinterpret_cast<std::byte*>(vAttributes.data()) + (i - PositionChannelCount) * 4, sizeof(MeshAttributeVertex) };
+		}
+		decodeVertices(Channels);
+	}
+
+	void MeshCacheFile::decodeVertexStreamBlocks(const VertexStreamBlockCallback& vOnBlock) const
+	{
+		// 块内存只有约11KB，一直留在缓存中，回调从这里读取比从映射的staging内存读回快得多
+		constexpr size_t BlockSize = MeshCodec::VertexBlockSize;
+		constexpr size_t PositionChannelCount = sizeof(MeshPositionVertex) / 4;
+		std::array<MeshPositionVertex, BlockSize> Positions;
+		std::array<MeshAttributeVertex, BlockSize> Attributes;
+		std::array<VertexChannel, sizeof(MeshVertex) / 4> Channels;
+		for (size_t i = 0; i < Channels.size(); ++i) {
+			if (i < PositionChannelCount)
+				Channels[i] = { reinterpret_cast<std::byte*>(Positions.data()) + i * 4, sizeof(MeshPositionVertex) };
+			else
+				Channels[i] = { reinterpret_cast<std::byte*>(Attributes.data()) + (i - PositionChannelCount) * 4, sizeof(MeshAttributeVertex) };
+		}
+		auto onBlock = [&](size_t vBase, size_t vCount) {
+			vOnBlock(vBase, std::span<const MeshPositionVertex>(Positions.data(), vCount), std::span<const MeshAttributeVertex>(Attributes.data(), vCount));
+		};
+
+		std::span<const uint8_t> Data = getStreamData(m_Header->m_VertexOffset, m_Header->m_VertexDataSize);
+		if (m_Header->m_VertexEncoding == MeshStreamEncoding::Codec) {
+			MeshCodec::decodeVertexBlocks(Data, m_Header->m_VertexCount, Channels, onBlock);
+			return;
+		}
+		for (size_t Base = 0; Base < m_Header->m_VertexCount; Base += BlockSize) {
+			size_t Count = std::min<size_t>(BlockSize, m_Header->m_VertexCount - Base);
+			for (size_t i = 0; i < Count; ++i) {
+				for (size_t c = 0; c < Channels.size(); ++c)
+					std::memcpy(Channels[c].m_Data + i * Channels[c].m_Stride, Data.data() + (Base + i) * m_Header->m_VertexStride + c * 4, 4);
+			}
+			onBlock(Base, Count);
+		}
+	}
+
+	void MeshCacheFile::decodeIndices(std::span<uint32_t> vIndices) const
+	{
+		if (vIndices.size() != m_Header->m_IndexCount)
+			throw std::runtime_error("Failed to decode mesh cache indices into a mismatched buffer!");
+		std::span<const uint8_t> Data = getStreamData(m_Header->m_IndexOffset, m_Header->m_IndexDataSize);
+		if (m_Header->m_IndexEncoding == MeshStreamEncoding::Codec)
+			MeshCodec::decodeIndices(Data, vIndices);
+		else
+			std::memcpy(vIndices.data(), Data.data(), Data.size());
+	}
+
+	std::span<const uint8_t> MeshCacheFile::getStreamData(uint64_t vOffset, uint64_t vSize) const
+	{
+		return { reinterpret_cast<const uint8_t*>(m_File.data() + vOffset), vSize };
+	}
+
+	void MeshCacheFile::decodeVertices(std::span<const VertexChannel> vChannels) const
+	{
+		std::span<const uint8_t> Data = getStreamData(m_Header->m_VertexOffset, m_Header->m_VertexDataSize);
+		if (m_Header->m_VertexEncoding == MeshStreamEncoding::Codec) {
+			MeshCodec::decodeVertices(Data, m_Header->m_VertexCount, vChannels);
+			return;
+		}
+		for (size_t i = 0; i < m_Header->m_VertexCount; ++i) {
+			for (size_t c = 0; c < vChannels.size(); ++c)
+				std::memcpy(vChannels[c].m_Data + i * vChannels[c].m_Stride, Data.data() + i * m_Header->m_VertexStride + c * 4, 4);
+		}
+	}
+
+	std::span<const Meshlet> MeshCacheFile::getMeshlets() const
+	{
+		return { reinterpret_cast<const Meshlet*>(m_File.data() + m_Header->m_MeshletOffset), m_Header->m_MeshletCount };
+	}
+
+	std::span<const MeshletBounds> MeshCacheFile::getMeshletBounds() const
+	{
+		return { reinterpret_cast<const MeshletBounds*>(m_File.data() + m_Header->m_MeshletBoundsOffset), m_Header->m_MeshletCount };
+	}
+
+	std::span<const uint32_t> MeshCacheFile::getMeshletVertices() const
+	{
+		return { reinterpret_cast<const uint32_t*>(m_File.data() + m_Header->m_MeshletVertexOffset), m_Header->m_MeshletVertexCount };
+	}
+
+	std::span<const uint8_t> MeshCacheFile::getMeshletTriangles() const
+	{
+		return { reinterpret_cast<const uint8_t*>(m_File.data() + m_Header->m_MeshletTriangleOffset), m_Header->m_MeshletTriangleSize };
+	}
+
+	Mesh MeshCacheFile::toMesh() const
+	{
+		Mesh Result;
+		Result.m_Vertices.resize(m_Header->m_VertexCount);
+		Result.m_Indices.resize(m_Header->m_IndexCount);
+		decodeVertices(Result.m_Vertices);
+		decodeIndices(Result.m_Indices);
+		Result.m_Lods.assign(m_Header->m_Lods, m_Header->m_Lods + m_Header->m_LodCount);
+		std::span<const Meshlet> Meshlets = getMeshlets();
+		std::span<const MeshletBounds> Bounds = getMeshletBounds();
+		std::span<const uint32_t> MeshletVertices = getMeshletVertices();
+		std::span<const uint8_t> MeshletTriangles = getMeshletTriangles();
+		Result.m_Meshlets.m_Meshlets.assign(Meshlets.begin(), Meshlets.end());
+		Result.m_Meshlets.m_Bounds.assign(Bounds.begin(), Bounds.end());
+		Result.m_Meshlets.m_Vertices.assign(MeshletVertices.begin(), MeshletVertices.end());
+		Result.m_Meshlets.m_Triangles.assign(MeshletTriangles.begin(), MeshletTriangles.end());
+		Result.m_Bounds = m_Header->m_Bounds;
+		return Result;
+	}
+
+	MeshCache::MeshCache(const std::filesystem::path& vCacheDirectory)
+		: m_CacheDirectory(vCacheDirectory)
+	{
+		std::filesystem::create_directories(m_CacheDirectory);
+	}
+
+	uint64_t MeshCache::hashSource(const std::filesystem::path& vSourcePath, std::span<const std::filesystem::path> vDependencies)
+	{
+		MappedFile SourceFile(vSourcePath);
+		uint64_t Hash = hashBytes(SourceFile.data(), SourceFile.size(), CacheVersion);
+		for (const auto& Dependency : vDependencies) {
+			MappedFile DependencyFile(Dependency);
+			Hash = hashCombine(Hash, hashBytes(DependencyFile.data(), DependencyFile.size()));
+		}
+		return Hash;
+	}
+
+	std::span<const MeshAttributeDesc> MeshCache::getVertexLayout()
+	{
+		return VertexLayout;
+	}
+
+	std::filesystem::path MeshCache::getCachePath(const std::filesystem::path& vSourcePath, uint64_t vSourceHash) const
+	{
+		// 扩展名和规范化后的源路径哈希也放进文件名，不同目录下的同名网格、同名的.obj和.gltf各有自己的缓存，清理旧缓存时不会互相删除
+		std::string Extension = vSourcePath.extension().string();
+		std::error_code ErrorCode;
+		std::filesystem::path SourcePath = std::filesystem::weakly_canonical(vSourcePath, ErrorCode);
+		if (ErrorCode)
+			SourcePath = std::filesystem::absolute(vSourcePath).lexically_normal();
+		uint64_t PathHash = hashString(SourcePath.generic_string());
+		return m_CacheDirectory / std::format("{0}_{1}_{2:016x}_{3:016x}{4}", vSourcePath.stem().string(), Extension.empty() ? "" : Extension.substr(1),
+			PathHash, vSourceHash, CacheExtension);
+	}
+
+	bool MeshCache::load(const std::filesystem::path& vSourcePath, uint64_t vSourceHash, MeshCacheFile& vFile) const
+	{
+		std::filesystem::path CachePath = getCachePath(vSourcePath, vSourceHash);
+		if (!std::filesystem::exists(CachePath))
+			return false;
+		if (vFile.open(CachePath, vSourceHash))
+			return true;
+		vFile.close();
+		return false;
+	}
+
+	MeshCacheHeader MeshCache::store(const std::filesystem::path& vSourcePath, uint64_t vSourceHash, const Mesh& vMesh) const
+	{
+		// 同一源文件的旧缓存已经不可能再命中，顺便清理掉；CachePath本身可能刚由另一个进程写好，旧缓存也可能正被映射，删除失败时忽略
+		std::filesystem::path CachePath = getCachePath(vSourcePath, vSourceHash);
+		std::string CacheName = CachePath.filename().string();
+		std::string Prefix = CacheName.substr(0, CacheName.size() - 16 - std::strlen(CacheExtension));
+		std::error_code ErrorCode;
+		for (const auto& Entry : std::filesystem::directory_iterator(m_CacheDirectory, ErrorCode)) {
+			std::string FileName = Entry.path().filename().string();
+			if (FileName != CacheName && FileName.starts_with(Prefix) && FileName.size() == CacheName.size() && FileName.ends_with(CacheExtension))
+				std::filesystem::remove(Entry.path(), ErrorCode);
+		}
+
+		MeshCacheHeader Header;
+		Header.m_Magic = CacheMagic;
+		Header.m_Version = CacheVersion;
+		Header.m_SourceHash = vSourceHash;
+		Header.m_Bounds = vMesh.m_Bounds;
+		for (const auto& Vertex : vMesh.m_Vertices)
+			Header.m_TexCoordBounds.expand(Vertex.m_TexCoord);
+		Header.m_VertexStride = sizeof(MeshVertex);
+		Header.m_AttributeCount = static_cast<uint32_t>(VertexLayout.size());
+		std::copy(VertexLayout.begin(), VertexLayout.end(), Header.m_Attributes);
+		// 压缩后不比原始数据小(例如很小的网格)时直接存原始数据
+		std::vector<uint8_t> EncodedVertices = MeshCodec::encodeVertices(vMesh.m_Vertices.data(), vMesh.m_Vertices.size(), sizeof(MeshVertex));
+		std::vector<uint8_t> EncodedIndices = MeshCodec::encodeIndices(vMesh.m_Indices);
+		const void* VertexData = vMesh.m_Vertices.data();
+		const void* IndexData = vMesh.m_Indices.data();
+		Header.m_VertexCount = vMesh.m_Vertices.size();
+		Header.m_VertexOffset = alignUp(sizeof(MeshCacheHeader), StreamAlignment);
+		Header.m_VertexDataSize = Header.m_VertexCount * Header.m_VertexStride;
+		if (EncodedVertices.size() < Header.m_VertexDataSize) {
+			Header.m_VertexEncoding = MeshStreamEncoding::Codec;
+			Header.m_VertexDataSize = EncodedVertices.size();
+			VertexData = EncodedVertices.data();
+		}
+		Header.m_IndexCount = vMesh.m_Indices.size();
+		Header.m_IndexSize = sizeof(uint32_t);
+		Header.m_IndexOffset = alignUp(Header.m_VertexOffset + Header.m_VertexDataSize, StreamAlignment);
+		Header.m_IndexDataSize = Header.m_IndexCount * Header.m_IndexSize;
+		if (EncodedIndices.size() < Header.m_IndexDataSize) {
+			Header.m_IndexEncoding = MeshStreamEncoding::Codec;
+			Header.m_IndexDataSize = EncodedIndices.size();
+			IndexData = EncodedIndices.data();
+		}
+		const MeshletData& Meshlets = vMesh.m_Meshlets;
+		if (Meshlets.m_Bounds.size() != Meshlets.m_Meshlets.size())
+			throw std::runtime_error("Failed to store mesh cache with mismatched meshlet bounds!");
+		Header.m_MeshletCount = Meshlets.m_Meshlets.size();
+		Header.m_MeshletOffset = alignUp(Header.m_IndexOffset + Header.m_IndexDataSize, StreamAlignment);
+		Header.m_MeshletBoundsOffset = alignUp(Header.m_MeshletOffset + Header.m_MeshletCount * sizeof(Meshlet), StreamAlignment);
+		Header.m_MeshletVertexCount = Meshlets.m_Vertices.size();
+		Header.m_MeshletVertexOffset = alignUp(Header.m_MeshletBoundsOffset + Header.m_MeshletCount * sizeof(MeshletBounds), StreamAlignment);
+		Header.m_MeshletTriangleSize = Meshlets.m_Triangles.size();
+		Header.m_MeshletTriangleOffset = alignUp(Header.m_MeshletVertexOffset + Header.m_MeshletVertexCount * sizeof(uint32_t), StreamAlignment);
+		if (vMesh.m_Lods.size() > MeshLod::MaxCount)
+			throw std::runtime_error("Failed to store mesh cache with too many LODs!");
+		if (vMesh.m_Lods.empty()) {
+			Header.m_LodCount = 1;
+			Header.m_Lods[0] = { 0, static_cast<uint32_t>(vMesh.m_Indices.size()), 0.0f };
+		}
+		else {
+			Header.m_LodCount = static_cast<uint32_t>(vMesh.m_Lods.size());
+			std::copy(vMesh.m_Lods.begin(), vMesh.m_Lods.end(), Header.m_Lods);
+		}
+
+		std::filesystem::path TempPath = makeTempPath(CachePath);
+		try {
+			std::ofstream OutFileStream(TempPath, std::ios_base::binary | std::ios_base::trunc);
+			if (!OutFileStream)
+				throw std::runtime_error(std::format(R"(Fail to open the file at "{0}".)", TempPath.string()));
+			// 每个流之前补零到它的偏移处
+			uint64_t Position = 0;
+			auto writeStream = [&](uint64_t vOffset, const void* vData, uint64_t vSize) {
+				const char Padding[StreamAlignment]{};
+				OutFileStream.write(Padding, static_cast<std::streamsize>(vOffset - Position));
+				OutFileStream.write(reinterpret_cast<const char*>(vData), static_cast<std::streamsize>(vSize));
+				Position = vOffset + vSize;
+			};
+			writeStream(0, &Header, sizeof(Header));
+			writeStream(Header.m_VertexOffset, VertexData, Header.m_VertexDataSize);
+			writeStream(Header.m_IndexOffset, IndexData, Header.m_IndexDataSize);
+			writeStream(Header.m_MeshletOffset, Meshlets.m_Meshlets.data(), Meshlets.m_Meshlets.size() * sizeof(Meshlet));
+			writeStream(Header.m_MeshletBoundsOffset, Meshlets.m_Bounds.data(), Meshlets.m_Bounds.size() * sizeof(MeshletBounds));
+			writeStream(Header.m_MeshletVertexOffset, Meshlets.m_Vertices.data(), Meshlets.m_Vertices.size() * sizeof(uint32_t));
+			writeStream(Header.m_MeshletTriangleOffset, Meshlets.m_Triangles.data(), Meshlets.m_Triangles.size());
+			if (!OutFileStream)
+				throw std::runtime_error(std::format(R"(Fail to write the file at "{0}".)", TempPath.string()));
+			OutFileStream.close();
+			std::filesystem::rename(TempPath, CachePath);
+		}
+		catch (const std::filesystem::filesystem_error&) {
+			std::filesystem::remove(TempPath, ErrorCode);
+			// 另一个进程同时导入了同一文件并已写好缓存，正被映射的文件在Windows上不能被替换
+			if (!std::filesystem::exists(CachePath))
+				throw;
+		}
+		catch (...) {
+			std::filesystem::remove(TempPath, ErrorCode);
+			throw;
+		}
+		return Header;
+	}
+
+}
@@ -0,0 +1,126 @@
+#pragma once
+#include "MappedFile.h"
+#include "MeshCodec.h"
+#include "Mesh.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <span>
+
+namespace VulkanTutorial {
+
+	enum class MeshAttributeSemantic : uint32_t
+	{
+		Position = 0,
+		Normal,
+		TexCoord,
+		Color
+	};
+
+	enum class MeshStreamEncoding : uint32_t
+	{
+		Raw = 0,
+		Codec       // MeshCodec压缩，只在比原始数据小时使用
+	};
+
+	struct MeshAttributeDesc
+	{
+		MeshAttributeSemantic m_Semantic = MeshAttributeSemantic::Position;
+		VkFormat m_Format = VK_FORMAT_UNDEFINED;
+		uint32_t m_Offset = 0;
+	};
+
+	// 缓存文件头，紧接着是按StreamAlignment对齐的顶点流、索引流(依次存放各级LOD)和LOD 0的meshlet各数组。
+	// 顶点流和索引流可以是压缩过的，m_VertexDataSize/m_IndexDataSize是它们在文件中的字节数
+	struct MeshCacheHeader
+	{
+		static constexpr uint32_t MaxAttributeCount = 8;
+
+		uint32_t m_Magic = 0;
+		uint32_t m_Version = 0;
+		uint64_t m_SourceHash = 0;
+		MeshBounds m_Bounds;
+		TexCoordBounds m_TexCoordBounds;
+		uint32_t m_VertexStride = 0;
+		uint32_t m_AttributeCount = 0;
+		MeshAttributeDesc m_Attributes[MaxAttributeCount]{};
+		uint64_t m_VertexCount = 0;
+		uint64_t m_VertexOffset = 0;
+		uint64_t m_VertexDataSize = 0;
+		MeshStreamEncoding m_VertexEncoding = MeshStreamEncoding::Raw;
+		MeshStreamEncoding m_IndexEncoding = MeshStreamEncoding::Raw;
+		uint64_t m_IndexCount = 0;
+		uint64_t m_IndexOffset = 0;
+		uint64_t m_IndexDataSize = 0;
+		uint32_t m_IndexSize = 0;
+		uint32_t m_LodCount = 0;
+		MeshLod m_Lods[MeshLod::MaxCount]{};   // 索引流中各级LOD的区间
+		uint64_t m_MeshletCount = 0;
+		uint64_t m_MeshletOffset = 0;
+		uint64_t m_MeshletBoundsOffset = 0;
+		uint64_t m_MeshletVertexCount = 0;
+		uint64_t m_MeshletVertexOffset = 0;
+		uint64_t m_MeshletTriangleSize = 0;     // 字节数
+		uint64_t m_MeshletTriangleOffset = 0;
+	};
+
+	// 只读映射的缓存文件，顶点/索引流直接解码(或memcpy)到调用者给出的内存，例如映射着的staging buffer
+	class MeshCacheFile
+	{
+	public:
+		using VertexStreamBlockCallback = std::function<void(size_t vBase, std::span<const MeshPositionVertex> vPositions, std::span<const MeshAttributeVertex> vAttributes)>;
+
+		MeshCacheFile() = default;
+		MeshCacheFile(MeshCacheFile&& vOther) noexcept;
+		MeshCacheFile& operator=(MeshCacheFile&& vOther) noexcept;
+
+		bool open(const std::filesystem::path& vPath, uint64_t vSourceHash);  // 文件损坏或过期时返回false
+		void close();
+
+		inline bool isOpen() const { return m_Header != nullptr; }
+		inline const MeshCacheHeader& getHeader() const { return *m_Header; }
+		inline const MeshBounds& getBounds() const { return m_Header->m_Bounds; }
+		inline const TexCoordBounds& getTexCoordBounds() const { return m_Header->m_TexCoordBounds; }
+		inline std::span<const MeshLod> getLods() const { return { m_Header->m_Lods, m_Header->m_LodCount }; }
+		inline size_t getVertexCount() const { return m_Header->m_VertexCount; }
+		inline size_t getIndexCount() const { return m_Header->m_IndexCount; }
+		void decodeVertices(std::span<MeshVertex> vVertices) const;
+		void decodeVertexStreams(std::span<MeshPositionVertex> vPositions, std::span<MeshAttributeVertex> vAttributes) const;  // 直接解码成拆分后的两个顶点流
+		// 每次解码MeshCodec::VertexBlockSize个顶点到内部的小块内存，依次交给vOnBlock，vBase是块中第一个顶点的序号
+		void decodeVertexStreamBlocks(const VertexStreamBlockCallback& vOnBlock) const;
+		void decodeIndices(std::span<uint32_t> vIndices) const;
+		std::span<const Meshlet> getMeshlets() const;
+		std::span<const MeshletBounds> getMeshletBounds() const;
+		std::span<const uint32_t> getMeshletVertices() const;
+		std::span<const uint8_t> getMeshletTriangles() const;
+
+		Mesh toMesh() const;
+	private:
+		std::span<const uint8_t> getStreamData(uint64_t vOffset, uint64_t vSize) const;
+		void decodeVertices(std::span<const VertexChannel> vChannels) const;
+
+		MappedFile m_File;
+		const MeshCacheHeader* m_Header = nullptr;
+	};
+
+	// 以源文件内容哈希为键的二进制网格缓存：首次导入后写入，之后直接映射，不再解析和去重
+	class MeshCache
+	{
+	public:
+		explicit MeshCache(const std::filesystem::path& vCacheDirectory);
+
+		static uint64_t hashSource(const std::filesystem::path& vSourcePath, std::span<const std::filesystem::path> vDependencies = {});  // vDependencies: 外部buffer等引用的文件
+		static std::span<const MeshAttributeDesc> getVertexLayout();  // 当前MeshVertex的布局，与缓存中的不一致即视为过期
+
+		std::filesystem::path getCachePath(const std::filesystem::path& vSourcePath, uint64_t vSourceHash) const;
+		bool load(const std::filesystem::path& vSourcePath, uint64_t vSourceHash, MeshCacheFile& vFile) const;
+		MeshCacheHeader store(const std::filesystem::path& vSourcePath, uint64_t vSourceHash, const Mesh& vMesh) const;  // 返回写入的文件头，可以从中得到压缩后的大小
+	private:
+		std::filesystem::path m_CacheDirectory;
+	};
+
+}
@@ -0,0 +1,396 @@
+#include "MeshCodec.h"
+
+#include <algorithm>
+#include <array>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VK_TUTORIAL_MESH_CODEC_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr size_t BlockVertexCount = MeshCodec::VertexBlockSize;
+		constexpr size_t GroupSize = 16;
+		constexpr size_t PlaneCount = 4;  // 每个32位通道拆成4个字节平面
+		constexpr std::array<size_t, 4> GroupPayloadSizes{ 0, 4, 8, 16 };  // 每组16个字节分别按0/2/4/8位存放
+
+		constexpr uint32_t FifoSize = 16;
+		constexpr uint32_t EdgeFifoReach = 15;    // 编码字节高4位0~14引用最近的边，15表示没有共享边
+		constexpr uint32_t VertexFifoReach = 14;  // 低4位1~14引用最近的顶点
+		constexpr uint8_t NextVertexCode = 0;
+		constexpr uint8_t ExplicitVertexCode = 15;
+		constexpr uint8_t EdgeMissCode = 0xF0;    // 低3位标记三个顶点中哪些是下一个新顶点，其余显式存放
+
+		inline uint32_t zigzag(uint32_t vValue) { return (vValue << 1) ^ (0u - (vValue >> 31)); }
+		inline uint32_t unzigzag(uint32_t vValue) { return (vValue >> 1) ^ (0u - (vValue & 1)); }
+
+		inline uint32_t getGroupMode(const uint8_t* vHeader, size_t vGroup) { return (vHeader[vGroup / 4] >> ((vGroup % 4) * 2)) & 3; }
+
+		void encodePlane(std::vector<uint8_t>& vOutput, const uint8_t* vPlane, size_t vGroupCount)
+		{
+			size_t HeaderOffset = vOutput.size();
+			vOutput.resize(HeaderOffset + (vGroupCount + 3) / 4, 0);
+			for (size_t g = 0; g < vGroupCount; ++g) {
+				const uint8_t* Group = vPlane + g * GroupSize;
+				uint8_t Max = *std::max_element(Group, Group + GroupSize);
+				uint32_t Mode = Max == 0 ? 0 : Max < 4 ? 1 : Max < 16 ? 2 : 3;
+				vOutput[HeaderOffset + g / 4] |= static_cast<uint8_t>(Mode << ((g % 4) * 2));
+				// 第j个字节存放第j、j+4(、j+8、j+12)个值，解码时整个寄存器移位再掩码即可展开
+				if (Mode == 1) {
+					for (size_t j = 0; j < 4; ++j)
+						vOutput.push_back(static_cast<uint8_t>(Group[j] | Group[j + 4] << 2 | Group[j + 8] << 4 | Group[j + 12] << 6));
+				}
+				else if (Mode == 2) {
+					for (size_t j = 0; j < 8; ++j)
+						vOutput.push_back(static_cast<uint8_t>(Group[j] | Group[j + 8] << 4));
+				}
+				else if (Mode == 3)
+					vOutput.insert(vOutput.end(), Group, Group + GroupSize);
+			}
+		}
+
+		const uint8_t* decodePlane(const uint8_t* vCursor, const uint8_t* vEnd, uint8_t* vPlane, size_t vGroupCount)
+		{
+			const uint8_t* Header = vCursor;
+			size_t HeaderSize = (vGroupCount + 3) / 4;
+			if (static_cast<size_t>(vEnd - vCursor) < HeaderSize)
+				throw std::runtime_error("Failed to decode truncated vertices!");
+			vCursor += HeaderSize;
+			size_t PayloadSize = 0;
+			for (size_t g = 0; g < vGroupCount; ++g)
+				PayloadSize += GroupPayloadSizes[getGroupMode(Header, g)];
+			if (static_cast<size_t>(vEnd - vCursor) < PayloadSize)
+				throw std::runtime_error("Failed to decode truncated vertices!");
+
+			for (size_t g = 0; g < vGroupCount; ++g) {
+				uint32_t Mode = getGroupMode(Header, g);
+				uint8_t* Group = vPlane + g * GroupSize;
+#ifdef VK_TUTORIAL_MESH_CODEC_SSE2
+				__m128i Result;
+				if (Mode == 0)
+					Result = _mm_setzero_si128();
+				else if (Mode == 1) {
+					int32_t Packed;
+					std::memcpy(&Packed, vCursor, sizeof(Packed));
+					__m128i Bits = _mm_cvtsi32_si128(Packed);
+					__m128i Mask = _mm_set1_epi8(3);
+					Result = _mm_and_si128(Bits, Mask);
+					Result = _mm_or_si128(Result, _mm_slli_si128(_mm_and_si128(_mm_srli_epi32(Bits, 2), Mask), 4));
+					Result = _mm_or_si128(Result, _mm_slli_si128(_mm_and_si128(_mm_srli_epi32(Bits, 4), Mask), 8));
+					Result = _mm_or_si128(Result, _mm_slli_si128(_mm_and_si128(_mm_srli_epi32(Bits, 6), Mask), 12));
+				}
+				else if (Mode == 2) {
+					__m128i Bits = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(vCursor));
+					__m128i Mask = _mm_set1_epi8(15);
+					Result = _mm_unpacklo_epi64(_mm_and_si128(Bits, Mask), _mm_and_si128(_mm_srli_epi16(Bits, 4), Mask));
+				}
+				else
+					Result = _mm_loadu_si128(reinterpret_cast<const __m128i*>(vCursor));
+				_mm_store_si128(reinterpret_cast<__m128i*>(Group), Result);
+#else
+				if (Mode == 0)
+					std::memset(Group, 0, GroupSize);
+				else if (Mode == 1) {
+					for (size_t j = 0; j < 4; ++j)
+						for (size_t k = 0; k < 4; ++k)
+							Group[k * 4 + j] = (vCursor[j] >> (k * 2)) & 3;
+				}
+				else if (Mode == 2) {
+					for (size_t j = 0; j < 8; ++j) {
+						Group[j] = vCursor[j] & 15;
+						Group[j + 8] = vCursor[j] >> 4;
+					}
+				}
+				else
+					std::memcpy(Group, vCursor, GroupSize);
+#endif
+				vCursor += GroupPayloadSizes[Mode];
+			}
+			return vCursor;
+		}
+
+		// 4个字节平面拼回32位，还原zigzag后沿顶点方向做前缀和，vLast是上一个顶点的值
+		void reconstructChannel(const uint8_t (&vPlanes)[PlaneCount][BlockVertexCount], size_t vGroupCount, uint32_t& vLast, uint32_t* vValues)
+		{
+#ifdef VK_TUTORIAL_MESH_CODEC_SSE2
+			const __m128i One = _mm_set1_epi32(1);
+			__m128i Last = _mm_set1_epi32(static_cast<int32_t>(vLast));
+			for (size_t g = 0; g < vGroupCount; ++g) {
+				__m128i P0 = _mm_load_si128(reinterpret_cast<const __m128i*>(vPlanes[0] + g * GroupSize));
+				__m128i P1 = _mm_load_si128(reinterpret_cast<const __m128i*>(vPlanes[1] + g * GroupSize));
+				__m128i P2 = _mm_load_si128(reinterpret_cast<const __m128i*>(vPlanes[2] + g * GroupSize));
+				__m128i P3 = _mm_load_si128(reinterpret_cast<const __m128i*>(vPlanes[3] + g * GroupSize));
+				__m128i Low01 = _mm_unpacklo_epi8(P0, P1), High01 = _mm_unpackhi_epi8(P0, P1);
+				__m128i Low23 = _mm_unpacklo_epi8(P2, P3), High23 = _mm_unpackhi_epi8(P2, P3);
+				__m128i Deltas[4]{
+					_mm_unpacklo_epi16(Low01, Low23), _mm_unpackhi_epi16(Low01, Low23),
+					_mm_unpacklo_epi16(High01, High23), _mm_unpackhi_epi16(High01, High23)
+				};
+				for (size_t k = 0; k < 4; ++k) {
+					__m128i Value = _mm_xor_si128(_mm_srli_epi32(Deltas[k], 1), _mm_sub_epi32(_mm_setzero_si128(), _mm_and_si128(Deltas[k], One)));
+					Value = _mm_add_epi32(Value, _mm_slli_si128(Value, 4));
+					Value = _mm_add_epi32(Value, _mm_slli_si128(Value, 8));
+					Value = _mm_add_epi32(Value, Last);
+					Last = _mm_shuffle_epi32(Value, _MM_SHUFFLE(3, 3, 3, 3));
+					_mm_store_si128(reinterpret_cast<__m128i*>(vValues + g * GroupSize + k * 4), Value);
+				}
+			}
+			vLast = static_cast<uint32_t>(_mm_cvtsi128_si32(Last));
+#else
+			for (size_t i = 0; i < vGroupCount * GroupSize; ++i) {
+				uint32_t Delta = vPlanes[0][i] | vPlanes[1][i] << 8 | vPlanes[2][i] << 16 | static_cast<uint32_t>(vPlanes[3][i]) << 24;
+				vLast += unzigzag(Delta);
+				vValues[i] = vLast;
+			}
+#endif
+		}
+
+		// vIsBlockLocal为true时每块都从vChannels的起始处写，块写完后调用vOnBlock；否则按顶点的全局序号写
+		template<typename OnBlock>
+		void decodeVertexStream(std::span<const uint8_t> vEncoded, size_t vVertexCount, std::span<const VertexChannel> vChannels, bool vIsBlockLocal, const OnBlock& vOnBlock)
+		{
+			uint32_t ChannelCount = 0;
+			if (vEncoded.size() < sizeof(ChannelCount))
+				throw std::runtime_error("Failed to decode truncated vertices!");
+			std::memcpy(&ChannelCount, vEncoded.data(), sizeof(ChannelCount));
+			if (ChannelCount != vChannels.size())
+				throw std::runtime_error("Failed to decode vertices with mismatched channels!");
+			const uint8_t* Cursor = vEncoded.data() + sizeof(ChannelCount);
+			const uint8_t* End = vEncoded.data() + vEncoded.size();
+
+			std::vector<uint32_t> Last(ChannelCount, 0);
+			alignas(16) uint8_t Planes[PlaneCount][BlockVertexCount];
+			alignas(16) uint32_t Values[BlockVertexCount];
+			for (size_t Base = 0; Base < vVertexCount; Base += BlockVertexCount) {
+				size_t Count = std::min(BlockVertexCount, vVertexCount - Base);
+				size_t GroupCount = (Count + GroupSize - 1) / GroupSize;
+				for (size_t c = 0; c < ChannelCount; ++c) {
+					for (size_t k = 0; k < PlaneCount; ++k)
+						Cursor = decodePlane(Cursor, End, Planes[k], GroupCount);
+					reconstructChannel(Planes, GroupCount, Last[c], Values);
+					std::byte* Target = vChannels[c].m_Data + (vIsBlockLocal ? 0 : Base) * vChannels[c].m_Stride;
+					for (size_t i = 0; i < Count; ++i, Target += vChannels[c].m_Stride)
+						std::memcpy(Target, &Values[i], sizeof(uint32_t));
+				}
+				vOnBlock(Base, Count);
+			}
+			if (Cursor != End)
+				throw std::runtime_error("Failed to decode vertices with trailing data!");
+		}
+
+		void writeVarint(std::vector<uint8_t>& vOutput, uint32_t vValue)
+		{
+			while (vValue >= 0x80) {
+				vOutput.push_back(static_cast<uint8_t>(vValue | 0x80));
+				vValue >>= 7;
+			}
+			vOutput.push_back(static_cast<uint8_t>(vValue));
+		}
+
+		uint32_t readVarint(const uint8_t*& vCursor, const uint8_t* vEnd)
+		{
+			uint32_t Result = 0;
+			for (uint32_t Shift = 0; Shift < 35; Shift += 7) {
+				if (vCursor == vEnd)
+					throw std::runtime_error("Failed to decode truncated indices!");
+				uint8_t Byte = *vCursor++;
+				Result |= static_cast<uint32_t>(Byte & 0x7F) << Shift;
+				if ((Byte & 0x80) == 0)
+					return Result;
+			}
+			throw std::runtime_error("Failed to decode indices with invalid varint!");
+		}
+
+		// 编码和解码维护完全相同的状态：最近的边和顶点各一个环形队列，加上下一个新顶点和上一个显式顶点
+		struct IndexCodecState
+		{
+			std::array<std::array<uint32_t, 2>, FifoSize> m_Edges;
+			std::array<uint32_t, FifoSize> m_Vertices;
+			uint32_t m_EdgeHead = 0;
+			uint32_t m_VertexHead = 0;
+			uint32_t m_Next = 0;
+			uint32_t m_Last = 0;
+
+			IndexCodecState()
+			{
+				m_Edges.fill({ UINT32_MAX, UINT32_MAX });
+				m_Vertices.fill(UINT32_MAX);
+			}
+
+			inline const std::array<uint32_t, 2>& getEdge(uint32_t vAge) const { return m_Edges[(m_EdgeHead - 1 - vAge) % FifoSize]; }
+			inline uint32_t getVertex(uint32_t vAge) const { return m_Vertices[(m_VertexHead - 1 - vAge) % FifoSize]; }
+			inline void pushVertex(uint32_t vVertex) { m_Vertices[m_VertexHead++ % FifoSize] = vVertex; }
+			inline void observe(uint32_t vVertex) { m_Next += vVertex == m_Next; }
+
+			// 相邻三角形以相反方向经过共享边，所以存入反向的边，新三角形可以直接按自身的边查找
+			inline void pushTriangle(uint32_t vA, uint32_t vB, uint32_t vC)
+			{
+				m_Edges[m_EdgeHead++ % FifoSize] = { vB, vA };
+				m_Edges[m_EdgeHead++ % FifoSize] = { vC, vB };
+				m_Edges[m_EdgeHead++ % FifoSize] = { vA, vC };
+			}
+		};
+
+	}
+
+	std::vector<uint8_t> MeshCodec::encodeVertices(const void* vVertices, size_t vVertexCount, size_t vVertexStride)
+	{
+		if (vVertexStride == 0 || vVertexStride % 4 != 0)
+			throw std::runtime_error("Failed to encode vertices with invalid stride!");
+		const size_t ChannelCount = vVertexStride / 4;
+		const std::byte* Vertices = static_cast<const std::byte*>(vVertices);
+		std::vector<uint8_t> Result(sizeof(uint32_t));
+		uint32_t StoredChannelCount = static_cast<uint32_t>(ChannelCount);
+		std::memcpy(Result.data(), &StoredChannelCount, sizeof(StoredChannelCount));
+		Result.reserve(vVertexCount * vVertexStride / 2);
+
+		std::vector<uint32_t> Last(ChannelCount, 0);
+		alignas(16) uint8_t Planes[PlaneCount][BlockVertexCount];
+		for (size_t Base = 0; Base < vVertexCount; Base += BlockVertexCount) {
+			size_t Count = std::min(BlockVertexCount, vVertexCount - Base);
+			size_t GroupCount = (Count + GroupSize - 1) / GroupSize;
+			for (size_t c = 0; c < ChannelCount; ++c) {
+				std::memset(Planes, 0, sizeof(Planes));  // 末尾不满一组的部分差分为0，解码时前缀和不受影响
+				for (size_t i = 0; i < Count; ++i) {
+					uint32_t Value;
+					std::memcpy(&Value, Vertices + (Base + i) * vVertexStride + c * 4, sizeof(Value));
+					uint32_t Delta = zigzag(Value - Last[c]);
+					Last[c] = Value;
+					for (size_t k = 0; k < PlaneCount; ++k)
+						Planes[k][i] = static_cast<uint8_t>(Delta >> (k * 8));
+				}
+				for (size_t k = 0; k < PlaneCount; ++k)
+					encodePlane(Result, Planes[k], GroupCount);
+			}
+		}
+		return Result;
+	}
+
+	void MeshCodec::decodeVertices(std::span<const uint8_t> vEncoded, size_t vVertexCount, std::span<const VertexChannel> vChannels)
+	{
+		decodeVertexStream(vEncoded, vVertexCount, vChannels, false, [](size_t, size_t) {});
+	}
+
+	void MeshCodec::decodeVertexBlocks(std::span<const uint8_t> vEncoded, size_t vVertexCount, std::span<const VertexChannel> vChannels, const VertexBlockCallback& vOnBlock)
+	{
+		decodeVertexStream(vEncoded, vVertexCount, vChannels, true, vOnBlock);
+	}
+
+	std::vector<uint8_t> MeshCodec::encodeIndices(std::span<const uint32_t> vIndices)
+	{
+		if (vIndices.size() % 3 != 0)
+			throw std::runtime_error("Failed to encode indices which are not a triangle list!");
+		const size_t TriangleCount = vIndices.size() / 3;
+		std::vector<uint8_t> Result(TriangleCount);  // 先是每个三角形一个编码字节，之后是显式顶点的varint
+		IndexCodecState State;
+		auto writeExplicit = [&](uint32_t vVertex) {
+			writeVarint(Result, zigzag(vVertex - State.m_Last));
+			State.m_Last = vVertex;
+		};
+		auto getVertexCode = [&](uint32_t vVertex) -> uint8_t {
+			if (vVertex == State.m_Next)
+				return NextVertexCode;
+			for (uint32_t Age = 0; Age < VertexFifoReach; ++Age) {
+				if (State.getVertex(Age) == vVertex)
+					return static_cast<uint8_t>(Age + 1);
+			}
+			return ExplicitVertexCode;
+		};
+
+		for (size_t t = 0; t < TriangleCount; ++t) {
+			const uint32_t* Triangle = &vIndices[t * 3];
+			// 三种轮换中找共享边的，优先第三个顶点是新顶点，其次是最近用过的
+			int BestRotation = -1;
+			uint8_t BestCode = 0;
+			for (int r = 0; r < 3; ++r) {
+				std::array<uint32_t, 2> Edge{ Triangle[r], Triangle[(r + 1) % 3] };
+				for (uint32_t Age = 0; Age < EdgeFifoReach; ++Age) {
+					if (State.getEdge(Age) != Edge)
+						continue;
+					uint8_t VertexCode = getVertexCode(Triangle[(r + 2) % 3]);
+					if (BestRotation < 0 || VertexCode < (BestCode & 15)) {
+						BestRotation = r;
+						BestCode = static_cast<uint8_t>(Age << 4 | VertexCode);
+					}
+					break;
+				}
+			}
+
+			if (BestRotation >= 0) {
+				uint32_t A = Triangle[BestRotation], B = Triangle[(BestRotation + 1) % 3], C = Triangle[(BestRotation + 2) % 3];
+				uint8_t VertexCode = BestCode & 15;
+				Result[t] = BestCode;
+				if (VertexCode == ExplicitVertexCode)
+					writeExplicit(C);
+				if (VertexCode == NextVertexCode || VertexCode == ExplicitVertexCode)
+					State.pushVertex(C);
+				State.observe(C);
+				State.pushTriangle(A, B, C);
+				continue;
+			}
+			uint8_t Flags = 0;
+			for (uint32_t k = 0; k < 3; ++k) {
+				if (Triangle[k] == State.m_Next)
+					Flags |= static_cast<uint8_t>(1u << k);
+				else
+					writeExplicit(Triangle[k]);
+				State.observe(Triangle[k]);
+				State.pushVertex(Triangle[k]);
+			}
+			Result[t] = EdgeMissCode | Flags;
+			State.pushTriangle(Triangle[0], Triangle[1], Triangle[2]);
+		}
+		return Result;
+	}
+
+	void MeshCodec::decodeIndices(std::span<const uint8_t> vEncoded, std::span<uint32_t> vIndices)
+	{
+		if (vIndices.size() % 3 != 0)
+			throw std::runtime_error("Failed to decode indices which are not a triangle list!");
+		const size_t TriangleCount = vIndices.size() / 3;
+		if (vEncoded.size() < TriangleCount)
+			throw std::runtime_error("Failed to decode truncated indices!");
+		const uint8_t* Codes = vEncoded.data();
+		const uint8_t* Cursor = Codes + TriangleCount;
+		const uint8_t* End = vEncoded.data() + vEncoded.size();
+		IndexCodecState State;
+		auto readExplicit = [&]() {
+			State.m_Last += unzigzag(readVarint(Cursor, End));
+			return State.m_Last;
+		};
+
+		for (size_t t = 0; t < TriangleCount; ++t) {
+			uint8_t Code = Codes[t];
+			uint32_t* Triangle = &vIndices[t * 3];
+			if (Code < EdgeMissCode) {
+				std::array<uint32_t, 2> Edge = State.getEdge(Code >> 4);
+				uint8_t VertexCode = Code & 15;
+				uint32_t C = VertexCode == NextVertexCode ? State.m_Next : VertexCode == ExplicitVertexCode ? readExplicit() : State.getVertex(VertexCode - 1);
+				if (VertexCode == NextVertexCode || VertexCode == ExplicitVertexCode)
+					State.pushVertex(C);
+				State.observe(C);
+				Triangle[0] = Edge[0];
+				Triangle[1] = Edge[1];
+				Triangle[2] = C;
+			}
+			else {
+				if (Code > (EdgeMissCode | 7))
+					throw std::runtime_error("Failed to decode indices with invalid code!");
+				for (uint32_t k = 0; k < 3; ++k) {
+					Triangle[k] = (Code >> k) & 1 ? State.m_Next : readExplicit();
+					State.observe(Triangle[k]);
+					State.pushVertex(Triangle[k]);
+				}
+			}
+			State.pushTriangle(Triangle[0], Triangle[1], Triangle[2]);
+		}
+		if (Cursor != End)
+			throw std::runtime_error("Failed to decode indices with trailing data!");
+	}
+
+}
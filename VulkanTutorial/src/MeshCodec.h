@@ -0,0 +1,38 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 解码输出的一个32位通道：第i个顶点的该通道写到m_Data + i * m_Stride
+	struct VertexChannel
+	{
+		std::byte* m_Data = nullptr;
+		size_t m_Stride = 0;
+	};
+
+	// 网格缓存使用的压缩编码。
+	// 顶点：每256个顶点一块，每个32位通道与上一个顶点做差分后zigzag，再拆成4个字节平面，
+	// 平面内每16字节一组按0/2/4/8位宽存放，解码时用SSE2整组展开、拼回32位并做前缀和。
+	// 索引：逐三角形编码，与最近的边共享两个顶点时整个三角形只占一个字节，第三个顶点多数是下一个新顶点或最近用过的顶点。
+	// 编码时三角形的顶点可能被轮换(绕序不变)，解码出的索引与原始索引画出的三角形相同
+	class MeshCodec
+	{
+	public:
+		static constexpr size_t VertexBlockSize = 256;
+		using VertexBlockCallback = std::function<void(size_t vBase, size_t vCount)>;
+
+		static std::vector<uint8_t> encodeVertices(const void* vVertices, size_t vVertexCount, size_t vVertexStride);  // vVertexStride须是4的倍数
+		static void decodeVertices(std::span<const uint8_t> vEncoded, size_t vVertexCount, std::span<const VertexChannel> vChannels);
+		// 逐块解码：vChannels只需容纳一块，第vBase + i个顶点写到m_Data + i * m_Stride，每块写完后调用vOnBlock。
+		// 调用者可以在缓存中的小块内存上继续处理(例如量化)，不必为整个网格分配中间数组
+		static void decodeVertexBlocks(std::span<const uint8_t> vEncoded, size_t vVertexCount, std::span<const VertexChannel> vChannels, const VertexBlockCallback& vOnBlock);
+
+		static std::vector<uint8_t> encodeIndices(std::span<const uint32_t> vIndices);
+		static void decodeIndices(std::span<const uint8_t> vEncoded, std::span<uint32_t> vIndices);
+	};
+
+}
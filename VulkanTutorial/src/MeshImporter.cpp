@@ -0,0 +1,147 @@
+#include "MeshImporter.h"
+#include "GltfLoader.h"
+#include "Hash.h"
+#include "MeshOptimizer.h"
+#include "MeshletBuilder.h"
+#include "MeshSimplifier.h"
+#include "ObjLoader.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <cctype>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		// 扩展名不区分大小写，Windows上导出的"Model.OBJ"、"scene.GLB"很常见
+		std::string getLowerExtension(const std::filesystem::path& vPath)
+		{
+			std::string Extension = vPath.extension().string();
+			std::transform(Extension.begin(), Extension.end(), Extension.begin(), [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+			return Extension;
+		}
+
+	}
+
+	Mesh MeshImporter::import(const std::filesystem::path& vPath, const MeshImportOptions& vOptions, const std::filesystem::path& vCacheDirectory)
+	{
+		std::cout << std::format(R"(Try to import mesh "{0}" ...)", vPath.string()) << "\n";
+		MeshCache Cache(vCacheDirectory);
+		Timer HashTimer;
+		uint64_t SourceHash = hashSource(vPath, vOptions);
+		float HashMilliseconds = HashTimer.ellapseMilliseconds();
+
+		Mesh Result;
+		MeshCacheFile CacheFile;
+		if (Cache.load(vPath, SourceHash, CacheFile)) {
+			Timer LoadTimer;
+			Result = CacheFile.toMesh();
+			float LoadMilliseconds = LoadTimer.ellapseMilliseconds();
+			// 吞吐量按解码后的顶点和索引字节数计算
+			size_t DecodedBytes = Result.m_Vertices.size() * sizeof(MeshVertex) + Result.m_Indices.size() * sizeof(uint32_t);
+			std::cout << std::format("\tcache hit: hash {0:.2f} ms, load {1:.2f} ms, decode {2:.0f} MB/s ({3} vertices, {4} triangles)\n",
+				HashMilliseconds, LoadMilliseconds, computeMegabytesPerSecond(DecodedBytes, LoadMilliseconds), Result.m_Vertices.size(), Result.getLodIndices(0).size() / 3);
+			std::cout << std::format("\t{0} LODs, coarsest {1} triangles\n", Result.getLodCount(), Result.getLodIndices(Result.getLodCount() - 1).size() / 3);
+			std::cout << std::format("\t{0} meshlets\n", Result.m_Meshlets.m_Meshlets.size());
+		}
+		else {
+			Result = parse(vPath, vOptions);
+			Timer StoreTimer;
+			MeshCacheHeader Header = Cache.store(vPath, SourceHash, Result);
+			std::cout << std::format("\tstore cache: {0:.2f} ms (vertices {1} -> {2} KB, indices {3} -> {4} KB)\n", StoreTimer.ellapseMilliseconds(),
+				Header.m_VertexCount * Header.m_VertexStride / 1024, Header.m_VertexDataSize / 1024, Header.m_IndexCount * Header.m_IndexSize / 1024, Header.m_IndexDataSize / 1024);
+		}
+		std::cout << std::format(R"(Success to import mesh "{0}" !)", vPath.string()) << "\n";
+		return Result;
+	}
+
+	MeshCacheFile MeshImporter::importMapped(const std::filesystem::path& vPath, const MeshImportOptions& vOptions, const std::filesystem::path& vCacheDirectory)
+	{
+		std::cout << std::format(R"(Try to import mesh "{0}" ...)", vPath.string()) << "\n";
+		MeshCache Cache(vCacheDirectory);
+		uint64_t SourceHash = hashSource(vPath, vOptions);
+		MeshCacheFile CacheFile;
+		if (!Cache.load(vPath, SourceHash, CacheFile)) {
+			Cache.store(vPath, SourceHash, parse(vPath, vOptions));
+			if (!Cache.load(vPath, SourceHash, CacheFile))
+				throw std::runtime_error(std::format(R"(Fail to load the mesh cache of "{0}".)", vPath.string()));
+		}
+		const MeshCacheHeader& Header = CacheFile.getHeader();
+		std::cout << std::format("\tmapped cache: {0} vertices in {1} KB, {2} indices in {3} KB\n",
+			Header.m_VertexCount, Header.m_VertexDataSize / 1024, Header.m_IndexCount, Header.m_IndexDataSize / 1024);
+		std::cout << std::format(R"(Success to import mesh "{0}" !)", vPath.string()) << "\n";
+		return CacheFile;
+	}
+
+	uint64_t MeshImporter::hashSource(const std::filesystem::path& vPath, const MeshImportOptions& vOptions)
+	{
+		std::string Extension = getLowerExtension(vPath);
+		uint64_t Hash = 0;
+		if (Extension == ".gltf" || Extension == ".glb")
+			Hash = MeshCache::hashSource(vPath, GltfLoader::getExternalBuffers(vPath));
+		else
+			Hash = MeshCache::hashSource(vPath);
+		return hashCombine(Hash, vOptions.m_IsOptimized ? 1 : 0);
+	}
+
+	Mesh MeshImporter::parse(const std::filesystem::path& vPath, const MeshImportOptions& vOptions)
+	{
+		std::string Extension = getLowerExtension(vPath);
+		if (Extension == ".gltf" || Extension == ".glb") {
+			Timer LoadTimer;
+			Mesh Result = GltfLoader::load(vPath);
+			std::cout << std::format("\tload glTF: {0:.2f} ms ({1} vertices, {2} triangles)\n", LoadTimer.ellapseMilliseconds(), Result.m_Vertices.size(), Result.m_Indices.size() / 3);
+			optimize(Result, vOptions);
+			buildLods(Result);
+			buildMeshlets(Result);
+			return Result;
+		}
+		if (Extension != ".obj")
+			throw std::runtime_error(std::format(R"(Unknown mesh format of "{0}".)", vPath.string()));
+
+		Timer ParseTimer;
+		ObjData Data = ObjLoader::load(vPath);
+		float ParseMilliseconds = ParseTimer.ellapseMilliseconds();
+		Timer BuildTimer;
+		Mesh Result = ObjLoader::buildMesh(Data);
+		float BuildMilliseconds = BuildTimer.ellapseMilliseconds();
+
+		std::cout << std::format("\tparse: {0:.2f} ms ({1} positions, {2} triangles)\n", ParseMilliseconds, Data.m_Positions.size(), Data.m_Indices.size() / 3);
+		std::cout << std::format("\tbuild: {0:.2f} ms ({1} unique vertices)\n", BuildMilliseconds, Result.m_Vertices.size());
+		optimize(Result, vOptions);
+		buildLods(Result);
+		buildMeshlets(Result);
+		return Result;
+	}
+
+	void MeshImporter::optimize(Mesh& vMesh, const MeshImportOptions& vOptions)
+	{
+		if (!vOptions.m_IsOptimized) {
+			std::cout << "\tskip optimize (--no-optimize)\n";
+			return;
+		}
+		MeshOptimizer::optimize(vMesh);
+	}
+
+	void MeshImporter::buildLods(Mesh& vMesh)
+	{
+		Timer LodTimer;
+		MeshSimplifier::buildLods(vMesh);
+		std::cout << std::format("\tbuild LODs: {0:.2f} ms\n", LodTimer.ellapseMilliseconds());
+	}
+
+	void MeshImporter::buildMeshlets(Mesh& vMesh)
+	{
+		Timer MeshletTimer;
+		vMesh.m_Meshlets = MeshletBuilder::build(vMesh.getLodIndices(0), vMesh.m_Vertices);
+		const MeshletData& Meshlets = vMesh.m_Meshlets;
+		size_t MeshletCount = std::max<size_t>(Meshlets.m_Meshlets.size(), 1);
+		std::cout << std::format("\tbuild meshlets: {0:.2f} ms ({1} meshlets, {2:.1f} vertices and {3:.1f} triangles on average)\n", MeshletTimer.ellapseMilliseconds(),
+			Meshlets.m_Meshlets.size(), static_cast<float>(Meshlets.m_Vertices.size()) / MeshletCount, static_cast<float>(Meshlets.getTriangleCount()) / MeshletCount);
+	}
+
+}
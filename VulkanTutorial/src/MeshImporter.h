@@ -0,0 +1,33 @@
+#pragma once
+#include "Mesh.h"
+#include "MeshCache.h"
+
+#include <filesystem>
+
+namespace VulkanTutorial {
+
+	// 影响导入结果的选项都参与缓存键，切换后重新导入而不是命中另一种设置的缓存
+	struct MeshImportOptions
+	{
+		bool m_IsOptimized = true;   // false时跳过MeshOptimizer，保留解析出的顶点和三角形顺序，用于对比优化的效果
+	};
+
+	// 网格导入流程：按扩展名选择解析器(.obj/.gltf/.glb)，输出可直接上传的Mesh(包含简化生成的LOD链和LOD 0的meshlet)，并打印每一步的耗时。
+	// 结果按源文件内容哈希写入二进制缓存，顶点/索引流经MeshCodec压缩，源文件不变时后续导入只是一次映射加解码
+	class MeshImporter
+	{
+	public:
+		static constexpr const char* DefaultCacheDirectory = "resources/meshes/cache";
+
+		static Mesh import(const std::filesystem::path& vPath, const MeshImportOptions& vOptions = {}, const std::filesystem::path& vCacheDirectory = DefaultCacheDirectory);
+		// 返回映射着的缓存文件，顶点/索引流可直接解码进staging buffer，不经过中间的Mesh
+		static MeshCacheFile importMapped(const std::filesystem::path& vPath, const MeshImportOptions& vOptions = {}, const std::filesystem::path& vCacheDirectory = DefaultCacheDirectory);
+	private:
+		static uint64_t hashSource(const std::filesystem::path& vPath, const MeshImportOptions& vOptions);
+		static Mesh parse(const std::filesystem::path& vPath, const MeshImportOptions& vOptions);
+		static void optimize(Mesh& vMesh, const MeshImportOptions& vOptions);
+		static void buildLods(Mesh& vMesh);
+		static void buildMeshlets(Mesh& vMesh);
+	};
+
+}
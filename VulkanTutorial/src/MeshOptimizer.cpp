@@ -0,0 +1,337 @@
+#include "MeshOptimizer.h"
+#include "Timer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t InvalidIndex = UINT32_MAX;
+
+		// 每个顶点相邻的三角形列表(CSR格式)
+		struct TriangleAdjacency
+		{
+			std::vector<uint32_t> m_Counts;
+			std::vector<uint32_t> m_Offsets;
+			std::vector<uint32_t> m_Triangles;
+
+			void build(std::span<const uint32_t> vIndices, size_t vVertexCount)
+			{
+				m_Counts.assign(vVertexCount, 0);
+				for (uint32_t Index : vIndices)
+					++m_Counts[Index];
+				m_Offsets.resize(vVertexCount + 1);
+				m_Offsets[0] = 0;
+				for (size_t i = 0; i < vVertexCount; ++i)
+					m_Offsets[i + 1] = m_Offsets[i] + m_Counts[i];
+				m_Triangles.resize(vIndices.size());
+				std::vector<uint32_t> Cursors(m_Offsets.begin(), m_Offsets.end() - 1);
+				for (size_t i = 0; i < vIndices.size(); ++i)
+					m_Triangles[Cursors[vIndices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+		};
+
+		constexpr uint32_t OverdrawResolution = 256;
+
+		// 带时间戳的FIFO缓存模拟，reset()相当于清空缓存
+		struct VertexCacheSimulator
+		{
+			std::vector<size_t> m_CacheTimes;
+			size_t m_Time;
+			uint32_t m_CacheSize;
+
+			VertexCacheSimulator(size_t vVertexCount, uint32_t vCacheSize) : m_CacheTimes(vVertexCount, 0), m_Time(vCacheSize + 1), m_CacheSize(vCacheSize) {}
+
+			inline uint32_t access(const uint32_t* vTriangle)
+			{
+				uint32_t Misses = 0;
+				for (size_t c = 0; c < 3; ++c) {
+					if (m_Time - m_CacheTimes[vTriangle[c]] > m_CacheSize) {
+						m_CacheTimes[vTriangle[c]] = m_Time++;
+						++Misses;
+					}
+				}
+				return Misses;
+			}
+
+			inline void reset() { m_Time += m_CacheSize + 1; }
+		};
+
+		void validateIndices(std::span<const uint32_t> vIndices, size_t vVertexCount)
+		{
+			if (vIndices.size() % 3 != 0)
+				throw std::runtime_error("Index count is not a multiple of 3.");
+			for (uint32_t Index : vIndices)
+				if (Index >= vVertexCount)
+					throw std::runtime_error("Mesh index out of range.");
+		}
+
+	}
+
+	void MeshOptimizer::optimizeVertexCache(std::span<uint32_t> vIndices, size_t vVertexCount, uint32_t vCacheSize)
+	{
+		validateIndices(vIndices, vVertexCount);
+		const size_t TriangleCount = vIndices.size() / 3;
+		if (TriangleCount == 0)
+			return;
+
+		TriangleAdjacency Adjacency;
+		Adjacency.build(vIndices, vVertexCount);
+		std::vector<uint32_t>& LiveTriangles = Adjacency.m_Counts;    // 每个顶点还未输出的相邻三角形数
+		std::vector<uint32_t> CacheTimes(vVertexCount, 0);            // 顶点最近一次进入缓存的时间戳
+		std::vector<bool> IsEmitted(TriangleCount, false);
+		std::vector<uint32_t> DeadEnds;                               // 最近输出的顶点，找不到好的候选时回溯
+		std::vector<uint32_t> Candidates;
+		std::vector<uint32_t> Result;
+		Result.reserve(vIndices.size());
+
+		uint32_t Time = vCacheSize + 1;
+		size_t Cursor = 0;                                            // 回溯失败时按顺序扫描的位置
+		uint32_t Fanning = 0;
+		while (Fanning != InvalidIndex) {
+			Candidates.clear();
+			// 输出当前顶点的所有剩余三角形
+			for (uint32_t k = Adjacency.m_Offsets[Fanning]; k < Adjacency.m_Offsets[Fanning + 1]; ++k) {
+				uint32_t Triangle = Adjacency.m_Triangles[k];
+				if (IsEmitted[Triangle])
+					continue;
+				IsEmitted[Triangle] = true;
+				for (size_t c = 0; c < 3; ++c) {
+					uint32_t Vertex = vIndices[Triangle * 3 + c];
+					Result.push_back(Vertex);
+					DeadEnds.push_back(Vertex);
+					Candidates.push_back(Vertex);
+					--LiveTriangles[Vertex];
+					if (Time - CacheTimes[Vertex] > vCacheSize)
+						CacheTimes[Vertex] = Time++;
+				}
+			}
+
+			// 选择下一个扇形中心：还在缓存中、且输出其剩余三角形后仍不会被挤出的顶点里最早进入缓存的那个
+			uint32_t Next = InvalidIndex;
+			int64_t BestPriority = -1;
+			for (uint32_t Vertex : Candidates) {
+				if (LiveTriangles[Vertex] == 0)
+					continue;
+				int64_t Priority = 0;
+				if (Time - CacheTimes[Vertex] + 2 * LiveTriangles[Vertex] <= vCacheSize)
+					Priority = Time - CacheTimes[Vertex];
+				if (Priority > BestPriority) {
+					BestPriority = Priority;
+					Next = Vertex;
+				}
+			}
+			if (Next == InvalidIndex) {
+				while (!DeadEnds.empty() && Next == InvalidIndex) {
+					uint32_t Vertex = DeadEnds.back();
+					DeadEnds.pop_back();
+					if (LiveTriangles[Vertex] > 0)
+						Next = Vertex;
+				}
+				for (; Next == InvalidIndex && Cursor < vVertexCount; ++Cursor)
+					if (LiveTriangles[Cursor] > 0)
+						Next = static_cast<uint32_t>(Cursor);
+			}
+			Fanning = Next;
+		}
+		std::copy(Result.begin(), Result.end(), vIndices.begin());
+	}
+
+	size_t MeshOptimizer::optimizeVertexFetch(std::span<uint32_t> vIndices, std::vector<MeshVertex>& vVertices)
+	{
+		validateIndices(vIndices, vVertices.size());
+		std::vector<uint32_t> Remap(vVertices.size(), InvalidIndex);
+		std::vector<MeshVertex> Reordered;
+		Reordered.reserve(vVertices.size());
+		for (uint32_t& Index : vIndices) {
+			if (Remap[Index] == InvalidIndex) {
+				Remap[Index] = static_cast<uint32_t>(Reordered.size());
+				Reordered.emplace_back(vVertices[Index]);
+			}
+			Index = Remap[Index];
+		}
+		vVertices = std::move(Reordered);
+		return vVertices.size();
+	}
+
+	void MeshOptimizer::optimizeOverdraw(std::span<uint32_t> vIndices, std::span<const MeshVertex> vVertices, float vThreshold, uint32_t vCacheSize)
+	{
+		validateIndices(vIndices, vVertices.size());
+		const size_t TriangleCount = vIndices.size() / 3;
+		if (TriangleCount == 0)
+			return;
+
+		// 1. 硬边界：三个顶点全部未命中的三角形说明缓存中的内容已无用，从这里开始新簇不会损失命中率
+		std::vector<size_t> HardClusters;
+		VertexCacheSimulator Cache(vVertices.size(), vCacheSize);
+		for (size_t t = 0; t < TriangleCount; ++t)
+			if (Cache.access(&vIndices[t * 3]) == 3 || t == 0)
+				HardClusters.push_back(t);
+		HardClusters.push_back(TriangleCount);
+
+		// 2. 软边界：簇内累计ACMR降到阈值以下就可以切开，新簇从空缓存开始
+		std::vector<size_t> Clusters;
+		for (size_t h = 0; h + 1 < HardClusters.size(); ++h) {
+			size_t Begin = HardClusters[h], End = HardClusters[h + 1];
+			Cache.reset();
+			uint32_t ClusterMisses = 0;
+			for (size_t t = Begin; t < End; ++t)
+				ClusterMisses += Cache.access(&vIndices[t * 3]);
+			float MaxACMR = vThreshold * ClusterMisses / static_cast<float>(End - Begin);
+
+			Cache.reset();
+			size_t Start = Begin;
+			uint32_t Misses = 0;
+			Clusters.push_back(Begin);
+			for (size_t t = Begin; t < End; ++t) {
+				Misses += Cache.access(&vIndices[t * 3]);
+				if (t + 1 < End && Misses / static_cast<float>(t + 1 - Start) <= MaxACMR) {
+					Clusters.push_back(t + 1);
+					Cache.reset();
+					Start = t + 1;
+					Misses = 0;
+				}
+			}
+		}
+		Clusters.push_back(TriangleCount);
+
+		// 3. 面积加权的簇中心与法线
+		const size_t ClusterCount = Clusters.size() - 1;
+		std::vector<glm::vec3> Centroids(ClusterCount, glm::vec3(0.0f)), Normals(ClusterCount, glm::vec3(0.0f));
+		std::vector<float> Areas(ClusterCount, 0.0f);
+		glm::vec3 MeshCentroid(0.0f);
+		float MeshArea = 0.0f;
+		for (size_t c = 0; c < ClusterCount; ++c) {
+			for (size_t t = Clusters[c]; t < Clusters[c + 1]; ++t) {
+				const glm::vec3& P0 = vVertices[vIndices[t * 3 + 0]].m_Position;
+				const glm::vec3& P1 = vVertices[vIndices[t * 3 + 1]].m_Position;
+				const glm::vec3& P2 = vVertices[vIndices[t * 3 + 2]].m_Position;
+				glm::vec3 Normal = glm::cross(P1 - P0, P2 - P0);
+				float Area = glm::length(Normal);
+				Centroids[c] += (P0 + P1 + P2) * (Area / 3.0f);
+				Normals[c] += Normal;
+				Areas[c] += Area;
+			}
+			MeshCentroid += Centroids[c];
+			MeshArea += Areas[c];
+			if (Areas[c] > 0.0f)
+				Centroids[c] /= Areas[c];
+		}
+		if (MeshArea > 0.0f)
+			MeshCentroid /= MeshArea;
+
+		// 4. 越靠外、越朝外的簇越先画
+		std::vector<float> Keys(ClusterCount, 0.0f);
+		for (size_t c = 0; c < ClusterCount; ++c) {
+			float Length = glm::length(Normals[c]);
+			if (Length > 0.0f)
+				Keys[c] = glm::dot(Centroids[c] - MeshCentroid, Normals[c] / Length);
+		}
+		std::vector<uint32_t> Order(ClusterCount);
+		for (size_t c = 0; c < ClusterCount; ++c)
+			Order[c] = static_cast<uint32_t>(c);
+		std::stable_sort(Order.begin(), Order.end(), [&Keys](uint32_t vLeft, uint32_t vRight) { return Keys[vLeft] > Keys[vRight]; });
+
+		std::vector<uint32_t> Result;
+		Result.reserve(vIndices.size());
+		for (uint32_t c : Order)
+			Result.insert(Result.end(), vIndices.begin() + Clusters[c] * 3, vIndices.begin() + Clusters[c + 1] * 3);
+		std::copy(Result.begin(), Result.end(), vIndices.begin());
+	}
+
+	VertexCacheStatistics MeshOptimizer::analyzeVertexCache(std::span<const uint32_t> vIndices, size_t vVertexCount, uint32_t vCacheSize)
+	{
+		VertexCacheStatistics Statistics;
+		// 顶点进入缓存时记录当时的未命中计数，两者之差不超过缓存大小即仍在FIFO中
+		std::vector<size_t> CacheTimes(vVertexCount, 0);
+		size_t Time = vCacheSize + 1;
+		for (uint32_t Index : vIndices) {
+			if (Time - CacheTimes[Index] > vCacheSize) {
+				CacheTimes[Index] = Time++;
+				++Statistics.m_TransformedVertexCount;
+			}
+		}
+		size_t TriangleCount = vIndices.size() / 3;
+		Statistics.m_ACMR = TriangleCount ? static_cast<float>(Statistics.m_TransformedVertexCount) / TriangleCount : 0.0f;
+		Statistics.m_ATVR = vVertexCount ? static_cast<float>(Statistics.m_TransformedVertexCount) / vVertexCount : 0.0f;
+		return Statistics;
+	}
+
+	OverdrawStatistics MeshOptimizer::analyzeOverdraw(std::span<const uint32_t> vIndices, std::span<const MeshVertex> vVertices)
+	{
+		validateIndices(vIndices, vVertices.size());
+		OverdrawStatistics Statistics;
+		MeshBounds Bounds;
+		for (const auto& Vertex : vVertices)
+			Bounds.expand(Vertex.m_Position);
+		if (!Bounds.isValid())
+			return Statistics;
+		glm::vec3 Extent = glm::max(Bounds.getExtent(), glm::vec3(1e-8f));
+		float Scale = (OverdrawResolution - 1) / std::max(Extent.x, std::max(Extent.y, Extent.z));
+
+		std::vector<float> DepthBuffer(OverdrawResolution * OverdrawResolution);
+		for (int Axis = 0; Axis < 3; ++Axis) {
+			const int AxisU = (Axis + 1) % 3, AxisV = (Axis + 2) % 3;
+			for (float Direction : { 1.0f, -1.0f }) {
+				std::fill(DepthBuffer.begin(), DepthBuffer.end(), std::numeric_limits<float>::max());
+				for (size_t t = 0; t < vIndices.size(); t += 3) {
+					glm::vec3 Points[3];
+					for (size_t c = 0; c < 3; ++c) {
+						glm::vec3 Position = (vVertices[vIndices[t + c]].m_Position - Bounds.m_Min) * Scale;
+						Points[c] = glm::vec3(Position[AxisU], Position[AxisV], Position[Axis] * Direction);
+					}
+					// 相机沿投影轴看向Direction方向，法线(按逆时针绕序)在该轴上的分量与Direction同号即为背面
+					float Area = (Points[1].x - Points[0].x) * (Points[2].y - Points[0].y) - (Points[1].y - Points[0].y) * (Points[2].x - Points[0].x);
+					if (Area * Direction >= 0.0f)
+						continue;
+					int MinX = std::max(0, static_cast<int>(std::floor(std::min({ Points[0].x, Points[1].x, Points[2].x }))));
+					int MaxX = std::min<int>(OverdrawResolution - 1, static_cast<int>(std::ceil(std::max({ Points[0].x, Points[1].x, Points[2].x }))));
+					int MinY = std::max(0, static_cast<int>(std::floor(std::min({ Points[0].y, Points[1].y, Points[2].y }))));
+					int MaxY = std::min<int>(OverdrawResolution - 1, static_cast<int>(std::ceil(std::max({ Points[0].y, Points[1].y, Points[2].y }))));
+					float InverseArea = 1.0f / Area;
+					for (int y = MinY; y <= MaxY; ++y) {
+						for (int x = MinX; x <= MaxX; ++x) {
+							float PixelX = x + 0.5f, PixelY = y + 0.5f;
+							float W0 = ((Points[2].x - Points[1].x) * (PixelY - Points[1].y) - (Points[2].y - Points[1].y) * (PixelX - Points[1].x)) * InverseArea;
+							float W1 = ((Points[0].x - Points[2].x) * (PixelY - Points[2].y) - (Points[0].y - Points[2].y) * (PixelX - Points[2].x)) * InverseArea;
+							float W2 = 1.0f - W0 - W1;
+							if (W0 < 0.0f || W1 < 0.0f || W2 < 0.0f)
+								continue;
+							float Depth = W0 * Points[0].z + W1 * Points[1].z + W2 * Points[2].z;
+							float& Stored = DepthBuffer[y * OverdrawResolution + x];
+							if (Depth < Stored) {
+								if (Stored == std::numeric_limits<float>::max())
+									++Statistics.m_CoveredPixelCount;
+								Stored = Depth;
+								++Statistics.m_ShadedPixelCount;
+							}
+						}
+					}
+				}
+			}
+		}
+		Statistics.m_Overdraw = Statistics.m_CoveredPixelCount ? static_cast<float>(Statistics.m_ShadedPixelCount) / Statistics.m_CoveredPixelCount : 0.0f;
+		return Statistics;
+	}
+
+	void MeshOptimizer::optimize(Mesh& vMesh)
+	{
+		Timer OptimizeTimer;
+		VertexCacheStatistics Before = analyzeVertexCache(vMesh.m_Indices, vMesh.m_Vertices.size());
+		OverdrawStatistics OverdrawBefore = analyzeOverdraw(vMesh.m_Indices, vMesh.m_Vertices);
+		optimizeVertexCache(vMesh.m_Indices, vMesh.m_Vertices.size());
+		optimizeOverdraw(vMesh.m_Indices, vMesh.m_Vertices);
+		optimizeVertexFetch(vMesh.m_Indices, vMesh.m_Vertices);
+		VertexCacheStatistics After = analyzeVertexCache(vMesh.m_Indices, vMesh.m_Vertices.size());
+		OverdrawStatistics OverdrawAfter = analyzeOverdraw(vMesh.m_Indices, vMesh.m_Vertices);
+		std::cout << std::format("\toptimize: {0:.2f} ms, ACMR {1:.3f} -> {2:.3f}, ATVR {3:.3f} -> {4:.3f}, overdraw {5:.3f} -> {6:.3f}\n",
+			OptimizeTimer.ellapseMilliseconds(), Before.m_ACMR, After.m_ACMR, Before.m_ATVR, After.m_ATVR, OverdrawBefore.m_Overdraw, OverdrawAfter.m_Overdraw);
+	}
+
+}
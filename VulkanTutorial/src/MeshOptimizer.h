@@ -0,0 +1,49 @@
+#pragma once
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 用FIFO缓存模拟post-transform cache的结果
+	struct VertexCacheStatistics
+	{
+		size_t m_TransformedVertexCount = 0;  // 缓存未命中、需要执行vertex shader的次数
+		float m_ACMR = 0.0f;                  // 平均每个三角形的未命中数，理想值约0.5，最差3
+		float m_ATVR = 0.0f;                  // 未命中数/顶点数，理想值1
+	};
+
+	// 软件光栅化估计的overdraw：从6个轴向正交投影，背面剔除+深度测试
+	struct OverdrawStatistics
+	{
+		size_t m_CoveredPixelCount = 0;
+		size_t m_ShadedPixelCount = 0;        // 通过深度测试的片元数，相当于early-z下的fragment shader调用次数
+		float m_Overdraw = 0.0f;              // 理想值1
+	};
+
+	// 导入时的网格优化，结果会写入网格缓存，运行时零开销
+	class MeshOptimizer
+	{
+	public:
+		static constexpr uint32_t DefaultCacheSize = 16;
+
+		// Tipsify(Sander et al. 2007)：以顶点为中心扇形输出相邻三角形，线性时间重排索引提高post-transform cache命中率
+		static void optimizeVertexCache(std::span<uint32_t> vIndices, size_t vVertexCount, uint32_t vCacheSize = DefaultCacheSize);
+		// 按索引中首次使用的顺序重排顶点，使顶点读取近似顺序访问；返回重排后的顶点数(未被引用的顶点会被丢弃)
+		static size_t optimizeVertexFetch(std::span<uint32_t> vIndices, std::vector<MeshVertex>& vVertices);
+
+		// 在顶点缓存优化之后执行(Sander et al. 2007)：按缓存模拟把三角形切成簇，切分后每个簇的ACMR不超过切分前的vThreshold倍，
+		// 再按簇朝外的程度(簇中心相对网格中心在簇法线上的投影)从大到小排序，先画的簇更可能遮挡后画的
+		static void optimizeOverdraw(std::span<uint32_t> vIndices, std::span<const MeshVertex> vVertices, float vThreshold = 1.05f, uint32_t vCacheSize = DefaultCacheSize);
+
+		static VertexCacheStatistics analyzeVertexCache(std::span<const uint32_t> vIndices, size_t vVertexCount, uint32_t vCacheSize = DefaultCacheSize);
+
+		static OverdrawStatistics analyzeOverdraw(std::span<const uint32_t> vIndices, std::span<const MeshVertex> vVertices);
+
+		static void optimize(Mesh& vMesh);  // 依次执行上面的优化并打印前后的统计
+	};
+
+}
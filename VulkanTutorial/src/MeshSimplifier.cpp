@@ -0,0 +1,409 @@
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include "VertexDeduplicator.h"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <format>
+#include <iostream>
+#include <numeric>
+#include <utility>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		// 对称矩阵 A = n*n^T，b = n*d，c = d^2，均已乘以三角形面积；误差 = (x^T*A*x + 2*b*x + c) / 总面积
+		struct Quadric
+		{
+			double m_A00 = 0.0, m_A11 = 0.0, m_A22 = 0.0, m_A01 = 0.0, m_A02 = 0.0, m_A12 = 0.0;
+			double m_B0 = 0.0, m_B1 = 0.0, m_B2 = 0.0;
+			double m_C = 0.0;
+			double m_Weight = 0.0;
+
+			static Quadric fromPlane(const glm::dvec3& vNormal, double vDistance, double vWeight)
+			{
+				Quadric Result;
+				Result.m_A00 = vWeight * vNormal.x * vNormal.x;
+				Result.m_A11 = vWeight * vNormal.y * vNormal.y;
+				Result.m_A22 = vWeight * vNormal.z * vNormal.z;
+				Result.m_A01 = vWeight * vNormal.x * vNormal.y;
+				Result.m_A02 = vWeight * vNormal.x * vNormal.z;
+				Result.m_A12 = vWeight * vNormal.y * vNormal.z;
+				Result.m_B0 = vWeight * vNormal.x * vDistance;
+				Result.m_B1 = vWeight * vNormal.y * vDistance;
+				Result.m_B2 = vWeight * vNormal.z * vDistance;
+				Result.m_C = vWeight * vDistance * vDistance;
+				Result.m_Weight = vWeight;
+				return Result;
+			}
+
+			void add(const Quadric& vOther)
+			{
+				m_A00 += vOther.m_A00; m_A11 += vOther.m_A11; m_A22 += vOther.m_A22;
+				m_A01 += vOther.m_A01; m_A02 += vOther.m_A02; m_A12 += vOther.m_A12;
+				m_B0 += vOther.m_B0; m_B1 += vOther.m_B1; m_B2 += vOther.m_B2;
+				m_C += vOther.m_C;
+				m_Weight += vOther.m_Weight;
+			}
+
+			double evaluate(const glm::dvec3& vPoint) const
+			{
+				const double x = vPoint.x, y = vPoint.y, z = vPoint.z;
+				double Error = m_A00 * x * x + m_A11 * y * y + m_A22 * z * z
+					+ 2.0 * (m_A01 * x * y + m_A02 * x * z + m_A12 * y * z)
+					+ 2.0 * (m_B0 * x + m_B1 * y + m_B2 * z) + m_C;
+				return std::max(Error, 0.0);
+			}
+		};
+
+		struct Collapse
+		{
+			uint32_t m_From = 0;
+			uint32_t m_To = 0;
+			float m_Cost = 0.0f;
+			float m_PositionError = 0.0f;  // 代价中的几何部分，属性误差不计入最终的距离误差
+		};
+
+		struct SimplifierState
+		{
+			std::span<const MeshVertex> m_Vertices;
+			std::vector<glm::dvec3> m_Positions;  // 归一化到包围盒最长边为1
+			std::vector<uint32_t> m_PositionRemap;  // 顶点->焊接后的位置
+			std::vector<uint32_t> m_WedgeOffsets;   // 每个位置上的顶点在m_Wedges中的区间
+			std::vector<uint32_t> m_Wedges;
+			std::vector<Quadric> m_Quadrics;        // 按位置累加，接缝两侧的平面都计入
+			std::vector<uint8_t> m_IsLocked;   // 锁定边界时的边界顶点
+			std::vector<uint8_t> m_IsBorder;
+			std::vector<uint8_t> m_IsSeam;
+			SimplificationConfig m_Config;
+
+			std::span<const uint32_t> getWedges(uint32_t vVertex) const
+			{
+				uint32_t Position = m_PositionRemap[vVertex];
+				return std::span<const uint32_t>(m_Wedges).subspan(m_WedgeOffsets[Position], m_WedgeOffsets[Position + 1] - m_WedgeOffsets[Position]);
+			}
+
+			double computePositionError(uint32_t vFrom, uint32_t vTo) const
+			{
+				Quadric Merged = m_Quadrics[m_PositionRemap[vFrom]];
+				Merged.add(m_Quadrics[m_PositionRemap[vTo]]);
+				return Merged.m_Weight > 0.0 ? Merged.evaluate(m_Positions[vTo]) / Merged.m_Weight : 0.0;
+			}
+
+			double computeAttributeError(uint32_t vFrom, uint32_t vTo) const
+			{
+				const MeshVertex& From = m_Vertices[vFrom];
+				const MeshVertex& To = m_Vertices[vTo];
+				glm::vec3 NormalDelta = From.m_Normal - To.m_Normal;
+				glm::vec2 TexCoordDelta = From.m_TexCoord - To.m_TexCoord;
+				glm::vec3 ColorDelta = From.m_Color - To.m_Color;
+				return m_Config.m_NormalWeight * glm::dot(NormalDelta, NormalDelta)
+					+ m_Config.m_TexCoordWeight * glm::dot(TexCoordDelta, TexCoordDelta)
+					+ m_Config.m_ColorWeight * glm::dot(ColorDelta, ColorDelta);
+			}
+		};
+
+		// 非负float的位模式与数值单调一致，按高11位(指数和3位尾数)做计数排序，桶内保持原顺序，
+		// 对选择坍缩顺序来说这个精度足够，比比较排序快得多
+		void sortCollapses(const std::vector<Collapse>& vCollapses, std::vector<Collapse>& vSorted)
+		{
+			constexpr uint32_t BucketBits = 11;
+			auto getBucket = [](float vCost) { return std::bit_cast<uint32_t>(vCost) >> (32 - 1 - BucketBits); };
+			std::vector<uint32_t> Offsets((1u << BucketBits) + 1, 0);
+			for (const Collapse& Candidate : vCollapses)
+				++Offsets[getBucket(Candidate.m_Cost) + 1];
+			for (size_t i = 0; i + 1 < Offsets.size(); ++i)
+				Offsets[i + 1] += Offsets[i];
+			vSorted.resize(vCollapses.size());
+			for (const Collapse& Candidate : vCollapses)
+				vSorted[Offsets[getBucket(Candidate.m_Cost)]++] = Candidate;
+		}
+
+		// vFrom移动到vTo后，周围不含vTo的三角形法线不能翻转或大幅旋转
+		bool isCollapseValid(const SimplifierState& vState, std::span<const uint32_t> vIndices, std::span<const uint32_t> vTriangles, uint32_t vFrom, uint32_t vTo)
+		{
+			for (uint32_t Triangle : vTriangles) {
+				const uint32_t* Corners = &vIndices[Triangle * 3];
+				if (Corners[0] == vTo || Corners[1] == vTo || Corners[2] == vTo)
+					continue;
+				glm::dvec3 Before[3], After[3];
+				for (size_t c = 0; c < 3; ++c) {
+					Before[c] = vState.m_Positions[Corners[c]];
+					After[c] = Corners[c] == vFrom ? vState.m_Positions[vTo] : Before[c];
+				}
+				glm::dvec3 NormalBefore = glm::cross(Before[1] - Before[0], Before[2] - Before[0]);
+				glm::dvec3 NormalAfter = glm::cross(After[1] - After[0], After[2] - After[0]);
+				double LengthProduct = glm::length(NormalBefore) * glm::length(NormalAfter);
+				if (LengthProduct <= 0.0 || glm::dot(NormalBefore, NormalAfter) < 0.25 * LengthProduct)
+					return false;
+			}
+			return true;
+		}
+
+	}
+
+	SimplificationResult MeshSimplifier::simplify(std::span<const uint32_t> vIndices, std::span<const MeshVertex> vVertices, size_t vTargetIndexCount,
+		float vTargetError, const SimplificationConfig& vConfig)
+	{
+		SimplificationResult Result;
+		Result.m_Indices.assign(vIndices.begin(), vIndices.end());
+		if (vIndices.size() <= vTargetIndexCount || vVertices.empty())
+			return Result;
+
+		const size_t VertexCount = vVertices.size();
+		SimplifierState State;
+		State.m_Vertices = vVertices;
+		State.m_Config = vConfig;
+
+		MeshBounds Bounds;
+		for (uint32_t Index : vIndices)
+			Bounds.expand(vVertices[Index].m_Position);
+		glm::vec3 Extent = Bounds.getExtent();
+		double Scale = std::max({ Extent.x, Extent.y, Extent.z });
+		if (Scale <= 0.0)
+			return Result;
+		State.m_Positions.resize(VertexCount);
+		for (size_t i = 0; i < VertexCount; ++i)
+			State.m_Positions[i] = (glm::dvec3(vVertices[i].m_Position) - glm::dvec3(Bounds.m_Min)) / Scale;
+
+		// 按位置焊接后判断拓扑：同一位置有多个顶点的是接缝，焊接后只被一个三角形使用的边是开放边界
+		std::vector<glm::vec3> Positions(VertexCount);
+		for (size_t i = 0; i < VertexCount; ++i)
+			Positions[i] = vVertices[i].m_Position;
+		State.m_PositionRemap.resize(VertexCount);
+		const std::vector<uint32_t>& PositionRemap = State.m_PositionRemap;
+		size_t PositionCount = VertexDeduplicator::generateRemap(State.m_PositionRemap, Positions.data(), VertexCount, sizeof(glm::vec3));
+		State.m_WedgeOffsets.assign(PositionCount + 1, 0);
+		for (size_t i = 0; i < VertexCount; ++i)
+			++State.m_WedgeOffsets[PositionRemap[i] + 1];
+		for (size_t i = 0; i < PositionCount; ++i)
+			State.m_WedgeOffsets[i + 1] += State.m_WedgeOffsets[i];
+		State.m_Wedges.resize(VertexCount);
+		{
+			std::vector<uint32_t> Cursors(State.m_WedgeOffsets.begin(), State.m_WedgeOffsets.end() - 1);
+			for (size_t i = 0; i < VertexCount; ++i)
+				State.m_Wedges[Cursors[PositionRemap[i]]++] = static_cast<uint32_t>(i);
+		}
+
+		State.m_IsSeam.assign(VertexCount, 0);
+		for (size_t i = 0; i < VertexCount; ++i)
+			State.m_IsSeam[i] = State.getWedges(static_cast<uint32_t>(i)).size() > 1;
+		State.m_IsLocked.assign(VertexCount, 0);
+		State.m_IsBorder.assign(VertexCount, 0);
+		{
+			// 焊接后的顶点->三角形邻接表，边A->B没有对应的反向边B->A即为边界
+			std::vector<uint32_t> Offsets(PositionCount + 1, 0);
+			for (uint32_t Index : vIndices)
+				++Offsets[PositionRemap[Index] + 1];
+			for (size_t i = 0; i < PositionCount; ++i)
+				Offsets[i + 1] += Offsets[i];
+			std::vector<uint32_t> Triangles(vIndices.size());
+			{
+				std::vector<uint32_t> Cursors(Offsets.begin(), Offsets.end() - 1);
+				for (size_t i = 0; i < vIndices.size(); ++i)
+					Triangles[Cursors[PositionRemap[vIndices[i]]]++] = static_cast<uint32_t>(i / 3);
+			}
+			auto hasEdge = [&](uint32_t vFrom, uint32_t vTo) {
+				for (uint32_t k = Offsets[vFrom]; k < Offsets[vFrom + 1]; ++k) {
+					const uint32_t* Corners = &vIndices[Triangles[k] * 3];
+					for (size_t c = 0; c < 3; ++c) {
+						if (PositionRemap[Corners[c]] == vFrom && PositionRemap[Corners[(c + 1) % 3]] == vTo)
+							return true;
+					}
+				}
+				return false;
+			};
+			for (size_t i = 0; i < vIndices.size(); i += 3) {
+				for (size_t c = 0; c < 3; ++c) {
+					uint32_t A = vIndices[i + c], B = vIndices[i + (c + 1) % 3];
+					if (!hasEdge(PositionRemap[B], PositionRemap[A]))
+						State.m_IsBorder[A] = State.m_IsBorder[B] = 1;
+				}
+			}
+		}
+		if (vConfig.m_IsBorderLocked)
+			State.m_IsLocked = State.m_IsBorder;
+
+		State.m_Quadrics.assign(PositionCount, {});
+		for (size_t i = 0; i < vIndices.size(); i += 3) {
+			const glm::dvec3& P0 = State.m_Positions[vIndices[i]];
+			const glm::dvec3& P1 = State.m_Positions[vIndices[i + 1]];
+			const glm::dvec3& P2 = State.m_Positions[vIndices[i + 2]];
+			glm::dvec3 Normal = glm::cross(P1 - P0, P2 - P0);
+			double DoubleArea = glm::length(Normal);
+			if (DoubleArea <= 0.0)
+				continue;
+			Normal /= DoubleArea;
+			Quadric Plane = Quadric::fromPlane(Normal, -glm::dot(Normal, P0), DoubleArea * 0.5);
+			for (size_t c = 0; c < 3; ++c)
+				State.m_Quadrics[PositionRemap[vIndices[i + c]]].add(Plane);
+		}
+
+		const double MaxCost = static_cast<double>(vTargetError) * vTargetError;
+		double ResultError = 0.0;
+		std::vector<uint32_t>& Indices = Result.m_Indices;
+		std::vector<uint32_t> Remap(VertexCount);
+		std::vector<uint8_t> IsCollapseLocked(VertexCount);
+		std::vector<Collapse> Collapses, SortedCollapses;
+		std::vector<uint32_t> AdjacencyOffsets(VertexCount + 1);
+		std::vector<uint32_t> AdjacentTriangles;
+		std::vector<std::pair<uint32_t, uint32_t>> Moves;  // 一次坍缩中一起移动的顶点及其目标
+
+		// 每一轮：收集所有候选边按代价排序，依次坍缩互不相邻的边，再统一重写索引
+		while (Indices.size() > vTargetIndexCount) {
+			const size_t TriangleCount = Indices.size() / 3;
+			std::fill(AdjacencyOffsets.begin(), AdjacencyOffsets.end(), 0);
+			for (uint32_t Index : Indices)
+				++AdjacencyOffsets[Index + 1];
+			for (size_t i = 0; i < VertexCount; ++i)
+				AdjacencyOffsets[i + 1] += AdjacencyOffsets[i];
+			AdjacentTriangles.resize(Indices.size());
+			{
+				std::vector<uint32_t> Cursors(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+				for (size_t i = 0; i < Indices.size(); ++i)
+					AdjacentTriangles[Cursors[Indices[i]]++] = static_cast<uint32_t>(i / 3);
+			}
+			auto getTriangles = [&](uint32_t vVertex) {
+				return std::span<const uint32_t>(AdjacentTriangles).subspan(AdjacencyOffsets[vVertex], AdjacencyOffsets[vVertex + 1] - AdjacencyOffsets[vVertex]);
+			};
+			// vFrom->vTo坍缩时要移动的顶点。接缝顶点所在位置上仍被使用的每个顶点，都要在自己的三角形中找到唯一一个位于vTo位置的顶点作为目标，
+			// 找不到(边不在接缝上，会把接缝一侧拉到另一侧)或不唯一(多条接缝交汇)时不能坍缩
+			auto collectMoves = [&](uint32_t vFrom, uint32_t vTo) {
+				Moves.clear();
+				if (!State.m_IsSeam[vFrom]) {
+					Moves.emplace_back(vFrom, vTo);
+					return true;
+				}
+				const uint32_t ToPosition = PositionRemap[vTo];
+				if (PositionRemap[vFrom] == ToPosition)
+					return false;
+				for (uint32_t Wedge : State.getWedges(vFrom)) {
+					std::span<const uint32_t> Triangles = getTriangles(Wedge);
+					if (Triangles.empty())
+						continue;
+					uint32_t Target = UINT32_MAX;
+					for (uint32_t Triangle : Triangles) {
+						for (size_t c = 0; c < 3; ++c) {
+							uint32_t Corner = Indices[Triangle * 3 + c];
+							if (PositionRemap[Corner] != ToPosition)
+								continue;
+							if (Target != UINT32_MAX && Target != Corner)
+								return false;
+							Target = Corner;
+						}
+					}
+					if (Target == UINT32_MAX || State.m_IsLocked[Wedge] || (State.m_IsBorder[Wedge] && !State.m_IsBorder[Target]))
+						return false;
+					Moves.emplace_back(Wedge, Target);
+				}
+				return true;
+			};
+
+			Collapses.clear();
+			for (size_t i = 0; i < Indices.size(); i += 3) {
+				for (size_t c = 0; c < 3; ++c) {
+					uint32_t A = Indices[i + c], B = Indices[i + (c + 1) % 3];
+					// 两端都是普通顶点的边一定被两侧三角形各访问一次，只收集A < B的一次
+					bool IsSpecialEdge = State.m_IsLocked[A] || State.m_IsLocked[B] || State.m_IsBorder[A] || State.m_IsBorder[B] || State.m_IsSeam[A] || State.m_IsSeam[B];
+					if ((A > B && !IsSpecialEdge) || (State.m_IsLocked[A] && State.m_IsLocked[B]))
+						continue;
+					Collapse Candidate{ 0, 0, static_cast<float>(MaxCost) + 1.0f, 0.0f };
+					for (auto [From, To] : { std::pair{ A, B }, std::pair{ B, A } }) {
+						// 边界顶点只能沿边界坍缩，否则边界会向内收缩
+						if (State.m_IsLocked[From] || (State.m_IsBorder[From] && !State.m_IsBorder[To]) || !collectMoves(From, To))
+							continue;
+						double PositionError = State.computePositionError(From, To);
+						double Cost = PositionError;
+						for (auto [Wedge, Target] : Moves)
+							Cost += State.computeAttributeError(Wedge, Target);
+						if (Cost < Candidate.m_Cost)
+							Candidate = { From, To, static_cast<float>(Cost), static_cast<float>(PositionError) };
+					}
+					if (Candidate.m_Cost <= MaxCost)
+						Collapses.push_back(Candidate);
+				}
+			}
+			if (Collapses.empty())
+				break;
+			sortCollapses(Collapses, SortedCollapses);
+
+			// 一次坍缩大约去掉两个三角形
+			const size_t CollapseLimit = std::max<size_t>((TriangleCount - vTargetIndexCount / 3) / 2, 1);
+			size_t CollapseCount = 0;
+			std::iota(Remap.begin(), Remap.end(), 0u);
+			std::fill(IsCollapseLocked.begin(), IsCollapseLocked.end(), 0);
+			for (const Collapse& Candidate : SortedCollapses) {
+				if (CollapseCount >= CollapseLimit)
+					break;
+				// 本轮的索引还没有重写，邻接关系与收集候选时相同
+				collectMoves(Candidate.m_From, Candidate.m_To);
+				bool IsValid = true;
+				for (auto [Wedge, Target] : Moves) {
+					if (IsCollapseLocked[Wedge] || IsCollapseLocked[Target] || !isCollapseValid(State, Indices, getTriangles(Wedge), Wedge, Target)) {
+						IsValid = false;
+						break;
+					}
+				}
+				if (!IsValid)
+					continue;
+				State.m_Quadrics[PositionRemap[Candidate.m_To]].add(State.m_Quadrics[PositionRemap[Candidate.m_From]]);
+				ResultError = std::max(ResultError, static_cast<double>(Candidate.m_PositionError));
+				++CollapseCount;
+				for (auto [Wedge, Target] : Moves) {
+					Remap[Wedge] = Target;
+					// 本轮内不再动这一圈顶点，保证后续坍缩的合法性检查看到的三角形都还没被修改
+					for (uint32_t Triangle : getTriangles(Wedge)) {
+						for (size_t c = 0; c < 3; ++c)
+							IsCollapseLocked[Indices[Triangle * 3 + c]] = 1;
+					}
+				}
+			}
+			if (CollapseCount == 0)
+				break;
+
+			size_t WriteCursor = 0;
+			for (size_t i = 0; i < Indices.size(); i += 3) {
+				uint32_t A = Remap[Indices[i]], B = Remap[Indices[i + 1]], C = Remap[Indices[i + 2]];
+				if (A == B || B == C || C == A)
+					continue;
+				Indices[WriteCursor++] = A;
+				Indices[WriteCursor++] = B;
+				Indices[WriteCursor++] = C;
+			}
+			Indices.resize(WriteCursor);
+		}
+
+		Result.m_Error = static_cast<float>(std::sqrt(ResultError) * Scale);
+		return Result;
+	}
+
+	void MeshSimplifier::buildLods(Mesh& vMesh, const LodChainConfig& vConfig)
+	{
+		vMesh.m_Lods.clear();
+		vMesh.m_Lods.push_back({ 0, static_cast<uint32_t>(vMesh.m_Indices.size()), 0.0f });
+		std::vector<uint32_t> Previous = vMesh.m_Indices;
+		float Error = 0.0f;
+		const uint32_t MaxLodCount = std::min(vConfig.m_MaxLodCount, MeshLod::MaxCount);
+		while (vMesh.m_Lods.size() < MaxLodCount) {
+			size_t TargetIndexCount = static_cast<size_t>(Previous.size() / 3 * vConfig.m_ReductionRatio) * 3;
+			if (TargetIndexCount / 3 < vConfig.m_MinTriangleCount)
+				break;
+			SimplificationResult Simplified = simplify(Previous, vMesh.m_Vertices, TargetIndexCount, vConfig.m_MaxError, vConfig.m_Simplification);
+			// 被误差上限或锁定顶点卡住、已经简化不动了
+			if (static_cast<float>(Previous.size() - Simplified.m_Indices.size()) < Previous.size() * vConfig.m_MinReduction)
+				break;
+			// 每一级是在上一级的基础上简化的，相对LOD 0的误差取累加的上界
+			Error += Simplified.m_Error;
+			MeshOptimizer::optimizeVertexCache(Simplified.m_Indices, vMesh.m_Vertices.size());
+			vMesh.m_Lods.push_back({ static_cast<uint32_t>(vMesh.m_Indices.size()), static_cast<uint32_t>(Simplified.m_Indices.size()), Error });
+			vMesh.m_Indices.insert(vMesh.m_Indices.end(), Simplified.m_Indices.begin(), Simplified.m_Indices.end());
+			Previous = std::move(Simplified.m_Indices);
+		}
+
+		for (size_t i = 0; i < vMesh.m_Lods.size(); ++i)
+			std::cout << std::format("\tLOD {0}: {1} triangles, error {2:.6f}\n", i, vMesh.m_Lods[i].m_IndexCount / 3, vMesh.m_Lods[i].m_Error);
+	}
+
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include "Mesh.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	struct SimplificationConfig
+	{
+		// 属性误差的权重，与归一化(包围盒最长边为1)后的位置误差平方相加
+		float m_NormalWeight = 0.5f;
+		float m_TexCoordWeight = 1.0f;
+		float m_ColorWeight = 0.5f;
+		bool m_IsBorderLocked = true;  // 开放边界上的顶点不移动，避免与相邻网格之间出现裂缝
+	};
+
+	struct SimplificationResult
+	{
+		std::vector<uint32_t> m_Indices;
+		float m_Error = 0.0f;          // 模型空间下的距离误差
+	};
+
+	struct LodChainConfig
+	{
+		SimplificationConfig m_Simplification;
+		uint32_t m_MaxLodCount = MeshLod::MaxCount;
+		float m_ReductionRatio = 0.5f;   // 每一级的目标三角形数为上一级的这个比例
+		float m_MaxError = 0.05f;        // 每一级允许的误差，相对包围盒最长边
+		size_t m_MinTriangleCount = 64;
+		float m_MinReduction = 0.1f;     // 一级去掉的三角形少于上一级的这个比例时停止，再往下的LOD几乎不省顶点处理
+	};
+
+	// 基于二次误差度量(Garland & Heckbert 1997)的网格简化。
+	// 只做半边坍缩(把一个顶点合并到相邻的已有顶点上)，简化结果只是新的索引，所有LOD共享同一个顶点缓冲。
+	// UV/法线接缝上的顶点(同一位置有多个顶点)只沿接缝边坍缩，该位置的所有顶点一起合并到边另一端对应的顶点上，接缝两侧不会错开
+	class MeshSimplifier
+	{
+	public:
+		// vTargetError相对包围盒最长边，坍缩代价超过它时提前停止，结果可能多于vTargetIndexCount
+		static SimplificationResult simplify(std::span<const uint32_t> vIndices, std::span<const MeshVertex> vVertices, size_t vTargetIndexCount,
+			float vTargetError, const SimplificationConfig& vConfig = {});
+
+		// 逐级简化并把各级索引依次追加到vMesh.m_Indices之后，填写vMesh.m_Lods；应在顶点重排(optimizeVertexFetch)之后调用
+		static void buildLods(Mesh& vMesh, const LodChainConfig& vConfig = {});
+	};
+
+}
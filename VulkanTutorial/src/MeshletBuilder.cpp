@@ -0,0 +1,235 @@
+#include "MeshletBuilder.h"
+#include "VertexDeduplicator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t InvalidTriangle = UINT32_MAX;
+		constexpr uint8_t UnusedLocalIndex = 0xFF;
+		// 法线锥半角的余弦低于这个值时，能被整体剔除的视角已经很少，不值得测试
+		constexpr float MinConeCosine = 0.1f;
+
+	}
+
+	MeshletData MeshletBuilder::build(std::span<const uint32_t> vIndices, std::span<const MeshVertex> vVertices, uint32_t vMaxVertexCount, uint32_t vMaxTriangleCount)
+	{
+		if (vMaxVertexCount < 3 || vMaxVertexCount >= UnusedLocalIndex || vMaxTriangleCount == 0 || vMaxTriangleCount % 4 != 0)
+			throw std::runtime_error("Failed to build meshlets with invalid limits!");
+
+		MeshletData Result;
+		const size_t VertexCount = vVertices.size();
+		const size_t TriangleCount = vIndices.size() / 3;
+		if (TriangleCount == 0)
+			return Result;
+
+		// 相邻关系按位置焊接后计算，法线/UV不连续(例如平直着色)的三角形仍然算相邻
+		std::vector<glm::vec3> Positions(VertexCount);
+		for (size_t i = 0; i < VertexCount; ++i)
+			Positions[i] = vVertices[i].m_Position;
+		std::vector<uint32_t> PositionRemap(VertexCount);
+		size_t PositionCount = VertexDeduplicator::generateRemap(PositionRemap, Positions.data(), VertexCount, sizeof(glm::vec3));
+		std::vector<uint32_t> AdjacencyOffsets(PositionCount + 1, 0);
+		for (uint32_t Index : vIndices)
+			++AdjacencyOffsets[PositionRemap[Index] + 1];
+		for (size_t i = 0; i < PositionCount; ++i)
+			AdjacencyOffsets[i + 1] += AdjacencyOffsets[i];
+		std::vector<uint32_t> AdjacentTriangles(vIndices.size());
+		{
+			std::vector<uint32_t> Cursors(AdjacencyOffsets.begin(), AdjacencyOffsets.end() - 1);
+			for (size_t i = 0; i < vIndices.size(); ++i)
+				AdjacentTriangles[Cursors[PositionRemap[vIndices[i]]]++] = static_cast<uint32_t>(i / 3);
+		}
+
+		std::vector<uint8_t> IsEmitted(TriangleCount, 0);
+		std::vector<uint8_t> LocalIndices(VertexCount, UnusedLocalIndex);
+		std::vector<uint32_t> Candidates;
+		std::vector<uint32_t> CandidateStamps(TriangleCount, UINT32_MAX);  // 已加入候选列表的meshlet编号，避免同一三角形重复加入
+		Meshlet Current;
+		glm::vec3 CenterSum = glm::vec3(0.0f);
+		size_t ScanCursor = 0;
+		size_t EmittedCount = 0;
+
+		auto countNewVertices = [&](uint32_t vTriangle) {
+			uint32_t Count = 0;
+			for (size_t c = 0; c < 3; ++c)
+				Count += LocalIndices[vIndices[vTriangle * 3 + c]] == UnusedLocalIndex;
+			return Count;
+		};
+		auto finishMeshlet = [&]() {
+			for (uint32_t i = 0; i < Current.m_VertexCount; ++i)
+				LocalIndices[Result.m_Vertices[Current.m_VertexOffset + i]] = UnusedLocalIndex;
+			while (Result.m_Triangles.size() % 4 != 0)
+				Result.m_Triangles.push_back(0);
+			Result.m_Meshlets.push_back(Current);
+			Current = {};
+			Current.m_VertexOffset = static_cast<uint32_t>(Result.m_Vertices.size());
+			Current.m_TriangleOffset = static_cast<uint32_t>(Result.m_Triangles.size());
+			CenterSum = glm::vec3(0.0f);
+			Candidates.clear();
+		};
+		auto appendTriangle = [&](uint32_t vTriangle) {
+			for (size_t c = 0; c < 3; ++c) {
+				uint32_t Vertex = vIndices[vTriangle * 3 + c];
+				if (LocalIndices[Vertex] == UnusedLocalIndex) {
+					LocalIndices[Vertex] = static_cast<uint8_t>(Current.m_VertexCount++);
+					Result.m_Vertices.push_back(Vertex);
+					CenterSum += vVertices[Vertex].m_Position;
+					uint32_t Position = PositionRemap[Vertex];
+					for (uint32_t k = AdjacencyOffsets[Position]; k < AdjacencyOffsets[Position + 1]; ++k) {
+						uint32_t Triangle = AdjacentTriangles[k];
+						if (!IsEmitted[Triangle] && CandidateStamps[Triangle] != Result.m_Meshlets.size()) {
+							CandidateStamps[Triangle] = static_cast<uint32_t>(Result.m_Meshlets.size());
+							Candidates.push_back(Triangle);
+						}
+					}
+				}
+				Result.m_Triangles.push_back(LocalIndices[Vertex]);
+			}
+			++Current.m_TriangleCount;
+			IsEmitted[vTriangle] = 1;
+			++EmittedCount;
+		};
+
+		while (EmittedCount < TriangleCount) {
+			uint32_t Best = InvalidTriangle;
+			if (Current.m_TriangleCount > 0) {
+				// 新增顶点最少者优先，其次离当前中心最近；顺便把已输出的三角形从候选中移除
+				glm::vec3 Center = CenterSum / static_cast<float>(Current.m_VertexCount);
+				uint32_t BestNewVertices = 4;
+				float BestDistance = std::numeric_limits<float>::max();
+				size_t WriteCursor = 0;
+				for (uint32_t Triangle : Candidates) {
+					if (IsEmitted[Triangle])
+						continue;
+					Candidates[WriteCursor++] = Triangle;
+					uint32_t NewVertices = countNewVertices(Triangle);
+					if (NewVertices > BestNewVertices)
+						continue;
+					const uint32_t* Corners = &vIndices[Triangle * 3];
+					glm::vec3 Centroid = (vVertices[Corners[0]].m_Position + vVertices[Corners[1]].m_Position + vVertices[Corners[2]].m_Position) / 3.0f;
+					glm::vec3 Offset = Centroid - Center;
+					float Distance = glm::dot(Offset, Offset);
+					if (NewVertices < BestNewVertices || Distance < BestDistance) {
+						Best = Triangle;
+						BestNewVertices = NewVertices;
+						BestDistance = Distance;
+					}
+				}
+				Candidates.resize(WriteCursor);
+			}
+
+			if (Best == InvalidTriangle) {
+				// 当前meshlet已经没有相邻的三角形，结束它并从索引顺序中的下一个三角形重新开始
+				if (Current.m_TriangleCount > 0)
+					finishMeshlet();
+				while (IsEmitted[ScanCursor])
+					++ScanCursor;
+				Best = static_cast<uint32_t>(ScanCursor);
+			}
+			else if (Current.m_VertexCount + countNewVertices(Best) > vMaxVertexCount || Current.m_TriangleCount + 1 > vMaxTriangleCount) {
+				// 装不下时从这个三角形开始下一个meshlet，与上一个在空间上相邻
+				finishMeshlet();
+			}
+			appendTriangle(Best);
+		}
+		finishMeshlet();
+
+		Result.m_Bounds.reserve(Result.m_Meshlets.size());
+		for (const Meshlet& Item : Result.m_Meshlets)
+			Result.m_Bounds.push_back(computeBounds(Result, Item, vVertices));
+		return Result;
+	}
+
+	MeshletBounds MeshletBuilder::computeBounds(const MeshletData& vData, const Meshlet& vMeshlet, std::span<const MeshVertex> vVertices)
+	{
+		MeshletBounds Result;
+		MeshBounds Box;
+		for (uint32_t i = 0; i < vMeshlet.m_VertexCount; ++i)
+			Box.expand(vVertices[vData.m_Vertices[vMeshlet.m_VertexOffset + i]].m_Position);
+		Result.m_Center = Box.getCenter();
+		for (uint32_t i = 0; i < vMeshlet.m_VertexCount; ++i)
+			Result.m_Radius = std::max(Result.m_Radius, glm::length(vVertices[vData.m_Vertices[vMeshlet.m_VertexOffset + i]].m_Position - Result.m_Center));
+
+		// 法线锥：轴取各三角形单位法线之和的方向，半角由与轴夹角最大的法线决定
+		std::vector<glm::vec3> Normals;
+		Normals.reserve(vMeshlet.m_TriangleCount);
+		glm::vec3 NormalSum = glm::vec3(0.0f);
+		for (uint32_t i = 0; i < vMeshlet.m_TriangleCount; ++i) {
+			glm::vec3 Corners[3];
+			for (uint32_t c = 0; c < 3; ++c) {
+				uint8_t Local = vData.m_Triangles[vMeshlet.m_TriangleOffset + i * 3 + c];
+				Corners[c] = vVertices[vData.m_Vertices[vMeshlet.m_VertexOffset + Local]].m_Position;
+			}
+			glm::vec3 Normal = glm::cross(Corners[1] - Corners[0], Corners[2] - Corners[0]);
+			float Length = glm::length(Normal);
+			if (Length <= 0.0f)
+				continue;
+			Normals.push_back(Normal / Length);
+			NormalSum += Normals.back();
+		}
+		float SumLength = glm::length(NormalSum);
+		if (Normals.empty() || SumLength <= 0.0f)
+			return Result;
+		Result.m_ConeAxis = NormalSum / SumLength;
+		float MinCosine = 1.0f;
+		for (const glm::vec3& Normal : Normals)
+			MinCosine = std::min(MinCosine, glm::dot(Normal, Result.m_ConeAxis));
+		if (MinCosine > MinConeCosine)
+			Result.m_ConeCutoff = std::sqrt(1.0f - MinCosine * MinCosine);
+		return Result;
+	}
+
+	std::array<glm::vec4, 6> MeshletBuilder::extractFrustumPlanes(const glm::mat4& vViewProjection)
+	{
+		// Gribb-Hartmann：平面由投影矩阵的行组合得到，Vulkan的深度范围是[0, 1]，近平面就是第三行
+		auto getRow = [&](int vRow) { return glm::vec4(vViewProjection[0][vRow], vViewProjection[1][vRow], vViewProjection[2][vRow], vViewProjection[3][vRow]); };
+		std::array<glm::vec4, 6> Planes{
+			getRow(3) + getRow(0), getRow(3) - getRow(0),
+			getRow(3) + getRow(1), getRow(3) - getRow(1),
+			getRow(2), getRow(3) - getRow(2)
+		};
+		for (glm::vec4& Plane : Planes)
+			Plane /= glm::length(glm::vec3(Plane.x, Plane.y, Plane.z));
+		return Planes;
+	}
+
+	bool MeshletBuilder::isFrustumCulled(const MeshletBounds& vBounds, const std::array<glm::vec4, 6>& vPlanes)
+	{
+		for (const glm::vec4& Plane : vPlanes) {
+			if (glm::dot(glm::vec3(Plane.x, Plane.y, Plane.z), vBounds.m_Center) + Plane.w < -vBounds.m_Radius)
+				return true;
+		}
+		return false;
+	}
+
+	bool MeshletBuilder::isConeCulled(const MeshletBounds& vBounds, const glm::vec3& vCameraPosition)
+	{
+		// 包围球内任意一点看向锥内任意法线都是背面时才能剔除
+		glm::vec3 View = vBounds.m_Center - vCameraPosition;
+		return glm::dot(View, vBounds.m_ConeAxis) >= vBounds.m_ConeCutoff * glm::length(View) + vBounds.m_Radius;
+	}
+
+	MeshletCullStatistics MeshletBuilder::cull(const MeshletData& vData, const glm::mat4& vViewProjection, const glm::vec3& vCameraPosition)
+	{
+		MeshletCullStatistics Result;
+		std::array<glm::vec4, 6> Planes = extractFrustumPlanes(vViewProjection);
+		for (size_t i = 0; i < vData.m_Meshlets.size(); ++i) {
+			if (isFrustumCulled(vData.m_Bounds[i], Planes))
+				++Result.m_FrustumCulledCount;
+			else if (isConeCulled(vData.m_Bounds[i], vCameraPosition))
+				++Result.m_ConeCulledCount;
+			else {
+				++Result.m_VisibleMeshletCount;
+				Result.m_VisibleTriangleCount += vData.m_Meshlets[i].m_TriangleCount;
+			}
+		}
+		return Result;
+	}
+
+}
@@ -0,0 +1,37 @@
+#pragma once
+#include "Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace VulkanTutorial {
+
+	struct MeshletCullStatistics
+	{
+		size_t m_VisibleMeshletCount = 0;
+		size_t m_VisibleTriangleCount = 0;
+		size_t m_FrustumCulledCount = 0;
+		size_t m_ConeCulledCount = 0;
+	};
+
+	// 导入时把三角形切成meshlet：从一个未用的三角形开始，贪心地加入与当前meshlet共享顶点最多、离中心最近的相邻三角形，
+	// 直到顶点或三角形数达到上限；没有相邻三角形可选时按索引顺序取下一个(顶点缓存优化后的顺序本身就有空间局部性)
+	class MeshletBuilder
+	{
+	public:
+		static MeshletData build(std::span<const uint32_t> vIndices, std::span<const MeshVertex> vVertices,
+			uint32_t vMaxVertexCount = MeshletData::MaxVertexCount, uint32_t vMaxTriangleCount = MeshletData::MaxTriangleCount);
+		static MeshletBounds computeBounds(const MeshletData& vData, const Meshlet& vMeshlet, std::span<const MeshVertex> vVertices);
+
+		// 与resources/shaders/glsl/meshlet_cull.comp中的测试一致，用于CPU端统计
+		static std::array<glm::vec4, 6> extractFrustumPlanes(const glm::mat4& vViewProjection);
+		static bool isFrustumCulled(const MeshletBounds& vBounds, const std::array<glm::vec4, 6>& vPlanes);
+		static bool isConeCulled(const MeshletBounds& vBounds, const glm::vec3& vCameraPosition);
+		static MeshletCullStatistics cull(const MeshletData& vData, const glm::mat4& vViewProjection, const glm::vec3& vCameraPosition);
+	};
+
+}
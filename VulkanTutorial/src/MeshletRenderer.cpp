@@ -0,0 +1,565 @@
+#include "MeshletRenderer.h"
+#include "DeviceFunction.h"
+#include "Timer.h"
+#include "VertexLayout.h"
+#include "VertexQuantizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t TaskWorkgroupSize = 32;   // 与meshlet.task的local_size_x一致
+		constexpr VkDeviceSize UploadAlignment = 16;
+
+		// 与shader中的binding一致
+		enum MeshletBinding : uint32_t
+		{
+			MeshletBindingMeshlets = 0,
+			MeshletBindingBounds,
+			MeshletBindingVertices,
+			MeshletBindingTriangles,
+			MeshletBindingOutputIndices,  // 只用于compute剔除路径
+			MeshletBindingDrawCommand,    // 只用于compute剔除路径
+			MeshletBindingMeshPositions,  // 只用于mesh shader路径
+			MeshletBindingMeshAttributes  // 只用于mesh shader路径
+		};
+
+		inline VkDeviceSize alignUp(VkDeviceSize vValue, VkDeviceSize vAlignment)
+		{
+			return (vValue + vAlignment - 1) / vAlignment * vAlignment;
+		}
+
+		uint32_t findMemoryType(VkPhysicalDevice vPhysicalDevice, uint32_t vTypeFilter, VkMemoryPropertyFlags vProperties)
+		{
+			VkPhysicalDeviceMemoryProperties MemoryProperties{};
+			vkGetPhysicalDeviceMemoryProperties(vPhysicalDevice, &MemoryProperties);
+			for (uint32_t i = 0; i < MemoryProperties.memoryTypeCount; ++i) {
+				if ((vTypeFilter & (1 << i)) && (MemoryProperties.memoryTypes[i].propertyFlags & vProperties) == vProperties)
+					return i;
+			}
+			throw std::runtime_error("Failed to find suitable memory type!");
+		}
+
+	}
+
+	MeshletRenderer::~MeshletRenderer()
+	{
+		destroy();
+	}
+
+	void MeshletRenderer::create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, const DeviceFeatures& vFeatures, const DeviceTuning& vTuning, DescriptorCache& vDescriptorCache,
+		VkCommandPool vCommandPool, VkQueue vQueue, VkRenderPass vRenderPass, VkFormat vColorFormat, const MeshCacheFile& vMesh, const MeshletShaderCode& vShaderCode, uint32_t vFrameCount)
+	{
+		std::cout << "Try to create meshlet renderer ..." << "\n";
+		destroy();
+		std::span<const Meshlet> Meshlets = vMesh.getMeshlets();
+		if (Meshlets.empty())
+			throw std::runtime_error("Failed to create meshlet renderer for a mesh without meshlets!");
+		m_PhysicalDevice = vPhysicalDevice;
+		m_Device = vDevice;
+		m_DescriptorCache = &vDescriptorCache;
+		m_IsDynamicRendering = vRenderPass == VK_NULL_HANDLE;
+		m_ColorFormat = vColorFormat;
+		bool IsMeshShader = vFeatures.isMeshShaderSupported() && !vShaderCode.m_Task.empty() && !vShaderCode.m_Mesh.empty();
+		m_StorageStages = IsMeshShader ? VK_SHADER_STAGE_TASK_BIT_EXT | VK_SHADER_STAGE_MESH_BIT_EXT : VK_SHADER_STAGE_COMPUTE_BIT;
+		m_Constants = {};
+		m_Constants.m_MeshletCount = static_cast<uint32_t>(Meshlets.size());
+		size_t TriangleCount = 0;
+		for (const Meshlet& Item : Meshlets)
+			TriangleCount += Item.m_TriangleCount;
+		m_Bounds = vMesh.getBounds();
+		m_Lods.assign(vMesh.getLods().begin(), vMesh.getLods().end());
+		m_CurrentLod = 0;
+		// 粗LOD总是走顶点着色器管线，mesh shader路径下有多级LOD时也要量化顶点流并创建该管线
+		bool HasCoarseLods = m_Lods.size() > 1;
+
+		uploadBuffers(vCommandPool, vQueue, vMesh, IsMeshShader, !IsMeshShader || HasCoarseLods);
+		if (!IsMeshShader) {
+			VkDeviceSize IndexBufferSize = TriangleCount * 3 * sizeof(uint32_t);
+			for (uint32_t i = 0; i < vFrameCount; ++i) {
+				m_IndexBuffers.push_back(createBuffer(IndexBufferSize, VK_BUFFER_USAGE_INDEX_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT,
+					VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+				m_DrawBuffers.push_back(createBuffer(sizeof(VkDrawIndexedIndirectCommand), VK_BUFFER_USAGE_INDIRECT_BUFFER_BIT | VK_BUFFER_USAGE_STORAGE_BUFFER_BIT
+					| VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT));
+			}
+		}
+		createDescriptorSets(vFrameCount);
+		if (IsMeshShader) {
+			createMeshPipeline(vRenderPass, vShaderCode);
+			m_CmdDrawMeshTasks = loadDeviceFunction<PFN_vkCmdDrawMeshTasksEXT>(m_Device, "vkCmdDrawMeshTasksEXT");
+			if (HasCoarseLods)
+				createVertexPipeline(vRenderPass, vShaderCode.m_Vertex, vShaderCode.m_Fragment);
+		}
+		else {
+			createCullPipeline(vShaderCode.m_Cull, vTuning);
+			createVertexPipeline(vRenderPass, vShaderCode.m_Vertex, vShaderCode.m_Fragment);
+		}
+		std::cout << std::format("\t{0} meshlets, {1} triangles, culled by {2}, {3} LODs\n", m_Constants.m_MeshletCount, TriangleCount,
+			IsMeshShader ? "task shader" : "compute shader", std::max<size_t>(m_Lods.size(), 1));
+		std::cout << "Success to create meshlet renderer !" << "\n";
+	}
+
+	void MeshletRenderer::destroy()
+	{
+		if (m_Device == VK_NULL_HANDLE)
+			return;
+		for (VkPipeline Pipeline : { m_CullPipeline, m_VertexPipeline, m_MeshPipeline }) {
+			if (Pipeline != VK_NULL_HANDLE)
+				vkDestroyPipeline(m_Device, Pipeline, nullptr);
+		}
+		for (VkPipelineLayout Layout : { m_CullPipelineLayout, m_VertexPipelineLayout, m_MeshPipelineLayout }) {
+			if (Layout != VK_NULL_HANDLE)
+				vkDestroyPipelineLayout(m_Device, Layout, nullptr);
+		}
+		m_CullPipeline = m_VertexPipeline = m_MeshPipeline = VK_NULL_HANDLE;
+		m_CullWorkGroupSize = 0;
+		m_IsDynamicRendering = false;
+		m_CullPipelineLayout = m_VertexPipelineLayout = m_MeshPipelineLayout = VK_NULL_HANDLE;
+		// 缓存的set键中含有下面将销毁的buffer句柄，必须在句柄可能被复用之前清除；set本身回收给同一layout复用
+		if (!m_DescriptorSets.empty())
+			m_DescriptorCache->clearSets();
+		m_DescriptorCache = nullptr;
+		m_SetLayout = VK_NULL_HANDLE;
+		m_DescriptorSets.clear();
+
+		for (BufferAllocation* Buffer : { &m_PositionBuffer, &m_AttributeBuffer, &m_QuantizedVertexBuffer, &m_LodIndexBuffer, &m_MeshletBuffer, &m_BoundsBuffer, &m_MeshletVertexBuffer, &m_MeshletTriangleBuffer })
+			destroyBuffer(*Buffer);
+		for (BufferAllocation& Buffer : m_IndexBuffers)
+			destroyBuffer(Buffer);
+		for (BufferAllocation& Buffer : m_DrawBuffers)
+			destroyBuffer(Buffer);
+		m_IndexBuffers.clear();
+		m_DrawBuffers.clear();
+		m_CmdDrawMeshTasks = nullptr;
+		m_Lods.clear();
+		m_LodIndices.clear();
+		m_CurrentLod = 0;
+		m_Device = VK_NULL_HANDLE;
+	}
+
+	void MeshletRenderer::cull(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex, const glm::mat4& vViewProjection, const glm::vec3& vCameraPosition)
+	{
+		m_Constants.m_ViewProjection = vViewProjection;
+		m_Constants.m_CameraPosition = glm::vec4(vCameraPosition, 1.0f);
+		if (!isEnabled())
+			return;
+		m_CurrentLod = m_LodSelector.select(m_Lods, vCameraPosition, m_Bounds.getCenter(), glm::length(m_Bounds.getExtent()) * 0.5f);
+		if (m_CurrentLod > 0 || isMeshShaderEnabled()) // 粗LOD没有meshlet，不剔除；mesh shader路径在task shader中剔除
+			return;
+
+		// 该帧的上一轮绘制已经在fence处完成，这里只需保证清零先于剔除、剔除先于绘制
+		const VkDrawIndexedIndirectCommand DrawCommand{ 0, 1, 0, 0, 0 };
+		vkCmdUpdateBuffer(vCommandBuffer, m_DrawBuffers[vFrameIndex].m_Buffer, 0, sizeof(DrawCommand), &DrawCommand);
+		VkMemoryBarrier MemoryBarrier{};
+		MemoryBarrier.sType = VK_STRUCTURE_TYPE_MEMORY_BARRIER;
+		MemoryBarrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+		MemoryBarrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT | VK_ACCESS_SHADER_WRITE_BIT;
+		vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0, 1, &MemoryBarrier, 0, nullptr, 0, nullptr);
+
+		vkCmdBindPipeline(vCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_CullPipeline);
+		vkCmdBindDescriptorSets(vCommandBuffer, VK_PIPELINE_BIND_POINT_COMPUTE, m_CullPipelineLayout, 0, 1, &m_DescriptorSets[vFrameIndex], 0, nullptr);
+		vkCmdPushConstants(vCommandBuffer, m_CullPipelineLayout, VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants), &m_Constants);
+		vkCmdDispatch(vCommandBuffer, (m_Constants.m_MeshletCount + m_CullWorkGroupSize - 1) / m_CullWorkGroupSize, 1, 1);
+
+		MemoryBarrier.srcAccessMask = VK_ACCESS_SHADER_WRITE_BIT;
+		MemoryBarrier.dstAccessMask = VK_ACCESS_INDIRECT_COMMAND_READ_BIT | VK_ACCESS_INDEX_READ_BIT;
+		vkCmdPipelineBarrier(vCommandBuffer, VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, VK_PIPELINE_STAGE_DRAW_INDIRECT_BIT | VK_PIPELINE_STAGE_VERTEX_INPUT_BIT,
+			0, 1, &MemoryBarrier, 0, nullptr, 0, nullptr);
+	}
+
+	void MeshletRenderer::draw(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex, const VkExtent2D& vExtent) const
+	{
+		if (!isEnabled())
+			return;
+		VkViewport Viewport{ 0.0f, 0.0f, static_cast<float>(vExtent.width), static_cast<float>(vExtent.height), 0.0f, 1.0f };
+		VkRect2D Scissor{ { 0, 0 }, vExtent };
+		if (isMeshShaderEnabled() && m_CurrentLod == 0) {
+			vkCmdBindPipeline(vCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_MeshPipeline);
+			vkCmdSetViewport(vCommandBuffer, 0, 1, &Viewport);
+			vkCmdSetScissor(vCommandBuffer, 0, 1, &Scissor);
+			vkCmdBindDescriptorSets(vCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_MeshPipelineLayout, 0, 1, &m_DescriptorSets[vFrameIndex], 0, nullptr);
+			vkCmdPushConstants(vCommandBuffer, m_MeshPipelineLayout, m_StorageStages, 0, sizeof(CullConstants), &m_Constants);
+			m_CmdDrawMeshTasks(vCommandBuffer, (m_Constants.m_MeshletCount + TaskWorkgroupSize - 1) / TaskWorkgroupSize, 1, 1);
+			return;
+		}
+		vkCmdBindPipeline(vCommandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_VertexPipeline);
+		vkCmdSetViewport(vCommandBuffer, 0, 1, &Viewport);
+		vkCmdSetScissor(vCommandBuffer, 0, 1, &Scissor);
+		vkCmdPushConstants(vCommandBuffer, m_VertexPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, 0, sizeof(glm::mat4), &m_Constants.m_ViewProjection);
+		vkCmdPushConstants(vCommandBuffer, m_VertexPipelineLayout, VK_SHADER_STAGE_VERTEX_BIT, VertexDequantization::PushConstantOffset, sizeof(VertexDequantization), &m_Dequantization);
+		VkDeviceSize Offset = 0;
+		vkCmdBindVertexBuffers(vCommandBuffer, 0, QuantizedMeshVertexLayout::BindingCount, &m_QuantizedVertexBuffer.m_Buffer, &Offset);
+		if (m_CurrentLod > 0) {
+			const LodIndexRange& Range = m_LodIndices[m_CurrentLod - 1];
+			vkCmdBindIndexBuffer(vCommandBuffer, m_LodIndexBuffer.m_Buffer, Range.m_Offset, Range.m_Indices.m_IndexType);
+			Range.m_Indices.draw(vCommandBuffer);
+			return;
+		}
+		vkCmdBindIndexBuffer(vCommandBuffer, m_IndexBuffers[vFrameIndex].m_Buffer, 0, VK_INDEX_TYPE_UINT32);
+		vkCmdDrawIndexedIndirect(vCommandBuffer, m_DrawBuffers[vFrameIndex].m_Buffer, 0, 1, sizeof(VkDrawIndexedIndirectCommand));
+	}
+
+	MeshletRenderer::BufferAllocation MeshletRenderer::createBuffer(VkDeviceSize vSize, VkBufferUsageFlags vUsage, VkMemoryPropertyFlags vProperties) const
+	{
+		BufferAllocation Result;
+		VkBufferCreateInfo BufferCreateInfo{};
+		BufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		BufferCreateInfo.size = vSize;
+		BufferCreateInfo.usage = vUsage;
+		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(m_Device, &BufferCreateInfo, nullptr, &Result.m_Buffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create meshlet buffer!");
+
+		VkMemoryRequirements MemoryRequirements;
+		vkGetBufferMemoryRequirements(m_Device, Result.m_Buffer, &MemoryRequirements);
+		VkMemoryAllocateInfo MemoryAllocateInfo{};
+		MemoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		MemoryAllocateInfo.allocationSize = MemoryRequirements.size;
+		MemoryAllocateInfo.memoryTypeIndex = findMemoryType(m_PhysicalDevice, MemoryRequirements.memoryTypeBits, vProperties);
+		if (vkAllocateMemory(m_Device, &MemoryAllocateInfo, nullptr, &Result.m_Memory) != VK_SUCCESS) {
+			vkDestroyBuffer(m_Device, Result.m_Buffer, nullptr);
+			throw std::runtime_error("Failed to allocate meshlet buffer memory!");
+		}
+		vkBindBufferMemory(m_Device, Result.m_Buffer, Result.m_Memory, 0);
+		return Result;
+	}
+
+	void MeshletRenderer::destroyBuffer(BufferAllocation& vBuffer) const
+	{
+		if (vBuffer.m_Buffer != VK_NULL_HANDLE)
+			vkDestroyBuffer(m_Device, vBuffer.m_Buffer, nullptr);
+		if (vBuffer.m_Memory != VK_NULL_HANDLE)
+			vkFreeMemory(m_Device, vBuffer.m_Memory, nullptr);
+		vBuffer = {};
+	}
+
+	void MeshletRenderer::uploadBuffers(VkCommandPool vCommandPool, VkQueue vQueue, const MeshCacheFile& vMesh, bool vIsMeshShader, bool vIsQuantized)
+	{
+		// 所有静态数据放进同一个staging buffer，一次提交完成拷贝。mesh shader路径把两个float顶点流从缓存文件直接解码进staging buffer，
+		// 顶点着色器路径(以及粗LOD)解码后量化成每顶点20字节的单个流再写入；meshlet各数组在缓存中没有压缩，直接memcpy
+		struct Upload
+		{
+			BufferAllocation* m_Target;
+			const void* m_Data;         // 为空时由解码写入
+			VkDeviceSize m_Size;
+			VkBufferUsageFlags m_Usage;
+			VkDeviceSize m_StagingOffset;
+		};
+		const size_t VertexCount = vMesh.getVertexCount();
+		// 索引流依次存放各级LOD，只上传LOD 1起的部分，LOD 0由meshlet绘制。每级粗LOD单独打包，用到的顶点跨度小的级别可以用16位索引；
+		// 顶点着色器管线按三角形列表创建，不使用三角形带。绑定偏移须对齐到索引大小，各级按4字节对齐存放
+		m_LodIndices.clear();
+		std::vector<std::byte> LodIndexData;
+		if (m_Lods.size() > 1) {
+			std::vector<uint32_t> Indices(vMesh.getIndexCount());
+			vMesh.decodeIndices(Indices);
+			IndexPackingConfig PackingConfig;
+			PackingConfig.m_IsStripAllowed = false;
+			for (size_t Lod = 1; Lod < m_Lods.size(); ++Lod) {
+				LodIndexRange& Range = m_LodIndices.emplace_back();
+				Range.m_Indices = IndexPacker::pack(std::span<const uint32_t>(Indices).subspan(m_Lods[Lod].m_IndexOffset, m_Lods[Lod].m_IndexCount), VertexCount, PackingConfig);
+				Range.m_Offset = alignUp(LodIndexData.size(), sizeof(uint32_t));
+				LodIndexData.resize(Range.m_Offset);
+				LodIndexData.insert(LodIndexData.end(), Range.m_Indices.m_Data.begin(), Range.m_Indices.m_Data.end());
+				Range.m_Indices.m_Data = {};
+			}
+		}
+		std::vector<Upload> Uploads;
+		if (vIsMeshShader) {
+			Uploads.push_back({ &m_PositionBuffer, nullptr, VertexCount * sizeof(MeshPositionVertex), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0 });
+			Uploads.push_back({ &m_AttributeBuffer, nullptr, VertexCount * sizeof(MeshAttributeVertex), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0 });
+		}
+		if (vIsQuantized)
+			Uploads.push_back({ &m_QuantizedVertexBuffer, nullptr, VertexCount * sizeof(QuantizedMeshVertex), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, 0 });
+		if (!LodIndexData.empty())
+			Uploads.push_back({ &m_LodIndexBuffer, LodIndexData.data(), LodIndexData.size(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT, 0 });
+		Uploads.insert(Uploads.end(), {
+			{ &m_MeshletBuffer, vMesh.getMeshlets().data(), vMesh.getMeshlets().size_bytes(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0 },
+			{ &m_BoundsBuffer, vMesh.getMeshletBounds().data(), vMesh.getMeshletBounds().size_bytes(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0 },
+			{ &m_MeshletVertexBuffer, vMesh.getMeshletVertices().data(), vMesh.getMeshletVertices().size_bytes(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0 },
+			{ &m_MeshletTriangleBuffer, vMesh.getMeshletTriangles().data(), vMesh.getMeshletTriangles().size_bytes(), VK_BUFFER_USAGE_STORAGE_BUFFER_BIT, 0 }
+			});
+		VkDeviceSize StagingSize = 0;
+		for (Upload& Item : Uploads) {
+			Item.m_StagingOffset = StagingSize;
+			StagingSize = alignUp(StagingSize + Item.m_Size, UploadAlignment);
+		}
+
+		BufferAllocation StagingBuffer = createBuffer(StagingSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		void* Data = nullptr;
+		if (vkMapMemory(m_Device, StagingBuffer.m_Memory, 0, StagingSize, 0, &Data) != VK_SUCCESS) {
+			destroyBuffer(StagingBuffer);
+			throw std::runtime_error("Failed to map meshlet staging buffer memory!");
+		}
+		try {
+			for (const Upload& Item : Uploads) {
+				if (Item.m_Data != nullptr)
+					std::memcpy(static_cast<std::byte*>(Data) + Item.m_StagingOffset, Item.m_Data, Item.m_Size);
+			}
+			auto getStaging = [&Uploads, Data](const BufferAllocation& vTarget) -> void* {
+				for (const Upload& Item : Uploads) {
+					if (Item.m_Target == &vTarget)
+						return static_cast<std::byte*>(Data) + Item.m_StagingOffset;
+				}
+				return nullptr;
+			};
+			Timer DecodeTimer;
+			std::span<MeshPositionVertex> StagingPositions{ static_cast<MeshPositionVertex*>(getStaging(m_PositionBuffer)), vIsMeshShader ? VertexCount : 0 };
+			std::span<MeshAttributeVertex> StagingAttributes{ static_cast<MeshAttributeVertex*>(getStaging(m_AttributeBuffer)), vIsMeshShader ? VertexCount : 0 };
+			if (!vIsQuantized) {
+				vMesh.decodeVertexStreams(StagingPositions, StagingAttributes);
+			}
+			else {
+				// 量化要读回解码结果：逐块解码到缓存中的小块内存，再从那里量化写入staging，不读可能是write-combined的映射内存，
+				// 也不为整个网格分配中间数组。反量化参数由缓存中的包围盒和纹理坐标范围预先确定
+				m_Dequantization = VertexQuantizer::getStreamDequantization(vMesh.getBounds(), vMesh.getTexCoordBounds());
+				QuantizedMeshVertex* StagingQuantized = static_cast<QuantizedMeshVertex*>(getStaging(m_QuantizedVertexBuffer));
+				vMesh.decodeVertexStreamBlocks([&](size_t vBase, std::span<const MeshPositionVertex> vPositions, std::span<const MeshAttributeVertex> vAttributes) {
+					if (vIsMeshShader) {
+						std::memcpy(StagingPositions.data() + vBase, vPositions.data(), vPositions.size_bytes());
+						std::memcpy(StagingAttributes.data() + vBase, vAttributes.data(), vAttributes.size_bytes());
+					}
+					VertexQuantizer::quantizeStreams(vPositions, vAttributes, m_Dequantization, { StagingQuantized + vBase, vPositions.size() });
+					});
+			}
+			// 吞吐量按解码出的float顶点字节计，与是否量化无关，便于比较
+			float DecodeMilliseconds = DecodeTimer.ellapseMilliseconds();
+			std::cout << std::format("\t{0} {1} vertices into staging memory: {2:.2f} ms, {3:.0f} MB/s\n", vIsQuantized ? "decode and quantize" : "decode", VertexCount,
+				DecodeMilliseconds, computeMegabytesPerSecond(VertexCount * sizeof(MeshVertex), DecodeMilliseconds));
+		}
+		catch (...) {
+			vkUnmapMemory(m_Device, StagingBuffer.m_Memory);
+			destroyBuffer(StagingBuffer);
+			throw;
+		}
+		vkUnmapMemory(m_Device, StagingBuffer.m_Memory);
+		for (const Upload& Item : Uploads)
+			*Item.m_Target = createBuffer(Item.m_Size, Item.m_Usage | VK_BUFFER_USAGE_TRANSFER_DST_BIT, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+
+		VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
+		CommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		CommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		CommandBufferAllocateInfo.commandPool = vCommandPool;
+		CommandBufferAllocateInfo.commandBufferCount = 1;
+		VkCommandBuffer CopyCommandBuffer = VK_NULL_HANDLE;
+		if (vkAllocateCommandBuffers(m_Device, &CommandBufferAllocateInfo, &CopyCommandBuffer) != VK_SUCCESS) {
+			destroyBuffer(StagingBuffer);
+			throw std::runtime_error("Failed to allocate command buffers!");
+		}
+		VkCommandBufferBeginInfo CommandBufferBeginInfo{};
+		CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		CommandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(CopyCommandBuffer, &CommandBufferBeginInfo);
+		for (const Upload& Item : Uploads) {
+			VkBufferCopy CopyRegion{ Item.m_StagingOffset, 0, Item.m_Size };
+			vkCmdCopyBuffer(CopyCommandBuffer, StagingBuffer.m_Buffer, Item.m_Target->m_Buffer, 1, &CopyRegion);
+		}
+		vkEndCommandBuffer(CopyCommandBuffer);
+
+		VkSubmitInfo SubmitInfo{};
+		SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		SubmitInfo.commandBufferCount = 1;
+		SubmitInfo.pCommandBuffers = &CopyCommandBuffer;
+		vkQueueSubmit(vQueue, 1, &SubmitInfo, VK_NULL_HANDLE);
+		vkQueueWaitIdle(vQueue);
+		vkFreeCommandBuffers(m_Device, vCommandPool, 1, &CopyCommandBuffer);
+		destroyBuffer(StagingBuffer);
+	}
+
+	void MeshletRenderer::createDescriptorSets(uint32_t vFrameCount)
+	{
+		// 静态数据所有帧共用，只有compute路径的输出索引和间接绘制参数按帧区分
+		bool IsMeshShader = m_IndexBuffers.empty();
+		std::vector<uint32_t> Bindings{ MeshletBindingMeshlets, MeshletBindingBounds, MeshletBindingVertices, MeshletBindingTriangles };
+		if (IsMeshShader) {
+			Bindings.push_back(MeshletBindingMeshPositions);
+			Bindings.push_back(MeshletBindingMeshAttributes);
+		}
+		else {
+			Bindings.push_back(MeshletBindingOutputIndices);
+			Bindings.push_back(MeshletBindingDrawCommand);
+		}
+
+		std::vector<VkDescriptorSetLayoutBinding> LayoutBindings;
+		for (uint32_t Binding : Bindings)
+			LayoutBindings.push_back({ Binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 1, m_StorageStages, nullptr });
+		m_SetLayout = m_DescriptorCache->getLayout(LayoutBindings);
+
+		m_DescriptorSets.resize(vFrameCount);
+		for (uint32_t i = 0; i < vFrameCount; ++i) {
+			auto getBuffer = [&](uint32_t vBinding) {
+				switch (vBinding) {
+				case MeshletBindingMeshlets: return m_MeshletBuffer.m_Buffer;
+				case MeshletBindingBounds: return m_BoundsBuffer.m_Buffer;
+				case MeshletBindingVertices: return m_MeshletVertexBuffer.m_Buffer;
+				case MeshletBindingTriangles: return m_MeshletTriangleBuffer.m_Buffer;
+				case MeshletBindingOutputIndices: return m_IndexBuffers[i].m_Buffer;
+				case MeshletBindingDrawCommand: return m_DrawBuffers[i].m_Buffer;
+				case MeshletBindingMeshPositions: return m_PositionBuffer.m_Buffer;
+				default: return m_AttributeBuffer.m_Buffer;
+				}
+			};
+			std::vector<DescriptorWrite> Writes;
+			for (uint32_t Binding : Bindings)
+				Writes.push_back({ Binding, VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, { { getBuffer(Binding), 0, VK_WHOLE_SIZE } }, {} });
+			m_DescriptorSets[i] = m_DescriptorCache->getSet(m_SetLayout, Writes);  // 与已写好的set内容相同时直接复用，不再更新
+		}
+	}
+
+	VkShaderModule MeshletRenderer::createShaderModule(std::span<const uint32_t> vCode) const
+	{
+		VkShaderModuleCreateInfo ShaderModuleCreateInfo{};
+		ShaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+		ShaderModuleCreateInfo.codeSize = vCode.size_bytes();
+		ShaderModuleCreateInfo.pCode = vCode.data();
+		VkShaderModule ShaderModule = VK_NULL_HANDLE;
+		if (vkCreateShaderModule(m_Device, &ShaderModuleCreateInfo, nullptr, &ShaderModule) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create shader module!");
+		return ShaderModule;
+	}
+
+	void MeshletRenderer::createCullPipeline(std::span<const uint32_t> vCode, const DeviceTuning& vTuning)
+	{
+		VkPushConstantRange PushConstantRange{ VK_SHADER_STAGE_COMPUTE_BIT, 0, sizeof(CullConstants) };
+		VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo{};
+		PipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		PipelineLayoutCreateInfo.setLayoutCount = 1;
+		PipelineLayoutCreateInfo.pSetLayouts = &m_SetLayout;
+		PipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		PipelineLayoutCreateInfo.pPushConstantRanges = &PushConstantRange;
+		if (vkCreatePipelineLayout(m_Device, &PipelineLayoutCreateInfo, nullptr, &m_CullPipelineLayout) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create meshlet cull pipeline layout!");
+
+		// local_size_x_id = WorkGroupSizeConstantID，dispatch的工作组数必须按同一个值计算
+		SpecializationConstants Constants;
+		vTuning.apply(Constants);
+		VkSpecializationInfo SpecializationInfo = Constants.getInfo();
+		m_CullWorkGroupSize = vTuning.m_WorkGroupSize;
+
+		VkShaderModule ShaderModule = createShaderModule(vCode);
+		VkComputePipelineCreateInfo PipelineCreateInfo{};
+		PipelineCreateInfo.sType = VK_STRUCTURE_TYPE_COMPUTE_PIPELINE_CREATE_INFO;
+		PipelineCreateInfo.stage.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+		PipelineCreateInfo.stage.stage = VK_SHADER_STAGE_COMPUTE_BIT;
+		PipelineCreateInfo.stage.module = ShaderModule;
+		PipelineCreateInfo.stage.pName = "main";
+		PipelineCreateInfo.stage.pSpecializationInfo = &SpecializationInfo;
+		PipelineCreateInfo.layout = m_CullPipelineLayout;
+		VkResult Result = vkCreateComputePipelines(m_Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, nullptr, &m_CullPipeline);
+		vkDestroyShaderModule(m_Device, ShaderModule, nullptr);
+		if (Result != VK_SUCCESS)
+			throw std::runtime_error("Failed to create meshlet cull pipeline!");
+	}
+
+	void MeshletRenderer::createVertexPipeline(VkRenderPass vRenderPass, std::span<const uint32_t> vVertexCode, std::span<const uint32_t> vFragmentCode)
+	{
+		VkPushConstantRange PushConstantRange{ VK_SHADER_STAGE_VERTEX_BIT, 0, VertexDequantization::PushConstantOffset + sizeof(VertexDequantization) };
+		VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo{};
+		PipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		PipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		PipelineLayoutCreateInfo.pPushConstantRanges = &PushConstantRange;
+		if (vkCreatePipelineLayout(m_Device, &PipelineLayoutCreateInfo, nullptr, &m_VertexPipelineLayout) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create meshlet draw pipeline layout!");
+
+		std::vector<VkPipelineShaderStageCreateInfo> Stages(2);
+		Stages[0] = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_VERTEX_BIT, createShaderModule(vVertexCode), "main", nullptr };
+		Stages[1] = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, createShaderModule(vFragmentCode), "main", nullptr };
+		m_VertexPipeline = createGraphicsPipeline(Stages, m_VertexPipelineLayout, vRenderPass, false);
+	}
+
+	void MeshletRenderer::createMeshPipeline(VkRenderPass vRenderPass, const MeshletShaderCode& vShaderCode)
+	{
+		VkPushConstantRange PushConstantRange{ m_StorageStages, 0, sizeof(CullConstants) };
+		VkPipelineLayoutCreateInfo PipelineLayoutCreateInfo{};
+		PipelineLayoutCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LAYOUT_CREATE_INFO;
+		PipelineLayoutCreateInfo.setLayoutCount = 1;
+		PipelineLayoutCreateInfo.pSetLayouts = &m_SetLayout;
+		PipelineLayoutCreateInfo.pushConstantRangeCount = 1;
+		PipelineLayoutCreateInfo.pPushConstantRanges = &PushConstantRange;
+		if (vkCreatePipelineLayout(m_Device, &PipelineLayoutCreateInfo, nullptr, &m_MeshPipelineLayout) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create mesh shader pipeline layout!");
+
+		std::vector<VkPipelineShaderStageCreateInfo> Stages(3);
+		Stages[0] = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_TASK_BIT_EXT, createShaderModule(vShaderCode.m_Task), "main", nullptr };
+		Stages[1] = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_MESH_BIT_EXT, createShaderModule(vShaderCode.m_Mesh), "main", nullptr };
+		Stages[2] = { VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO, nullptr, 0, VK_SHADER_STAGE_FRAGMENT_BIT, createShaderModule(vShaderCode.m_Fragment), "main", nullptr };
+		m_MeshPipeline = createGraphicsPipeline(Stages, m_MeshPipelineLayout, vRenderPass, true);
+	}
+
+	VkPipeline MeshletRenderer::createGraphicsPipeline(const std::vector<VkPipelineShaderStageCreateInfo>& vStages, VkPipelineLayout vLayout, VkRenderPass vRenderPass, bool vIsMeshShader) const
+	{
+		VkPipelineVertexInputStateCreateInfo VertexInputState{};
+		VertexInputState.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+		VertexInputState.vertexBindingDescriptionCount = QuantizedMeshVertexLayout::BindingCount;
+		VertexInputState.pVertexBindingDescriptions = QuantizedMeshVertexLayout::Bindings.data();
+		VertexInputState.vertexAttributeDescriptionCount = QuantizedMeshVertexLayout::AttributeCount;
+		VertexInputState.pVertexAttributeDescriptions = QuantizedMeshVertexLayout::Attributes.data();
+		VkPipelineInputAssemblyStateCreateInfo InputAssemblyState{};
+		InputAssemblyState.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+		InputAssemblyState.topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+
+		VkPipelineViewportStateCreateInfo ViewportState{};
+		ViewportState.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+		ViewportState.viewportCount = 1;
+		ViewportState.scissorCount = 1;
+		// 投影矩阵翻转了Y轴，模型中逆时针的三角形在屏幕上仍是逆时针
+		VkPipelineRasterizationStateCreateInfo RasterizationState{};
+		RasterizationState.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+		RasterizationState.polygonMode = VK_POLYGON_MODE_FILL;
+		RasterizationState.cullMode = VK_CULL_MODE_BACK_BIT;
+		RasterizationState.frontFace = VK_FRONT_FACE_COUNTER_CLOCKWISE;
+		RasterizationState.lineWidth = 1.0f;
+		VkPipelineMultisampleStateCreateInfo MultisampleState{};
+		MultisampleState.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+		MultisampleState.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+		VkPipelineColorBlendAttachmentState ColorBlendAttachment{};
+		ColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT | VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		VkPipelineColorBlendStateCreateInfo ColorBlendState{};
+		ColorBlendState.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+		ColorBlendState.attachmentCount = 1;
+		ColorBlendState.pAttachments = &ColorBlendAttachment;
+		std::array<VkDynamicState, 2> DynamicStates{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+		VkPipelineDynamicStateCreateInfo DynamicState{};
+		DynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+		DynamicState.dynamicStateCount = static_cast<uint32_t>(DynamicStates.size());
+		DynamicState.pDynamicStates = DynamicStates.data();
+
+		VkGraphicsPipelineCreateInfo PipelineCreateInfo{};
+		PipelineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		PipelineCreateInfo.stageCount = static_cast<uint32_t>(vStages.size());
+		PipelineCreateInfo.pStages = vStages.data();
+		PipelineCreateInfo.pVertexInputState = vIsMeshShader ? nullptr : &VertexInputState;  // mesh shader管线没有顶点输入阶段
+		PipelineCreateInfo.pInputAssemblyState = vIsMeshShader ? nullptr : &InputAssemblyState;
+		PipelineCreateInfo.pViewportState = &ViewportState;
+		PipelineCreateInfo.pRasterizationState = &RasterizationState;
+		PipelineCreateInfo.pMultisampleState = &MultisampleState;
+		PipelineCreateInfo.pColorBlendState = &ColorBlendState;
+		PipelineCreateInfo.pDynamicState = &DynamicState;
+		PipelineCreateInfo.layout = vLayout;
+		PipelineCreateInfo.renderPass = vRenderPass;
+		PipelineCreateInfo.subpass = 0;
+		VkPipelineRenderingCreateInfo RenderingCreateInfo{};
+		RenderingCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_RENDERING_CREATE_INFO;
+		RenderingCreateInfo.colorAttachmentCount = 1;
+		RenderingCreateInfo.pColorAttachmentFormats = &m_ColorFormat;
+		if (m_IsDynamicRendering)
+			PipelineCreateInfo.pNext = &RenderingCreateInfo;
+		VkPipeline Pipeline = VK_NULL_HANDLE;
+		VkResult Result = vkCreateGraphicsPipelines(m_Device, VK_NULL_HANDLE, 1, &PipelineCreateInfo, nullptr, &Pipeline);
+		for (const VkPipelineShaderStageCreateInfo& Stage : vStages)
+			vkDestroyShaderModule(m_Device, Stage.module, nullptr);
+		if (Result != VK_SUCCESS)
+			throw std::runtime_error("Failed to create meshlet graphics pipeline!");
+		return Pipeline;
+	}
+
+}
@@ -0,0 +1,132 @@
+#pragma once
+#include "DescriptorCache.h"
+#include "DeviceFeatures.h"
+#include "DeviceTuning.h"
+#include "IndexPacker.h"
+#include "LodSelector.h"
+#include "Mesh.h"
+#include "MeshCache.h"
+#include "VertexQuantizer.h"
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	struct MeshletShaderCode
+	{
+		std::span<const uint32_t> m_Cull;      // meshlet_cull.comp
+		std::span<const uint32_t> m_Vertex;    // quantized_mesh.vert
+		std::span<const uint32_t> m_Fragment;  // meshlet.frag
+		std::span<const uint32_t> m_Task;      // meshlet.task，为空时不使用mesh shader
+		std::span<const uint32_t> m_Mesh;      // meshlet.mesh
+	};
+
+	// 按meshlet剔除后绘制一个网格。默认路径：compute shader对每个meshlet做视锥和法线锥测试，
+	// 把可见meshlet的三角形写成紧凑的32位索引列表，再用vkCmdDrawIndexedIndirect绘制，索引数由GPU累加。
+	// 设备支持VK_EXT_mesh_shader时改由task shader剔除、mesh shader直接输出meshlet，不再经过索引缓冲。
+	// 输出索引和间接绘制参数每帧一份，避免下一帧的剔除覆盖GPU还在读的数据。
+	// 每帧cull时按相机用LodSelector选LOD；meshlet只由LOD 0切分，选中更粗的LOD时不剔除，直接用顶点着色器管线绘制该级的索引区间
+	class MeshletRenderer
+	{
+	public:
+		MeshletRenderer() = default;
+		~MeshletRenderer();
+
+		MeshletRenderer(const MeshletRenderer&) = delete;
+		MeshletRenderer& operator=(const MeshletRenderer&) = delete;
+
+		// 顶点从缓存文件直接解码进staging buffer，上传通过vCommandPool/vQueue同步完成；vRenderPass的subpass 0须只有一个颜色附件，
+		// vRenderPass为空时图形管线按动态渲染创建，颜色附件格式为vColorFormat。剔除的工作组大小和循环展开次数按vTuning特化。
+		// set layout和每帧的descriptor set都从vDescriptorCache获取，内容相同的帧共用同一个set
+		void create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, const DeviceFeatures& vFeatures, const DeviceTuning& vTuning, DescriptorCache& vDescriptorCache,
+			VkCommandPool vCommandPool, VkQueue vQueue,
+			VkRenderPass vRenderPass, VkFormat vColorFormat, const MeshCacheFile& vMesh, const MeshletShaderCode& vShaderCode, uint32_t vFrameCount);
+		void destroy();  // 同时清除vDescriptorCache中缓存的set，它们引用本渲染器的buffer
+
+		void cull(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex, const glm::mat4& vViewProjection, const glm::vec3& vCameraPosition);  // 必须在render pass之外录制
+		void draw(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex, const VkExtent2D& vExtent) const;  // 使用最近一次cull的相机和LOD
+
+		inline void setLodProjection(float vVerticalFov, uint32_t vViewportHeight) { m_LodSelector.setProjection(vVerticalFov, vViewportHeight); }  // vVerticalFov为弧度
+
+		inline bool isEnabled() const { return m_Device != VK_NULL_HANDLE; }
+		inline bool isMeshShaderEnabled() const { return m_MeshPipeline != VK_NULL_HANDLE; }
+		inline bool isDynamicRendering() const { return m_IsDynamicRendering; }  // 为true时只能在vkCmdBeginRendering中绘制
+		inline uint32_t getMeshletCount() const { return m_Constants.m_MeshletCount; }
+		inline uint32_t getCurrentLod() const { return m_CurrentLod; }
+	private:
+		// 与shader中的push constant块一致；顶点着色器路径只push其中的viewProjection，其后接VertexDequantization
+		struct CullConstants
+		{
+			glm::mat4 m_ViewProjection = glm::mat4(1.0f);
+			glm::vec4 m_CameraPosition = glm::vec4(0.0f);
+			uint32_t m_MeshletCount = 0;
+		};
+
+		struct BufferAllocation
+		{
+			VkBuffer m_Buffer = VK_NULL_HANDLE;
+			VkDeviceMemory m_Memory = VK_NULL_HANDLE;
+		};
+
+		// 一级粗LOD在m_LodIndexBuffer中的位置和打包格式，上传后不保留索引数据
+		struct LodIndexRange
+		{
+			PackedIndices m_Indices;
+			VkDeviceSize m_Offset = 0;
+		};
+
+		BufferAllocation createBuffer(VkDeviceSize vSize, VkBufferUsageFlags vUsage, VkMemoryPropertyFlags vProperties) const;
+		void destroyBuffer(BufferAllocation& vBuffer) const;
+		void uploadBuffers(VkCommandPool vCommandPool, VkQueue vQueue, const MeshCacheFile& vMesh, bool vIsMeshShader, bool vIsQuantized);
+		void createDescriptorSets(uint32_t vFrameCount);
+		VkShaderModule createShaderModule(std::span<const uint32_t> vCode) const;
+		void createCullPipeline(std::span<const uint32_t> vCode, const DeviceTuning& vTuning);
+		void createVertexPipeline(VkRenderPass vRenderPass, std::span<const uint32_t> vVertexCode, std::span<const uint32_t> vFragmentCode);
+		void createMeshPipeline(VkRenderPass vRenderPass, const MeshletShaderCode& vShaderCode);
+		VkPipeline createGraphicsPipeline(const std::vector<VkPipelineShaderStageCreateInfo>& vStages, VkPipelineLayout vLayout, VkRenderPass vRenderPass, bool vIsMeshShader) const;
+	private:
+		VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
+		VkDevice m_Device = VK_NULL_HANDLE;
+		VkShaderStageFlags m_StorageStages = 0;
+		bool m_IsDynamicRendering = false;
+		VkFormat m_ColorFormat = VK_FORMAT_UNDEFINED;  // 只用于动态渲染
+
+		BufferAllocation m_PositionBuffer;          // MeshPositionVertex，只用于mesh shader路径，作为storage buffer读取
+		BufferAllocation m_AttributeBuffer;         // MeshAttributeVertex，同上
+		BufferAllocation m_QuantizedVertexBuffer;   // QuantizedMeshVertex，顶点着色器路径和粗LOD使用，按QuantizedMeshVertexLayout绑定
+		BufferAllocation m_LodIndexBuffer;          // LOD 1及以后各级的索引，各级按m_LodIndices的格式打包后依次存放，网格只有一级时为空
+		BufferAllocation m_MeshletBuffer;
+		BufferAllocation m_BoundsBuffer;
+		BufferAllocation m_MeshletVertexBuffer;
+		BufferAllocation m_MeshletTriangleBuffer;
+		std::vector<BufferAllocation> m_IndexBuffers;  // 每帧一份，容量为LOD 0的全部索引
+		std::vector<BufferAllocation> m_DrawBuffers;   // 每帧一份VkDrawIndexedIndirectCommand
+
+		DescriptorCache* m_DescriptorCache = nullptr;
+		VkDescriptorSetLayout m_SetLayout = VK_NULL_HANDLE;  // 由DescriptorCache持有
+		std::vector<VkDescriptorSet> m_DescriptorSets;       // 每帧一个，mesh shader路径各帧内容相同，缓存命中后是同一个set
+		VkPipelineLayout m_CullPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline m_CullPipeline = VK_NULL_HANDLE;
+		uint32_t m_CullWorkGroupSize = 0;           // 特化后的local_size_x，决定dispatch的工作组数
+		VkPipelineLayout m_VertexPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline m_VertexPipeline = VK_NULL_HANDLE;
+		VkPipelineLayout m_MeshPipelineLayout = VK_NULL_HANDLE;
+		VkPipeline m_MeshPipeline = VK_NULL_HANDLE;
+		PFN_vkCmdDrawMeshTasksEXT m_CmdDrawMeshTasks = nullptr;
+
+		CullConstants m_Constants;
+		VertexDequantization m_Dequantization;  // 顶点着色器路径在viewProjection之后push
+
+		LodSelector m_LodSelector;
+		MeshBounds m_Bounds;
+		std::vector<MeshLod> m_Lods;   // 索引区间相对缓存中的完整索引流
+		std::vector<LodIndexRange> m_LodIndices;  // m_LodIndices[i]对应LOD i + 1，各级可以是不同的索引格式
+		uint32_t m_CurrentLod = 0;
+	};
+
+}
@@ -0,0 +1,262 @@
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "ParallelFor.h"
+#include "VertexDeduplicator.h"
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <format>
+#include <stdexcept>
+#include <string_view>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr size_t MinChunkSize = 1 << 20; // 小文件不值得切块
+
+		struct Chunk
+		{
+			const char* m_Begin = nullptr;
+			const char* m_End = nullptr;
+			size_t m_PositionCount = 0;
+			size_t m_TexCoordCount = 0;
+			size_t m_NormalCount = 0;
+			size_t m_PositionBase = 0;
+			size_t m_TexCoordBase = 0;
+			size_t m_NormalBase = 0;
+			bool m_HasColor = false;
+			std::vector<ObjIndex> m_Indices;
+		};
+
+		inline bool isSpace(char vChar) { return vChar == ' ' || vChar == '\t' || vChar == '\r'; }
+
+		inline const char* skipSpace(const char* vBegin, const char* vEnd)
+		{
+			while (vBegin < vEnd && isSpace(*vBegin))
+				++vBegin;
+			return vBegin;
+		}
+
+		inline const char* findLineEnd(const char* vBegin, const char* vEnd)
+		{
+			const void* LineEnd = std::memchr(vBegin, '\n', static_cast<size_t>(vEnd - vBegin));
+			return LineEnd ? static_cast<const char*>(LineEnd) : vEnd;
+		}
+
+		// 读取一行中最多vMaxCount个float，返回实际读到的数量
+		size_t parseFloats(const char* vBegin, const char* vEnd, float* vValues, size_t vMaxCount)
+		{
+			size_t Count = 0;
+			while (Count < vMaxCount) {
+				vBegin = skipSpace(vBegin, vEnd);
+				if (vBegin >= vEnd)
+					break;
+				if (*vBegin == '+') // from_chars不接受前导加号
+					++vBegin;
+				auto [Pointer, Error] = std::from_chars(vBegin, vEnd, vValues[Count]);
+				if (Error != std::errc())
+					break;
+				vBegin = Pointer;
+				++Count;
+			}
+			return Count;
+		}
+
+		// OBJ索引从1开始，负数表示相对于当前已定义数量的倒数
+		inline int32_t resolveIndex(int64_t vIndex, size_t vDefinedCount)
+		{
+			if (vIndex > 0)
+				return static_cast<int32_t>(vIndex - 1);
+			if (vIndex < 0)
+				return static_cast<int32_t>(static_cast<int64_t>(vDefinedCount) + vIndex);
+			return -1;
+		}
+
+		const char* parseFaceVertex(const char* vBegin, const char* vEnd, const Chunk& vChunk, size_t vPositionCount,
+			size_t vTexCoordCount, size_t vNormalCount, ObjIndex& vIndex)
+		{
+			int64_t Values[3] = { 0, 0, 0 };
+			for (int k = 0; k < 3; ++k) {
+				if (vBegin < vEnd && *vBegin != '/' && !isSpace(*vBegin)) {
+					auto [Pointer, Error] = std::from_chars(vBegin, vEnd, Values[k]);
+					if (Error != std::errc())
+						throw std::runtime_error("Fail to parse a face index in the OBJ file.");
+					vBegin = Pointer;
+				}
+				if (vBegin >= vEnd || *vBegin != '/')
+					break;
+				++vBegin;
+			}
+			vIndex.m_Position = resolveIndex(Values[0], vChunk.m_PositionBase + vPositionCount);
+			vIndex.m_TexCoord = resolveIndex(Values[1], vChunk.m_TexCoordBase + vTexCoordCount);
+			vIndex.m_Normal = resolveIndex(Values[2], vChunk.m_NormalBase + vNormalCount);
+			return vBegin;
+		}
+
+		void countChunk(Chunk& vChunk)
+		{
+			for (const char* Line = vChunk.m_Begin; Line < vChunk.m_End;) {
+				const char* LineEnd = findLineEnd(Line, vChunk.m_End);
+				const char* Pointer = skipSpace(Line, LineEnd);
+				if (LineEnd - Pointer >= 2 && Pointer[0] == 'v') {
+					if (isSpace(Pointer[1]))
+						++vChunk.m_PositionCount;
+					else if (Pointer[1] == 't')
+						++vChunk.m_TexCoordCount;
+					else if (Pointer[1] == 'n')
+						++vChunk.m_NormalCount;
+				}
+				Line = LineEnd + 1;
+			}
+		}
+
+		void parseChunk(Chunk& vChunk, ObjData& vData)
+		{
+			size_t PositionCount = 0, TexCoordCount = 0, NormalCount = 0;
+			std::vector<ObjIndex> Polygon;
+			for (const char* Line = vChunk.m_Begin; Line < vChunk.m_End;) {
+				const char* LineEnd = findLineEnd(Line, vChunk.m_End);
+				const char* Pointer = skipSpace(Line, LineEnd);
+				if (LineEnd - Pointer < 2) {
+					Line = LineEnd + 1;
+					continue;
+				}
+
+				if (Pointer[0] == 'v' && isSpace(Pointer[1])) {
+					float Values[6];
+					size_t Count = parseFloats(Pointer + 2, LineEnd, Values, 6);
+					if (Count < 3)
+						throw std::runtime_error("Fail to parse a vertex position in the OBJ file.");
+					size_t Index = vChunk.m_PositionBase + PositionCount++;
+					vData.m_Positions[Index] = glm::vec3(Values[0], Values[1], Values[2]);
+					if (Count == 6) {
+						vData.m_Colors[Index] = glm::vec3(Values[3], Values[4], Values[5]);
+						vChunk.m_HasColor = true;
+					}
+				}
+				else if (Pointer[0] == 'v' && Pointer[1] == 't') {
+					float Values[2] = { 0.0f, 0.0f };
+					if (parseFloats(Pointer + 2, LineEnd, Values, 2) < 1)
+						throw std::runtime_error("Fail to parse a texture coordinate in the OBJ file.");
+					vData.m_TexCoords[vChunk.m_TexCoordBase + TexCoordCount++] = glm::vec2(Values[0], Values[1]);
+				}
+				else if (Pointer[0] == 'v' && Pointer[1] == 'n') {
+					float Values[3];
+					if (parseFloats(Pointer + 2, LineEnd, Values, 3) < 3)
+						throw std::runtime_error("Fail to parse a vertex normal in the OBJ file.");
+					vData.m_Normals[vChunk.m_NormalBase + NormalCount++] = glm::vec3(Values[0], Values[1], Values[2]);
+				}
+				else if (Pointer[0] == 'f' && isSpace(Pointer[1])) {
+					Polygon.clear();
+					for (const char* Token = skipSpace(Pointer + 2, LineEnd); Token < LineEnd; Token = skipSpace(Token, LineEnd)) {
+						ObjIndex Index;
+						Token = parseFaceVertex(Token, LineEnd, vChunk, PositionCount, TexCoordCount, NormalCount, Index);
+						Polygon.emplace_back(Index);
+					}
+					for (size_t k = 2; k < Polygon.size(); ++k) { // 扇形三角化
+						vChunk.m_Indices.emplace_back(Polygon[0]);
+						vChunk.m_Indices.emplace_back(Polygon[k - 1]);
+						vChunk.m_Indices.emplace_back(Polygon[k]);
+					}
+				}
+				Line = LineEnd + 1;
+			}
+		}
+
+	}
+
+	ObjData ObjLoader::load(const std::filesystem::path& vPath)
+	{
+		MappedFile File(vPath);
+		const char* Begin = reinterpret_cast<const char*>(File.data());
+		const char* End = Begin + File.size();
+
+		// 按行边界切块，块数是线程数的几倍以平衡负载
+		const size_t ChunkCount = std::max<size_t>(1, std::min<size_t>(getWorkerCount() * 4, File.size() / MinChunkSize));
+		const size_t ChunkSize = File.size() / ChunkCount + 1;
+		std::vector<Chunk> Chunks;
+		for (const char* ChunkBegin = Begin; ChunkBegin < End;) {
+			const char* ChunkEnd = ChunkBegin + std::min<size_t>(ChunkSize, End - ChunkBegin);
+			ChunkEnd = ChunkEnd < End ? findLineEnd(ChunkEnd, End) : End;
+			ChunkEnd = ChunkEnd < End ? ChunkEnd + 1 : End;
+			Chunk& Item = Chunks.emplace_back(); // 其余成员取默认值，计数在countChunk中填写
+			Item.m_Begin = ChunkBegin;
+			Item.m_End = ChunkEnd;
+			ChunkBegin = ChunkEnd;
+		}
+
+		parallelFor(Chunks.size(), [&Chunks](size_t i) { countChunk(Chunks[i]); });
+
+		ObjData Data;
+		size_t PositionCount = 0, TexCoordCount = 0, NormalCount = 0;
+		for (auto& Chunk : Chunks) {
+			Chunk.m_PositionBase = PositionCount;
+			Chunk.m_TexCoordBase = TexCoordCount;
+			Chunk.m_NormalBase = NormalCount;
+			PositionCount += Chunk.m_PositionCount;
+			TexCoordCount += Chunk.m_TexCoordCount;
+			NormalCount += Chunk.m_NormalCount;
+		}
+		Data.m_Positions.resize(PositionCount);
+		Data.m_Colors.resize(PositionCount, glm::vec3(1.0f));
+		Data.m_TexCoords.resize(TexCoordCount);
+		Data.m_Normals.resize(NormalCount);
+
+		try {
+			parallelFor(Chunks.size(), [&Chunks, &Data](size_t i) { parseChunk(Chunks[i], Data); });
+		}
+		catch (const std::runtime_error& vError) {
+			throw std::runtime_error(std::format(R"({0} ("{1}"))", vError.what(), vPath.string()));
+		}
+
+		// 拼接各块的面索引
+		std::vector<size_t> IndexOffsets(Chunks.size() + 1, 0);
+		bool HasColor = false;
+		for (size_t i = 0; i < Chunks.size(); ++i) {
+			IndexOffsets[i + 1] = IndexOffsets[i] + Chunks[i].m_Indices.size();
+			HasColor |= Chunks[i].m_HasColor;
+		}
+		Data.m_Indices.resize(IndexOffsets.back());
+		parallelFor(Chunks.size(), [&](size_t i) {
+			std::copy(Chunks[i].m_Indices.begin(), Chunks[i].m_Indices.end(), Data.m_Indices.begin() + IndexOffsets[i]);
+			});
+		if (!HasColor)
+			Data.m_Colors.clear();
+		return Data;
+	}
+
+	Mesh ObjLoader::buildMesh(const ObjData& vData)
+	{
+		// 先把每个面角展开成完整顶点，再按顶点内容去重：
+		// 不同索引组合指向相同数据的顶点(导出工具常见的重复位置/法线)也能合并
+		std::vector<MeshVertex> Corners(vData.m_Indices.size());
+		constexpr size_t BlockSize = 1 << 16;
+		parallelFor((Corners.size() + BlockSize - 1) / BlockSize, [&](size_t vBlock) {
+			size_t End = std::min(Corners.size(), (vBlock + 1) * BlockSize);
+			for (size_t i = vBlock * BlockSize; i < End; ++i) {
+				const ObjIndex& Index = vData.m_Indices[i];
+				if (Index.m_Position < 0 || static_cast<size_t>(Index.m_Position) >= vData.m_Positions.size())
+					throw std::runtime_error("OBJ face references a vertex position out of range.");
+				MeshVertex& Vertex = Corners[i];
+				Vertex.m_Position = vData.m_Positions[Index.m_Position];
+				if (!vData.m_Colors.empty())
+					Vertex.m_Color = vData.m_Colors[Index.m_Position];
+				if (Index.m_TexCoord >= 0 && static_cast<size_t>(Index.m_TexCoord) < vData.m_TexCoords.size()) {
+					const glm::vec2& TexCoord = vData.m_TexCoords[Index.m_TexCoord];
+					Vertex.m_TexCoord = glm::vec2(TexCoord.x, 1.0f - TexCoord.y); // OBJ的v轴向上，Vulkan图像的v轴向下
+				}
+				if (Index.m_Normal >= 0 && static_cast<size_t>(Index.m_Normal) < vData.m_Normals.size())
+					Vertex.m_Normal = vData.m_Normals[Index.m_Normal];
+			}
+			});
+
+		Mesh Result;
+		Result.m_Indices.resize(Corners.size());
+		size_t UniqueCount = VertexDeduplicator::generateRemapAuto(Result.m_Indices, Corners.data(), Corners.size(), sizeof(MeshVertex));
+		Result.m_Vertices = VertexDeduplicator::remapVertices<MeshVertex>(Corners, Result.m_Indices, UniqueCount);
+		Result.computeBounds();
+		return Result;
+	}
+}
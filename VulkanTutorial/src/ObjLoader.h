@@ -0,0 +1,42 @@
+#pragma once
+#include "Mesh.h"
+
+#include <glm/glm.hpp>
+
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 一个面顶点引用的属性索引，已转换为从0开始，-1表示没有该属性
+	struct ObjIndex
+	{
+		int32_t m_Position = -1;
+		int32_t m_TexCoord = -1;
+		int32_t m_Normal = -1;
+	};
+
+	struct ObjData
+	{
+		std::vector<glm::vec3> m_Positions;
+		std::vector<glm::vec3> m_Colors;      // "v x y z r g b"扩展，与m_Positions一一对应，没有顶点颜色时为空
+		std::vector<glm::vec2> m_TexCoords;
+		std::vector<glm::vec3> m_Normals;
+		std::vector<ObjIndex> m_Indices;      // 多边形已按扇形三角化，每3个一个三角形
+	};
+
+	// 并行OBJ解析：
+	// 1. 整个文件内存映射，按行边界切成若干块
+	// 2. 第一遍并行统计每块的v/vt/vn数量，前缀和得到每块属性的全局起始位置(相对索引也由此解析)
+	// 3. 第二遍并行解析，属性直接写入最终数组，面索引先写入每块自己的数组，最后并行拼接
+	// 数字解析使用std::from_chars，不经过iostream与locale
+	// 只处理几何数据，o/g/s/usemtl/mtllib等指令被忽略
+	class ObjLoader
+	{
+	public:
+		static ObjData load(const std::filesystem::path& vPath);
+		static Mesh buildMesh(const ObjData& vData);  // 展开为顶点+索引，并合并相同的顶点
+	};
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	inline unsigned getWorkerCount()
+	{
+		return std::max(1u, std::thread::hardware_concurrency());
+	}
+
+	// 把[0, vCount)分给多个线程执行vFunction(i)，任务由原子计数器动态领取，适合大小不均的块。
+	// 任一任务抛出的第一个异常会在所有线程结束后重新抛出
+	template<typename Function>
+	void parallelFor(size_t vCount, Function&& vFunction, unsigned vThreadCount = getWorkerCount())
+	{
+		vThreadCount = static_cast<unsigned>(std::min<size_t>(vThreadCount, vCount));
+		if (vThreadCount <= 1) {
+			for (size_t i = 0; i < vCount; ++i)
+				vFunction(i);
+			return;
+		}
+
+		std::atomic<size_t> NextIndex = 0;
+		std::exception_ptr Exception;
+		std::mutex ExceptionMutex;
+		auto Worker = [&]() {
+			try {
+				for (size_t i = NextIndex++; i < vCount; i = NextIndex++)
+					vFunction(i);
+			}
+			catch (...) {
+				std::lock_guard<std::mutex> Lock(ExceptionMutex);
+				if (!Exception)
+					Exception = std::current_exception();
+				NextIndex = vCount;
+			}
+		};
+		std::vector<std::thread> Threads;
+		Threads.reserve(vThreadCount - 1);
+		for (unsigned i = 1; i < vThreadCount; ++i)
+			Threads.emplace_back(Worker);
+		Worker(); // 调用线程也参与
+		for (auto& Thread : Threads)
+			Thread.join();
+		if (Exception)
+			std::rethrow_exception(Exception);
+	}
+
+}
@@ -0,0 +1,102 @@
+#include "PipelineKey.h"
+#include "Hash.h"
+
+#include <algorithm>
+#include <bit>
+#include <format>
+
+namespace VulkanTutorial {
+
+	SpecializationConstants& SpecializationConstants::set(uint32_t vID, std::string_view vName, uint32_t vValue)
+	{
+		return setBits(vID, vName, vValue);
+	}
+
+	SpecializationConstants& SpecializationConstants::set(uint32_t vID, std::string_view vName, int32_t vValue)
+	{
+		return setBits(vID, vName, std::bit_cast<uint32_t>(vValue));
+	}
+
+	SpecializationConstants& SpecializationConstants::set(uint32_t vID, std::string_view vName, float vValue)
+	{
+		return setBits(vID, vName, std::bit_cast<uint32_t>(vValue));
+	}
+
+	SpecializationConstants& SpecializationConstants::set(uint32_t vID, std::string_view vName, bool vValue)
+	{
+		return setBits(vID, vName, vValue ? VK_TRUE : VK_FALSE);
+	}
+
+	SpecializationConstants& SpecializationConstants::setBits(uint32_t vID, std::string_view vName, uint32_t vBits)
+	{
+		auto It = std::lower_bound(m_Entries.begin(), m_Entries.end(), vID,
+			[](const VkSpecializationMapEntry& vEntry, uint32_t vID) { return vEntry.constantID < vID; });
+		size_t Index = static_cast<size_t>(It - m_Entries.begin());
+		if (It != m_Entries.end() && It->constantID == vID) {
+			m_Names[Index] = vName;
+			m_Data[Index] = vBits;
+			return *this;
+		}
+		m_Entries.insert(It, VkSpecializationMapEntry{ vID, 0, sizeof(uint32_t) });
+		m_Names.insert(m_Names.begin() + Index, std::string(vName));
+		m_Data.insert(m_Data.begin() + Index, vBits);
+		for (size_t i = 0; i < m_Entries.size(); ++i)
+			m_Entries[i].offset = static_cast<uint32_t>(i * sizeof(uint32_t));
+		return *this;
+	}
+
+	const uint32_t* SpecializationConstants::find(uint32_t vID) const
+	{
+		for (size_t i = 0; i < m_Entries.size(); ++i) {
+			if (m_Entries[i].constantID == vID)
+				return &m_Data[i];
+		}
+		return nullptr;
+	}
+
+	VkSpecializationInfo SpecializationConstants::getInfo() const
+	{
+		VkSpecializationInfo Info{};
+		Info.mapEntryCount = static_cast<uint32_t>(m_Entries.size());
+		Info.pMapEntries = m_Entries.data();
+		Info.dataSize = m_Data.size() * sizeof(uint32_t);
+		Info.pData = m_Data.data();
+		return Info;
+	}
+
+	uint64_t SpecializationConstants::hash() const
+	{
+		// 名字只用于调试，不参与哈希
+		uint64_t Hash = 0;
+		for (size_t i = 0; i < m_Entries.size(); ++i)
+			Hash = hashCombine(Hash, (static_cast<uint64_t>(m_Entries[i].constantID) << 32) | m_Data[i]);
+		return Hash;
+	}
+
+	std::string SpecializationConstants::toString() const
+	{
+		std::string Result;
+		for (size_t i = 0; i < m_Entries.size(); ++i)
+			Result += std::format("{0}{1}={2}", i == 0 ? "" : " ", m_Names[i], m_Data[i]);
+		return Result;
+	}
+
+	bool SpecializationConstants::operator==(const SpecializationConstants& vOther) const
+	{
+		if (m_Entries.size() != vOther.m_Entries.size())
+			return false;
+		for (size_t i = 0; i < m_Entries.size(); ++i) {
+			if (m_Entries[i].constantID != vOther.m_Entries[i].constantID || m_Data[i] != vOther.m_Data[i])
+				return false;
+		}
+		return true;
+	}
+
+	uint64_t PipelineKey::hash() const
+	{
+		uint64_t Hash = hashString(m_VertexShader);
+		Hash = hashCombine(Hash, hashString(m_FragmentShader));
+		return hashCombine(Hash, m_Constants.hash());
+	}
+
+}
@@ -0,0 +1,61 @@
+#pragma once
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 约定的specialization constant ID，shader中以layout(constant_id = N)声明
+	enum SpecializationConstantID : uint32_t
+	{
+		WorkGroupSizeConstantID = 0,   // 与layout(local_size_x_id = 0)配合
+		UnrollCountConstantID = 1,
+		FeatureConstantIDBegin = 16,   // 之后的ID留给各shader自己的功能开关
+		BenchmarkConstantID = 0xFFFF   // 不被任何shader使用，只用来产生新的变体
+	};
+
+	// 一组具名的specialization constant，所有值都按4字节存储(bool为VkBool32，float按位存储)
+	class SpecializationConstants
+	{
+	public:
+		SpecializationConstants& set(uint32_t vID, std::string_view vName, uint32_t vValue);
+		SpecializationConstants& set(uint32_t vID, std::string_view vName, int32_t vValue);
+		SpecializationConstants& set(uint32_t vID, std::string_view vName, float vValue);
+		SpecializationConstants& set(uint32_t vID, std::string_view vName, bool vValue);
+
+		const uint32_t* find(uint32_t vID) const;
+		VkSpecializationInfo getInfo() const;        // 指向内部数据，在下次修改前有效
+		uint64_t hash() const;
+		std::string toString() const;                  // 如"WorkGroupSize=256 UnrollCount=4"，用于日志
+
+		inline bool empty() const { return m_Entries.empty(); }
+		bool operator==(const SpecializationConstants& vOther) const;
+	private:
+		SpecializationConstants& setBits(uint32_t vID, std::string_view vName, uint32_t vBits);
+	private:
+		std::vector<std::string> m_Names;
+		std::vector<VkSpecializationMapEntry> m_Entries;  // 按constantID排序，保证相同内容得到相同的哈希
+		std::vector<uint32_t> m_Data;
+	};
+
+	// 唯一确定一个pipeline变体：同一份SPIR-V + 不同的specialization constant即为不同的变体
+	struct PipelineKey
+	{
+		std::string m_VertexShader;
+		std::string m_FragmentShader;
+		SpecializationConstants m_Constants;
+
+		bool uses(std::string_view vShaderName) const { return m_VertexShader == vShaderName || m_FragmentShader == vShaderName; }
+		uint64_t hash() const;
+		bool operator==(const PipelineKey& vOther) const = default;
+	};
+
+	struct PipelineKeyHasher
+	{
+		size_t operator()(const PipelineKey& vKey) const { return static_cast<size_t>(vKey.hash()); }
+	};
+
+}
@@ -0,0 +1,516 @@
+#include "PipelineLibrary.h"
+#include "Hash.h"
+#include "Timer.h"
+
+#include <format>
+#include <iostream>
+#include <stdexcept>
+#include <type_traits>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		template<typename T>
+		uint64_t getHandleKey(T vHandle)
+		{
+			if constexpr (std::is_pointer_v<T>)
+				return static_cast<uint64_t>(reinterpret_cast<uintptr_t>(vHandle));
+			else
+				return static_cast<uint64_t>(vHandle);
+		}
+
+		// 由GraphicsPipelineDesc生成的固定功能状态，结构体之间互相引用，因此不可拷贝
+		struct FixedFunctionStates
+		{
+			explicit FixedFunctionStates(const GraphicsPipelineDesc& vDesc);
+			FixedFunctionStates(const FixedFunctionStates&) = delete;
+			FixedFunctionStates& operator=(const FixedFunctionStates&) = delete;
+
+			VkPipelineVertexInputStateCreateInfo m_VertexInput{};
+			VkPipelineInputAssemblyStateCreateInfo m_InputAssembly{};
+			std::array<VkDynamicState, 2> m_DynamicStates{ VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
+			VkPipelineDynamicStateCreateInfo m_Dynamic{};
+			VkPipelineViewportStateCreateInfo m_Viewport{};
+			VkPipelineRasterizationStateCreateInfo m_Rasterization{};
+			VkPipelineMultisampleStateCreateInfo m_Multisample{};
+			VkPipelineDepthStencilStateCreateInfo m_DepthStencil{};
+			VkPipelineColorBlendAttachmentState m_ColorBlendAttachment{};
+			VkPipelineColorBlendStateCreateInfo m_ColorBlend{};
+		};
+
+		FixedFunctionStates::FixedFunctionStates(const GraphicsPipelineDesc& vDesc)
+		{
+			// VertexInput
+			m_VertexInput.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+			m_VertexInput.vertexBindingDescriptionCount = static_cast<uint32_t>(vDesc.m_VertexBindings.size());
+			m_VertexInput.pVertexBindingDescriptions = vDesc.m_VertexBindings.data();       // 结构体包含：绑定信息，顶点或实例作为步长等
+			m_VertexInput.vertexAttributeDescriptionCount = static_cast<uint32_t>(vDesc.m_VertexAttributes.size());
+			m_VertexInput.pVertexAttributeDescriptions = vDesc.m_VertexAttributes.data();   // 结构体包含：顶点属性布局、格式、偏移量等
+
+			// Input Assembly
+			m_InputAssembly.sType = VK_STRUCTURE_TYPE_PIPELINE_INPUT_ASSEMBLY_STATE_CREATE_INFO;
+			m_InputAssembly.topology = vDesc.m_Topology;
+			m_InputAssembly.primitiveRestartEnable = vDesc.m_IsPrimitiveRestartEnable ? VK_TRUE : VK_FALSE;
+
+			// Dynamic State
+			m_Dynamic.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
+			m_Dynamic.dynamicStateCount = static_cast<uint32_t>(m_DynamicStates.size());
+			m_Dynamic.pDynamicStates = m_DynamicStates.data();
+
+			// Viewport and Scissors
+			m_Viewport.sType = VK_STRUCTURE_TYPE_PIPELINE_VIEWPORT_STATE_CREATE_INFO;
+			m_Viewport.viewportCount = 1;
+			m_Viewport.scissorCount = 1; // 有些GPU支持有多个Viewport和Scissor
+			m_Viewport.pViewports = nullptr;
+			m_Viewport.pScissors = nullptr; // 这里不需要设置，因为这两个已经指明为dynamic state，可以之后在运行时指定
+
+			// Rasterizer
+			m_Rasterization.sType = VK_STRUCTURE_TYPE_PIPELINE_RASTERIZATION_STATE_CREATE_INFO;
+			m_Rasterization.depthClampEnable = VK_FALSE; // 超出视锥部分是否进行clamp
+			m_Rasterization.rasterizerDiscardEnable = VK_FALSE; // 是否不进行光栅化
+			m_Rasterization.polygonMode = VK_POLYGON_MODE_FILL;
+			m_Rasterization.lineWidth = 1.0f;
+			m_Rasterization.cullMode = vDesc.m_CullMode;
+			m_Rasterization.frontFace = vDesc.m_FrontFace;
+			m_Rasterization.depthBiasEnable = VK_FALSE; // 不进行深度偏移
+			//Depth = Depth + depthBiasConstantFactor * constant + depthBiasSlopeFactor * slope (计算公式)
+
+			// Mutisampling
+			m_Multisample.sType = VK_STRUCTURE_TYPE_PIPELINE_MULTISAMPLE_STATE_CREATE_INFO;
+			m_Multisample.sampleShadingEnable = VK_FALSE; // 是否超采样
+			m_Multisample.rasterizationSamples = VK_SAMPLE_COUNT_1_BIT;
+			m_Multisample.minSampleShading = 1.0f;
+
+			// Depth and Stencil testing
+			m_DepthStencil.sType = VK_STRUCTURE_TYPE_PIPELINE_DEPTH_STENCIL_STATE_CREATE_INFO; // 暂时不用
+
+			// Color Blending
+			m_ColorBlendAttachment.colorWriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
+				| VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+			m_ColorBlendAttachment.blendEnable = vDesc.m_IsBlendEnable ? VK_TRUE : VK_FALSE;  // alpha blending
+			m_ColorBlendAttachment.srcColorBlendFactor = VK_BLEND_FACTOR_SRC_ALPHA;
+			m_ColorBlendAttachment.dstColorBlendFactor = VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA;
+			m_ColorBlendAttachment.colorBlendOp = VK_BLEND_OP_ADD;
+			m_ColorBlendAttachment.srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE;
+			m_ColorBlendAttachment.dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO;
+			m_ColorBlendAttachment.alphaBlendOp = VK_BLEND_OP_ADD;
+
+			m_ColorBlend.sType = VK_STRUCTURE_TYPE_PIPELINE_COLOR_BLEND_STATE_CREATE_INFO;
+			m_ColorBlend.logicOpEnable = VK_FALSE;
+			m_ColorBlend.logicOp = VK_LOGIC_OP_COPY;
+			m_ColorBlend.attachmentCount = 1;
+			m_ColorBlend.pAttachments = &m_ColorBlendAttachment; // blendConstants只有VK_BLEND_FACTOR_CONSTANT_*才需要设置
+		}
+
+		// 着色器阶段，shader module在pipeline创建完成后即可销毁
+		struct ShaderStages
+		{
+			ShaderStages(VkDevice vDevice, const GraphicsPipelineDesc& vDesc, bool vHasVertex, bool vHasFragment);
+			~ShaderStages();
+			ShaderStages(const ShaderStages&) = delete;
+			ShaderStages& operator=(const ShaderStages&) = delete;
+
+			VkDevice m_Device = VK_NULL_HANDLE;
+			VkSpecializationInfo m_SpecializationInfo{};
+			std::vector<VkShaderModule> m_Modules;
+			std::vector<VkPipelineShaderStageCreateInfo> m_Stages;
+		private:
+			void addStage(VkShaderStageFlagBits vStage, std::span<const uint32_t> vCode, bool vHasConstants);
+		};
+
+		ShaderStages::ShaderStages(VkDevice vDevice, const GraphicsPipelineDesc& vDesc, bool vHasVertex, bool vHasFragment)
+			: m_Device(vDevice), m_SpecializationInfo(vDesc.m_Constants.getInfo())
+		{
+			try {
+				if (vHasVertex)
+					addStage(VK_SHADER_STAGE_VERTEX_BIT, vDesc.m_VertexCode, !vDesc.m_Constants.empty());
+				if (vHasFragment)
+					addStage(VK_SHADER_STAGE_FRAGMENT_BIT, vDesc.m_FragmentCode, !vDesc.m_Constants.empty());
+			}
+			catch (...) {
+				for (auto Module : m_Modules)
+					vkDestroyShaderModule(m_Device, Module, nullptr);
+				throw;
+			}
+		}
+
+		ShaderStages::~ShaderStages()
+		{
+			for (auto Module : m_Modules)
+				vkDestroyShaderModule(m_Device, Module, nullptr);
+		}
+
+		void ShaderStages::addStage(VkShaderStageFlagBits vStage, std::span<const uint32_t> vCode, bool vHasConstants)
+		{
+			VkShaderModuleCreateInfo ShaderModuleCreateInfo{};
+			ShaderModuleCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
+			ShaderModuleCreateInfo.codeSize = vCode.size_bytes();
+			ShaderModuleCreateInfo.pCode = vCode.data();
+			VkShaderModule ShaderModule = VK_NULL_HANDLE;
+			if (vkCreateShaderModule(m_Device, &ShaderModuleCreateInfo, nullptr, &ShaderModule) != VK_SUCCESS)
+				throw std::runtime_error("Failed to create shader module!");
+			m_Modules.emplace_back(ShaderModule);
+
+			VkPipelineShaderStageCreateInfo ShaderStageCreateInfo{};
+			ShaderStageCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
+			ShaderStageCreateInfo.pSpecializationInfo = vHasConstants ? &m_SpecializationInfo : nullptr; // 可以指定shader中的常量值避免渲染时再赋值，提高效率！
+			ShaderStageCreateInfo.stage = vStage;
+			ShaderStageCreateInfo.module = ShaderModule;
+			ShaderStageCreateInfo.pName = "main"; // shader主函数名
+			m_Stages.emplace_back(ShaderStageCreateInfo);
+		}
+
+	}
+
+	uint64_t GraphicsPipelineDesc::hashVertexInput() const
+	{
+		uint64_t Hash = hashBytes(m_VertexBindings.data(), m_VertexBindings.size() * sizeof(VkVertexInputBindingDescription));
+		Hash = hashBytes(m_VertexAttributes.data(), m_VertexAttributes.size() * sizeof(VkVertexInputAttributeDescription), Hash);
+		Hash = hashCombine(Hash, static_cast<uint64_t>(m_Topology));
+		return hashCombine(Hash, m_IsPrimitiveRestartEnable ? 1 : 0);
+	}
+
+	uint64_t GraphicsPipelineDesc::hashPreRasterization() const
+	{
+		uint64_t Hash = hashBytes(m_VertexCode.data(), m_VertexCode.size_bytes());
+		Hash = hashCombine(Hash, m_Constants.hash());
+		Hash = hashCombine(Hash, static_cast<uint64_t>(m_CullMode));
+		Hash = hashCombine(Hash, static_cast<uint64_t>(m_FrontFace));
+		Hash = hashCombine(Hash, getHandleKey(m_Layout));
+		Hash = hashCombine(Hash, getHandleKey(m_RenderPass));
+		return hashCombine(Hash, m_Subpass);
+	}
+
+	uint64_t GraphicsPipelineDesc::hashFragmentShader() const
+	{
+		uint64_t Hash = hashBytes(m_FragmentCode.data(), m_FragmentCode.size_bytes());
+		Hash = hashCombine(Hash, m_Constants.hash());
+		Hash = hashCombine(Hash, getHandleKey(m_Layout));
+		Hash = hashCombine(Hash, getHandleKey(m_RenderPass));
+		return hashCombine(Hash, m_Subpass);
+	}
+
+	uint64_t GraphicsPipelineDesc::hashFragmentOutput() const
+	{
+		uint64_t Hash = hashCombine(0, m_IsBlendEnable ? 1 : 0);
+		Hash = hashCombine(Hash, getHandleKey(m_RenderPass));
+		return hashCombine(Hash, m_Subpass);
+	}
+
+	uint64_t GraphicsPipelineDesc::hash() const
+	{
+		uint64_t Hash = hashVertexInput();
+		Hash = hashCombine(Hash, hashPreRasterization());
+		Hash = hashCombine(Hash, hashFragmentShader());
+		return hashCombine(Hash, hashFragmentOutput());
+	}
+
+	PipelineLibrary::~PipelineLibrary()
+	{
+		destroy();
+	}
+
+	void PipelineLibrary::create(VkDevice vDevice, const DeviceFeatures& vFeatures, DeletionQueue& vDeletionQueue)
+	{
+		std::cout << "Try to create pipeline library ..." << "\n";
+		m_Device = vDevice;
+		m_DeletionQueue = &vDeletionQueue;
+		m_IsLibraryEnabled = vFeatures.isGraphicsPipelineLibrarySupported();
+
+		VkPipelineCacheCreateInfo PipelineCacheCreateInfo{};
+		PipelineCacheCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_CACHE_CREATE_INFO;
+		if (vkCreatePipelineCache(m_Device, &PipelineCacheCreateInfo, nullptr, &m_PipelineCache) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create pipeline cache!");
+
+		m_IsStopping = false;
+		m_Worker = std::thread(&PipelineLibrary::runWorker, this);
+		std::cout << std::format("Success to create pipeline library (graphics pipeline library: {0}, fast linking: {1}) !",
+			m_IsLibraryEnabled, vFeatures.isGraphicsPipelineLibraryFastLinkingSupported()) << "\n";
+	}
+
+	void PipelineLibrary::destroy()
+	{
+		if (m_Device == VK_NULL_HANDLE)
+			return;
+		{
+			std::lock_guard<std::mutex> Lock(m_TaskMutex);
+			m_IsStopping = true;
+			m_Tasks.clear();
+		}
+		m_TaskCondition.notify_all();
+		if (m_Worker.joinable())
+			m_Worker.join();
+
+		for (auto& [ID, Pipeline] : m_CompletedPipelines)
+			vkDestroyPipeline(m_Device, Pipeline, nullptr);
+		m_CompletedPipelines.clear();
+		for (auto& [ID, Pipeline] : m_Pipelines)
+			vkDestroyPipeline(m_Device, Pipeline.m_Pipeline, nullptr);
+		m_Pipelines.clear();
+		for (auto& [Key, Part] : m_Parts)
+			vkDestroyPipeline(m_Device, Part, nullptr);
+		m_Parts.clear();
+		vkDestroyPipelineCache(m_Device, m_PipelineCache, nullptr);
+		m_PipelineCache = VK_NULL_HANDLE;
+		m_Device = VK_NULL_HANDLE;
+	}
+
+	uint64_t PipelineLibrary::request(const GraphicsPipelineDesc& vDesc)
+	{
+		uint64_t ID = vDesc.hash();
+		if (m_Pipelines.contains(ID))
+			return ID;
+
+		Timer CreateTimer;
+		LinkedPipeline Pipeline;
+		if (!m_IsLibraryEnabled) {
+			Pipeline.m_Pipeline = createMonolithic(vDesc);
+			Pipeline.m_IsOptimized = true;
+			m_Pipelines[ID] = Pipeline;
+			std::cout << std::format("Success to create pipeline {0:016x} in {1:.2f} ms !", ID, CreateTimer.ellapseMilliseconds()) << "\n";
+			return ID;
+		}
+
+		Parts LibraryParts{};
+		for (uint32_t i = 0; i < PartCount; ++i)
+			LibraryParts[i] = getPart(static_cast<PartType>(i), vDesc);
+		Pipeline.m_Pipeline = link(LibraryParts, vDesc.m_Layout, false);
+		m_Pipelines[ID] = Pipeline;
+		std::cout << std::format("Success to fast link pipeline {0:016x} in {1:.2f} ms !", ID, CreateTimer.ellapseMilliseconds()) << "\n";
+		CompileTask Task;
+		Task.m_ID = ID;
+		Task.m_Parts = LibraryParts;
+		Task.m_Layout = vDesc.m_Layout;
+		pushTask(std::move(Task));
+		return ID;
+	}
+
+	uint64_t PipelineLibrary::requestAsync(const GraphicsPipelineDesc& vDesc)
+	{
+		uint64_t ID = vDesc.hash();
+		if (m_Pipelines.contains(ID))
+			return ID;
+		m_Pipelines[ID] = LinkedPipeline{}; // 占位，完成前getPipeline()返回VK_NULL_HANDLE
+
+		CompileTask Task;
+		Task.m_ID = ID;
+		Task.m_IsLink = false;
+		Task.m_Desc = vDesc;
+		Task.m_VertexCode.assign(vDesc.m_VertexCode.begin(), vDesc.m_VertexCode.end()); // 源数据可能在编译完成前被热重载替换
+		Task.m_FragmentCode.assign(vDesc.m_FragmentCode.begin(), vDesc.m_FragmentCode.end());
+		pushTask(std::move(Task));
+		return ID;
+	}
+
+	void PipelineLibrary::pushTask(CompileTask&& vTask)
+	{
+		{
+			std::lock_guard<std::mutex> Lock(m_TaskMutex);
+			m_Tasks.emplace_back(std::move(vTask));
+		}
+		m_TaskCondition.notify_one();
+	}
+
+	VkPipeline PipelineLibrary::getPipeline(uint64_t vID) const
+	{
+		auto It = m_Pipelines.find(vID);
+		return It == m_Pipelines.end() ? VK_NULL_HANDLE : It->second.m_Pipeline;
+	}
+
+	void PipelineLibrary::release(uint64_t vID, uint64_t vFrame)
+	{
+		auto It = m_Pipelines.find(vID);
+		if (It == m_Pipelines.end())
+			return;
+		m_DeletionQueue->push(vFrame, [Device = m_Device, Pipeline = It->second.m_Pipeline]() {
+			vkDestroyPipeline(Device, Pipeline, nullptr);
+			});
+		m_Pipelines.erase(It);
+		std::lock_guard<std::mutex> Lock(m_TaskMutex);
+		std::erase_if(m_Tasks, [vID](const CompileTask& vTask) { return vTask.m_ID == vID; });
+	}
+
+	void PipelineLibrary::update(uint64_t vFrame)
+	{
+		std::vector<std::pair<uint64_t, VkPipeline>> CompletedPipelines;
+		{
+			std::lock_guard<std::mutex> Lock(m_TaskMutex);
+			CompletedPipelines.swap(m_CompletedPipelines);
+		}
+		for (auto& [ID, Completed] : CompletedPipelines) {
+			auto It = m_Pipelines.find(ID);
+			if (It == m_Pipelines.end()) {
+				vkDestroyPipeline(m_Device, Completed, nullptr); // 编译期间已被释放，从未被使用过
+				continue;
+			}
+			// 快速链接的版本可能还在被在途的帧使用
+			if (It->second.m_Pipeline != VK_NULL_HANDLE) {
+				m_DeletionQueue->push(vFrame, [Device = m_Device, Pipeline = It->second.m_Pipeline]() {
+					vkDestroyPipeline(Device, Pipeline, nullptr);
+					});
+			}
+			It->second.m_Pipeline = Completed;
+			It->second.m_IsOptimized = true;
+		}
+	}
+
+	VkPipeline PipelineLibrary::getPart(PartType vType, const GraphicsPipelineDesc& vDesc)
+	{
+		uint64_t Key = 0;
+		switch (vType) {
+		case VertexInputPart: Key = vDesc.hashVertexInput(); break;
+		case PreRasterizationPart: Key = vDesc.hashPreRasterization(); break;
+		case FragmentShaderPart: Key = vDesc.hashFragmentShader(); break;
+		default: Key = vDesc.hashFragmentOutput(); break;
+		}
+		Key = hashCombine(Key, vType);
+		if (auto It = m_Parts.find(Key); It != m_Parts.end())
+			return It->second;
+		VkPipeline Part = createPart(vType, vDesc);
+		m_Parts[Key] = Part;
+		return Part;
+	}
+
+	VkPipeline PipelineLibrary::createPart(PartType vType, const GraphicsPipelineDesc& vDesc)
+	{
+		FixedFunctionStates States(vDesc);
+		ShaderStages Stages(m_Device, vDesc, vType == PreRasterizationPart, vType == FragmentShaderPart);
+
+		VkGraphicsPipelineLibraryCreateInfoEXT LibraryCreateInfo{};
+		LibraryCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_LIBRARY_CREATE_INFO_EXT;
+
+		VkGraphicsPipelineCreateInfo GraphicsPiplineCreateInfo{};
+		GraphicsPiplineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		GraphicsPiplineCreateInfo.pNext = &LibraryCreateInfo;
+		// 保留链接期优化所需的信息，后台才能做完整优化链接
+		GraphicsPiplineCreateInfo.flags = VK_PIPELINE_CREATE_LIBRARY_BIT_KHR | VK_PIPELINE_CREATE_RETAIN_LINK_TIME_OPTIMIZATION_INFO_BIT_EXT;
+		GraphicsPiplineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+		GraphicsPiplineCreateInfo.basePipelineIndex = -1;
+		switch (vType) {
+		case VertexInputPart:
+			LibraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_VERTEX_INPUT_INTERFACE_BIT_EXT;
+			GraphicsPiplineCreateInfo.pVertexInputState = &States.m_VertexInput;
+			GraphicsPiplineCreateInfo.pInputAssemblyState = &States.m_InputAssembly;
+			break;
+		case PreRasterizationPart:
+			LibraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_PRE_RASTERIZATION_SHADERS_BIT_EXT;
+			GraphicsPiplineCreateInfo.pDynamicState = &States.m_Dynamic;
+			GraphicsPiplineCreateInfo.pViewportState = &States.m_Viewport;
+			GraphicsPiplineCreateInfo.pRasterizationState = &States.m_Rasterization;
+			GraphicsPiplineCreateInfo.layout = vDesc.m_Layout;
+			GraphicsPiplineCreateInfo.renderPass = vDesc.m_RenderPass;
+			GraphicsPiplineCreateInfo.subpass = vDesc.m_Subpass;
+			break;
+		case FragmentShaderPart:
+			LibraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_SHADER_BIT_EXT;
+			GraphicsPiplineCreateInfo.pMultisampleState = &States.m_Multisample;
+			GraphicsPiplineCreateInfo.pDepthStencilState = &States.m_DepthStencil;
+			GraphicsPiplineCreateInfo.layout = vDesc.m_Layout;
+			GraphicsPiplineCreateInfo.renderPass = vDesc.m_RenderPass;
+			GraphicsPiplineCreateInfo.subpass = vDesc.m_Subpass;
+			break;
+		default:
+			LibraryCreateInfo.flags = VK_GRAPHICS_PIPELINE_LIBRARY_FRAGMENT_OUTPUT_INTERFACE_BIT_EXT;
+			GraphicsPiplineCreateInfo.pMultisampleState = &States.m_Multisample;
+			GraphicsPiplineCreateInfo.pColorBlendState = &States.m_ColorBlend;
+			GraphicsPiplineCreateInfo.renderPass = vDesc.m_RenderPass;
+			GraphicsPiplineCreateInfo.subpass = vDesc.m_Subpass;
+			break;
+		}
+		GraphicsPiplineCreateInfo.stageCount = static_cast<uint32_t>(Stages.m_Stages.size());
+		GraphicsPiplineCreateInfo.pStages = Stages.m_Stages.data();
+
+		VkPipeline Part = VK_NULL_HANDLE;
+		if (vkCreateGraphicsPipelines(m_Device, m_PipelineCache, 1, &GraphicsPiplineCreateInfo, nullptr, &Part) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create graphics pipeline library!");
+		return Part;
+	}
+
+	VkPipeline PipelineLibrary::link(const Parts& vParts, VkPipelineLayout vLayout, bool vIsOptimized)
+	{
+		VkPipelineLibraryCreateInfoKHR LibraryCreateInfo{};
+		LibraryCreateInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_LIBRARY_CREATE_INFO_KHR;
+		LibraryCreateInfo.libraryCount = static_cast<uint32_t>(vParts.size());
+		LibraryCreateInfo.pLibraries = vParts.data();
+
+		VkGraphicsPipelineCreateInfo GraphicsPiplineCreateInfo{};
+		GraphicsPiplineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		GraphicsPiplineCreateInfo.pNext = &LibraryCreateInfo;
+		GraphicsPiplineCreateInfo.flags = vIsOptimized ? VK_PIPELINE_CREATE_LINK_TIME_OPTIMIZATION_BIT_EXT : 0;
+		GraphicsPiplineCreateInfo.layout = vLayout;
+		GraphicsPiplineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+		GraphicsPiplineCreateInfo.basePipelineIndex = -1;
+
+		VkPipeline Pipeline = VK_NULL_HANDLE;
+		if (vkCreateGraphicsPipelines(m_Device, m_PipelineCache, 1, &GraphicsPiplineCreateInfo, nullptr, &Pipeline) != VK_SUCCESS)
+			throw std::runtime_error("Failed to link graphics pipeline!");
+		return Pipeline;
+	}
+
+	VkPipeline PipelineLibrary::createMonolithic(const GraphicsPipelineDesc& vDesc)
+	{
+		FixedFunctionStates States(vDesc);
+		ShaderStages Stages(m_Device, vDesc, true, true);
+
+		// Pipline !
+		VkGraphicsPipelineCreateInfo GraphicsPiplineCreateInfo{};
+		GraphicsPiplineCreateInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
+		GraphicsPiplineCreateInfo.stageCount = static_cast<uint32_t>(Stages.m_Stages.size());
+		GraphicsPiplineCreateInfo.pStages = Stages.m_Stages.data();
+		GraphicsPiplineCreateInfo.pVertexInputState = &States.m_VertexInput;
+		GraphicsPiplineCreateInfo.pInputAssemblyState = &States.m_InputAssembly;
+		GraphicsPiplineCreateInfo.pDynamicState = &States.m_Dynamic;
+		GraphicsPiplineCreateInfo.pViewportState = &States.m_Viewport;
+		GraphicsPiplineCreateInfo.pRasterizationState = &States.m_Rasterization;
+		GraphicsPiplineCreateInfo.pMultisampleState = &States.m_Multisample;
+		GraphicsPiplineCreateInfo.pDepthStencilState = &States.m_DepthStencil;
+		GraphicsPiplineCreateInfo.pColorBlendState = &States.m_ColorBlend;
+		GraphicsPiplineCreateInfo.layout = vDesc.m_Layout;
+		GraphicsPiplineCreateInfo.renderPass = vDesc.m_RenderPass;
+		GraphicsPiplineCreateInfo.subpass = vDesc.m_Subpass;
+		GraphicsPiplineCreateInfo.basePipelineHandle = VK_NULL_HANDLE;
+		GraphicsPiplineCreateInfo.basePipelineIndex = -1;
+
+		VkPipeline Pipeline = VK_NULL_HANDLE;
+		if (vkCreateGraphicsPipelines(m_Device, m_PipelineCache, 1, &GraphicsPiplineCreateInfo, nullptr, &Pipeline) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create graphics pipeline!");
+		return Pipeline;
+	}
+
+	void PipelineLibrary::runWorker()
+	{
+		while (true) {
+			CompileTask Task;
+			{
+				std::unique_lock<std::mutex> Lock(m_TaskMutex);
+				m_TaskCondition.wait(Lock, [this]() { return m_IsStopping || !m_Tasks.empty(); });
+				if (m_IsStopping)
+					return;
+				Task = std::move(m_Tasks.front());
+				m_Tasks.pop_front();
+			}
+			// 各部分只在destroy()中销毁，而destroy()会先等待本线程退出，因此这里可以安全使用
+			try {
+				Timer CompileTimer;
+				VkPipeline Pipeline = VK_NULL_HANDLE;
+				if (Task.m_IsLink) {
+					Pipeline = link(Task.m_Parts, Task.m_Layout, true);
+				}
+				else {
+					Task.m_Desc.m_VertexCode = Task.m_VertexCode;
+					Task.m_Desc.m_FragmentCode = Task.m_FragmentCode;
+					Pipeline = createMonolithic(Task.m_Desc);
+				}
+				std::cout << std::format("Success to {0} pipeline {1:016x} in background in {2:.2f} ms !",
+					Task.m_IsLink ? "optimize" : "compile", Task.m_ID, CompileTimer.ellapseMilliseconds()) << "\n";
+				std::lock_guard<std::mutex> Lock(m_TaskMutex);
+				m_CompletedPipelines.emplace_back(Task.m_ID, Pipeline);
+			}
+			catch (const std::exception& e) {
+				std::cerr << e.what() << "\n"; // 失败时继续使用快速链接的版本或ubershader
+			}
+		}
+	}
+
+}
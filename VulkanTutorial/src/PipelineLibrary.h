@@ -0,0 +1,128 @@
+#pragma once
+#include "DeletionQueue.h"
+#include "DeviceFeatures.h"
+#include "PipelineKey.h"
+
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 描述一个图形pipeline所需的全部状态，viewport与scissor总是dynamic state
+	struct GraphicsPipelineDesc
+	{
+		std::span<const uint32_t> m_VertexCode;
+		std::span<const uint32_t> m_FragmentCode;
+		SpecializationConstants m_Constants;
+
+		std::vector<VkVertexInputBindingDescription> m_VertexBindings;
+		std::vector<VkVertexInputAttributeDescription> m_VertexAttributes;
+		VkPrimitiveTopology m_Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+		bool m_IsPrimitiveRestartEnable = false;
+
+		VkCullModeFlags m_CullMode = VK_CULL_MODE_BACK_BIT;
+		VkFrontFace m_FrontFace = VK_FRONT_FACE_CLOCKWISE;
+		bool m_IsBlendEnable = true;
+
+		VkPipelineLayout m_Layout = VK_NULL_HANDLE;
+		std::vector<VkDescriptorSetLayout> m_SetLayouts;          // 须与m_Layout一致，shader object没有pipeline layout只能单独给出
+		std::vector<VkPushConstantRange> m_PushConstantRanges;
+		VkRenderPass m_RenderPass = VK_NULL_HANDLE;
+		uint32_t m_Subpass = 0;
+
+		// 四个pipeline library部分各自的键，只包含影响该部分的状态
+		uint64_t hashVertexInput() const;
+		uint64_t hashPreRasterization() const;
+		uint64_t hashFragmentShader() const;
+		uint64_t hashFragmentOutput() const;
+		uint64_t hash() const;
+	};
+
+	// 图形pipeline缓存。设备支持VK_EXT_graphics_pipeline_library时：
+	// 1. vertex input / pre-rasterization / fragment shader / fragment output四部分各自编译一次并缓存
+	// 2. 新组合先快速链接(不做链接期优化)立即可用
+	// 3. 后台线程再做一次完整优化链接，完成后替换快速链接的版本
+	// 不支持时退化为普通的vkCreateGraphicsPipelines
+	// requestAsync()则把完整编译整个放到后台线程，完成前getPipeline()返回VK_NULL_HANDLE
+	class PipelineLibrary
+	{
+	public:
+		PipelineLibrary() = default;
+		~PipelineLibrary();
+
+		PipelineLibrary(const PipelineLibrary&) = delete;
+		PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+
+		void create(VkDevice vDevice, const DeviceFeatures& vFeatures, DeletionQueue& vDeletionQueue);
+		void destroy();  // 调用前设备必须空闲
+
+		uint64_t request(const GraphicsPipelineDesc& vDesc);  // 返回pipeline ID(即vDesc.hash())，已存在时直接返回
+		uint64_t requestAsync(const GraphicsPipelineDesc& vDesc);
+		VkPipeline getPipeline(uint64_t vID) const;
+		inline bool isReady(uint64_t vID) const { return getPipeline(vID) != VK_NULL_HANDLE; }
+		void release(uint64_t vID, uint64_t vFrame);          // 第vFrame帧起不再使用，延迟销毁
+		void update(uint64_t vFrame);                         // 每帧在录制命令前调用，换入后台完成的pipeline
+
+		inline bool isLibraryEnabled() const { return m_IsLibraryEnabled; }
+	private:
+		enum PartType : uint32_t
+		{
+			VertexInputPart = 0,
+			PreRasterizationPart,
+			FragmentShaderPart,
+			FragmentOutputPart,
+			PartCount
+		};
+		using Parts = std::array<VkPipeline, PartCount>;
+
+		struct LinkedPipeline
+		{
+			VkPipeline m_Pipeline = VK_NULL_HANDLE;
+			bool m_IsOptimized = false;
+		};
+
+		// 后台任务：优化链接已有的各部分，或者完整编译一个pipeline(此时自带SPIR-V副本)
+		struct CompileTask
+		{
+			uint64_t m_ID = 0;
+			bool m_IsLink = true;
+			Parts m_Parts{};
+			VkPipelineLayout m_Layout = VK_NULL_HANDLE;
+			GraphicsPipelineDesc m_Desc;
+			std::vector<uint32_t> m_VertexCode;
+			std::vector<uint32_t> m_FragmentCode;
+		};
+
+		VkPipeline getPart(PartType vType, const GraphicsPipelineDesc& vDesc);
+		VkPipeline createPart(PartType vType, const GraphicsPipelineDesc& vDesc);
+		VkPipeline link(const Parts& vParts, VkPipelineLayout vLayout, bool vIsOptimized);
+		VkPipeline createMonolithic(const GraphicsPipelineDesc& vDesc);
+		void runWorker();
+		void pushTask(CompileTask&& vTask);
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		DeletionQueue* m_DeletionQueue = nullptr;
+		VkPipelineCache m_PipelineCache = VK_NULL_HANDLE;
+		bool m_IsLibraryEnabled = false;
+
+		std::unordered_map<uint64_t, VkPipeline> m_Parts;  // 键中已混入PartType
+		std::unordered_map<uint64_t, LinkedPipeline> m_Pipelines;
+
+		std::thread m_Worker;
+		std::mutex m_TaskMutex;
+		std::condition_variable m_TaskCondition;
+		std::deque<CompileTask> m_Tasks;
+		std::vector<std::pair<uint64_t, VkPipeline>> m_CompletedPipelines;  // 后台已完成、等待主线程换入
+		bool m_IsStopping = false;
+	};
+
+}
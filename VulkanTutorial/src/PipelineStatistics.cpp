@@ -0,0 +1,98 @@
+#include "PipelineStatistics.h"
+
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		// 结果按标志位从低到高的顺序排列，与Counters的成员顺序一致
+		constexpr VkQueryPipelineStatisticFlags StatisticFlags =
+			VK_QUERY_PIPELINE_STATISTIC_INPUT_ASSEMBLY_PRIMITIVES_BIT
+			| VK_QUERY_PIPELINE_STATISTIC_VERTEX_SHADER_INVOCATIONS_BIT
+			| VK_QUERY_PIPELINE_STATISTIC_CLIPPING_PRIMITIVES_BIT
+			| VK_QUERY_PIPELINE_STATISTIC_FRAGMENT_SHADER_INVOCATIONS_BIT;
+		constexpr uint32_t StatisticCount = 4;
+
+	}
+
+	PipelineStatistics::~PipelineStatistics()
+	{
+		destroy();
+	}
+
+	void PipelineStatistics::create(VkDevice vDevice, const DeviceFeatures& vFeatures, uint32_t vFrameCount)
+	{
+		m_Device = vDevice;
+		if (!vFeatures.isPipelineStatisticsQuerySupported())
+			return;
+		VkQueryPoolCreateInfo QueryPoolCreateInfo{};
+		QueryPoolCreateInfo.sType = VK_STRUCTURE_TYPE_QUERY_POOL_CREATE_INFO;
+		QueryPoolCreateInfo.queryType = VK_QUERY_TYPE_PIPELINE_STATISTICS;
+		QueryPoolCreateInfo.queryCount = vFrameCount;
+		QueryPoolCreateInfo.pipelineStatistics = StatisticFlags;
+		if (vkCreateQueryPool(m_Device, &QueryPoolCreateInfo, nullptr, &m_QueryPool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create pipeline statistics query pool!");
+		m_IsPending.assign(vFrameCount, false);
+		m_Total = {};
+		m_CollectedFrameCount = 0;
+	}
+
+	void PipelineStatistics::destroy()
+	{
+		if (m_QueryPool != VK_NULL_HANDLE)
+			vkDestroyQueryPool(m_Device, m_QueryPool, nullptr);
+		m_QueryPool = VK_NULL_HANDLE;
+		m_IsPending.clear();
+	}
+
+	void PipelineStatistics::reset(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex) const
+	{
+		if (isEnabled())
+			vkCmdResetQueryPool(vCommandBuffer, m_QueryPool, vFrameIndex, 1);
+	}
+
+	void PipelineStatistics::begin(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex) const
+	{
+		if (isEnabled())
+			vkCmdBeginQuery(vCommandBuffer, m_QueryPool, vFrameIndex, 0);
+	}
+
+	void PipelineStatistics::end(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex)
+	{
+		if (!isEnabled())
+			return;
+		vkCmdEndQuery(vCommandBuffer, m_QueryPool, vFrameIndex);
+		m_IsPending[vFrameIndex] = true;
+	}
+
+	void PipelineStatistics::collect(uint32_t vFrameIndex)
+	{
+		if (!isEnabled() || !m_IsPending[vFrameIndex])
+			return;
+		uint64_t Results[StatisticCount + 1] = {};  // 最后一个是可用性
+		VkResult Result = vkGetQueryPoolResults(m_Device, m_QueryPool, vFrameIndex, 1, sizeof(Results), Results, sizeof(Results),
+			VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WITH_AVAILABILITY_BIT);
+		m_IsPending[vFrameIndex] = false;
+		if (Result != VK_SUCCESS || Results[StatisticCount] == 0)
+			return;
+		m_Total.m_InputAssemblyPrimitives += Results[0];
+		m_Total.m_VertexShaderInvocations += Results[1];
+		m_Total.m_ClippingPrimitives += Results[2];
+		m_Total.m_FragmentShaderInvocations += Results[3];
+		++m_CollectedFrameCount;
+	}
+
+	void PipelineStatistics::report() const
+	{
+		if (!isEnabled() || m_CollectedFrameCount == 0)
+			return;
+		double FrameCount = static_cast<double>(m_CollectedFrameCount);
+		std::cout << std::format("Pipeline statistics over {0} frames (per frame): {1:.0f} primitives, {2:.0f} vertex invocations, {3:.0f} clipped primitives, {4:.0f} fragment invocations",
+			m_CollectedFrameCount, m_Total.m_InputAssemblyPrimitives / FrameCount, m_Total.m_VertexShaderInvocations / FrameCount,
+			m_Total.m_ClippingPrimitives / FrameCount, m_Total.m_FragmentShaderInvocations / FrameCount) << "\n";
+	}
+
+}
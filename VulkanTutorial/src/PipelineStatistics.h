@@ -0,0 +1,51 @@
+#pragma once
+#include "DeviceFeatures.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 每帧一个VK_QUERY_TYPE_PIPELINE_STATISTICS查询，累计各帧的顶点/片元着色器调用次数，
+	// 用来对比网格优化(顶点缓存、overdraw)前后GPU实际执行的工作量。
+	// 设备不支持pipelineStatisticsQuery特性时所有调用都是空操作
+	class PipelineStatistics
+	{
+	public:
+		struct Counters
+		{
+			uint64_t m_InputAssemblyPrimitives = 0;
+			uint64_t m_VertexShaderInvocations = 0;
+			uint64_t m_ClippingPrimitives = 0;
+			uint64_t m_FragmentShaderInvocations = 0;
+		};
+
+		PipelineStatistics() = default;
+		~PipelineStatistics();
+
+		PipelineStatistics(const PipelineStatistics&) = delete;
+		PipelineStatistics& operator=(const PipelineStatistics&) = delete;
+
+		void create(VkDevice vDevice, const DeviceFeatures& vFeatures, uint32_t vFrameCount);
+		void destroy();
+
+		void reset(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex) const;  // 必须在render pass之外录制
+		void begin(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex) const;
+		void end(VkCommandBuffer vCommandBuffer, uint32_t vFrameIndex);
+		void collect(uint32_t vFrameIndex);  // 该帧fence等待之后调用，结果累加到总数
+
+		inline bool isEnabled() const { return m_QueryPool != VK_NULL_HANDLE; }
+		inline const Counters& getTotal() const { return m_Total; }
+		inline uint64_t getCollectedFrameCount() const { return m_CollectedFrameCount; }
+		void report() const;
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		VkQueryPool m_QueryPool = VK_NULL_HANDLE;
+		std::vector<bool> m_IsPending;
+		Counters m_Total;
+		uint64_t m_CollectedFrameCount = 0;
+	};
+
+}
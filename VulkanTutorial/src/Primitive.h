@@ -1,4 +1,6 @@
 #pragma once
+#include "VertexLayout.h"
+
 #include <glm/glm.hpp>
 #include <vulkan/vulkan.h>
 #include <array>
@@ -10,27 +12,9 @@ namespace VulkanTutorial {
 		glm::vec2 m_Position = glm::vec2(0.0f, 0.0f);
 		glm::vec3 m_Color = glm::vec3(0.0f, 0.0f, 0.0f);
 
-		static VkVertexInputBindingDescription getBindingDescription() {
-			VkVertexInputBindingDescription VertexInputBindingDescription{};
-			VertexInputBindingDescription.binding = 0;
-			VertexInputBindingDescription.stride = sizeof(Vertex);
-			VertexInputBindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
-			return VertexInputBindingDescription;
-		}
-
-		static std::array<VkVertexInputAttributeDescription, 2> getAttributeDescriptions() {
-			std::array<VkVertexInputAttributeDescription, 2> VertexInputAttributeDescriptions;
-			VertexInputAttributeDescriptions[0].binding = 0;
-			VertexInputAttributeDescriptions[0].location = 0;                         // location 0
-			VertexInputAttributeDescriptions[0].format = VK_FORMAT_R32G32_SFLOAT;     // vec2
-			VertexInputAttributeDescriptions[0].offset = offsetof(Vertex, m_Position);
-
-			VertexInputAttributeDescriptions[1].binding = 0;
-			VertexInputAttributeDescriptions[1].location = 1;                         // location 1
-			VertexInputAttributeDescriptions[1].format = VK_FORMAT_R32G32B32_SFLOAT;  // vec3
-			VertexInputAttributeDescriptions[1].offset = offsetof(Vertex, m_Color);
-			return VertexInputAttributeDescriptions;
-		}
+		// 描述由VertexStreamLayout根据成员类型在编译期生成
+		static constexpr VkVertexInputBindingDescription getBindingDescription() { return VertexStreamLayout<Vertex>::Bindings[0]; }
+		static constexpr auto getAttributeDescriptions() { return VertexStreamLayout<Vertex>::Attributes; }
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,152 @@
+#include "ShaderCompiler.h"
+#include "Hash.h"
+#include "MappedFile.h"
+
+#include <shaderc/shaderc.hpp>
+#include <spirv-tools/libspirv.h>
+
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <unordered_map>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		// 修改编译选项或校验规则时递增，使旧缓存全部失效
+		constexpr uint64_t CacheVersion = 2;
+		constexpr uint32_t SpirvMagic = 0x07230203;
+
+		const std::unordered_map<std::string, shaderc_shader_kind> ShaderKinds{
+			{ ".vert", shaderc_glsl_vertex_shader },
+			{ ".frag", shaderc_glsl_fragment_shader },
+			{ ".comp", shaderc_glsl_compute_shader },
+			{ ".geom", shaderc_glsl_geometry_shader },
+			{ ".tesc", shaderc_glsl_tess_control_shader },
+			{ ".tese", shaderc_glsl_tess_evaluation_shader },
+			{ ".task", shaderc_glsl_task_shader },
+			{ ".mesh", shaderc_glsl_mesh_shader }
+		};
+
+	}
+
+	ShaderCompiler::ShaderCompiler(const std::filesystem::path& vCacheDirectory)
+		: m_CacheDirectory(vCacheDirectory)
+	{
+		std::filesystem::create_directories(m_CacheDirectory);
+	}
+
+	bool ShaderCompiler::isShaderSource(const std::filesystem::path& vPath)
+	{
+		return ShaderKinds.contains(vPath.extension().string());
+	}
+
+	std::string ShaderCompiler::getShaderName(const std::filesystem::path& vSourcePath)
+	{
+		return vSourcePath.stem().string() + "_" + vSourcePath.extension().string().substr(1);
+	}
+
+	std::vector<uint32_t> ShaderCompiler::compile(const std::filesystem::path& vSourcePath)
+	{
+		auto Kind = ShaderKinds.find(vSourcePath.extension().string());
+		if (Kind == ShaderKinds.end())
+			throw std::runtime_error(std::format(R"(Unknown shader stage of "{0}".)", vSourcePath.string()));
+
+		std::string Source;
+		{
+			MappedFile SourceFile(vSourcePath);
+			Source.assign(reinterpret_cast<const char*>(SourceFile.data()), SourceFile.size());
+		}
+		std::string Name = getShaderName(vSourcePath);
+		uint64_t Key = hashCombine(hashString(Source, CacheVersion), hashString(Name));
+		std::filesystem::path CachePath = m_CacheDirectory / std::format("{0}_{1:016x}.spv", Name, Key);
+		if (std::filesystem::exists(CachePath)) {
+			std::vector<uint32_t> Code = loadCache(CachePath);
+			if (!Code.empty())
+				return Code;
+		}
+
+		std::lock_guard<std::mutex> Lock(m_CompileMutex);
+		std::cout << std::format(R"(Try to compile shader "{0}" ...)", vSourcePath.string()) << "\n";
+		shaderc::Compiler Compiler;
+		shaderc::CompileOptions Options;
+		Options.SetTargetEnvironment(shaderc_target_env_vulkan, shaderc_env_version_vulkan_1_3);
+		Options.SetOptimizationLevel(shaderc_optimization_level_performance);
+		shaderc::SpvCompilationResult Result = Compiler.CompileGlslToSpv(Source.data(), Source.size(), Kind->second,
+			vSourcePath.string().c_str(), "main", Options);
+		if (Result.GetCompilationStatus() != shaderc_compilation_status_success)
+			throw std::runtime_error(std::format("Fail to compile shader \"{0}\":\n{1}", vSourcePath.string(), Result.GetErrorMessage()));
+
+		std::vector<uint32_t> Code(Result.cbegin(), Result.cend());
+		validate(Name, Code); // 缓存中只存放校验过的二进制
+		storeCache(CachePath, Name, Code);
+		std::cout << std::format(R"(Success to compile shader "{0}" !)", vSourcePath.string()) << "\n";
+		return Code;
+	}
+
+	std::filesystem::path ShaderCompiler::generate(const std::filesystem::path& vSourcePath, const std::filesystem::path& vOutputDirectory)
+	{
+		std::vector<uint32_t> Code = compile(vSourcePath);
+		std::filesystem::path OutputPath = vOutputDirectory / (getShaderName(vSourcePath) + ".spv");
+		if (std::filesystem::exists(OutputPath) && loadCache(OutputPath) == Code)
+			return OutputPath;
+		std::filesystem::create_directories(vOutputDirectory);
+		writeFile(OutputPath, Code);
+		std::cout << std::format(R"(Success to generate "{0}" !)", OutputPath.string()) << "\n";
+		return OutputPath;
+	}
+
+	void ShaderCompiler::validate(const std::string& vName, std::span<const uint32_t> vCode)
+	{
+		spv_context Context = spvContextCreate(SPV_ENV_VULKAN_1_3);
+		spv_diagnostic Diagnostic = nullptr;
+		spv_result_t Result = spvValidateBinary(Context, vCode.data(), vCode.size(), &Diagnostic);
+		std::string Message = Diagnostic && Diagnostic->error ? Diagnostic->error : "";
+		spvDiagnosticDestroy(Diagnostic);
+		spvContextDestroy(Context);
+		if (Result != SPV_SUCCESS)
+			throw std::runtime_error(std::format("Fail to validate shader \"{0}\":\n{1}", vName, Message));
+	}
+
+	std::vector<uint32_t> ShaderCompiler::loadCache(const std::filesystem::path& vCachePath)
+	{
+		MappedFile CacheFile(vCachePath);
+		std::vector<uint32_t> Code(CacheFile.size() / sizeof(uint32_t));
+		if (Code.empty() || CacheFile.size() % sizeof(uint32_t) != 0)
+			return {};
+		std::memcpy(Code.data(), CacheFile.data(), CacheFile.size());
+		if (Code[0] != SpirvMagic)
+			return {};
+		return Code;
+	}
+
+	void ShaderCompiler::storeCache(const std::filesystem::path& vCachePath, const std::string& vName, const std::vector<uint32_t>& vCode)
+	{
+		// 同名shader的旧缓存已经不可能再命中，顺便清理掉
+		std::string Prefix = vName + "_";
+		for (const auto& Entry : std::filesystem::directory_iterator(m_CacheDirectory)) {
+			std::string FileName = Entry.path().filename().string();
+			if (FileName.starts_with(Prefix) && FileName.size() == Prefix.size() + 16 + 4)
+				std::filesystem::remove(Entry.path());
+		}
+
+		writeFile(vCachePath, vCode);
+	}
+
+	void ShaderCompiler::writeFile(const std::filesystem::path& vPath, const std::vector<uint32_t>& vCode)
+	{
+		std::filesystem::path TempPath = vPath;
+		TempPath += ".tmp";
+		{
+			std::ofstream OutFileStream(TempPath, std::ios_base::binary | std::ios_base::trunc);
+			if (!OutFileStream)
+				throw std::runtime_error(std::format(R"(Fail to open the file at "{0}".)", TempPath.string()));
+			OutFileStream.write(reinterpret_cast<const char*>(vCode.data()), static_cast<std::streamsize>(vCode.size() * sizeof(uint32_t)));
+		}
+		std::filesystem::rename(TempPath, vPath);
+	}
+
+}
@@ -0,0 +1,33 @@
+#pragma once
+#include <cstdint>
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <string>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 运行时GLSL -> SPIR-V编译(shaderc)，输出经SPIRV-Tools校验后按源码内容哈希缓存到磁盘
+	class ShaderCompiler
+	{
+	public:
+		explicit ShaderCompiler(const std::filesystem::path& vCacheDirectory);
+
+		std::vector<uint32_t> compile(const std::filesystem::path& vSourcePath);
+		std::filesystem::path generate(const std::filesystem::path& vSourcePath, const std::filesystem::path& vOutputDirectory); // 编译并写出"<名字>.spv"，内容不变时不改写文件
+
+		static void validate(const std::string& vName, std::span<const uint32_t> vCode); // 等同spirv-val，无效时抛出异常
+
+		static bool isShaderSource(const std::filesystem::path& vPath);
+		static std::string getShaderName(const std::filesystem::path& vSourcePath); // "18_shader_vertexbuffer.vert" -> "18_shader_vertexbuffer_vert"
+	private:
+		std::vector<uint32_t> loadCache(const std::filesystem::path& vCachePath);
+		void storeCache(const std::filesystem::path& vCachePath, const std::string& vName, const std::vector<uint32_t>& vCode);
+		static void writeFile(const std::filesystem::path& vPath, const std::vector<uint32_t>& vCode);
+	private:
+		std::filesystem::path m_CacheDirectory;
+		std::mutex m_CompileMutex;   // 主线程与热重载线程可能同时编译
+	};
+
+}
@@ -0,0 +1,172 @@
+#include "ShaderObjectBackend.h"
+#include "DeviceFunction.h"
+#include "Timer.h"
+
+#include <array>
+#include <format>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	ShaderObjectBackend::~ShaderObjectBackend()
+	{
+		destroy();
+	}
+
+	void ShaderObjectBackend::create(VkDevice vDevice, const DeviceFeatures& vFeatures, DeletionQueue& vDeletionQueue)
+	{
+		m_Device = vDevice;
+		m_DeletionQueue = &vDeletionQueue;
+		m_IsSupported = vFeatures.isShaderObjectSupported();
+		if (!m_IsSupported)
+			return;
+
+		m_CreateShaders = loadDeviceFunction<PFN_vkCreateShadersEXT>(m_Device, "vkCreateShadersEXT");
+		m_DestroyShader = loadDeviceFunction<PFN_vkDestroyShaderEXT>(m_Device, "vkDestroyShaderEXT");
+		m_CmdBindShaders = loadDeviceFunction<PFN_vkCmdBindShadersEXT>(m_Device, "vkCmdBindShadersEXT");
+		m_CmdSetVertexInput = loadDeviceFunction<PFN_vkCmdSetVertexInputEXT>(m_Device, "vkCmdSetVertexInputEXT");
+		m_CmdSetPolygonMode = loadDeviceFunction<PFN_vkCmdSetPolygonModeEXT>(m_Device, "vkCmdSetPolygonModeEXT");
+		m_CmdSetRasterizationSamples = loadDeviceFunction<PFN_vkCmdSetRasterizationSamplesEXT>(m_Device, "vkCmdSetRasterizationSamplesEXT");
+		m_CmdSetSampleMask = loadDeviceFunction<PFN_vkCmdSetSampleMaskEXT>(m_Device, "vkCmdSetSampleMaskEXT");
+		m_CmdSetAlphaToCoverageEnable = loadDeviceFunction<PFN_vkCmdSetAlphaToCoverageEnableEXT>(m_Device, "vkCmdSetAlphaToCoverageEnableEXT");
+		m_CmdSetColorBlendEnable = loadDeviceFunction<PFN_vkCmdSetColorBlendEnableEXT>(m_Device, "vkCmdSetColorBlendEnableEXT");
+		m_CmdSetColorBlendEquation = loadDeviceFunction<PFN_vkCmdSetColorBlendEquationEXT>(m_Device, "vkCmdSetColorBlendEquationEXT");
+		m_CmdSetColorWriteMask = loadDeviceFunction<PFN_vkCmdSetColorWriteMaskEXT>(m_Device, "vkCmdSetColorWriteMaskEXT");
+	}
+
+	void ShaderObjectBackend::destroy()
+	{
+		if (m_Device == VK_NULL_HANDLE)
+			return;
+		for (auto& [ID, Set] : m_ShaderSets) {
+			m_DestroyShader(m_Device, Set.m_Fragment, nullptr);
+			m_DestroyShader(m_Device, Set.m_Vertex, nullptr);
+		}
+		m_ShaderSets.clear();
+		m_Device = VK_NULL_HANDLE;
+	}
+
+	uint64_t ShaderObjectBackend::request(const GraphicsPipelineDesc& vDesc)
+	{
+		if (!m_IsSupported)
+			throw std::runtime_error("VK_EXT_shader_object is not supported!");
+		uint64_t ID = vDesc.hash();
+		if (m_ShaderSets.contains(ID))
+			return ID;
+
+		Timer CreateTimer;
+		VkSpecializationInfo SpecializationInfo = vDesc.m_Constants.getInfo();
+		std::array<VkShaderCreateInfoEXT, 2> ShaderCreateInfos{};
+		for (auto& ShaderCreateInfo : ShaderCreateInfos) {
+			ShaderCreateInfo.sType = VK_STRUCTURE_TYPE_SHADER_CREATE_INFO_EXT;
+			ShaderCreateInfo.flags = VK_SHADER_CREATE_LINK_STAGE_BIT_EXT; // 两个阶段一起链接，允许驱动做跨阶段优化
+			ShaderCreateInfo.codeType = VK_SHADER_CODE_TYPE_SPIRV_EXT;
+			ShaderCreateInfo.pName = "main";
+			ShaderCreateInfo.setLayoutCount = static_cast<uint32_t>(vDesc.m_SetLayouts.size());
+			ShaderCreateInfo.pSetLayouts = vDesc.m_SetLayouts.data();
+			ShaderCreateInfo.pushConstantRangeCount = static_cast<uint32_t>(vDesc.m_PushConstantRanges.size());
+			ShaderCreateInfo.pPushConstantRanges = vDesc.m_PushConstantRanges.data();
+			ShaderCreateInfo.pSpecializationInfo = vDesc.m_Constants.empty() ? nullptr : &SpecializationInfo;
+		}
+		ShaderCreateInfos[0].stage = VK_SHADER_STAGE_VERTEX_BIT;
+		ShaderCreateInfos[0].nextStage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		ShaderCreateInfos[0].codeSize = vDesc.m_VertexCode.size_bytes();
+		ShaderCreateInfos[0].pCode = vDesc.m_VertexCode.data();
+		ShaderCreateInfos[1].stage = VK_SHADER_STAGE_FRAGMENT_BIT;
+		ShaderCreateInfos[1].codeSize = vDesc.m_FragmentCode.size_bytes();
+		ShaderCreateInfos[1].pCode = vDesc.m_FragmentCode.data();
+
+		std::array<VkShaderEXT, 2> Shaders{};
+		if (m_CreateShaders(m_Device, static_cast<uint32_t>(ShaderCreateInfos.size()), ShaderCreateInfos.data(), nullptr, Shaders.data()) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create shader objects!");
+
+		ShaderSet Set;
+		Set.m_Vertex = Shaders[0];
+		Set.m_Fragment = Shaders[1];
+		for (const auto& Binding : vDesc.m_VertexBindings) {
+			VkVertexInputBindingDescription2EXT Binding2{};
+			Binding2.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_BINDING_DESCRIPTION_2_EXT;
+			Binding2.binding = Binding.binding;
+			Binding2.stride = Binding.stride;
+			Binding2.inputRate = Binding.inputRate;
+			Binding2.divisor = 1;
+			Set.m_VertexBindings.emplace_back(Binding2);
+		}
+		for (const auto& Attribute : vDesc.m_VertexAttributes) {
+			VkVertexInputAttributeDescription2EXT Attribute2{};
+			Attribute2.sType = VK_STRUCTURE_TYPE_VERTEX_INPUT_ATTRIBUTE_DESCRIPTION_2_EXT;
+			Attribute2.location = Attribute.location;
+			Attribute2.binding = Attribute.binding;
+			Attribute2.format = Attribute.format;
+			Attribute2.offset = Attribute.offset;
+			Set.m_VertexAttributes.emplace_back(Attribute2);
+		}
+		Set.m_Topology = vDesc.m_Topology;
+		Set.m_IsPrimitiveRestartEnable = vDesc.m_IsPrimitiveRestartEnable ? VK_TRUE : VK_FALSE;
+		Set.m_CullMode = vDesc.m_CullMode;
+		Set.m_FrontFace = vDesc.m_FrontFace;
+		Set.m_IsBlendEnable = vDesc.m_IsBlendEnable ? VK_TRUE : VK_FALSE;
+		m_ShaderSets[ID] = std::move(Set);
+		std::cout << std::format("Success to create shader objects {0:016x} in {1:.2f} ms !", ID, CreateTimer.ellapseMilliseconds()) << "\n";
+		return ID;
+	}
+
+	void ShaderObjectBackend::release(uint64_t vID, uint64_t vFrame)
+	{
+		auto It = m_ShaderSets.find(vID);
+		if (It == m_ShaderSets.end())
+			return;
+		m_DeletionQueue->push(vFrame, [Device = m_Device, DestroyShader = m_DestroyShader, Vertex = It->second.m_Vertex, Fragment = It->second.m_Fragment]() {
+			DestroyShader(Device, Fragment, nullptr);
+			DestroyShader(Device, Vertex, nullptr);
+			});
+		m_ShaderSets.erase(It);
+	}
+
+	void ShaderObjectBackend::bind(VkCommandBuffer vCommandBuffer, uint64_t vID, VkExtent2D vExtent) const
+	{
+		const ShaderSet& Set = m_ShaderSets.at(vID);
+		const VkShaderStageFlagBits Stages[] = { VK_SHADER_STAGE_VERTEX_BIT, VK_SHADER_STAGE_FRAGMENT_BIT };
+		const VkShaderEXT Shaders[] = { Set.m_Vertex, Set.m_Fragment };
+		m_CmdBindShaders(vCommandBuffer, 2, Stages, Shaders);
+
+		// 没有pipeline，以下状态在每次绑定后都必须设置
+		m_CmdSetVertexInput(vCommandBuffer, static_cast<uint32_t>(Set.m_VertexBindings.size()), Set.m_VertexBindings.data(),
+			static_cast<uint32_t>(Set.m_VertexAttributes.size()), Set.m_VertexAttributes.data());
+		vkCmdSetPrimitiveTopology(vCommandBuffer, Set.m_Topology);
+		vkCmdSetPrimitiveRestartEnable(vCommandBuffer, Set.m_IsPrimitiveRestartEnable);
+
+		VkViewport Viewport{ 0.0f, 0.0f, static_cast<float>(vExtent.width), static_cast<float>(vExtent.height), 0.0f, 1.0f };
+		VkRect2D Scissor{ { 0, 0 }, vExtent };
+		vkCmdSetViewportWithCount(vCommandBuffer, 1, &Viewport);
+		vkCmdSetScissorWithCount(vCommandBuffer, 1, &Scissor);
+
+		vkCmdSetRasterizerDiscardEnable(vCommandBuffer, VK_FALSE);
+		m_CmdSetPolygonMode(vCommandBuffer, VK_POLYGON_MODE_FILL);
+		vkCmdSetCullMode(vCommandBuffer, Set.m_CullMode);
+		vkCmdSetFrontFace(vCommandBuffer, Set.m_FrontFace);
+		vkCmdSetDepthBiasEnable(vCommandBuffer, VK_FALSE);
+		vkCmdSetLineWidth(vCommandBuffer, 1.0f);
+
+		m_CmdSetRasterizationSamples(vCommandBuffer, VK_SAMPLE_COUNT_1_BIT);
+		const VkSampleMask SampleMask = 0xFFFFFFFF;
+		m_CmdSetSampleMask(vCommandBuffer, VK_SAMPLE_COUNT_1_BIT, &SampleMask);
+		m_CmdSetAlphaToCoverageEnable(vCommandBuffer, VK_FALSE);
+
+		vkCmdSetDepthTestEnable(vCommandBuffer, VK_FALSE);
+		vkCmdSetDepthWriteEnable(vCommandBuffer, VK_FALSE);
+		vkCmdSetDepthBoundsTestEnable(vCommandBuffer, VK_FALSE);
+		vkCmdSetStencilTestEnable(vCommandBuffer, VK_FALSE);
+
+		// 与PipelineLibrary中的alpha blending一致
+		m_CmdSetColorBlendEnable(vCommandBuffer, 0, 1, &Set.m_IsBlendEnable);
+		VkColorBlendEquationEXT BlendEquation{ VK_BLEND_FACTOR_SRC_ALPHA, VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA, VK_BLEND_OP_ADD,
+			VK_BLEND_FACTOR_ONE, VK_BLEND_FACTOR_ZERO, VK_BLEND_OP_ADD };
+		m_CmdSetColorBlendEquation(vCommandBuffer, 0, 1, &BlendEquation);
+		const VkColorComponentFlags WriteMask = VK_COLOR_COMPONENT_R_BIT | VK_COLOR_COMPONENT_G_BIT
+			| VK_COLOR_COMPONENT_B_BIT | VK_COLOR_COMPONENT_A_BIT;
+		m_CmdSetColorWriteMask(vCommandBuffer, 0, 1, &WriteMask);
+	}
+
+}
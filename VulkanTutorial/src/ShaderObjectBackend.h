@@ -0,0 +1,65 @@
+#pragma once
+#include "DeletionQueue.h"
+#include "DeviceFeatures.h"
+#include "PipelineLibrary.h"
+
+#include <vulkan/vulkan.h>
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// VK_EXT_shader_object后端：不创建VkPipeline，录制时直接绑定vertex/fragment shader对象，
+	// 所有固定功能状态都作为动态状态设置。与PipelineLibrary使用同一个GraphicsPipelineDesc和ID
+	class ShaderObjectBackend
+	{
+	public:
+		ShaderObjectBackend() = default;
+		~ShaderObjectBackend();
+
+		ShaderObjectBackend(const ShaderObjectBackend&) = delete;
+		ShaderObjectBackend& operator=(const ShaderObjectBackend&) = delete;
+
+		void create(VkDevice vDevice, const DeviceFeatures& vFeatures, DeletionQueue& vDeletionQueue);
+		void destroy();  // 调用前设备必须空闲
+
+		uint64_t request(const GraphicsPipelineDesc& vDesc);  // 返回ID(即vDesc.hash())，已存在时直接返回
+		void release(uint64_t vID, uint64_t vFrame);
+		void bind(VkCommandBuffer vCommandBuffer, uint64_t vID, VkExtent2D vExtent) const;  // 绑定shader并设置全部动态状态
+
+		inline bool isSupported() const { return m_IsSupported; }
+	private:
+		struct ShaderSet
+		{
+			VkShaderEXT m_Vertex = VK_NULL_HANDLE;
+			VkShaderEXT m_Fragment = VK_NULL_HANDLE;
+			std::vector<VkVertexInputBindingDescription2EXT> m_VertexBindings;
+			std::vector<VkVertexInputAttributeDescription2EXT> m_VertexAttributes;
+			VkPrimitiveTopology m_Topology = VK_PRIMITIVE_TOPOLOGY_TRIANGLE_LIST;
+			VkBool32 m_IsPrimitiveRestartEnable = VK_FALSE;
+			VkCullModeFlags m_CullMode = VK_CULL_MODE_BACK_BIT;
+			VkFrontFace m_FrontFace = VK_FRONT_FACE_CLOCKWISE;
+			VkBool32 m_IsBlendEnable = VK_TRUE;
+		};
+	private:
+		VkDevice m_Device = VK_NULL_HANDLE;
+		DeletionQueue* m_DeletionQueue = nullptr;
+		bool m_IsSupported = false;
+		std::unordered_map<uint64_t, ShaderSet> m_ShaderSets;
+
+		PFN_vkCreateShadersEXT m_CreateShaders = nullptr;
+		PFN_vkDestroyShaderEXT m_DestroyShader = nullptr;
+		PFN_vkCmdBindShadersEXT m_CmdBindShaders = nullptr;
+		PFN_vkCmdSetVertexInputEXT m_CmdSetVertexInput = nullptr;
+		PFN_vkCmdSetPolygonModeEXT m_CmdSetPolygonMode = nullptr;
+		PFN_vkCmdSetRasterizationSamplesEXT m_CmdSetRasterizationSamples = nullptr;
+		PFN_vkCmdSetSampleMaskEXT m_CmdSetSampleMask = nullptr;
+		PFN_vkCmdSetAlphaToCoverageEnableEXT m_CmdSetAlphaToCoverageEnable = nullptr;
+		PFN_vkCmdSetColorBlendEnableEXT m_CmdSetColorBlendEnable = nullptr;
+		PFN_vkCmdSetColorBlendEquationEXT m_CmdSetColorBlendEquation = nullptr;
+		PFN_vkCmdSetColorWriteMaskEXT m_CmdSetColorWriteMask = nullptr;
+	};
+
+}
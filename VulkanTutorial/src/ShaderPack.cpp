@@ -0,0 +1,210 @@
+#include "ShaderPack.h"
+#include "Hash.h"
+#include "ShaderCompiler.h"
+
+#include <algorithm>
+#include <cstring>
+#include <format>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t SpirvMagic = 0x07230203;
+
+		inline std::string_view entryName(const ShaderPackEntry& vEntry)
+		{
+			return std::string_view(vEntry.m_Name, strnlen(vEntry.m_Name, sizeof(vEntry.m_Name)));
+		}
+
+		inline uint64_t alignUp(uint64_t vValue, uint64_t vAlignment)
+		{
+			return (vValue + vAlignment - 1) & ~(vAlignment - 1);
+		}
+
+		// vEntries须已按名字排序
+		uint64_t hashInputs(std::span<const ShaderPackEntry> vEntries)
+		{
+			uint64_t Hash = hashString("ShaderPack");
+			for (const auto& Entry : vEntries)
+				Hash = hashCombine(hashCombine(Hash, hashString(entryName(Entry))), Entry.m_ContentHash);
+			return Hash;
+		}
+
+	}
+
+	void ShaderPack::build(const std::filesystem::path& vOutputPath, const std::vector<std::filesystem::path>& vInputPaths)
+	{
+		std::cout << std::format(R"(Try to build shader pack "{0}" ...)", vOutputPath.string()) << "\n";
+		std::vector<MappedFile> Inputs;
+		std::vector<ShaderPackEntry> Entries;
+		Inputs.reserve(vInputPaths.size());
+		Entries.reserve(vInputPaths.size());
+		for (const auto& Path : vInputPaths) {
+			MappedFile& Input = Inputs.emplace_back(Path);
+			uint32_t FirstWord = 0;
+			if (Input.size() >= sizeof(FirstWord))
+				std::memcpy(&FirstWord, Input.data(), sizeof(FirstWord));
+			if (Input.size() % sizeof(uint32_t) != 0 || FirstWord != SpirvMagic)
+				throw std::runtime_error(std::format(R"("{0}" is not a valid SPIR-V binary.)", Path.string()));
+			// 只打包通过校验的二进制，无效的模块在这里报错而不是等到驱动创建ShaderModule时
+			ShaderCompiler::validate(Path.stem().string(), std::span(reinterpret_cast<const uint32_t*>(Input.data()), Input.size() / sizeof(uint32_t)));
+
+			std::string Name = Path.stem().string();
+			ShaderPackEntry Entry{};
+			if (Name.size() >= sizeof(Entry.m_Name))
+				throw std::runtime_error(std::format(R"(Shader name "{0}" is too long for the shader pack.)", Name));
+			std::memcpy(Entry.m_Name, Name.data(), Name.size());
+			Entry.m_ContentHash = hashBytes(Input.data(), Input.size());
+			Entry.m_Size = Input.size();
+			Entry.m_Offset = Inputs.size() - 1; // 暂存输入索引，排序后再计算真正的偏移
+			Entries.emplace_back(Entry);
+		}
+		std::sort(Entries.begin(), Entries.end(), [](const ShaderPackEntry& vLeft, const ShaderPackEntry& vRight) {
+			return entryName(vLeft) < entryName(vRight);
+			});
+		for (size_t i = 1; i < Entries.size(); ++i) {
+			if (entryName(Entries[i - 1]) == entryName(Entries[i]))
+				throw std::runtime_error(std::format(R"(Duplicated shader "{0}" in the shader pack.)", entryName(Entries[i])));
+		}
+
+		std::vector<size_t> InputIndices(Entries.size());
+		uint64_t Offset = alignUp(sizeof(ShaderPackHeader) + Entries.size() * sizeof(ShaderPackEntry), Alignment);
+		for (size_t i = 0; i < Entries.size(); ++i) {
+			InputIndices[i] = static_cast<size_t>(Entries[i].m_Offset);
+			Entries[i].m_Offset = Offset;
+			Offset = alignUp(Offset + Entries[i].m_Size, Alignment);
+		}
+
+		ShaderPackHeader Header{};
+		Header.m_Magic = Magic;
+		Header.m_Version = Version;
+		Header.m_EntryCount = static_cast<uint32_t>(Entries.size());
+		Header.m_InputHash = hashInputs(Entries);
+
+		// 先写临时文件再替换，避免运行中的进程映射到写了一半的包
+		std::filesystem::path TempPath = vOutputPath;
+		TempPath += ".tmp";
+		{
+			std::ofstream OutFileStream(TempPath, std::ios_base::binary | std::ios_base::trunc);
+			if (!OutFileStream)
+				throw std::runtime_error(std::format(R"(Fail to open the file at "{0}".)", TempPath.string()));
+			OutFileStream.write(reinterpret_cast<const char*>(&Header), sizeof(Header));
+			OutFileStream.write(reinterpret_cast<const char*>(Entries.data()), Entries.size() * sizeof(ShaderPackEntry));
+			const char Padding[Alignment] = {};
+			uint64_t Written = sizeof(Header) + Entries.size() * sizeof(ShaderPackEntry);
+			for (size_t i = 0; i < Entries.size(); ++i) {
+				OutFileStream.write(Padding, static_cast<std::streamsize>(Entries[i].m_Offset - Written));
+				const MappedFile& Input = Inputs[InputIndices[i]];
+				OutFileStream.write(reinterpret_cast<const char*>(Input.data()), static_cast<std::streamsize>(Input.size()));
+				Written = Entries[i].m_Offset + Entries[i].m_Size;
+			}
+			if (!OutFileStream)
+				throw std::runtime_error(std::format(R"(Fail to write the file at "{0}".)", TempPath.string()));
+		}
+		std::filesystem::rename(TempPath, vOutputPath);
+		std::cout << std::format("Success to build shader pack with {0} shaders !", Entries.size()) << "\n";
+	}
+
+	bool ShaderPack::isOutdated(const std::filesystem::path& vPackPath, const std::vector<std::filesystem::path>& vInputPaths)
+	{
+		if (!std::filesystem::exists(vPackPath))
+			return true;
+		if (vInputPaths.empty()) // 发布时只带shaders.pack，没有可比较的输入
+			return false;
+		ShaderPackHeader Header{};
+		{
+			MappedFile PackFile(vPackPath);
+			if (PackFile.size() < sizeof(Header))
+				return true;
+			std::memcpy(&Header, PackFile.data(), sizeof(Header));
+		}
+		if (Header.m_Magic != Magic || Header.m_Version != Version)
+			return true;
+
+		// 修改时间在复制或检出后不可靠，按内容哈希比较；SPIR-V文件很小，全部读一遍的开销可以忽略
+		std::vector<ShaderPackEntry> Entries;
+		Entries.reserve(vInputPaths.size());
+		for (const auto& Path : vInputPaths) {
+			std::string Name = Path.stem().string();
+			ShaderPackEntry Entry{};
+			if (Name.size() >= sizeof(Entry.m_Name))
+				return true;  // 让build()报告错误
+			std::memcpy(Entry.m_Name, Name.data(), Name.size());
+			MappedFile Input(Path);
+			Entry.m_ContentHash = hashBytes(Input.data(), Input.size());
+			Entries.emplace_back(Entry);
+		}
+		std::sort(Entries.begin(), Entries.end(), [](const ShaderPackEntry& vLeft, const ShaderPackEntry& vRight) {
+			return entryName(vLeft) < entryName(vRight);
+			});
+		return hashInputs(Entries) != Header.m_InputHash;
+	}
+
+	void ShaderPack::open(const std::filesystem::path& vPath)
+	{
+		close();
+		m_File.open(vPath);
+		ShaderPackHeader Header{};
+		if (m_File.size() < sizeof(Header))
+			throw std::runtime_error(std::format(R"("{0}" is not a shader pack.)", vPath.string()));
+		std::memcpy(&Header, m_File.data(), sizeof(Header));
+		if (Header.m_Magic != Magic || Header.m_Version != Version)
+			throw std::runtime_error(std::format(R"("{0}" is not a shader pack of version {1}.)", vPath.string(), Version));
+		if (sizeof(Header) + static_cast<uint64_t>(Header.m_EntryCount) * sizeof(ShaderPackEntry) > m_File.size())
+			throw std::runtime_error(std::format(R"(Shader pack "{0}" is truncated.)", vPath.string()));
+
+		m_Entries = std::span<const ShaderPackEntry>(reinterpret_cast<const ShaderPackEntry*>(m_File.data() + sizeof(Header)), Header.m_EntryCount);
+		for (const auto& Entry : m_Entries) {
+			if (Entry.m_Offset % Alignment != 0 || Entry.m_Offset + Entry.m_Size > m_File.size())
+				throw std::runtime_error(std::format(R"(Shader pack "{0}" is corrupted.)", vPath.string()));
+		}
+	}
+
+	void ShaderPack::close()
+	{
+		m_Entries = {};
+		m_File.close();
+	}
+
+	bool ShaderPack::verify() const
+	{
+		for (const auto& Entry : m_Entries) {
+			if (hashBytes(m_File.data() + Entry.m_Offset, Entry.m_Size) != Entry.m_ContentHash) {
+				std::cerr << std::format(R"(Shader "{0}" in the shader pack has a mismatched content hash!)", entryName(Entry)) << "\n";
+				return false;
+			}
+		}
+		return true;
+	}
+
+	std::span<const uint32_t> ShaderPack::find(std::string_view vName) const
+	{
+		const ShaderPackEntry* Entry = findEntry(vName);
+		if (!Entry)
+			throw std::runtime_error(std::format(R"(Fail to find shader "{0}" in the shader pack.)", vName));
+		return std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(m_File.data() + Entry->m_Offset), Entry->m_Size / sizeof(uint32_t));
+	}
+
+	std::span<const uint32_t> ShaderPack::tryFind(std::string_view vName) const
+	{
+		const ShaderPackEntry* Entry = findEntry(vName);
+		if (!Entry)
+			return {};
+		return std::span<const uint32_t>(reinterpret_cast<const uint32_t*>(m_File.data() + Entry->m_Offset), Entry->m_Size / sizeof(uint32_t));
+	}
+
+	const ShaderPackEntry* ShaderPack::findEntry(std::string_view vName) const
+	{
+		auto It = std::lower_bound(m_Entries.begin(), m_Entries.end(), vName, [](const ShaderPackEntry& vEntry, std::string_view vKey) {
+			return entryName(vEntry) < vKey;
+			});
+		if (It == m_Entries.end() || entryName(*It) != vName)
+			return nullptr;
+		return &*It;
+	}
+
+}
@@ -0,0 +1,55 @@
+#pragma once
+#include "MappedFile.h"
+
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 着色器包文件布局: [ShaderPackHeader][ShaderPackEntry * N (按名字排序)][按Alignment对齐的SPIR-V数据 ...]
+	struct ShaderPackHeader
+	{
+		uint32_t m_Magic = 0;
+		uint32_t m_Version = 0;
+		uint32_t m_EntryCount = 0;
+		uint32_t m_Reserved = 0;
+		uint64_t m_InputHash = 0;  // 全部输入(名字与内容哈希)的组合哈希，判断包是否过期
+	};
+
+	struct ShaderPackEntry
+	{
+		char m_Name[48] = {};      // 不含扩展名，如"18_shader_vertexbuffer_vert"
+		uint64_t m_ContentHash = 0;
+		uint64_t m_Offset = 0;     // 相对文件起始的偏移
+		uint64_t m_Size = 0;       // 字节数，必为4的倍数
+	};
+
+	class ShaderPack
+	{
+	public:
+		static constexpr uint32_t Magic = 0x50534B56;  // "VKSP"
+		static constexpr uint32_t Version = 2;
+		static constexpr uint64_t Alignment = 64;      // mmap基址按页对齐，因此条目数据可以直接当作uint32_t*使用
+
+		static void build(const std::filesystem::path& vOutputPath, const std::vector<std::filesystem::path>& vInputPaths);
+		static bool isOutdated(const std::filesystem::path& vPackPath, const std::vector<std::filesystem::path>& vInputPaths);  // 按内容比较，不看修改时间
+
+		void open(const std::filesystem::path& vPath);
+		void close();
+		bool verify() const;
+
+		std::span<const uint32_t> find(std::string_view vName) const;
+		std::span<const uint32_t> tryFind(std::string_view vName) const;  // 找不到时返回空span，用于可选的着色器
+		inline bool contains(std::string_view vName) const { return findEntry(vName) != nullptr; }
+		inline size_t size() const { return m_Entries.size(); }
+	private:
+		const ShaderPackEntry* findEntry(std::string_view vName) const;
+	private:
+		MappedFile m_File;
+		std::span<const ShaderPackEntry> m_Entries;
+	};
+
+}
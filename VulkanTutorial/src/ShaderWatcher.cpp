@@ -0,0 +1,112 @@
+#include "ShaderWatcher.h"
+
+#include <chrono>
+#include <format>
+#include <iostream>
+#include <set>
+#include <stdexcept>
+
+#ifndef _WIN32
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr auto PollInterval = std::chrono::milliseconds(200);
+
+	}
+
+	ShaderWatcher::~ShaderWatcher()
+	{
+		stop();
+	}
+
+	void ShaderWatcher::start(const std::filesystem::path& vDirectory, Callback vCallback)
+	{
+		stop();
+		m_Directory = vDirectory;
+		m_Callback = std::move(vCallback);
+#ifdef _WIN32
+		m_WriteTimes.clear();
+		for (const auto& Entry : std::filesystem::directory_iterator(m_Directory)) {
+			if (Entry.is_regular_file())
+				m_WriteTimes[Entry.path()] = Entry.last_write_time();
+		}
+#else
+		m_InotifyDescriptor = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+		if (m_InotifyDescriptor < 0)
+			throw std::runtime_error("Failed to initialize inotify!");
+		// 编辑器保存文件时要么原地写入(CLOSE_WRITE)，要么写临时文件再rename(MOVED_TO)
+		if (inotify_add_watch(m_InotifyDescriptor, m_Directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0) {
+			::close(m_InotifyDescriptor);
+			m_InotifyDescriptor = -1;
+			throw std::runtime_error(std::format(R"(Fail to watch the directory at "{0}".)", m_Directory.string()));
+		}
+#endif
+		m_IsRunning = true;
+		m_Thread = std::thread(&ShaderWatcher::run, this);
+		std::cout << std::format(R"(Start watching shader sources in "{0}".)", m_Directory.string()) << "\n";
+	}
+
+	void ShaderWatcher::stop()
+	{
+		m_IsRunning = false;
+		if (m_Thread.joinable())
+			m_Thread.join();
+#ifndef _WIN32
+		if (m_InotifyDescriptor >= 0)
+			::close(m_InotifyDescriptor);
+		m_InotifyDescriptor = -1;
+#endif
+	}
+
+#ifdef _WIN32
+	void ShaderWatcher::run()
+	{
+		while (m_IsRunning) {
+			std::this_thread::sleep_for(PollInterval);
+			std::error_code Error;
+			for (const auto& Entry : std::filesystem::directory_iterator(m_Directory, Error)) {
+				if (!Entry.is_regular_file(Error))
+					continue;
+				auto WriteTime = Entry.last_write_time(Error);
+				if (Error)
+					continue;
+				auto It = m_WriteTimes.find(Entry.path());
+				if (It != m_WriteTimes.end() && It->second == WriteTime)
+					continue;
+				m_WriteTimes[Entry.path()] = WriteTime;
+				m_Callback(Entry.path());
+			}
+		}
+	}
+#else
+	void ShaderWatcher::run()
+	{
+		alignas(inotify_event) char Buffer[4096];
+		pollfd PollDescriptor{ m_InotifyDescriptor, POLLIN, 0 };
+		while (m_IsRunning) {
+			if (poll(&PollDescriptor, 1, static_cast<int>(PollInterval.count())) <= 0)
+				continue;
+			// 一次保存通常会产生多个事件，合并后每个文件只回调一次
+			std::set<std::filesystem::path> ChangedFiles;
+			ssize_t Length = 0;
+			while ((Length = read(m_InotifyDescriptor, Buffer, sizeof(Buffer))) > 0) {
+				for (char* Pointer = Buffer; Pointer < Buffer + Length;) {
+					const inotify_event* Event = reinterpret_cast<const inotify_event*>(Pointer);
+					if (Event->len > 0)
+						ChangedFiles.insert(m_Directory / Event->name);
+					Pointer += sizeof(inotify_event) + Event->len;
+				}
+			}
+			for (const auto& Path : ChangedFiles)
+				m_Callback(Path);
+		}
+	}
+#endif
+
+}
@@ -0,0 +1,39 @@
+#pragma once
+#include <atomic>
+#include <filesystem>
+#include <functional>
+#include <map>
+#include <thread>
+
+namespace VulkanTutorial {
+
+	// 监视shader源码目录，文件被写入后在后台线程上回调(Linux下使用inotify，其他平台轮询修改时间)
+	class ShaderWatcher
+	{
+	public:
+		using Callback = std::function<void(const std::filesystem::path&)>;
+
+		ShaderWatcher() = default;
+		~ShaderWatcher();
+
+		ShaderWatcher(const ShaderWatcher&) = delete;
+		ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+
+		void start(const std::filesystem::path& vDirectory, Callback vCallback);
+		void stop();
+		inline bool isRunning() const { return m_IsRunning; }
+	private:
+		void run();
+	private:
+		std::filesystem::path m_Directory;
+		Callback m_Callback;
+		std::thread m_Thread;
+		std::atomic<bool> m_IsRunning = false;
+#ifdef _WIN32
+		std::map<std::filesystem::path, std::filesystem::file_time_type> m_WriteTimes;
+#else
+		int m_InotifyDescriptor = -1;
+#endif
+	};
+
+}
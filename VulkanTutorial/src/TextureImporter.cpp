@@ -0,0 +1,149 @@
+#include "TextureImporter.h"
+#include "Hash.h"
+#include "Ktx2File.h"
+#include "MappedFile.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <format>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint64_t ImportVersion = 1;  // mip生成方式或输出格式改变时递增，使旧缓存失效
+		constexpr const char* CacheExtension = ".ktx2";
+
+		float decodeSrgb(float vValue)
+		{
+			return vValue <= 0.04045f ? vValue / 12.92f : std::pow((vValue + 0.055f) / 1.055f, 2.4f);
+		}
+
+		struct SrgbTables
+		{
+			std::array<float, 256> m_ToLinear{};
+			std::array<float, 255> m_Thresholds{};  // 第i项是sRGB值i + 0.5对应的线性值，查找即在sRGB空间中四舍五入
+
+			SrgbTables()
+			{
+				for (int i = 0; i < 256; ++i)
+					m_ToLinear[i] = decodeSrgb(i / 255.0f);
+				for (int i = 0; i < 255; ++i)
+					m_Thresholds[i] = decodeSrgb((i + 0.5f) / 255.0f);
+			}
+
+			inline std::byte encode(float vLinear) const
+			{
+				return static_cast<std::byte>(std::upper_bound(m_Thresholds.begin(), m_Thresholds.end(), vLinear) - m_Thresholds.begin());
+			}
+		};
+
+		const SrgbTables& getSrgbTables()
+		{
+			static const SrgbTables Tables;
+			return Tables;
+		}
+
+	}
+
+	std::filesystem::path TextureImporter::import(const std::filesystem::path& vPath, ImageDecoder& vDecoder, const std::filesystem::path& vCacheDirectory)
+	{
+		if (Ktx2File::isKtx2(vPath))
+			return vPath;
+		uint64_t SourceHash = 0;
+		{
+			MappedFile SourceFile(vPath);
+			SourceHash = hashBytes(SourceFile.data(), SourceFile.size(), ImportVersion);
+		}
+		std::filesystem::path CachePath = getCachePath(vPath, SourceHash, vCacheDirectory);
+		if (std::filesystem::exists(CachePath)) {
+			try {
+				Ktx2File CacheFile(CachePath);   // 只映射并检查文件头，损坏时重新导入
+				return CachePath;
+			}
+			catch (const std::exception&) {
+			}
+		}
+
+		ImageExtent Extent = vDecoder.open(vPath);
+		std::vector<std::byte> Pixels(Extent.getRgbaSize());
+		vDecoder.decode(Pixels.data());
+		std::vector<std::vector<std::byte>> Levels = buildMipChain(Extent, std::move(Pixels));
+		std::filesystem::create_directories(vCacheDirectory);
+		removeStaleCaches(CachePath);
+		try {
+			Ktx2File::write(CachePath, VK_FORMAT_R8G8B8A8_SRGB, { Extent.m_Width, Extent.m_Height }, Levels);
+		}
+		catch (const std::filesystem::filesystem_error&) {
+			// 另一个线程同时导入了同一文件并已写好缓存，正被映射的文件在Windows上不能被替换
+			if (!std::filesystem::exists(CachePath))
+				throw;
+		}
+		return CachePath;
+	}
+
+	std::vector<std::vector<std::byte>> TextureImporter::buildMipChain(ImageExtent vExtent, std::vector<std::byte>&& vPixels)
+	{
+		if (vPixels.size() != vExtent.getRgbaSize())
+			throw std::runtime_error("Failed to build mip chain with mismatched pixel size!");
+		const SrgbTables& Tables = getSrgbTables();
+		std::vector<std::vector<std::byte>> Levels;
+		Levels.emplace_back(std::move(vPixels));
+		uint32_t Width = vExtent.m_Width, Height = vExtent.m_Height;
+		while (Width > 1 || Height > 1) {
+			uint32_t NextWidth = std::max(Width / 2, 1u), NextHeight = std::max(Height / 2, 1u);
+			const uint8_t* Source = reinterpret_cast<const uint8_t*>(Levels.back().data());
+			std::vector<std::byte> Next(static_cast<size_t>(NextWidth) * NextHeight * 4);
+			std::byte* Target = Next.data();
+			for (uint32_t y = 0; y < NextHeight; ++y) {
+				const uint8_t* Row0 = Source + static_cast<size_t>(std::min(y * 2, Height - 1)) * Width * 4;
+				const uint8_t* Row1 = Source + static_cast<size_t>(std::min(y * 2 + 1, Height - 1)) * Width * 4;
+				for (uint32_t x = 0; x < NextWidth; ++x, Target += 4) {
+					size_t X0 = static_cast<size_t>(std::min(x * 2, Width - 1)) * 4;
+					size_t X1 = static_cast<size_t>(std::min(x * 2 + 1, Width - 1)) * 4;
+					for (int c = 0; c < 3; ++c) {
+						float Linear = Tables.m_ToLinear[Row0[X0 + c]] + Tables.m_ToLinear[Row0[X1 + c]] + Tables.m_ToLinear[Row1[X0 + c]] + Tables.m_ToLinear[Row1[X1 + c]];
+						Target[c] = Tables.encode(Linear * 0.25f);
+					}
+					Target[3] = static_cast<std::byte>((Row0[X0 + 3] + Row0[X1 + 3] + Row1[X0 + 3] + Row1[X1 + 3] + 2) / 4);
+				}
+			}
+			Levels.emplace_back(std::move(Next));
+			Width = NextWidth;
+			Height = NextHeight;
+		}
+		return Levels;
+	}
+
+	std::filesystem::path TextureImporter::getCachePath(const std::filesystem::path& vPath, uint64_t vSourceHash, const std::filesystem::path& vCacheDirectory)
+	{
+		// 扩展名和规范化后的源路径哈希也放进文件名，同一目录下的albedo.png和albedo.jpg、
+		// 不同目录下的同名albedo.png都不会互相清理
+		std::string Extension = vPath.extension().string();
+		std::error_code ErrorCode;
+		std::filesystem::path SourcePath = std::filesystem::weakly_canonical(vPath, ErrorCode);
+		if (ErrorCode)
+			SourcePath = std::filesystem::absolute(vPath).lexically_normal();
+		uint64_t PathHash = hashString(SourcePath.generic_string());
+		return vCacheDirectory / std::format("{0}_{1}_{2:016x}_{3:016x}{4}", vPath.stem().string(), Extension.empty() ? "" : Extension.substr(1), PathHash, vSourceHash, CacheExtension);
+	}
+
+	void TextureImporter::removeStaleCaches(const std::filesystem::path& vCachePath)
+	{
+		// 同一源文件的旧缓存已经不可能再命中；vCachePath本身可能刚由另一个线程写好，不删除。
+		// 其他线程或进程可能正映射着旧缓存，删除失败时忽略
+		std::string CacheName = vCachePath.filename().string();
+		std::string Prefix = CacheName.substr(0, CacheName.size() - 16 - std::char_traits<char>::length(CacheExtension));
+		std::error_code ErrorCode;
+		for (const auto& Entry : std::filesystem::directory_iterator(vCachePath.parent_path(), ErrorCode)) {
+			std::string FileName = Entry.path().filename().string();
+			if (FileName != CacheName && FileName.starts_with(Prefix) && FileName.size() == CacheName.size() && FileName.ends_with(CacheExtension))
+				std::filesystem::remove(Entry.path(), ErrorCode);
+		}
+	}
+
+}
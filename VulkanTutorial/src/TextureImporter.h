@@ -0,0 +1,27 @@
+#pragma once
+#include "ImageDecoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 纹理导入流程：图片解码为RGBA8，在CPU上生成完整的mip链，写成R8G8B8A8_SRGB的KTX2。
+	// 结果按源文件路径和内容哈希缓存，源文件不变时加载只是映射KTX2后一次memcpy，既不解码也不需要在GPU上blit生成mip
+	class TextureImporter
+	{
+	public:
+		static constexpr const char* DefaultCacheDirectory = "resources/textures/cache";
+
+		// 返回可直接加载的KTX2路径，缓存未命中时用vDecoder解码并写入缓存；源文件本身是.ktx2时原样返回。可在多个线程上同时调用
+		static std::filesystem::path import(const std::filesystem::path& vPath, ImageDecoder& vDecoder, const std::filesystem::path& vCacheDirectory = DefaultCacheDirectory);
+		// 每级是上一级2x2像素的平均(奇数边长时最后一行/列重复使用)，颜色在线性空间中平均，alpha直接平均
+		static std::vector<std::vector<std::byte>> buildMipChain(ImageExtent vExtent, std::vector<std::byte>&& vPixels);
+	private:
+		static std::filesystem::path getCachePath(const std::filesystem::path& vPath, uint64_t vSourceHash, const std::filesystem::path& vCacheDirectory);
+		static void removeStaleCaches(const std::filesystem::path& vCachePath);
+	};
+
+}
@@ -0,0 +1,543 @@
+#include "TextureLoader.h"
+#include "ImageDecoder.h"
+#include "Ktx2File.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <memory>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr VkDeviceSize StagingAlignment = 16;  // 满足任意纹素大小和optimalBufferCopyOffsetAlignment的常见取值
+
+		uint32_t findMemoryType(VkPhysicalDevice vPhysicalDevice, uint32_t vTypeFilter, VkMemoryPropertyFlags vProperties)
+		{
+			VkPhysicalDeviceMemoryProperties MemoryProperties{};
+			vkGetPhysicalDeviceMemoryProperties(vPhysicalDevice, &MemoryProperties);
+			for (uint32_t i = 0; i < MemoryProperties.memoryTypeCount; ++i) {
+				if ((vTypeFilter & (1 << i)) && (MemoryProperties.memoryTypes[i].propertyFlags & vProperties) == vProperties)
+					return i;
+			}
+			throw std::runtime_error("Failed to find suitable memory type!");
+		}
+
+	}
+
+	TextureLoader::~TextureLoader()
+	{
+		destroy();
+	}
+
+	void TextureLoader::create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, uint32_t vQueueFamily, VkQueue vQueue, BindlessTable& vBindlessTable,
+		VkDeviceSize vStagingSize, unsigned vWorkerCount, const std::filesystem::path& vCacheDirectory)
+	{
+		std::cout << "Try to create texture loader ..." << "\n";
+		m_PhysicalDevice = vPhysicalDevice;
+		m_Device = vDevice;
+		m_Queue = vQueue;
+		m_BindlessTable = &vBindlessTable;
+		m_CacheDirectory = vCacheDirectory;
+
+		VkCommandPoolCreateInfo CommandPoolCreateInfo{};
+		CommandPoolCreateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_POOL_CREATE_INFO;
+		CommandPoolCreateInfo.flags = VK_COMMAND_POOL_CREATE_TRANSIENT_BIT;
+		CommandPoolCreateInfo.queueFamilyIndex = vQueueFamily;
+		if (vkCreateCommandPool(m_Device, &CommandPoolCreateInfo, nullptr, &m_CommandPool) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create texture upload command pool!");
+
+		VkSamplerCreateInfo SamplerCreateInfo{};
+		SamplerCreateInfo.sType = VK_STRUCTURE_TYPE_SAMPLER_CREATE_INFO;
+		SamplerCreateInfo.magFilter = VK_FILTER_LINEAR;
+		SamplerCreateInfo.minFilter = VK_FILTER_LINEAR;
+		SamplerCreateInfo.mipmapMode = VK_SAMPLER_MIPMAP_MODE_LINEAR;
+		SamplerCreateInfo.addressModeU = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		SamplerCreateInfo.addressModeV = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		SamplerCreateInfo.addressModeW = VK_SAMPLER_ADDRESS_MODE_REPEAT;
+		SamplerCreateInfo.maxLod = VK_LOD_CLAMP_NONE;
+		if (vkCreateSampler(m_Device, &SamplerCreateInfo, nullptr, &m_Sampler) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create texture sampler!");
+
+		// staging环常驻映射，工作线程直接写入其中
+		m_StagingSize = vStagingSize;
+		VkBufferCreateInfo BufferCreateInfo{};
+		BufferCreateInfo.sType = VK_STRUCTURE_TYPE_BUFFER_CREATE_INFO;
+		BufferCreateInfo.size = m_StagingSize;
+		BufferCreateInfo.usage = VK_BUFFER_USAGE_TRANSFER_SRC_BIT;
+		BufferCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		if (vkCreateBuffer(m_Device, &BufferCreateInfo, nullptr, &m_StagingBuffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create texture staging buffer!");
+		VkMemoryRequirements MemoryRequirements;
+		vkGetBufferMemoryRequirements(m_Device, m_StagingBuffer, &MemoryRequirements);
+		VkMemoryAllocateInfo MemoryAllocateInfo{};
+		MemoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		MemoryAllocateInfo.allocationSize = MemoryRequirements.size;
+		MemoryAllocateInfo.memoryTypeIndex = findMemoryType(m_PhysicalDevice, MemoryRequirements.memoryTypeBits,
+			VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT);
+		if (vkAllocateMemory(m_Device, &MemoryAllocateInfo, nullptr, &m_StagingMemory) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate texture staging buffer memory!");
+		vkBindBufferMemory(m_Device, m_StagingBuffer, m_StagingMemory, 0);
+		void* Data = nullptr;
+		if (vkMapMemory(m_Device, m_StagingMemory, 0, m_StagingSize, 0, &Data) != VK_SUCCESS)
+			throw std::runtime_error("Failed to map texture staging buffer memory!");
+		m_StagingData = static_cast<std::byte*>(Data);
+		m_StagingHead = m_StagingTail = 0;
+
+		m_IsStopping = false;
+		createPlaceholder();
+		for (unsigned i = 0; i < std::max(1u, vWorkerCount); ++i)
+			m_Workers.emplace_back(&TextureLoader::runWorker, this);
+		std::cout << std::format("Success to create texture loader ({0} workers, {1} MB staging ring) !", m_Workers.size(), m_StagingSize >> 20) << "\n";
+	}
+
+	void TextureLoader::destroy()
+	{
+		if (m_Device == VK_NULL_HANDLE)
+			return;
+		{
+			std::scoped_lock Lock(m_TaskMutex, m_StagingMutex); // 等待staging空间的工作线程也要被唤醒
+			m_IsStopping = true;
+			m_Tasks.clear();
+		}
+		m_TaskCondition.notify_all();
+		m_StagingCondition.notify_all();
+		for (auto& Worker : m_Workers)
+			Worker.join();
+		m_Workers.clear();
+
+		for (UploadBatch& Batch : m_Batches)
+			vkDestroyFence(m_Device, Batch.m_Fence, nullptr);  // 设备已空闲，命令缓冲随命令池一起释放
+		m_Batches.clear();
+		for (Texture& Item : m_Textures)
+			destroyImage(Item);
+		m_Textures.clear();
+		destroyImage(m_Placeholder);
+		m_DecodedTextures.clear();
+		m_StagingRanges.clear();
+		m_PendingCount = 0;
+
+		vkDestroyBuffer(m_Device, m_StagingBuffer, nullptr);
+		vkFreeMemory(m_Device, m_StagingMemory, nullptr);  // 释放时隐式解除映射
+		m_StagingBuffer = VK_NULL_HANDLE;
+		m_StagingMemory = VK_NULL_HANDLE;
+		m_StagingData = nullptr;
+		vkDestroySampler(m_Device, m_Sampler, nullptr);
+		m_Sampler = VK_NULL_HANDLE;
+		vkDestroyCommandPool(m_Device, m_CommandPool, nullptr);
+		m_CommandPool = VK_NULL_HANDLE;
+		m_Device = VK_NULL_HANDLE;
+	}
+
+	bool TextureLoader::isSupported(const std::filesystem::path& vPath)
+	{
+		return Ktx2File::isKtx2(vPath) || ImageDecoder::isSupported(vPath);
+	}
+
+	TextureHandle TextureLoader::load(const std::filesystem::path& vPath, Callback vCallback)
+	{
+		if (m_PendingCount == 0) {
+			m_LoadTimer.reset();
+			m_LoadedCount = 0;
+			m_LoadedBytes = 0;
+		}
+		TextureHandle Handle = static_cast<TextureHandle>(m_Textures.size());
+		Texture& Item = m_Textures.emplace_back();
+		Item.m_Path = vPath;
+		Item.m_Callback = std::move(vCallback);
+		++m_PendingCount;
+		{
+			std::lock_guard<std::mutex> Lock(m_TaskMutex);
+			m_Tasks.emplace_back(Handle, vPath);
+		}
+		m_TaskCondition.notify_one();
+		return Handle;
+	}
+
+	void TextureLoader::update()
+	{
+		// 同一队列上的提交按顺序完成，遇到第一个未完成的批次即可停止
+		while (!m_Batches.empty() && vkGetFenceStatus(m_Device, m_Batches.front().m_Fence) == VK_SUCCESS) {
+			finishBatch(m_Batches.front());
+			m_Batches.pop_front();
+		}
+
+		std::vector<DecodedTexture> DecodedTextures;
+		{
+			std::lock_guard<std::mutex> Lock(m_TaskMutex);
+			DecodedTextures.swap(m_DecodedTextures);
+		}
+		std::erase_if(DecodedTextures, [this](const DecodedTexture& vDecoded) {
+			if (vDecoded.m_IsLoaded)
+				return false;
+			failTexture(vDecoded.m_Handle);
+			return true;
+			});
+		if (!DecodedTextures.empty())
+			submitBatch(std::move(DecodedTextures));
+
+		if (m_PendingCount == 0 && m_LoadedCount > 0) {
+			float Milliseconds = m_LoadTimer.ellapseMilliseconds();
+			std::cout << std::format("Success to load {0} textures ({1:.1f} MB) in {2:.2f} ms ({3:.1f} MB/s) !", m_LoadedCount,
+				m_LoadedBytes / 1048576.0, Milliseconds, m_LoadedBytes / 1048576.0 / std::max(Milliseconds * 0.001, 1e-6)) << "\n";
+			m_LoadedCount = 0;
+			m_LoadedBytes = 0;
+		}
+	}
+
+	void TextureLoader::wait()
+	{
+		while (m_PendingCount > 0) {
+			update();
+			if (!m_Batches.empty()) {
+				vkWaitForFences(m_Device, 1, &m_Batches.front().m_Fence, VK_TRUE, 1'000'000);  // 最多1ms，期间可能有新的解码完成
+			}
+			else {
+				std::unique_lock<std::mutex> Lock(m_TaskMutex);
+				m_DecodedCondition.wait_for(Lock, std::chrono::milliseconds(1), [this]() { return !m_DecodedTextures.empty(); });
+			}
+		}
+		update(); // 打印统计
+	}
+
+	void TextureLoader::runWorker()
+	{
+		// 解码器每个线程一个(WIC需要按线程初始化COM)；创建失败时该线程领取的纹理都按失败处理
+		std::unique_ptr<ImageDecoder> Decoder;
+		try {
+			Decoder = std::make_unique<ImageDecoder>();
+		}
+		catch (const std::exception& e) {
+			std::cerr << e.what() << "\n";
+		}
+
+		while (true) {
+			std::pair<TextureHandle, std::filesystem::path> Task;
+			{
+				std::unique_lock<std::mutex> Lock(m_TaskMutex);
+				m_TaskCondition.wait(Lock, [this]() { return m_IsStopping || !m_Tasks.empty(); });
+				if (m_IsStopping)
+					return;
+				Task = std::move(m_Tasks.front());
+				m_Tasks.pop_front();
+			}
+			DecodedTexture Result;
+			Result.m_Handle = Task.first;
+			try {
+				std::filesystem::path Path = Task.second;
+				if (!Ktx2File::isKtx2(Path)) {
+					if (!Decoder)
+						throw std::runtime_error("Image decoder is not available!");
+					if (!m_CacheDirectory.empty())
+						Path = TextureImporter::import(Path, *Decoder, m_CacheDirectory);  // 缓存命中时不解码
+				}
+				bool IsWritten = Ktx2File::isKtx2(Path) ? copyKtx2(Path, Result) : decodeImage(*Decoder, Path, Result);
+				if (!IsWritten)
+					return;
+			}
+			catch (const std::exception& e) {
+				std::cerr << std::format(R"(Fail to load texture "{0}": {1})", Task.second.string(), e.what()) << "\n";
+			}
+			{
+				std::lock_guard<std::mutex> Lock(m_TaskMutex);
+				m_DecodedTextures.emplace_back(std::move(Result));
+			}
+			m_DecodedCondition.notify_one();
+		}
+	}
+
+	bool TextureLoader::decodeImage(ImageDecoder& vDecoder, const std::filesystem::path& vPath, DecodedTexture& vResult)
+	{
+		ImageExtent Extent = vDecoder.open(vPath);
+		std::optional<uint64_t> Begin = allocateStaging(Extent.getRgbaSize());
+		if (!Begin.has_value())
+			return false;
+		try {
+			vDecoder.decode(getStagingData(*Begin));
+		}
+		catch (...) {
+			releaseStaging(*Begin);
+			throw;
+		}
+		vResult.m_IsLoaded = true;
+		vResult.m_Extent = { Extent.m_Width, Extent.m_Height };
+		vResult.m_StagingBegin = *Begin;
+		vResult.m_StagingSize = Extent.getRgbaSize();
+		VkBufferImageCopy Region{};
+		Region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		Region.imageExtent = { Extent.m_Width, Extent.m_Height, 1 };
+		vResult.m_Regions.push_back(Region);
+		return true;
+	}
+
+	bool TextureLoader::copyKtx2(const std::filesystem::path& vPath, DecodedTexture& vResult)
+	{
+		// 各级mip在文件中连续存放且已按纹素块对齐，整段一次memcpy，区域偏移直接取自文件中的相对位置
+		Ktx2File File(vPath);
+		// 设备不支持的格式在这里就按失败处理，不占用staging，也不会在主线程创建图像时出错
+		constexpr VkFormatFeatureFlags RequiredFeatures = VK_FORMAT_FEATURE_SAMPLED_IMAGE_BIT | VK_FORMAT_FEATURE_SAMPLED_IMAGE_FILTER_LINEAR_BIT | VK_FORMAT_FEATURE_TRANSFER_DST_BIT;
+		VkFormatProperties FormatProperties{};
+		vkGetPhysicalDeviceFormatProperties(m_PhysicalDevice, File.getFormat(), &FormatProperties);
+		if ((FormatProperties.optimalTilingFeatures & RequiredFeatures) != RequiredFeatures)
+			throw std::runtime_error(std::format("Format {0} is not supported for sampled textures!", static_cast<uint32_t>(File.getFormat())));
+		std::span<const std::byte> Data = File.getLevelRange();
+		std::optional<uint64_t> Begin = allocateStaging(Data.size());
+		if (!Begin.has_value())
+			return false;
+		std::memcpy(getStagingData(*Begin), Data.data(), Data.size());
+		vResult.m_IsLoaded = true;
+		vResult.m_Format = File.getFormat();
+		vResult.m_Extent = File.getExtent();
+		vResult.m_MipLevelCount = File.getLevelCount();
+		vResult.m_StagingBegin = *Begin;
+		vResult.m_StagingSize = Data.size();
+		for (uint32_t i = 0; i < File.getLevelCount(); ++i) {
+			VkExtent2D Extent = File.getLevelExtent(i);
+			VkBufferImageCopy Region{};
+			Region.bufferOffset = File.getOffsetInLevelRange(i);
+			Region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, i, 0, 1 };
+			Region.imageExtent = { Extent.width, Extent.height, 1 };
+			vResult.m_Regions.push_back(Region);
+		}
+		return true;
+	}
+
+	std::optional<uint64_t> TextureLoader::allocateStaging(VkDeviceSize vSize)
+	{
+		VkDeviceSize Size = (vSize + StagingAlignment - 1) / StagingAlignment * StagingAlignment;
+		if (Size > m_StagingSize)
+			throw std::runtime_error(std::format("Texture of {0} bytes does not fit in the staging ring!", vSize));
+
+		std::unique_lock<std::mutex> Lock(m_StagingMutex);
+		uint64_t Begin = 0;
+		m_StagingCondition.wait(Lock, [&]() {
+			if (m_IsStopping)
+				return true;
+			// 一段不跨越缓冲末尾，放不下时跳到下一圈开头，跳过的部分随前一段一起回收
+			Begin = m_StagingHead;
+			uint64_t Offset = Begin % m_StagingSize;
+			if (Offset + Size > m_StagingSize)
+				Begin += m_StagingSize - Offset;
+			return m_StagingRanges.empty() || Begin + Size - m_StagingTail <= m_StagingSize;  // 环为空时跳过的部分也不含有效数据
+			});
+		if (m_IsStopping)
+			return std::nullopt;
+		m_StagingRanges.push_back({ Begin, Begin + Size, false });
+		m_StagingHead = Begin + Size;
+		return Begin;
+	}
+
+	void TextureLoader::releaseStaging(uint64_t vBegin)
+	{
+		{
+			std::lock_guard<std::mutex> Lock(m_StagingMutex);
+			auto It = std::find_if(m_StagingRanges.begin(), m_StagingRanges.end(), [vBegin](const StagingRange& vRange) { return vRange.m_Begin == vBegin; });
+			if (It != m_StagingRanges.end())
+				It->m_IsReleased = true;
+			// 解码完成的顺序与分配顺序不同，尾部只能越过连续的已释放段
+			while (!m_StagingRanges.empty() && m_StagingRanges.front().m_IsReleased)
+				m_StagingRanges.pop_front();
+			m_StagingTail = m_StagingRanges.empty() ? m_StagingHead : m_StagingRanges.front().m_Begin;
+		}
+		m_StagingCondition.notify_all();
+	}
+
+	void TextureLoader::createImage(Texture& vTexture, const DecodedTexture& vDecoded)
+	{
+		VkImageCreateInfo ImageCreateInfo{};
+		ImageCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_CREATE_INFO;
+		ImageCreateInfo.imageType = VK_IMAGE_TYPE_2D;
+		ImageCreateInfo.format = vDecoded.m_Format;
+		ImageCreateInfo.extent = { vDecoded.m_Extent.width, vDecoded.m_Extent.height, 1 };
+		ImageCreateInfo.mipLevels = vDecoded.m_MipLevelCount;
+		ImageCreateInfo.arrayLayers = 1;
+		ImageCreateInfo.samples = VK_SAMPLE_COUNT_1_BIT;
+		ImageCreateInfo.tiling = VK_IMAGE_TILING_OPTIMAL;
+		ImageCreateInfo.usage = VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT;
+		ImageCreateInfo.sharingMode = VK_SHARING_MODE_EXCLUSIVE;
+		ImageCreateInfo.initialLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+		if (vkCreateImage(m_Device, &ImageCreateInfo, nullptr, &vTexture.m_Image) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create texture image!");
+
+		VkMemoryRequirements MemoryRequirements;
+		vkGetImageMemoryRequirements(m_Device, vTexture.m_Image, &MemoryRequirements);
+		VkMemoryAllocateInfo MemoryAllocateInfo{};
+		MemoryAllocateInfo.sType = VK_STRUCTURE_TYPE_MEMORY_ALLOCATE_INFO;
+		MemoryAllocateInfo.allocationSize = MemoryRequirements.size;
+		MemoryAllocateInfo.memoryTypeIndex = findMemoryType(m_PhysicalDevice, MemoryRequirements.memoryTypeBits, VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT);
+		if (vkAllocateMemory(m_Device, &MemoryAllocateInfo, nullptr, &vTexture.m_Memory) != VK_SUCCESS) {
+			destroyImage(vTexture);
+			throw std::runtime_error("Failed to allocate texture image memory!");
+		}
+		vkBindImageMemory(m_Device, vTexture.m_Image, vTexture.m_Memory, 0);
+
+		VkImageViewCreateInfo ImageViewCreateInfo{};
+		ImageViewCreateInfo.sType = VK_STRUCTURE_TYPE_IMAGE_VIEW_CREATE_INFO;
+		ImageViewCreateInfo.image = vTexture.m_Image;
+		ImageViewCreateInfo.viewType = VK_IMAGE_VIEW_TYPE_2D;
+		ImageViewCreateInfo.format = vDecoded.m_Format;
+		ImageViewCreateInfo.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, vDecoded.m_MipLevelCount, 0, 1 };
+		if (vkCreateImageView(m_Device, &ImageViewCreateInfo, nullptr, &vTexture.m_ImageView) != VK_SUCCESS) {
+			destroyImage(vTexture);
+			throw std::runtime_error("Failed to create texture image view!");
+		}
+	}
+
+	void TextureLoader::destroyImage(Texture& vTexture)
+	{
+		if (vTexture.m_ImageView != VK_NULL_HANDLE)
+			vkDestroyImageView(m_Device, vTexture.m_ImageView, nullptr);
+		if (vTexture.m_Image != VK_NULL_HANDLE)
+			vkDestroyImage(m_Device, vTexture.m_Image, nullptr);
+		if (vTexture.m_Memory != VK_NULL_HANDLE)
+			vkFreeMemory(m_Device, vTexture.m_Memory, nullptr);
+		vTexture.m_ImageView = VK_NULL_HANDLE;
+		vTexture.m_Image = VK_NULL_HANDLE;
+		vTexture.m_Memory = VK_NULL_HANDLE;
+	}
+
+	void TextureLoader::submitBatch(std::vector<DecodedTexture>&& vTextures)
+	{
+		// 一批纹理共用一个命令缓冲：先全部转为TRANSFER_DST，拷贝，再全部转为SHADER_READ_ONLY。
+		// 之后的图形提交在同一队列上，由屏障保证在拷贝完成后才采样
+		UploadBatch Batch;
+		Batch.m_Textures = std::move(vTextures);
+		// 单个纹理创建图像失败(显存不足等)时只让它保持占位纹理，不影响同一批的其他纹理
+		std::erase_if(Batch.m_Textures, [this](const DecodedTexture& vDecoded) {
+			Texture& Item = getTexture(vDecoded.m_Handle);
+			try {
+				createImage(Item, vDecoded);
+				return false;
+			}
+			catch (const std::exception& e) {
+				destroyImage(Item);
+				if (vDecoded.m_Handle == PlaceholderHandle)
+					throw;
+				std::cerr << std::format(R"(Fail to load texture "{0}": {1})", Item.m_Path.string(), e.what()) << "\n";
+				releaseStaging(vDecoded.m_StagingBegin);
+				failTexture(vDecoded.m_Handle);
+				return true;
+			}
+			});
+		if (Batch.m_Textures.empty())
+			return;
+
+		std::vector<VkImageMemoryBarrier> Barriers;
+		for (const DecodedTexture& Decoded : Batch.m_Textures) {
+			Texture& Item = getTexture(Decoded.m_Handle);
+			Item.m_State = TextureState::Uploading;
+			VkImageMemoryBarrier Barrier{};
+			Barrier.sType = VK_STRUCTURE_TYPE_IMAGE_MEMORY_BARRIER;
+			Barrier.srcAccessMask = 0;
+			Barrier.dstAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			Barrier.oldLayout = VK_IMAGE_LAYOUT_UNDEFINED;
+			Barrier.newLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			Barrier.srcQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barrier.dstQueueFamilyIndex = VK_QUEUE_FAMILY_IGNORED;
+			Barrier.image = Item.m_Image;
+			Barrier.subresourceRange = { VK_IMAGE_ASPECT_COLOR_BIT, 0, Decoded.m_MipLevelCount, 0, 1 };
+			Barriers.push_back(Barrier);
+		}
+
+		VkCommandBufferAllocateInfo CommandBufferAllocateInfo{};
+		CommandBufferAllocateInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO;
+		CommandBufferAllocateInfo.level = VK_COMMAND_BUFFER_LEVEL_PRIMARY;
+		CommandBufferAllocateInfo.commandPool = m_CommandPool;
+		CommandBufferAllocateInfo.commandBufferCount = 1;
+		if (vkAllocateCommandBuffers(m_Device, &CommandBufferAllocateInfo, &Batch.m_CommandBuffer) != VK_SUCCESS)
+			throw std::runtime_error("Failed to allocate texture upload command buffer!");
+		VkCommandBufferBeginInfo CommandBufferBeginInfo{};
+		CommandBufferBeginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
+		CommandBufferBeginInfo.flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT;
+		vkBeginCommandBuffer(Batch.m_CommandBuffer, &CommandBufferBeginInfo);
+		vkCmdPipelineBarrier(Batch.m_CommandBuffer, VK_PIPELINE_STAGE_TOP_OF_PIPE_BIT, VK_PIPELINE_STAGE_TRANSFER_BIT, 0,
+			0, nullptr, 0, nullptr, static_cast<uint32_t>(Barriers.size()), Barriers.data());
+		std::vector<VkBufferImageCopy> Regions;
+		for (const DecodedTexture& Decoded : Batch.m_Textures) {
+			Regions.assign(Decoded.m_Regions.begin(), Decoded.m_Regions.end());
+			for (VkBufferImageCopy& Region : Regions)
+				Region.bufferOffset += Decoded.m_StagingBegin % m_StagingSize;
+			vkCmdCopyBufferToImage(Batch.m_CommandBuffer, m_StagingBuffer, getTexture(Decoded.m_Handle).m_Image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+				static_cast<uint32_t>(Regions.size()), Regions.data());
+		}
+		for (VkImageMemoryBarrier& Barrier : Barriers) {
+			Barrier.srcAccessMask = VK_ACCESS_TRANSFER_WRITE_BIT;
+			Barrier.dstAccessMask = VK_ACCESS_SHADER_READ_BIT;
+			Barrier.oldLayout = VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL;
+			Barrier.newLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+		}
+		vkCmdPipelineBarrier(Batch.m_CommandBuffer, VK_PIPELINE_STAGE_TRANSFER_BIT, VK_PIPELINE_STAGE_FRAGMENT_SHADER_BIT | VK_PIPELINE_STAGE_COMPUTE_SHADER_BIT, 0,
+			0, nullptr, 0, nullptr, static_cast<uint32_t>(Barriers.size()), Barriers.data());
+		vkEndCommandBuffer(Batch.m_CommandBuffer);
+
+		VkFenceCreateInfo FenceCreateInfo{};
+		FenceCreateInfo.sType = VK_STRUCTURE_TYPE_FENCE_CREATE_INFO;
+		if (vkCreateFence(m_Device, &FenceCreateInfo, nullptr, &Batch.m_Fence) != VK_SUCCESS)
+			throw std::runtime_error("Failed to create texture upload fence!");
+		VkSubmitInfo SubmitInfo{};
+		SubmitInfo.sType = VK_STRUCTURE_TYPE_SUBMIT_INFO;
+		SubmitInfo.commandBufferCount = 1;
+		SubmitInfo.pCommandBuffers = &Batch.m_CommandBuffer;
+		if (vkQueueSubmit(m_Queue, 1, &SubmitInfo, Batch.m_Fence) != VK_SUCCESS)
+			throw std::runtime_error("Failed to submit texture upload command buffer!");
+		m_Batches.emplace_back(std::move(Batch));
+	}
+
+	void TextureLoader::failTexture(TextureHandle vHandle)
+	{
+		Texture& Item = m_Textures[vHandle];
+		Item.m_State = TextureState::Failed;  // 保持占位纹理
+		--m_PendingCount;
+		if (Item.m_Callback)
+			Item.m_Callback(vHandle, false);
+	}
+
+	void TextureLoader::finishBatch(UploadBatch& vBatch)
+	{
+		for (const DecodedTexture& Decoded : vBatch.m_Textures) {
+			releaseStaging(Decoded.m_StagingBegin);
+			Texture& Item = getTexture(Decoded.m_Handle);
+			if (m_BindlessTable->isEnabled())
+				Item.m_BindlessIndex = m_BindlessTable->addTexture(Item.m_ImageView, m_Sampler);  // 新槽位，不影响仍在执行的命令
+			Item.m_State = TextureState::Ready;
+			if (Decoded.m_Handle == PlaceholderHandle)
+				continue;
+			m_LoadedBytes += Decoded.m_StagingSize;
+			++m_LoadedCount;
+			--m_PendingCount;
+			if (Item.m_Callback)
+				Item.m_Callback(Decoded.m_Handle, true);
+		}
+		vkFreeCommandBuffers(m_Device, m_CommandPool, 1, &vBatch.m_CommandBuffer);
+		vkDestroyFence(m_Device, vBatch.m_Fence, nullptr);
+	}
+
+	void TextureLoader::createPlaceholder()
+	{
+		// 1x1中性灰：纹理就绪前采样到的颜色，替换时不会有明显的闪烁
+		DecodedTexture Placeholder;
+		Placeholder.m_Handle = PlaceholderHandle;
+		Placeholder.m_IsLoaded = true;
+		Placeholder.m_Extent = { 1, 1 };
+		Placeholder.m_StagingBegin = allocateStaging(4).value();
+		Placeholder.m_StagingSize = 4;
+		const uint8_t Gray[4] = { 128, 128, 128, 255 };
+		std::memcpy(getStagingData(Placeholder.m_StagingBegin), Gray, sizeof(Gray));
+		VkBufferImageCopy Region{};
+		Region.imageSubresource = { VK_IMAGE_ASPECT_COLOR_BIT, 0, 0, 1 };
+		Region.imageExtent = { 1, 1, 1 };
+		Placeholder.m_Regions.push_back(Region);
+
+		std::vector<DecodedTexture> Textures;
+		Textures.emplace_back(std::move(Placeholder));
+		submitBatch(std::move(Textures));
+		vkWaitForFences(m_Device, 1, &m_Batches.back().m_Fence, VK_TRUE, UINT64_MAX);
+		finishBatch(m_Batches.back());
+		m_Batches.pop_back();
+	}
+
+}
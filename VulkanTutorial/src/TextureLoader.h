@@ -0,0 +1,159 @@
+#pragma once
+#include "BindlessTable.h"
+#include "ParallelFor.h"
+#include "TextureImporter.h"
+#include "Timer.h"
+
+#include <vulkan/vulkan.h>
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	using TextureHandle = uint32_t;
+
+	// 异步纹理加载：工作线程把纹理写入常驻映射的staging环形缓冲；主线程在update()中把已写入的纹理
+	// 合并成一次上传提交，fence完成后把纹理加入bindless表并调用完成回调。纹理就绪前getBindlessIndex()返回
+	// 占位纹理的槽位，shader不需要区分。环形缓冲空间不足时工作线程阻塞，直到主线程回收已完成的上传。
+	// 图片先经TextureImporter转换为带完整mip链的KTX2缓存，之后每次加载都只是把映射的KTX2整段memcpy进staging环，
+	// 所有mip用一次多区域拷贝上传；不使用缓存时直接解码进staging环，只有一级mip
+	class TextureLoader
+	{
+	public:
+		using Callback = std::function<void(TextureHandle vHandle, bool vIsLoaded)>;  // 在主线程的update()中调用
+
+		TextureLoader() = default;
+		~TextureLoader();
+
+		TextureLoader(const TextureLoader&) = delete;
+		TextureLoader& operator=(const TextureLoader&) = delete;
+
+		// vQueue须属于vQueueFamily，只在调用update()的线程上提交；staging环须放得下最大的一个纹理(4K RGBA8带mip约85MB)
+		void create(VkPhysicalDevice vPhysicalDevice, VkDevice vDevice, uint32_t vQueueFamily, VkQueue vQueue, BindlessTable& vBindlessTable,
+			VkDeviceSize vStagingSize = 128ull << 20, unsigned vWorkerCount = getWorkerCount(),
+			const std::filesystem::path& vCacheDirectory = TextureImporter::DefaultCacheDirectory);  // vCacheDirectory为空时不导入
+		void destroy();  // 调用前设备必须空闲
+
+		TextureHandle load(const std::filesystem::path& vPath, Callback vCallback = {});
+		void update();   // 每帧调用：回收完成的上传并调用回调，提交新解码完成的纹理
+		void wait();     // 阻塞直到所有已请求的纹理都加载完成或失败
+
+		inline bool isReady(TextureHandle vHandle) const { return m_Textures[vHandle].m_State == TextureState::Ready; }
+		inline uint32_t getBindlessIndex(TextureHandle vHandle) const { return getResident(vHandle).m_BindlessIndex; }  // 未就绪时为占位纹理
+		inline uint32_t getPlaceholderBindlessIndex() const { return m_Placeholder.m_BindlessIndex; }  // 占位纹理上传完成前为BindlessTable::InvalidIndex
+		inline VkImageView getImageView(TextureHandle vHandle) const { return getResident(vHandle).m_ImageView; }
+		inline VkSampler getSampler() const { return m_Sampler; }
+		inline size_t getPendingCount() const { return m_PendingCount; }
+
+		static bool isSupported(const std::filesystem::path& vPath);   // 按扩展名判断，包括.ktx2
+	private:
+		enum class TextureState
+		{
+			Decoding,
+			Uploading,
+			Ready,
+			Failed
+		};
+
+		struct Texture
+		{
+			std::filesystem::path m_Path;
+			Callback m_Callback;
+			TextureState m_State = TextureState::Decoding;
+			VkImage m_Image = VK_NULL_HANDLE;
+			VkDeviceMemory m_Memory = VK_NULL_HANDLE;
+			VkImageView m_ImageView = VK_NULL_HANDLE;
+			uint32_t m_BindlessIndex = BindlessTable::InvalidIndex;
+		};
+
+		// 已写入staging环的一个纹理，m_Regions中的bufferOffset相对于m_StagingBegin
+		struct DecodedTexture
+		{
+			TextureHandle m_Handle = 0;
+			bool m_IsLoaded = false;
+			VkFormat m_Format = VK_FORMAT_R8G8B8A8_SRGB;
+			VkExtent2D m_Extent{};
+			uint32_t m_MipLevelCount = 1;
+			uint64_t m_StagingBegin = 0;
+			VkDeviceSize m_StagingSize = 0;
+			std::vector<VkBufferImageCopy> m_Regions;
+		};
+
+		struct UploadBatch
+		{
+			VkCommandBuffer m_CommandBuffer = VK_NULL_HANDLE;
+			VkFence m_Fence = VK_NULL_HANDLE;
+			std::vector<DecodedTexture> m_Textures;
+		};
+
+		// staging环中的一段，位置单调递增，对环大小取模后才是缓冲内偏移
+		struct StagingRange
+		{
+			uint64_t m_Begin = 0;
+			uint64_t m_End = 0;
+			bool m_IsReleased = false;
+		};
+
+		static constexpr TextureHandle PlaceholderHandle = UINT32_MAX;
+
+		void runWorker();
+		bool decodeImage(ImageDecoder& vDecoder, const std::filesystem::path& vPath, DecodedTexture& vResult);  // 正在停止时返回false
+		bool copyKtx2(const std::filesystem::path& vPath, DecodedTexture& vResult);
+		std::optional<uint64_t> allocateStaging(VkDeviceSize vSize);   // 空间不足时阻塞，正在停止时返回空
+		void releaseStaging(uint64_t vBegin);
+		inline std::byte* getStagingData(uint64_t vBegin) const { return m_StagingData + vBegin % m_StagingSize; }
+
+		Texture& getTexture(TextureHandle vHandle) { return vHandle == PlaceholderHandle ? m_Placeholder : m_Textures[vHandle]; }
+		const Texture& getResident(TextureHandle vHandle) const { return m_Textures[vHandle].m_State == TextureState::Ready ? m_Textures[vHandle] : m_Placeholder; }
+		void createImage(Texture& vTexture, const DecodedTexture& vDecoded);
+		void destroyImage(Texture& vTexture);
+		void submitBatch(std::vector<DecodedTexture>&& vTextures);
+		void failTexture(TextureHandle vHandle);
+		void finishBatch(UploadBatch& vBatch);
+		void createPlaceholder();
+	private:
+		VkPhysicalDevice m_PhysicalDevice = VK_NULL_HANDLE;
+		VkDevice m_Device = VK_NULL_HANDLE;
+		VkQueue m_Queue = VK_NULL_HANDLE;
+		BindlessTable* m_BindlessTable = nullptr;
+		VkCommandPool m_CommandPool = VK_NULL_HANDLE;
+		VkSampler m_Sampler = VK_NULL_HANDLE;
+
+		std::vector<Texture> m_Textures;   // 只在主线程访问
+		Texture m_Placeholder;
+		std::deque<UploadBatch> m_Batches; // 按提交顺序，同一队列上也按此顺序完成
+		size_t m_PendingCount = 0;
+		size_t m_LoadedCount = 0;
+		uint64_t m_LoadedBytes = 0;
+		Timer m_LoadTimer;                 // 从没有待加载纹理时的第一次load()开始计时
+		std::filesystem::path m_CacheDirectory;
+
+		VkBuffer m_StagingBuffer = VK_NULL_HANDLE;
+		VkDeviceMemory m_StagingMemory = VK_NULL_HANDLE;
+		std::byte* m_StagingData = nullptr;
+		VkDeviceSize m_StagingSize = 0;
+		std::mutex m_StagingMutex;
+		std::condition_variable m_StagingCondition;
+		std::deque<StagingRange> m_StagingRanges;
+		uint64_t m_StagingHead = 0;
+		uint64_t m_StagingTail = 0;
+
+		std::vector<std::thread> m_Workers;
+		std::mutex m_TaskMutex;
+		std::condition_variable m_TaskCondition;
+		std::condition_variable m_DecodedCondition;
+		std::deque<std::pair<TextureHandle, std::filesystem::path>> m_Tasks;
+		std::vector<DecodedTexture> m_DecodedTextures;  // 工作线程已完成、等待主线程上传
+		bool m_IsStopping = false;
+	};
+
+}
@@ -1,5 +1,6 @@
 #pragma once
 #include <chrono>
+#include <cstddef>
 
 namespace VulkanTutorial {
 
@@ -8,10 +9,16 @@ namespace VulkanTutorial {
 	public:
 		Timer();
 		inline void reset() { m_StartTimePoint = std::chrono::high_resolution_clock::now(); }
-		inline float ellapseSeconds() { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - m_StartTimePoint).count() * 0.001f * 0.001f * 0.001f; }
-		inline float ellapseMilliseconds() { return ellapseSeconds() * 1000.0f; }
+		inline float ellapseSeconds() const { return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::high_resolution_clock::now() - m_StartTimePoint).count() * 0.001f * 0.001f * 0.001f; }
+		inline float ellapseMilliseconds() const { return ellapseSeconds() * 1000.0f; }
 	private:
 		std::chrono::time_point<std::chrono::high_resolution_clock> m_StartTimePoint;
 	};
 
+	// vMilliseconds内处理vBytes字节的吞吐量，MB按1024 * 1024字节计
+	inline double computeMegabytesPerSecond(size_t vBytes, float vMilliseconds)
+	{
+		return vMilliseconds > 0.0f ? static_cast<double>(vBytes) / (1024.0 * 1024.0) / (vMilliseconds * 0.001) : 0.0;
+	}
+
 }
@@ -0,0 +1,112 @@
+#include "VertexDeduplicator.h"
+#include "Hash.h"
+#include "ParallelFor.h"
+
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t EmptySlot = UINT32_MAX;
+		constexpr size_t ParallelThreshold = 1 << 18;  // 顶点较少时线程开销超过收益
+		constexpr unsigned ShardBits = 6;
+
+		// 负载因子不超过0.5，线性探测的平均探测长度很短
+		inline size_t getTableCapacity(size_t vCount)
+		{
+			return std::bit_ceil(std::max<size_t>(16, vCount * 2));
+		}
+
+		// 在表中查找与vIndex字节相同的顶点，找不到时插入vIndex，返回表中已有(或刚插入)的顶点编号
+		inline uint32_t findOrInsert(std::vector<uint32_t>& vTable, uint64_t vHash, uint32_t vIndex,
+			const unsigned char* vVertices, size_t vStride, const uint64_t* vHashes)
+		{
+			const size_t Mask = vTable.size() - 1;
+			const unsigned char* Vertex = vVertices + vIndex * vStride;
+			for (size_t Slot = vHash & Mask;; Slot = (Slot + 1) & Mask) {
+				uint32_t Existing = vTable[Slot];
+				if (Existing == EmptySlot) {
+					vTable[Slot] = vIndex;
+					return vIndex;
+				}
+				if ((vHashes == nullptr || vHashes[Existing] == vHash) && std::memcmp(vVertices + Existing * vStride, Vertex, vStride) == 0)
+					return Existing;
+			}
+		}
+
+	}
+
+	size_t VertexDeduplicator::generateRemap(std::span<uint32_t> vRemap, const void* vVertices, size_t vCount, size_t vStride)
+	{
+		if (vRemap.size() < vCount || vCount >= EmptySlot)
+			throw std::runtime_error("Invalid vertex remap size!");
+		const unsigned char* Vertices = static_cast<const unsigned char*>(vVertices);
+		std::vector<uint32_t> Table(getTableCapacity(vCount), EmptySlot);
+		size_t UniqueCount = 0;
+		for (size_t i = 0; i < vCount; ++i) {
+			uint64_t Hash = hashBytes(Vertices + i * vStride, vStride);
+			uint32_t First = findOrInsert(Table, Hash, static_cast<uint32_t>(i), Vertices, vStride, nullptr);
+			vRemap[i] = First == i ? static_cast<uint32_t>(UniqueCount++) : vRemap[First];
+		}
+		return UniqueCount;
+	}
+
+	size_t VertexDeduplicator::generateRemapParallel(std::span<uint32_t> vRemap, const void* vVertices, size_t vCount, size_t vStride)
+	{
+		if (vRemap.size() < vCount || vCount >= EmptySlot)
+			throw std::runtime_error("Invalid vertex remap size!");
+		const unsigned char* Vertices = static_cast<const unsigned char*>(vVertices);
+		constexpr size_t ShardCount = size_t(1) << ShardBits;
+		constexpr size_t BlockSize = 1 << 16;
+
+		// 1. 并行计算哈希
+		std::vector<uint64_t> Hashes(vCount);
+		parallelFor((vCount + BlockSize - 1) / BlockSize, [&](size_t vBlock) {
+			size_t End = std::min(vCount, (vBlock + 1) * BlockSize);
+			for (size_t i = vBlock * BlockSize; i < End; ++i)
+				Hashes[i] = hashBytes(Vertices + i * vStride, vStride);
+			});
+
+		// 2. 计数排序按哈希高位分片，分片内保持原始顺序
+		std::vector<size_t> ShardOffsets(ShardCount + 1, 0);
+		for (uint64_t Hash : Hashes)
+			++ShardOffsets[(Hash >> (64 - ShardBits)) + 1];
+		for (size_t s = 0; s < ShardCount; ++s)
+			ShardOffsets[s + 1] += ShardOffsets[s];
+		std::vector<uint32_t> ShardVertices(vCount);
+		{
+			std::vector<size_t> Cursors(ShardOffsets.begin(), ShardOffsets.end() - 1);
+			for (size_t i = 0; i < vCount; ++i)
+				ShardVertices[Cursors[Hashes[i] >> (64 - ShardBits)]++] = static_cast<uint32_t>(i);
+		}
+
+		// 3. 各分片独立去重，记录每个顶点首次出现的位置；相同的顶点哈希相同，必然落在同一分片
+		std::vector<uint32_t> FirstOccurrence(vCount);
+		parallelFor(ShardCount, [&](size_t vShard) {
+			size_t Begin = ShardOffsets[vShard], End = ShardOffsets[vShard + 1];
+			std::vector<uint32_t> Table(getTableCapacity(End - Begin), EmptySlot);
+			for (size_t k = Begin; k < End; ++k) {
+				uint32_t Index = ShardVertices[k];
+				// 表中用哈希的低位定位，高位已用于分片
+				FirstOccurrence[Index] = findOrInsert(Table, Hashes[Index], Index, Vertices, vStride, Hashes.data());
+			}
+			});
+
+		// 4. 按原始顺序编号，保证与单线程版本结果一致
+		size_t UniqueCount = 0;
+		for (size_t i = 0; i < vCount; ++i)
+			vRemap[i] = FirstOccurrence[i] == i ? static_cast<uint32_t>(UniqueCount++) : vRemap[FirstOccurrence[i]];
+		return UniqueCount;
+	}
+
+	size_t VertexDeduplicator::generateRemapAuto(std::span<uint32_t> vRemap, const void* vVertices, size_t vCount, size_t vStride)
+	{
+		if (vCount >= ParallelThreshold && getWorkerCount() > 1)
+			return generateRemapParallel(vRemap, vVertices, vCount, vStride);
+		return generateRemap(vRemap, vVertices, vCount, vStride);
+	}
+
+}
@@ -0,0 +1,30 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	// 按顶点的原始字节去重：64位xxHash + 开放寻址(线性探测)哈希表，每个输入顶点只查找一次。
+	// 输出remap表，vRemap[i]为第i个输入顶点去重后的编号，编号按首次出现的顺序分配。
+	// 顶点结构体中不能有未初始化的填充字节
+	class VertexDeduplicator
+	{
+	public:
+		static size_t generateRemap(std::span<uint32_t> vRemap, const void* vVertices, size_t vCount, size_t vStride);
+		// 分片并行版本：按哈希高位把顶点分到各分片，分片内独立去重，结果与单线程版本完全相同
+		static size_t generateRemapParallel(std::span<uint32_t> vRemap, const void* vVertices, size_t vCount, size_t vStride);
+		static size_t generateRemapAuto(std::span<uint32_t> vRemap, const void* vVertices, size_t vCount, size_t vStride);  // 顶点足够多时才并行
+
+		template<typename T>
+		static std::vector<T> remapVertices(std::span<const T> vVertices, std::span<const uint32_t> vRemap, size_t vUniqueCount)
+		{
+			std::vector<T> Result(vUniqueCount);
+			for (size_t i = 0; i < vVertices.size(); ++i)
+				Result[vRemap[i]] = vVertices[i];
+			return Result;
+		}
+	};
+
+}
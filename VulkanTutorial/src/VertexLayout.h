@@ -0,0 +1,137 @@
+#pragma once
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+namespace VulkanTutorial {
+
+	template<typename... Ts>
+	struct TypeList {};
+
+	// 归一化整数向量，顶点获取时由硬件转换为float：SNORM到[-1, 1]，UNORM到[0, 1]
+	struct Snorm16x4 { int16_t m_Values[4]; };
+	struct Snorm16x2 { int16_t m_Values[2]; };
+	struct Unorm16x2 { uint16_t m_Values[2]; };
+	struct Unorm8x4 { uint8_t m_Values[4]; };
+
+	namespace Detail {
+
+		// 可以转换为任意成员类型的占位符，只出现在不求值的上下文中
+		struct AnyField
+		{
+			template<typename T>
+			constexpr operator T&() const noexcept;
+		};
+
+		// 聚合体的成员个数：不断追加初始化项，直到聚合初始化不再合法
+		template<typename T, typename... Fields>
+		constexpr size_t countFields()
+		{
+			if constexpr (requires { T{ Fields{}..., AnyField{} }; })
+				return countFields<T, Fields..., AnyField>();
+			else
+				return sizeof...(Fields);
+		}
+
+		// 用结构化绑定取出成员类型，只用于decltype，从不真正调用
+		template<typename T>
+		auto getFieldTypes()
+		{
+			constexpr size_t Count = countFields<T>();
+			static_assert(Count >= 1 && Count <= 8, "Vertex stream must have 1 to 8 members");
+			T* Value = nullptr;
+			if constexpr (Count == 1) { auto& [A] = *Value; return TypeList<decltype(A)>{}; }
+			else if constexpr (Count == 2) { auto& [A, B] = *Value; return TypeList<decltype(A), decltype(B)>{}; }
+			else if constexpr (Count == 3) { auto& [A, B, C] = *Value; return TypeList<decltype(A), decltype(B), decltype(C)>{}; }
+			else if constexpr (Count == 4) { auto& [A, B, C, D] = *Value; return TypeList<decltype(A), decltype(B), decltype(C), decltype(D)>{}; }
+			else if constexpr (Count == 5) { auto& [A, B, C, D, E] = *Value; return TypeList<decltype(A), decltype(B), decltype(C), decltype(D), decltype(E)>{}; }
+			else if constexpr (Count == 6) { auto& [A, B, C, D, E, F] = *Value; return TypeList<decltype(A), decltype(B), decltype(C), decltype(D), decltype(E), decltype(F)>{}; }
+			else if constexpr (Count == 7) { auto& [A, B, C, D, E, F, G] = *Value; return TypeList<decltype(A), decltype(B), decltype(C), decltype(D), decltype(E), decltype(F), decltype(G)>{}; }
+			else { auto& [A, B, C, D, E, F, G, H] = *Value; return TypeList<decltype(A), decltype(B), decltype(C), decltype(D), decltype(E), decltype(F), decltype(G), decltype(H)>{}; }
+		}
+
+		template<typename T> constexpr VkFormat VertexFormat = VK_FORMAT_UNDEFINED;
+		template<> constexpr VkFormat VertexFormat<float> = VK_FORMAT_R32_SFLOAT;
+		template<> constexpr VkFormat VertexFormat<glm::vec2> = VK_FORMAT_R32G32_SFLOAT;
+		template<> constexpr VkFormat VertexFormat<glm::vec3> = VK_FORMAT_R32G32B32_SFLOAT;
+		template<> constexpr VkFormat VertexFormat<glm::vec4> = VK_FORMAT_R32G32B32A32_SFLOAT;
+		template<> constexpr VkFormat VertexFormat<uint32_t> = VK_FORMAT_R32_UINT;
+		template<> constexpr VkFormat VertexFormat<Snorm16x4> = VK_FORMAT_R16G16B16A16_SNORM;
+		template<> constexpr VkFormat VertexFormat<Snorm16x2> = VK_FORMAT_R16G16_SNORM;
+		template<> constexpr VkFormat VertexFormat<Unorm16x2> = VK_FORMAT_R16G16_UNORM;
+		template<> constexpr VkFormat VertexFormat<Unorm8x4> = VK_FORMAT_R8G8B8A8_UNORM;
+
+		template<typename Stream, typename FieldTypes>
+		struct VertexStreamFields;
+
+		// 标准布局下成员按声明顺序各自对齐排列，偏移量可以只由成员类型算出
+		template<typename Stream, typename... Fields>
+		struct VertexStreamFields<Stream, TypeList<Fields...>>
+		{
+			static constexpr size_t Count = sizeof...(Fields);
+			static constexpr std::array<VkFormat, Count> Formats{ VertexFormat<Fields>... };
+
+			static constexpr std::array<size_t, Count> Sizes{ sizeof(Fields)... };
+			static constexpr std::array<uint32_t, Count> Offsets = [] {
+				constexpr std::array<size_t, Count> Alignments{ alignof(Fields)... };
+				std::array<uint32_t, Count> Result{};
+				size_t Offset = 0;
+				for (size_t i = 0; i < Count; ++i) {
+					Offset = (Offset + Alignments[i] - 1) / Alignments[i] * Alignments[i];
+					Result[i] = static_cast<uint32_t>(Offset);
+					Offset += Sizes[i];
+				}
+				return Result;
+			}();
+			static constexpr size_t Size = (Offsets[Count - 1] + Sizes[Count - 1] + alignof(Stream) - 1) / alignof(Stream) * alignof(Stream);
+
+			static_assert(((VertexFormat<Fields> != VK_FORMAT_UNDEFINED) && ...), "Vertex stream member type has no vertex format");
+			static_assert(Size == sizeof(Stream), "Vertex stream layout does not match its members");
+		};
+
+		template<typename Stream>
+		using StreamFields = VertexStreamFields<Stream, decltype(getFieldTypes<Stream>())>;
+
+	}
+
+	// 由顶点结构体在编译期生成顶点输入描述：每个结构体是一个binding(按参数顺序编号)，
+	// 每个成员是一个attribute，location在所有流之间连续编号，格式由成员类型决定。
+	// 结构体须是只含float/glm::vecN/uint32_t或上面的归一化整数向量成员的聚合体
+	template<typename... Streams>
+	class VertexStreamLayout
+	{
+		static_assert(sizeof...(Streams) > 0, "Vertex layout needs at least one stream");
+		static_assert(((std::is_aggregate_v<Streams> && std::is_standard_layout_v<Streams>) && ...), "Vertex stream must be a standard layout aggregate");
+	public:
+		static constexpr uint32_t BindingCount = sizeof...(Streams);
+		static constexpr uint32_t AttributeCount = static_cast<uint32_t>((Detail::StreamFields<Streams>::Count + ...));
+
+		static constexpr std::array<VkVertexInputBindingDescription, BindingCount> Bindings = [] {
+			std::array<VkVertexInputBindingDescription, BindingCount> Result{};
+			uint32_t Binding = 0;
+			((Result[Binding] = { Binding, static_cast<uint32_t>(sizeof(Streams)), VK_VERTEX_INPUT_RATE_VERTEX }, ++Binding), ...);
+			return Result;
+		}();
+
+		static constexpr std::array<VkVertexInputAttributeDescription, AttributeCount> Attributes = [] {
+			std::array<VkVertexInputAttributeDescription, AttributeCount> Result{};
+			uint32_t Binding = 0;
+			uint32_t Location = 0;
+			auto appendStream = [&]<typename Stream>() {
+				using Fields = Detail::StreamFields<Stream>;
+				for (size_t i = 0; i < Fields::Count; ++i, ++Location)
+					Result[Location] = { Location, Binding, Fields::Formats[i], Fields::Offsets[i] };
+				++Binding;
+			};
+			(appendStream.template operator()<Streams>(), ...);
+			return Result;
+		}();
+
+		static constexpr uint32_t getStride(uint32_t vBinding) { return Bindings[vBinding].stride; }
+	};
+
+}
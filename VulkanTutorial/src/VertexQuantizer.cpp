@@ -0,0 +1,333 @@
+#include "VertexQuantizer.h"
+#include "ParallelFor.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <format>
+#include <iostream>
+#include <limits>
+#include <stdexcept>
+
+namespace VulkanTutorial {
+
+	namespace {
+
+		constexpr uint32_t PositionLocation = 0;
+		constexpr uint32_t NormalLocation = 1;
+		constexpr uint32_t TexCoordLocation = 2;
+		constexpr uint32_t ColorLocation = 3;
+		constexpr float MinRange = 1e-8f;  // 退化的包围盒(例如平面网格的某一轴)避免除0
+		constexpr size_t BlockSize = 1 << 14;
+
+		inline int16_t encodeSnorm16(float vValue) { return static_cast<int16_t>(std::lround(std::clamp(vValue, -1.0f, 1.0f) * 32767.0f)); }
+		inline float decodeSnorm16(int16_t vValue) { return std::max(vValue / 32767.0f, -1.0f); }
+		inline uint16_t encodeUnorm16(float vValue) { return static_cast<uint16_t>(std::lround(std::clamp(vValue, 0.0f, 1.0f) * 65535.0f)); }
+		inline int8_t encodeSnorm8(float vValue) { return static_cast<int8_t>(std::lround(std::clamp(vValue, -1.0f, 1.0f) * 127.0f)); }
+		inline uint8_t encodeUnorm8(float vValue) { return static_cast<uint8_t>(std::lround(std::clamp(vValue, 0.0f, 1.0f) * 255.0f)); }
+
+		inline float signNotZero(float vValue) { return vValue >= 0.0f ? 1.0f : -1.0f; }
+
+		const VkVertexInputAttributeDescription* findAttribute(const QuantizedLayout& vLayout, uint32_t vLocation)
+		{
+			for (const auto& Attribute : vLayout.m_Attributes)
+				if (Attribute.location == vLocation)
+					return &Attribute;
+			return nullptr;
+		}
+
+		template<typename T, size_t N>
+		inline void writeComponents(std::byte* vVertex, uint32_t vOffset, const T(&vValues)[N])
+		{
+			std::memcpy(vVertex + vOffset, vValues, sizeof(vValues));
+		}
+
+		template<typename T, size_t N>
+		inline void readComponents(const std::byte* vVertex, uint32_t vOffset, T(&vValues)[N])
+		{
+			std::memcpy(vValues, vVertex + vOffset, sizeof(vValues));
+		}
+
+		// 位置相对包围盒中心和半边长归一化；vTexCoordRange为空表示纹理坐标不做范围归一化(half编码)
+		VertexDequantization getDequantization(const MeshBounds& vBounds, const TexCoordBounds* vTexCoordRange)
+		{
+			VertexDequantization Result;
+			glm::vec3 Center = vBounds.getCenter();
+			glm::vec3 HalfExtent = glm::max(vBounds.getExtent() * 0.5f, glm::vec3(MinRange));
+			Result.m_PositionScale = glm::vec4(HalfExtent.x, HalfExtent.y, HalfExtent.z, 0.0f);
+			Result.m_PositionOffset = glm::vec4(Center.x, Center.y, Center.z, 1.0f);
+			if (vTexCoordRange) {
+				bool IsEmpty = !vTexCoordRange->isValid();
+				glm::vec2 Min = IsEmpty ? glm::vec2(0.0f) : vTexCoordRange->m_Min;
+				glm::vec2 Max = IsEmpty ? glm::vec2(0.0f) : vTexCoordRange->m_Max;
+				glm::vec2 Range = glm::max(Max - Min, glm::vec2(MinRange));
+				Result.m_TexCoordScaleOffset = glm::vec4(Range.x, Range.y, Min.x, Min.y);
+			}
+			return Result;
+		}
+
+	}
+
+	VkVertexInputBindingDescription QuantizedLayout::getBindingDescription(uint32_t vBinding) const
+	{
+		VkVertexInputBindingDescription BindingDescription{};
+		BindingDescription.binding = vBinding;
+		BindingDescription.stride = m_Stride;
+		BindingDescription.inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+		return BindingDescription;
+	}
+
+	std::vector<VkVertexInputAttributeDescription> QuantizedLayout::getAttributeDescriptions(uint32_t vBinding) const
+	{
+		std::vector<VkVertexInputAttributeDescription> Result = m_Attributes;
+		for (auto& Attribute : Result)
+			Attribute.binding = vBinding;
+		return Result;
+	}
+
+	QuantizedLayout VertexQuantizer::getLayout(const QuantizationConfig& vConfig)
+	{
+		// 按location顺序排列，默认配置下与QuantizedMeshVertex一致。分量都不超过2字节，8位法线之后的16位纹理坐标仍按分量对齐
+		QuantizedLayout Layout;
+		auto addAttribute = [&Layout](uint32_t vLocation, VkFormat vFormat, uint32_t vSize) {
+			Layout.m_Attributes.push_back({ vLocation, 0, vFormat, Layout.m_Stride });
+			Layout.m_Stride += vSize;
+		};
+		// 三分量16位格式作为顶点格式的支持不普遍，用四分量，w留空
+		addAttribute(PositionLocation, vConfig.m_Position == PositionEncoding::Snorm16 ? VK_FORMAT_R16G16B16A16_SNORM : VK_FORMAT_R16G16B16A16_SFLOAT, 8);
+		if (vConfig.m_Normal == NormalEncoding::Octahedral16)
+			addAttribute(NormalLocation, VK_FORMAT_R16G16_SNORM, 4);
+		else
+			addAttribute(NormalLocation, VK_FORMAT_R8G8_SNORM, 2);
+		addAttribute(TexCoordLocation, vConfig.m_TexCoord == TexCoordEncoding::Unorm16 ? VK_FORMAT_R16G16_UNORM : VK_FORMAT_R16G16_SFLOAT, 4);
+		if (vConfig.m_HasColor)
+			addAttribute(ColorLocation, VK_FORMAT_R8G8B8A8_UNORM, 4);
+		Layout.m_Stride = (Layout.m_Stride + 3) & ~3u;
+		return Layout;
+	}
+
+	QuantizedMesh VertexQuantizer::quantize(const Mesh& vMesh, const QuantizationConfig& vConfig)
+	{
+		QuantizedMesh Result;
+		Result.m_Config = vConfig;
+		Result.m_Layout = getLayout(vConfig);
+		Result.m_Indices = vMesh.m_Indices;
+		Result.m_Lods = vMesh.m_Lods;
+		Result.m_Bounds = vMesh.m_Bounds.isValid() ? vMesh.m_Bounds : MeshBounds{ glm::vec3(0.0f), glm::vec3(0.0f) };
+
+		TexCoordBounds Range;
+		if (vConfig.m_TexCoord == TexCoordEncoding::Unorm16) {
+			for (const auto& Vertex : vMesh.m_Vertices)
+				Range.expand(Vertex.m_TexCoord);
+		}
+		Result.m_Dequantization = getDequantization(Result.m_Bounds, vConfig.m_TexCoord == TexCoordEncoding::Unorm16 ? &Range : nullptr);
+		const glm::vec3 Center(Result.m_Dequantization.m_PositionOffset);
+		const glm::vec3 HalfExtent(Result.m_Dequantization.m_PositionScale);
+
+		const uint32_t Stride = Result.m_Layout.m_Stride;
+		const uint32_t PositionOffset = findAttribute(Result.m_Layout, PositionLocation)->offset;
+		const uint32_t NormalOffset = findAttribute(Result.m_Layout, NormalLocation)->offset;
+		const uint32_t TexCoordOffset = findAttribute(Result.m_Layout, TexCoordLocation)->offset;
+		const VkVertexInputAttributeDescription* Color = findAttribute(Result.m_Layout, ColorLocation);
+		const VertexDequantization& Dequantization = Result.m_Dequantization;
+		Result.m_Vertices.resize(vMesh.m_Vertices.size() * Stride);
+		parallelFor((vMesh.m_Vertices.size() + BlockSize - 1) / BlockSize, [&](size_t vBlock) {
+			size_t End = std::min(vMesh.m_Vertices.size(), (vBlock + 1) * BlockSize);
+			for (size_t i = vBlock * BlockSize; i < End; ++i) {
+				const MeshVertex& Vertex = vMesh.m_Vertices[i];
+				std::byte* Output = Result.m_Vertices.data() + i * Stride;
+
+				glm::vec3 Position = (Vertex.m_Position - Center) / HalfExtent;
+				if (vConfig.m_Position == PositionEncoding::Snorm16) {
+					int16_t Values[4] = { encodeSnorm16(Position.x), encodeSnorm16(Position.y), encodeSnorm16(Position.z), 0 };
+					writeComponents(Output, PositionOffset, Values);
+				}
+				else {
+					uint16_t Values[4] = { encodeHalf(Position.x), encodeHalf(Position.y), encodeHalf(Position.z), 0 };
+					writeComponents(Output, PositionOffset, Values);
+				}
+
+				if (vConfig.m_TexCoord == TexCoordEncoding::Unorm16) {
+					glm::vec2 TexCoord = (Vertex.m_TexCoord - glm::vec2(Dequantization.m_TexCoordScaleOffset.z, Dequantization.m_TexCoordScaleOffset.w))
+						/ glm::vec2(Dequantization.m_TexCoordScaleOffset.x, Dequantization.m_TexCoordScaleOffset.y);
+					uint16_t Values[2] = { encodeUnorm16(TexCoord.x), encodeUnorm16(TexCoord.y) };
+					writeComponents(Output, TexCoordOffset, Values);
+				}
+				else {
+					uint16_t Values[2] = { encodeHalf(Vertex.m_TexCoord.x), encodeHalf(Vertex.m_TexCoord.y) };
+					writeComponents(Output, TexCoordOffset, Values);
+				}
+
+				if (Color) {
+					uint8_t Values[4] = { encodeUnorm8(Vertex.m_Color.x), encodeUnorm8(Vertex.m_Color.y), encodeUnorm8(Vertex.m_Color.z), 255 };
+					writeComponents(Output, Color->offset, Values);
+				}
+
+				glm::vec2 Normal = encodeOctahedral(Vertex.m_Normal);
+				if (vConfig.m_Normal == NormalEncoding::Octahedral16) {
+					int16_t Values[2] = { encodeSnorm16(Normal.x), encodeSnorm16(Normal.y) };
+					writeComponents(Output, NormalOffset, Values);
+				}
+				else {
+					int8_t Values[2] = { encodeSnorm8(Normal.x), encodeSnorm8(Normal.y) };
+					writeComponents(Output, NormalOffset, Values);
+				}
+			}
+			});
+		return Result;
+	}
+
+	VertexDequantization VertexQuantizer::getStreamDequantization(const MeshBounds& vBounds, const TexCoordBounds& vTexCoordBounds)
+	{
+		return getDequantization(vBounds.isValid() ? vBounds : MeshBounds{ glm::vec3(0.0f), glm::vec3(0.0f) }, &vTexCoordBounds);
+	}
+
+	void VertexQuantizer::quantizeStreams(std::span<const MeshPositionVertex> vPositions, std::span<const MeshAttributeVertex> vAttributes,
+		const VertexDequantization& vDequantization, std::span<QuantizedMeshVertex> vOutput)
+	{
+		if (vAttributes.size() != vPositions.size() || vOutput.size() != vPositions.size())
+			throw std::runtime_error("Failed to quantize vertex streams with mismatched sizes!");
+		const glm::vec3 Center(vDequantization.m_PositionOffset);
+		const glm::vec3 HalfExtent(vDequantization.m_PositionScale);
+		const glm::vec2 TexCoordOffset(vDequantization.m_TexCoordScaleOffset.z, vDequantization.m_TexCoordScaleOffset.w);
+		const glm::vec2 TexCoordScale(vDequantization.m_TexCoordScaleOffset.x, vDequantization.m_TexCoordScaleOffset.y);
+		for (size_t i = 0; i < vPositions.size(); ++i) {
+			const MeshAttributeVertex& Attribute = vAttributes[i];
+			glm::vec3 Position = (vPositions[i].m_Position - Center) / HalfExtent;
+			glm::vec2 Normal = encodeOctahedral(Attribute.m_Normal);
+			glm::vec2 TexCoord = (Attribute.m_TexCoord - TexCoordOffset) / TexCoordScale;
+			// 逐成员写入，输出可能是write-combined的映射内存，不读回
+			QuantizedMeshVertex& Output = vOutput[i];
+			Output.m_Position = { { encodeSnorm16(Position.x), encodeSnorm16(Position.y), encodeSnorm16(Position.z), 0 } };
+			Output.m_Normal = { { encodeSnorm16(Normal.x), encodeSnorm16(Normal.y) } };
+			Output.m_TexCoord = { { encodeUnorm16(TexCoord.x), encodeUnorm16(TexCoord.y) } };
+			Output.m_Color = { { encodeUnorm8(Attribute.m_Color.x), encodeUnorm8(Attribute.m_Color.y), encodeUnorm8(Attribute.m_Color.z), 255 } };
+		}
+	}
+
+	MeshVertex VertexQuantizer::dequantize(const QuantizedMesh& vMesh, size_t vIndex)
+	{
+		const QuantizationConfig& Config = vMesh.m_Config;
+		const VertexDequantization& Dequantization = vMesh.m_Dequantization;
+		const std::byte* Input = vMesh.m_Vertices.data() + vIndex * vMesh.m_Layout.m_Stride;
+		MeshVertex Vertex;
+
+		glm::vec3 Position;
+		if (Config.m_Position == PositionEncoding::Snorm16) {
+			int16_t Values[4];
+			readComponents(Input, findAttribute(vMesh.m_Layout, PositionLocation)->offset, Values);
+			Position = glm::vec3(decodeSnorm16(Values[0]), decodeSnorm16(Values[1]), decodeSnorm16(Values[2]));
+		}
+		else {
+			uint16_t Values[4];
+			readComponents(Input, findAttribute(vMesh.m_Layout, PositionLocation)->offset, Values);
+			Position = glm::vec3(decodeHalf(Values[0]), decodeHalf(Values[1]), decodeHalf(Values[2]));
+		}
+		Vertex.m_Position = Position * glm::vec3(Dequantization.m_PositionScale.x, Dequantization.m_PositionScale.y, Dequantization.m_PositionScale.z)
+			+ glm::vec3(Dequantization.m_PositionOffset.x, Dequantization.m_PositionOffset.y, Dequantization.m_PositionOffset.z);
+
+		uint16_t TexCoord[2];
+		readComponents(Input, findAttribute(vMesh.m_Layout, TexCoordLocation)->offset, TexCoord);
+		if (Config.m_TexCoord == TexCoordEncoding::Unorm16)
+			Vertex.m_TexCoord = glm::vec2(TexCoord[0] / 65535.0f, TexCoord[1] / 65535.0f) * glm::vec2(Dequantization.m_TexCoordScaleOffset.x, Dequantization.m_TexCoordScaleOffset.y)
+				+ glm::vec2(Dequantization.m_TexCoordScaleOffset.z, Dequantization.m_TexCoordScaleOffset.w);
+		else
+			Vertex.m_TexCoord = glm::vec2(decodeHalf(TexCoord[0]), decodeHalf(TexCoord[1]));
+
+		if (const VkVertexInputAttributeDescription* Color = findAttribute(vMesh.m_Layout, ColorLocation)) {
+			uint8_t Values[4];
+			readComponents(Input, Color->offset, Values);
+			Vertex.m_Color = glm::vec3(Values[0] / 255.0f, Values[1] / 255.0f, Values[2] / 255.0f);
+		}
+
+		uint32_t NormalOffset = findAttribute(vMesh.m_Layout, NormalLocation)->offset;
+		if (Config.m_Normal == NormalEncoding::Octahedral16) {
+			int16_t Values[2];
+			readComponents(Input, NormalOffset, Values);
+			Vertex.m_Normal = decodeOctahedral(glm::vec2(decodeSnorm16(Values[0]), decodeSnorm16(Values[1])));
+		}
+		else {
+			int8_t Values[2];
+			readComponents(Input, NormalOffset, Values);
+			Vertex.m_Normal = decodeOctahedral(glm::vec2(std::max(Values[0] / 127.0f, -1.0f), std::max(Values[1] / 127.0f, -1.0f)));
+		}
+		return Vertex;
+	}
+
+	void VertexQuantizer::report(const Mesh& vSource, const QuantizedMesh& vQuantized)
+	{
+		float MaxPositionError = 0.0f, MaxTexCoordError = 0.0f, MaxNormalAngle = 0.0f;
+		for (size_t i = 0; i < vSource.m_Vertices.size(); ++i) {
+			const MeshVertex& Source = vSource.m_Vertices[i];
+			MeshVertex Decoded = dequantize(vQuantized, i);
+			MaxPositionError = std::max(MaxPositionError, glm::distance(Source.m_Position, Decoded.m_Position));
+			MaxTexCoordError = std::max(MaxTexCoordError, glm::distance(Source.m_TexCoord, Decoded.m_TexCoord));
+			float Length = glm::length(Source.m_Normal);
+			if (Length > 0.0f) {
+				float Cosine = std::clamp(glm::dot(Source.m_Normal / Length, Decoded.m_Normal), -1.0f, 1.0f);
+				MaxNormalAngle = std::max(MaxNormalAngle, std::acos(Cosine));
+			}
+		}
+		size_t SourceBytes = vSource.m_Vertices.size() * sizeof(MeshVertex);
+		std::cout << std::format("\tquantize: {0} -> {1} bytes per vertex, {2} -> {3} KB ({4:.2f}x)\n", sizeof(MeshVertex), vQuantized.m_Layout.m_Stride,
+			SourceBytes / 1024, vQuantized.m_Vertices.size() / 1024, vQuantized.m_Vertices.empty() ? 0.0 : static_cast<double>(SourceBytes) / vQuantized.m_Vertices.size());
+		std::cout << std::format("\tquantize error: position {0:.6f} (extent {1:.3f}), texcoord {2:.6f}, normal {3:.3f} deg\n", MaxPositionError,
+			glm::length(vSource.m_Bounds.getExtent()), MaxTexCoordError, MaxNormalAngle * 57.29578f);
+	}
+
+	uint16_t VertexQuantizer::encodeHalf(float vValue)
+	{
+		uint32_t Bits = 0;
+		std::memcpy(&Bits, &vValue, sizeof(Bits));
+		uint32_t Sign = (Bits >> 16) & 0x8000;
+		uint32_t Magnitude = Bits & 0x7FFFFFFF;
+		if (Magnitude >= 0x7F800000)                      // inf/nan
+			return static_cast<uint16_t>(Sign | (Magnitude > 0x7F800000 ? 0x7E00 : 0x7C00));
+		if (Magnitude >= 0x477FF000)                      // 超出half范围
+			return static_cast<uint16_t>(Sign | 0x7C00);
+		if (Magnitude < 0x38800000) {                     // half的非规格化数
+			float Absolute;
+			std::memcpy(&Absolute, &Magnitude, sizeof(Absolute));
+			return static_cast<uint16_t>(Sign | static_cast<uint32_t>(std::nearbyint(Absolute * 16777216.0f)));
+		}
+		uint32_t Rounded = Magnitude + 0x0FFF + ((Magnitude >> 13) & 1);  // 就近舍入到偶数
+		return static_cast<uint16_t>(Sign | ((Rounded - 0x38000000) >> 13));
+	}
+
+	float VertexQuantizer::decodeHalf(uint16_t vValue)
+	{
+		uint32_t Sign = static_cast<uint32_t>(vValue & 0x8000) << 16;
+		uint32_t Exponent = (vValue >> 10) & 0x1F;
+		uint32_t Mantissa = vValue & 0x3FF;
+		if (Exponent == 0) {
+			float Value = std::ldexp(static_cast<float>(Mantissa), -24);
+			return Sign ? -Value : Value;
+		}
+		uint32_t Bits = Exponent == 31 ? (Sign | 0x7F800000 | (Mantissa << 13)) : (Sign | ((Exponent + 112) << 23) | (Mantissa << 13));
+		float Value;
+		std::memcpy(&Value, &Bits, sizeof(Value));
+		return Value;
+	}
+
+	// 法线投影到八面体再展开到[-1, 1]^2，下半球折叠到四个角上
+	glm::vec2 VertexQuantizer::encodeOctahedral(const glm::vec3& vNormal)
+	{
+		float Sum = std::abs(vNormal.x) + std::abs(vNormal.y) + std::abs(vNormal.z);
+		if (Sum == 0.0f)
+			return glm::vec2(0.0f);
+		glm::vec2 Result(vNormal.x / Sum, vNormal.y / Sum);
+		if (vNormal.z < 0.0f)
+			Result = glm::vec2((1.0f - std::abs(Result.y)) * signNotZero(Result.x), (1.0f - std::abs(Result.x)) * signNotZero(Result.y));
+		return Result;
+	}
+
+	glm::vec3 VertexQuantizer::decodeOctahedral(const glm::vec2& vEncoded)
+	{
+		glm::vec3 Normal(vEncoded.x, vEncoded.y, 1.0f - std::abs(vEncoded.x) - std::abs(vEncoded.y));
+		float Fold = std::max(-Normal.z, 0.0f);
+		Normal.x += Normal.x >= 0.0f ? -Fold : Fold;
+		Normal.y += Normal.y >= 0.0f ? -Fold : Fold;
+		return glm::normalize(Normal);
+	}
+
+}
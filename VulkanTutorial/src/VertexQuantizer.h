@@ -0,0 +1,108 @@
+#pragma once
+#include "Mesh.h"
+#include "VertexLayout.h"
+
+#include <glm/glm.hpp>
+#include <vulkan/vulkan.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace VulkanTutorial {
+
+	enum class PositionEncoding : uint8_t
+	{
+		Snorm16 = 0,   // 相对包围盒归一化到[-1, 1]
+		Half
+	};
+
+	enum class TexCoordEncoding : uint8_t
+	{
+		Unorm16 = 0,   // 相对纹理坐标范围归一化到[0, 1]
+		Half
+	};
+
+	enum class NormalEncoding : uint8_t
+	{
+		Octahedral16 = 0,
+		Octahedral8
+	};
+
+	struct QuantizationConfig
+	{
+		PositionEncoding m_Position = PositionEncoding::Snorm16;
+		TexCoordEncoding m_TexCoord = TexCoordEncoding::Unorm16;
+		NormalEncoding m_Normal = NormalEncoding::Octahedral16;
+		bool m_HasColor = true;    // unorm8，没有顶点颜色的网格可以省掉
+	};
+
+	// 量化后的顶点布局，location固定为 0:位置 1:法线 2:纹理坐标 3:颜色，属性按location顺序排列
+	struct QuantizedLayout
+	{
+		uint32_t m_Stride = 0;
+		std::vector<VkVertexInputAttributeDescription> m_Attributes;
+
+		VkVertexInputBindingDescription getBindingDescription(uint32_t vBinding = 0) const;
+		std::vector<VkVertexInputAttributeDescription> getAttributeDescriptions(uint32_t vBinding = 0) const;
+	};
+
+	// 默认QuantizationConfig下的量化顶点，即MeshletRenderer顶点着色器路径绑定的顶点流，顶点输入描述由成员类型生成
+	struct QuantizedMeshVertex
+	{
+		Snorm16x4 m_Position;   // 相对包围盒归一化，w为0
+		Snorm16x2 m_Normal;     // 八面体编码
+		Unorm16x2 m_TexCoord;   // 相对纹理坐标范围归一化
+		Unorm8x4 m_Color;
+	};
+	using QuantizedMeshVertexLayout = VertexStreamLayout<QuantizedMeshVertex>;
+
+	static_assert(QuantizedMeshVertexLayout::getStride(0) == 20, "Quantized vertices must stay 20 bytes");
+
+	// shader中的反量化参数，作为vertex stage的push constant：
+	// position = q * m_PositionScale + m_PositionOffset, texCoord = q * m_TexCoordScaleOffset.xy + m_TexCoordScaleOffset.zw
+	struct VertexDequantization
+	{
+		static constexpr uint32_t PushConstantOffset = 64;  // 排在viewProjection矩阵之后，与quantized_mesh.vert一致
+
+		glm::vec4 m_PositionScale = glm::vec4(1.0f);
+		glm::vec4 m_PositionOffset = glm::vec4(0.0f);
+		glm::vec4 m_TexCoordScaleOffset = glm::vec4(1.0f, 1.0f, 0.0f, 0.0f);
+	};
+
+	struct QuantizedMesh
+	{
+		QuantizationConfig m_Config;
+		QuantizedLayout m_Layout;
+		VertexDequantization m_Dequantization;
+		std::vector<std::byte> m_Vertices;
+		std::vector<uint32_t> m_Indices;
+		std::vector<MeshLod> m_Lods;
+		MeshBounds m_Bounds;
+
+		inline size_t getVertexCount() const { return m_Layout.m_Stride ? m_Vertices.size() / m_Layout.m_Stride : 0; }
+	};
+
+	// 把MeshVertex(44字节)压缩为20字节左右的量化顶点，顶点获取时由硬件把SNORM/UNORM/half转成float，
+	// 再在vertex shader中(resources/shaders/glsl/quantized_mesh.vert)乘加还原
+	class VertexQuantizer
+	{
+	public:
+		static QuantizedLayout getLayout(const QuantizationConfig& vConfig);
+		static QuantizedMesh quantize(const Mesh& vMesh, const QuantizationConfig& vConfig = {});
+		// 流式量化：反量化参数只取决于包围盒和纹理坐标范围，可以在解码前确定；之后把逐块解码出的两个顶点流
+		// 按默认QuantizationConfig量化进vOutput(可以是映射的staging内存)，不需要整个网格的中间数组
+		static VertexDequantization getStreamDequantization(const MeshBounds& vBounds, const TexCoordBounds& vTexCoordBounds);
+		static void quantizeStreams(std::span<const MeshPositionVertex> vPositions, std::span<const MeshAttributeVertex> vAttributes,
+			const VertexDequantization& vDequantization, std::span<QuantizedMeshVertex> vOutput);
+		static MeshVertex dequantize(const QuantizedMesh& vMesh, size_t vIndex);  // CPU端还原，与shader一致，用于误差统计
+		static void report(const Mesh& vSource, const QuantizedMesh& vQuantized);
+
+		static uint16_t encodeHalf(float vValue);
+		static float decodeHalf(uint16_t vValue);
+		static glm::vec2 encodeOctahedral(const glm::vec3& vNormal);
+		static glm::vec3 decodeOctahedral(const glm::vec2& vEncoded);
+	};
+
+}
@@ -9,8 +9,9 @@
 
 #include "Application.h"
 
-int main() {
+int main(int argc, char** argv) {
     VulkanTutorial::Application App;
+    App.parseArguments(argc, argv); // --shader-object, --benchmark-backends, --import-mesh <path>, --mesh <path>, --mesh-shader
     try {
         App.run();
     }